@@ -2,18 +2,22 @@
 #include "PreCompactionCellCycleModel.hpp"
 #include "DifferentiatedCellProliferativeType.hpp"
 #include "TrophectodermCellProliferativeType.hpp"
+#include "ObjectPool.hpp"
+#include "CounterBasedRandomStreams.hpp"
 
 PreCompactionCellCycleModel::PreCompactionCellCycleModel()
     : AbstractSimpleCellCycleModel(),
       mMinCellCycleDuration(18.0), // Hours
-      mMaxCellCycleDuration(22.0)  // Hours
+      mMaxCellCycleDuration(22.0), // Hours
+      mCellCycleDurationScaling(2.0)
 {
 }
 
 PreCompactionCellCycleModel::PreCompactionCellCycleModel(const PreCompactionCellCycleModel& rModel)
 : AbstractSimpleCellCycleModel(rModel),
 mMinCellCycleDuration(rModel.mMinCellCycleDuration),
-mMaxCellCycleDuration(rModel.mMaxCellCycleDuration)
+mMaxCellCycleDuration(rModel.mMaxCellCycleDuration),
+mCellCycleDurationScaling(rModel.mCellCycleDurationScaling)
 {
     /*
      * Initialize only those member variables defined in this class.
@@ -29,6 +33,16 @@ mMaxCellCycleDuration(rModel.mMaxCellCycleDuration)
      */
 }
 
+void* PreCompactionCellCycleModel::operator new(size_t size)
+{
+    return ObjectPool<PreCompactionCellCycleModel>::Instance()->Allocate(size);
+}
+
+void PreCompactionCellCycleModel::operator delete(void* pObject)
+{
+    ObjectPool<PreCompactionCellCycleModel>::Instance()->Deallocate(pObject);
+}
+
 AbstractCellCycleModel* PreCompactionCellCycleModel::CreateCellCycleModel()
 {
     return new PreCompactionCellCycleModel(*this);
@@ -36,25 +50,65 @@ AbstractCellCycleModel* PreCompactionCellCycleModel::CreateCellCycleModel()
 
 void PreCompactionCellCycleModel::SetCellCycleDuration()
 {
-    RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
-
     //Check that the cell actually exists
     assert(mpCell != NULL);
     
-    if (mpCell->GetCellProliferativeType()->IsType<DifferentiatedCellProliferativeType>()) 
+    mCellCycleDurationScaling = GetCellCycleDurationScalingForType();
+    if (mCellCycleDurationScaling == DBL_MAX) 
     {
         mCellCycleDuration = DBL_MAX;
 	//Differentiated Cells shouldn't divide
     }
+    else
+    {
+        // Drawn from the cell's stream if counter-based random streams are enabled
+        double u = CounterBasedRandomStreams::Instance()->ranf(mpCell->GetCellId(), CounterBasedRandomStreams::CELL_CYCLE_DURATION, 0);
+        mCellCycleDuration = mCellCycleDurationScaling*(mMinCellCycleDuration + (mMaxCellCycleDuration - mMinCellCycleDuration) * u);
+        // U[MinCCD,MaxCCD] for trophectoderm, twice this for ICM
+    }
+}
+
+double PreCompactionCellCycleModel::GetCellCycleDurationScalingForType()
+{
+    if (mpCell->GetCellProliferativeType()->IsType<DifferentiatedCellProliferativeType>()) 
+    {
+        return DBL_MAX;
+    }
     else if (mpCell->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>())
     {
-	mCellCycleDuration = (mMinCellCycleDuration + (mMaxCellCycleDuration - mMinCellCycleDuration) * p_gen->ranf());
 	//Trophectoderm Cell Cycle time should be half that of ICM
+        return 1.0;
+    }
+    else
+    {
+        return 2.0;
+    }
+}
+
+void PreCompactionCellCycleModel::RescaleCellCycleDurationForType()
+{
+    assert(mpCell != NULL);
+    
+    double scaling = GetCellCycleDurationScalingForType();
+    if (mCellCycleDurationScaling == 0.0)
+    {
+        // Loaded from an archive without the scaling, so take the duration as drawn for the cell's current type
+        mCellCycleDurationScaling = scaling;
+    }
+    if (scaling == mCellCycleDurationScaling)
+    {
+        return;
+    }
+    
+    if (scaling == DBL_MAX || mCellCycleDurationScaling == DBL_MAX)
+    {
+        // There is no drawn duration to rescale, or the cell should no longer divide
+        SetCellCycleDuration();
     }
     else
     {
-        mCellCycleDuration = 2.0*(mMinCellCycleDuration + (mMaxCellCycleDuration - mMinCellCycleDuration) * p_gen->ranf());
-        // U[MinCCD,MaxCCD]
+        mCellCycleDuration *= scaling/mCellCycleDurationScaling;
+        mCellCycleDurationScaling = scaling;
     }
 }
 
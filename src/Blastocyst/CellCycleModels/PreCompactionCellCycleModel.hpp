@@ -4,6 +4,7 @@
 
 #include "AbstractSimpleCellCycleModel.hpp"
 #include "RandomNumberGenerator.hpp"
+#include <boost/serialization/version.hpp>
 
 class PreCompactionCellCycleModel : public AbstractSimpleCellCycleModel
 {
@@ -15,6 +16,12 @@ private:
     
     double mMaxCellCycleDuration;
     
+    // Multiple of U[MinCCD,MaxCCD] used for mCellCycleDuration, given the cell's type when it was drawn (DBL_MAX if the cell never divides).
+    // Zero if unknown, as after loading an archive of version 0, until it is derived from the cell's current type.
+    double mCellCycleDurationScaling;
+    
+    double GetCellCycleDurationScalingForType();
+    
     friend class boost::serialization::access;
     template<class Archive>
     void serialize(Archive & archive, const unsigned int version)
@@ -26,6 +33,15 @@ private:
         archive & p_wrapper;
         archive & mMinCellCycleDuration;
         archive & mMaxCellCycleDuration;
+        if (version > 0)
+        {
+            archive & mCellCycleDurationScaling;
+        }
+        else
+        {
+            // The cell is not yet known while loading, so the scaling is derived from its type on first use
+            mCellCycleDurationScaling = 0.0;
+        }
     }
     
 protected:
@@ -36,8 +52,20 @@ public:
     
     PreCompactionCellCycleModel();
     
+    // Allocate from an ObjectPool, so that the models created at each division sit together in memory
+    static void* operator new(size_t size);
+    
+    static void operator delete(void* pObject);
+    
     void SetCellCycleDuration();
     
+    /**
+     * Rescale the current cell-cycle duration after the cell's proliferative type has changed, so that
+     * for example a cell becoming trophectoderm has its remaining cycle shortened as if it had been
+     * trophectoderm when the duration was drawn. Callers should then reschedule the cell's division.
+     */
+    void RescaleCellCycleDurationForType();
+    
     AbstractCellCycleModel* CreateCellCycleModel();
     
     double GetMinCellCycleDuration();
@@ -59,6 +87,9 @@ public:
 // Declare identifier for the serializer
 CHASTE_CLASS_EXPORT(PreCompactionCellCycleModel)
 
+// Version 1 archives mCellCycleDurationScaling
+BOOST_CLASS_VERSION(PreCompactionCellCycleModel, 1)
+
 #endif /* PRECOMPACTIONCELLCYCLEMODEL_HPP_ */
 
 
@@ -35,7 +35,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "PolarityFirstFocusVectorWriter.hpp"
 #include "TrophectodermCellProliferativeType.hpp"
-#include "CellPolaritySrnModel.hpp"
+#include "CellPolarityVectors.hpp"
 #include "NodeBasedCellPopulation.hpp"
 
 
@@ -54,22 +54,12 @@ c_vector<double, SPACE_DIM> PolarityFirstFocusVectorWriter<ELEMENT_DIM, SPACE_DI
 {
     assert(this->mOutputVectorData);
 
-    c_vector<double, SPACE_DIM> orientation;
-    
-    CellPolaritySrnModel* p_srn_model_A = static_cast<CellPolaritySrnModel*>(pCell->GetSrnModel());
-    
-    // NOTE: Here we assert that the cell does actually have the right SRN model
-	  assert(p_srn_model_A != nullptr);
-    double angle_A = p_srn_model_A->GetPolarityAngle();
-    if(pCell->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>())
-    {
-        orientation[0] = -sin(angle_A);
-        orientation[1] = cos(angle_A);
-    }
-    else
+    c_vector<double, SPACE_DIM> orientation = zero_vector<double>(SPACE_DIM);
+
+    // Only trophectoderm cells are drawn with foci; in 3D this is one point of the focal ring
+    if (pCell->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>())
     {
-        orientation[0] = 0.0;
-        orientation[1] = 0.0;
+        orientation = CellPolarityVectors::GetPerpendicularVector<SPACE_DIM>(CellPolarityVectors::GetPolarityVector<SPACE_DIM>(pCell));
     }
 
     return orientation;
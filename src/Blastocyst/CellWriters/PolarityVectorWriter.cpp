@@ -35,7 +35,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "PolarityVectorWriter.hpp"
 #include "TrophectodermCellProliferativeType.hpp"
-#include "CellPolaritySrnModel.hpp"
+#include "CellPolarityVectors.hpp"
 #include "NodeBasedCellPopulation.hpp"
 
 
@@ -54,22 +54,12 @@ c_vector<double, SPACE_DIM> PolarityVectorWriter<ELEMENT_DIM, SPACE_DIM>::GetVec
 {
     assert(this->mOutputVectorData);
 
-    c_vector<double, SPACE_DIM> orientation;
-    
-    CellPolaritySrnModel* p_srn_model_A = static_cast<CellPolaritySrnModel*>(pCell->GetSrnModel());
-    
-    // NOTE: Here we assert that the cell does actually have the right SRN model
-	  assert(p_srn_model_A != nullptr);
-    double angle_A = p_srn_model_A->GetPolarityAngle();
-    if(pCell->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>())
-    {
-        orientation[0] = cos(angle_A);
-        orientation[1] = sin(angle_A);
-    }
-    else
+    c_vector<double, SPACE_DIM> orientation = zero_vector<double>(SPACE_DIM);
+
+    // Only trophectoderm cells are drawn with a polarity
+    if (pCell->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>())
     {
-        orientation[0] = 0.0;
-        orientation[1] = 0.0;
+        orientation = CellPolarityVectors::GetPolarityVector<SPACE_DIM>(pCell);
     }
 
     return orientation;
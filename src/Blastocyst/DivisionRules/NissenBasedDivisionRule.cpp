@@ -34,20 +34,115 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "NissenBasedDivisionRule.hpp"
-#include "RandomNumberGenerator.hpp"
+
+#include <algorithm>
+#include <cfloat>
+
+#include "CounterBasedRandomStreams.hpp"
 #include "TrophectodermCellProliferativeType.hpp"
-#include "CellPolaritySrnModel.hpp"
+#include "CellPolarityVectors.hpp"
+#include "NodeBasedCellPopulation.hpp"
 
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
 std::pair<c_vector<double, SPACE_DIM>, c_vector<double, SPACE_DIM> > NissenBasedDivisionRule<ELEMENT_DIM, SPACE_DIM>::CalculateCellDivisionVector(
     CellPtr pParentCell,
     AbstractCentreBasedCellPopulation<ELEMENT_DIM, SPACE_DIM>& rCellPopulation)
+{
+    typename std::map<Cell*, std::pair<c_vector<double, SPACE_DIM>, c_vector<double, SPACE_DIM> > >::iterator iter =
+        mBatchedDivisionVectors.find(pParentCell.get());
+    if (iter != mBatchedDivisionVectors.end())
+    {
+        std::pair<c_vector<double, SPACE_DIM>, c_vector<double, SPACE_DIM> > positions = iter->second;
+        mBatchedDivisionVectors.erase(iter);
+        return positions;
+    }
+
+    return ComputeDivisionVector(pParentCell, rCellPopulation);
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenBasedDivisionRule<ELEMENT_DIM, SPACE_DIM>::CalculateDivisionVectorsForBatch(
+    const std::vector<CellPtr>& rParentCells,
+    AbstractCentreBasedCellPopulation<ELEMENT_DIM, SPACE_DIM>& rCellPopulation)
+{
+    mBatchedDivisionVectors.clear();
+    mPlacedDaughters.clear();
+    mPlacedParentIndices.clear();
+    for (unsigned i=0; i<rParentCells.size(); i++)
+    {
+        std::pair<c_vector<double, SPACE_DIM>, c_vector<double, SPACE_DIM> > positions = ComputeDivisionVector(rParentCells[i], rCellPopulation);
+        mBatchedDivisionVectors[rParentCells[i].get()] = positions;
+
+        // Later parents in the batch should avoid these daughters, rather than this parent's current position
+        unsigned parent_index = rCellPopulation.GetLocationIndexUsingCell(rParentCells[i]);
+        double radius = rCellPopulation.GetNode(parent_index)->GetRadius();
+        mPlacedDaughters.push_back(std::make_pair(positions.first, radius));
+        mPlacedDaughters.push_back(std::make_pair(positions.second, radius));
+        mPlacedParentIndices.insert(parent_index);
+    }
+    mPlacedDaughters.clear();
+    mPlacedParentIndices.clear();
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenBasedDivisionRule<ELEMENT_DIM, SPACE_DIM>::GetNumBatchedDivisions() const
+{
+    return mBatchedDivisionVectors.size();
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+bool NissenBasedDivisionRule<ELEMENT_DIM, SPACE_DIM>::GetUseOverlapAwarePlacement() const
+{
+    return mUseOverlapAwarePlacement;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenBasedDivisionRule<ELEMENT_DIM, SPACE_DIM>::SetUseOverlapAwarePlacement(bool useOverlapAwarePlacement)
+{
+    mUseOverlapAwarePlacement = useOverlapAwarePlacement;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenBasedDivisionRule<ELEMENT_DIM, SPACE_DIM>::GetNumCandidateDirections() const
+{
+    return mNumCandidateDirections;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenBasedDivisionRule<ELEMENT_DIM, SPACE_DIM>::SetNumCandidateDirections(unsigned numCandidateDirections)
+{
+    assert(numCandidateDirections > 0);
+    mNumCandidateDirections = numCandidateDirections;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenBasedDivisionRule<ELEMENT_DIM, SPACE_DIM>::GetMaximumPolarityDeviation() const
+{
+    return mMaximumPolarityDeviation;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenBasedDivisionRule<ELEMENT_DIM, SPACE_DIM>::SetMaximumPolarityDeviation(double maximumPolarityDeviation)
+{
+    assert(maximumPolarityDeviation >= 0.0 && maximumPolarityDeviation <= 0.5*M_PI);
+    mMaximumPolarityDeviation = maximumPolarityDeviation;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+std::pair<c_vector<double, SPACE_DIM>, c_vector<double, SPACE_DIM> > NissenBasedDivisionRule<ELEMENT_DIM, SPACE_DIM>::ComputeDivisionVector(
+    CellPtr pParentCell,
+    AbstractCentreBasedCellPopulation<ELEMENT_DIM, SPACE_DIM>& rCellPopulation)
 {
     // Get separation parameter
     double separation = rCellPopulation.GetMeinekeDivisionSeparation();
 
+    // The random numbers are drawn from the parent's stream if counter-based random streams are enabled
+    CounterBasedRandomStreams* p_streams = CounterBasedRandomStreams::Instance();
+    unsigned parent_id = pParentCell->GetCellId();
+
     // Make a random direction vector of the required length
     c_vector<double, SPACE_DIM> polarity_dependent_vector;
+    bool is_constrained_by_polarity = false;
 
     /*
      * Pick a random direction and move the parent cell backwards by 0.5*separation
@@ -58,7 +153,7 @@ std::pair<c_vector<double, SPACE_DIM>, c_vector<double, SPACE_DIM> > NissenBased
     {
         case 1:
         {
-            double random_direction = -1.0 + 2.0*(RandomNumberGenerator::Instance()->ranf() < 0.5);
+            double random_direction = -1.0 + 2.0*(p_streams->ranf(parent_id, CounterBasedRandomStreams::DIVISION_DIRECTION, 0) < 0.5);
 
             polarity_dependent_vector(0) = 0.5*separation*random_direction;
             break;
@@ -69,14 +164,13 @@ std::pair<c_vector<double, SPACE_DIM>, c_vector<double, SPACE_DIM> > NissenBased
             //perpendicular to the polarity axis
             if (pParentCell->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>())
             {
-                CellPolaritySrnModel* pParent_Srn_Model = static_cast<CellPolaritySrnModel*>(pParentCell->GetSrnModel());
-                double directed_angle = pParent_Srn_Model->GetPolarityAngle() + M_PI/2.0;
-                polarity_dependent_vector(0) = 0.5*separation*cos(directed_angle);
-                polarity_dependent_vector(1) = 0.5*separation*sin(directed_angle);
+                c_vector<double, SPACE_DIM> polarity = CellPolarityVectors::GetPolarityVector<SPACE_DIM>(pParentCell);
+                is_constrained_by_polarity = true;
+                polarity_dependent_vector = 0.5*separation*CellPolarityVectors::GetPerpendicularVector<SPACE_DIM>(polarity);
             }
             else
             {
-                double random_angle = 2.0*M_PI*RandomNumberGenerator::Instance()->ranf();
+                double random_angle = 2.0*M_PI*p_streams->ranf(parent_id, CounterBasedRandomStreams::DIVISION_DIRECTION, 0);
 
                 polarity_dependent_vector(0) = 0.5*separation*cos(random_angle);
                 polarity_dependent_vector(1) = 0.5*separation*sin(random_angle);
@@ -85,14 +179,31 @@ std::pair<c_vector<double, SPACE_DIM>, c_vector<double, SPACE_DIM> > NissenBased
         }
         case 3:
         {
+            //A trophectoderm cell divides in the plane normal to its polarity, along a random direction in that plane
+            c_vector<double, SPACE_DIM> polarity = CellPolarityVectors::GetPolarityVector<SPACE_DIM>(pParentCell);
+            if (pParentCell->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>()
+                && norm_2(polarity) > 0.0)
+            {
+                c_vector<double, SPACE_DIM> first_axis = CellPolarityVectors::GetPerpendicularVector<SPACE_DIM>(polarity);
+                c_vector<double, SPACE_DIM> second_axis;
+                second_axis(0) = polarity(1)*first_axis(2) - polarity(2)*first_axis(1);
+                second_axis(1) = polarity(2)*first_axis(0) - polarity(0)*first_axis(2);
+                second_axis(2) = polarity(0)*first_axis(1) - polarity(1)*first_axis(0);
+
+                double random_angle = 2.0*M_PI*p_streams->ranf(parent_id, CounterBasedRandomStreams::DIVISION_DIRECTION, 0);
+                is_constrained_by_polarity = true;
+                polarity_dependent_vector = 0.5*separation*(cos(random_angle)*first_axis + sin(random_angle)*second_axis);
+                break;
+            }
+
             /*
              * Note that to pick a random point on the surface of a sphere, it is incorrect
              * to select spherical coordinates from uniform distributions on [0, 2*pi) and
              * [0, pi) respectively, since points picked in this way will be 'bunched' near
              * the poles. See #2230.
              */
-            double u = RandomNumberGenerator::Instance()->ranf();
-            double v = RandomNumberGenerator::Instance()->ranf();
+            double u = p_streams->ranf(parent_id, CounterBasedRandomStreams::DIVISION_DIRECTION, 0);
+            double v = p_streams->ranf(parent_id, CounterBasedRandomStreams::DIVISION_DIRECTION, 1);
 
             double random_azimuth_angle = 2*M_PI*u;
             double random_zenith_angle = std::acos(2*v - 1);
@@ -107,14 +218,186 @@ std::pair<c_vector<double, SPACE_DIM>, c_vector<double, SPACE_DIM> > NissenBased
             NEVER_REACHED;
     }
 
-    c_vector<double, SPACE_DIM> parent_position = rCellPopulation.GetLocationOfCellCentre(pParentCell) - polarity_dependent_vector;
-    c_vector<double, SPACE_DIM> daughter_position = parent_position + polarity_dependent_vector;
+    // In more than one dimension, the axis may be turned away from neighbouring cells
+    if (mUseOverlapAwarePlacement && SPACE_DIM > 1)
+    {
+        polarity_dependent_vector = ChooseLeastOverlappingDisplacement(pParentCell, rCellPopulation,
+                                                                       polarity_dependent_vector,
+                                                                       is_constrained_by_polarity);
+    }
+
+    return PlaceDaughters(rCellPopulation.GetLocationOfCellCentre(pParentCell), polarity_dependent_vector);
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+std::pair<c_vector<double, SPACE_DIM>, c_vector<double, SPACE_DIM> > NissenBasedDivisionRule<ELEMENT_DIM, SPACE_DIM>::PlaceDaughters(
+    const c_vector<double, SPACE_DIM>& rCentre,
+    const c_vector<double, SPACE_DIM>& rDisplacement)
+{
+    if (mUseOverlapAwarePlacement)
+    {
+        // Both daughters move off the parent's centre, so that both are clear of the neighbours scored
+        std::pair<c_vector<double, SPACE_DIM>, c_vector<double, SPACE_DIM> > positions(rCentre - rDisplacement, rCentre + rDisplacement);
+        return positions;
+    }
+
+    c_vector<double, SPACE_DIM> parent_position = rCentre - rDisplacement;
+    c_vector<double, SPACE_DIM> daughter_position = parent_position + rDisplacement;
 
     std::pair<c_vector<double, SPACE_DIM>, c_vector<double, SPACE_DIM> > positions(parent_position, daughter_position);
 
     return positions;
 }
 
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+c_vector<double, SPACE_DIM> NissenBasedDivisionRule<ELEMENT_DIM, SPACE_DIM>::ChooseLeastOverlappingDisplacement(
+    CellPtr pParentCell,
+    AbstractCentreBasedCellPopulation<ELEMENT_DIM, SPACE_DIM>& rCellPopulation,
+    const c_vector<double, SPACE_DIM>& rDefaultDisplacement,
+    bool isConstrainedByPolarity)
+{
+    unsigned parent_index = rCellPopulation.GetLocationIndexUsingCell(pParentCell);
+    Node<SPACE_DIM>* p_parent_node = rCellPopulation.GetNode(parent_index);
+    c_vector<double, SPACE_DIM> centre = rCellPopulation.GetLocationOfCellCentre(pParentCell);
+    double parent_radius = p_parent_node->GetRadius();
+    double displacement_length = norm_2(rDefaultDisplacement);
+
+    /*
+     * Find the cells a daughter could overlap. For a node-based population these are the nodes within
+     * a daughter's displacement plus a cell diameter of the parent, as far as the node neighbour lists
+     * allow; otherwise we use the population's own neighbours.
+     */
+    std::set<unsigned> neighbour_indices;
+    NodeBasedCellPopulation<SPACE_DIM>* p_node_based_population = dynamic_cast<NodeBasedCellPopulation<SPACE_DIM>*>(&rCellPopulation);
+    if (p_node_based_population)
+    {
+        double search_radius = std::min(displacement_length + 2.0*parent_radius,
+                                        p_node_based_population->rGetMesh().GetMaximumInteractionDistance());
+        neighbour_indices = p_node_based_population->GetNodesWithinNeighbourhoodRadius(parent_index, search_radius);
+    }
+    else
+    {
+        neighbour_indices = rCellPopulation.GetNeighbouringNodeIndices(parent_index);
+    }
+
+    std::vector<std::pair<c_vector<double, SPACE_DIM>, double> > obstacles(mPlacedDaughters);
+    for (std::set<unsigned>::iterator iter = neighbour_indices.begin(); iter != neighbour_indices.end(); ++iter)
+    {
+        if (*iter != parent_index && mPlacedParentIndices.find(*iter) == mPlacedParentIndices.end())
+        {
+            Node<SPACE_DIM>* p_node = rCellPopulation.GetNode(*iter);
+            obstacles.push_back(std::make_pair(p_node->rGetLocation(), p_node->GetRadius()));
+        }
+    }
+    if (obstacles.empty())
+    {
+        return rDefaultDisplacement;
+    }
+
+    // Generate the candidate displacements, starting with the default
+    std::vector<c_vector<double, SPACE_DIM> > candidates(1, rDefaultDisplacement);
+    if (SPACE_DIM == 2)
+    {
+        std::vector<double> rotations;
+        if (isConstrainedByPolarity)
+        {
+            // Deviate either side of the perpendicular to the polarity, nearest first so that ties keep the axis
+            unsigned num_each_side = std::max(1u, (mNumCandidateDirections - 1)/2);
+            if (mMaximumPolarityDeviation > 0.0 && mNumCandidateDirections > 1)
+            {
+                for (unsigned k=1; k<=num_each_side; k++)
+                {
+                    double rotation = mMaximumPolarityDeviation*double(k)/double(num_each_side);
+                    rotations.push_back(rotation);
+                    rotations.push_back(-rotation);
+                }
+            }
+        }
+        else
+        {
+            // The two daughters are interchangeable, so directions over half a turn cover every axis
+            for (unsigned k=1; k<mNumCandidateDirections; k++)
+            {
+                rotations.push_back(M_PI*double(k)/double(mNumCandidateDirections));
+            }
+        }
+
+        for (unsigned i=0; i<rotations.size(); i++)
+        {
+            c_vector<double, SPACE_DIM> candidate;
+            candidate(0) = cos(rotations[i])*rDefaultDisplacement(0) - sin(rotations[i])*rDefaultDisplacement(1);
+            candidate(1) = sin(rotations[i])*rDefaultDisplacement(0) + cos(rotations[i])*rDefaultDisplacement(1);
+            candidates.push_back(candidate);
+        }
+    }
+    else if (SPACE_DIM == 3 && isConstrainedByPolarity)
+    {
+        // Turn the axis about the polarity, keeping it in the plane normal to the polarity
+        c_vector<double, SPACE_DIM> polarity = CellPolarityVectors::GetPolarityVector<SPACE_DIM>(pParentCell);
+        c_vector<double, SPACE_DIM> polarity_cross_default;
+        polarity_cross_default(0) = polarity(1)*rDefaultDisplacement(2) - polarity(2)*rDefaultDisplacement(1);
+        polarity_cross_default(1) = polarity(2)*rDefaultDisplacement(0) - polarity(0)*rDefaultDisplacement(2);
+        polarity_cross_default(2) = polarity(0)*rDefaultDisplacement(1) - polarity(1)*rDefaultDisplacement(0);
+
+        for (unsigned k=1; k<mNumCandidateDirections; k++)
+        {
+            double rotation = M_PI*double(k)/double(mNumCandidateDirections);
+            candidates.push_back(c_vector<double, SPACE_DIM>(cos(rotation)*rDefaultDisplacement + sin(rotation)*polarity_cross_default));
+        }
+    }
+    else if (SPACE_DIM == 3)
+    {
+        // Random axes, drawn after the two numbers used for the default axis
+        CounterBasedRandomStreams* p_streams = CounterBasedRandomStreams::Instance();
+        unsigned parent_id = pParentCell->GetCellId();
+        for (unsigned k=1; k<mNumCandidateDirections; k++)
+        {
+            double u = p_streams->ranf(parent_id, CounterBasedRandomStreams::DIVISION_DIRECTION, 2*k);
+            double v = p_streams->ranf(parent_id, CounterBasedRandomStreams::DIVISION_DIRECTION, 2*k + 1);
+
+            double random_azimuth_angle = 2*M_PI*u;
+            double random_zenith_angle = std::acos(2*v - 1);
+
+            c_vector<double, SPACE_DIM> candidate;
+            candidate(0) = displacement_length*cos(random_azimuth_angle)*sin(random_zenith_angle);
+            candidate(1) = displacement_length*sin(random_azimuth_angle)*sin(random_zenith_angle);
+            candidate(2) = displacement_length*cos(random_zenith_angle);
+            candidates.push_back(candidate);
+        }
+    }
+
+    // Keep the candidate whose daughters overlap their neighbours least
+    unsigned best_candidate = 0;
+    double best_overlap = DBL_MAX;
+    for (unsigned i=0; i<candidates.size(); i++)
+    {
+        // Score the daughters where PlaceDaughters() will put them
+        std::pair<c_vector<double, SPACE_DIM>, c_vector<double, SPACE_DIM> > positions = PlaceDaughters(centre, candidates[i]);
+        c_vector<double, SPACE_DIM> daughter_positions[2] = {positions.first, positions.second};
+
+        double overlap = 0.0;
+        for (unsigned k=0; k<2; k++)
+        {
+            for (unsigned j=0; j<obstacles.size(); j++)
+            {
+                double shortfall = parent_radius + obstacles[j].second - norm_2(daughter_positions[k] - obstacles[j].first);
+                if (shortfall > 0.0)
+                {
+                    overlap += shortfall*shortfall;
+                }
+            }
+        }
+
+        if (overlap < best_overlap)
+        {
+            best_overlap = overlap;
+            best_candidate = i;
+        }
+    }
+
+    return candidates[best_candidate];
+}
+
 // Explicit instantiation
 template class NissenBasedDivisionRule<1,1>;
 template class NissenBasedDivisionRule<1,2>;
@@ -36,6 +36,9 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef NISSENBASEDDIVISIONRULE_HPP_
 #define NISSENBASEDDIVISIONRULE_HPP_
 
+#include <map>
+#include <set>
+#include <vector>
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
 #include "AbstractCentreBasedDivisionRule.hpp"
@@ -50,6 +53,19 @@ template<unsigned ELEMENT_DIM, unsigned SPACE_DIM> class AbstractCentreBasedDivi
  * AbstractCentreBasedCellPopulation::mMeinekeDivisionSeparation apart,
  * along a random axis. The midpoint between the two daughter cell
  * positions corresponds to the parent cell's position.
+ *
+ * Trophectoderm cells divide perpendicular to their polarity: along the perpendicular in 2D, and along
+ * a random direction in the plane normal to the polarity in 3D.
+ *
+ * When many cells divide in the same time step, the daughter positions can be computed together
+ * beforehand by CalculateDivisionVectorsForBatch(); CalculateCellDivisionVector() then returns the
+ * stored positions for each parent in the batch as it is added to the population.
+ *
+ * Optionally, the division direction may be chosen to minimise the overlap of the two daughter cells
+ * with their neighbours (see SetUseOverlapAwarePlacement()). A number of candidate directions are
+ * tried, each respecting the polarity constraint on trophectoderm cells, and the one whose daughters
+ * overlap least with the parent's neighbours is used. Within a batch, the daughters already placed
+ * take the place of their parents as neighbours.
  */
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
 class NissenBasedDivisionRule : public AbstractCentreBasedDivisionRule<ELEMENT_DIM, SPACE_DIM>
@@ -66,14 +82,84 @@ private:
     void serialize(Archive & archive, const unsigned int version)
     {
         archive & boost::serialization::base_object<AbstractCentreBasedDivisionRule<ELEMENT_DIM, SPACE_DIM> >(*this);
+        archive & mUseOverlapAwarePlacement;
+        archive & mNumCandidateDirections;
+        archive & mMaximumPolarityDeviation;
     }
 
+    /** Whether to choose the division direction to minimise overlap with neighbouring cells. Defaults to false. */
+    bool mUseOverlapAwarePlacement;
+
+    /** The number of candidate division directions tried when placement is overlap-aware. Defaults to 12. */
+    unsigned mNumCandidateDirections;
+
+    /**
+     * The largest angle (in radians) by which the division axis of a trophectoderm cell may deviate
+     * from the perpendicular to its polarity when placement is overlap-aware. Defaults to 0.
+     */
+    double mMaximumPolarityDeviation;
+
+    /** Positions and radii of the daughter cells already placed in the current batch. */
+    std::vector<std::pair<c_vector<double, SPACE_DIM>, double> > mPlacedDaughters;
+
+    /** Node indices of the parent cells already placed in the current batch. */
+    std::set<unsigned> mPlacedParentIndices;
+
+    /** Daughter cell positions computed by CalculateDivisionVectorsForBatch() and not yet used, by parent cell. */
+    std::map<Cell*, std::pair<c_vector<double, SPACE_DIM>, c_vector<double, SPACE_DIM> > > mBatchedDivisionVectors;
+
+    /**
+     * Compute the two daughter cell positions for a single parent cell.
+     *
+     * @param pParentCell  The cell to divide
+     * @param rCellPopulation  The centre-based cell population
+     *
+     * @return the two daughter cell positions.
+     */
+    std::pair<c_vector<double, SPACE_DIM>, c_vector<double, SPACE_DIM> > ComputeDivisionVector(CellPtr pParentCell,
+        AbstractCentreBasedCellPopulation<ELEMENT_DIM, SPACE_DIM>& rCellPopulation);
+
+    /**
+     * Place the two daughter cells of a division. By default the parent moves back by the displacement and the
+     * daughter takes its old centre; with overlap-aware placement the two are placed either side of the centre.
+     *
+     * @param rCentre  The centre of the parent cell
+     * @param rDisplacement  The displacement along the division axis
+     *
+     * @return the two daughter cell positions.
+     */
+    std::pair<c_vector<double, SPACE_DIM>, c_vector<double, SPACE_DIM> > PlaceDaughters(const c_vector<double, SPACE_DIM>& rCentre,
+        const c_vector<double, SPACE_DIM>& rDisplacement);
+
+    /**
+     * Choose, from a set of candidate directions, the displacement of the daughter cells from the parent's
+     * centre that minimises the overlap of the daughters with the parent's neighbours.
+     *
+     * The overlap of two cells is the amount by which the distance between their centres falls short of
+     * the sum of their radii, and the candidates are compared by the sum of the squared overlaps.
+     * In 3D, the candidates for a cell constrained by its polarity are turned about the polarity axis.
+     *
+     * @param pParentCell  The cell to divide
+     * @param rCellPopulation  The centre-based cell population
+     * @param rDefaultDisplacement  The displacement the rule would otherwise use, which is the first candidate
+     * @param isConstrainedByPolarity  Whether the division axis is set by the cell's polarity
+     *
+     * @return the chosen displacement.
+     */
+    c_vector<double, SPACE_DIM> ChooseLeastOverlappingDisplacement(CellPtr pParentCell,
+        AbstractCentreBasedCellPopulation<ELEMENT_DIM, SPACE_DIM>& rCellPopulation,
+        const c_vector<double, SPACE_DIM>& rDefaultDisplacement,
+        bool isConstrainedByPolarity);
+
 public:
 
     /**
      * Default constructor.
      */
     NissenBasedDivisionRule()
+        : mUseOverlapAwarePlacement(false),
+          mNumCandidateDirections(12),
+          mMaximumPolarityDeviation(0.0)
     {
     }
 
@@ -87,6 +173,9 @@ public:
     /**
      * Overridden CalculateCellDivisionVector() method.
      *
+     * Returns the positions computed for this parent by CalculateDivisionVectorsForBatch(), if any,
+     * and otherwise computes them now.
+     *
      * @param pParentCell  The cell to divide
      * @param rCellPopulation  The centre-based cell population
      *
@@ -94,6 +183,58 @@ public:
      */
     virtual std::pair<c_vector<double, SPACE_DIM>, c_vector<double, SPACE_DIM> > CalculateCellDivisionVector(CellPtr pParentCell,
         AbstractCentreBasedCellPopulation<ELEMENT_DIM, SPACE_DIM>& rCellPopulation);
+
+    /**
+     * Compute and store the daughter cell positions for every cell about to divide in this time step,
+     * discarding any stored positions left over from an earlier batch.
+     *
+     * @param rParentCells  The cells to divide
+     * @param rCellPopulation  The centre-based cell population
+     */
+    void CalculateDivisionVectorsForBatch(const std::vector<CellPtr>& rParentCells,
+        AbstractCentreBasedCellPopulation<ELEMENT_DIM, SPACE_DIM>& rCellPopulation);
+
+    /**
+     * @return the number of stored daughter cell positions not yet used.
+     */
+    unsigned GetNumBatchedDivisions() const;
+
+    /**
+     * @return whether the division direction is chosen to minimise overlap with neighbouring cells.
+     */
+    bool GetUseOverlapAwarePlacement() const;
+
+    /**
+     * Set whether the division direction is chosen to minimise overlap with neighbouring cells.
+     *
+     * @param useOverlapAwarePlacement whether to use overlap-aware placement
+     */
+    void SetUseOverlapAwarePlacement(bool useOverlapAwarePlacement);
+
+    /**
+     * @return the number of candidate division directions tried.
+     */
+    unsigned GetNumCandidateDirections() const;
+
+    /**
+     * Set the number of candidate division directions tried when placement is overlap-aware.
+     *
+     * @param numCandidateDirections the number of candidates, which must be at least 1
+     */
+    void SetNumCandidateDirections(unsigned numCandidateDirections);
+
+    /**
+     * @return the largest deviation of a trophectoderm cell's division axis from the perpendicular to its polarity.
+     */
+    double GetMaximumPolarityDeviation() const;
+
+    /**
+     * Set the largest angle by which the division axis of a trophectoderm cell may deviate from the
+     * perpendicular to its polarity when placement is overlap-aware.
+     *
+     * @param maximumPolarityDeviation the angle, in radians, between 0 and pi/2
+     */
+    void SetMaximumPolarityDeviation(double maximumPolarityDeviation);
 };
 
 #include "SerializationExportWrapper.hpp"
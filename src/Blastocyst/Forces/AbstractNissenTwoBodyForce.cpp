@@ -0,0 +1,274 @@
+
+#include "AbstractNissenTwoBodyForce.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "NissenPairGeometryCache.hpp"
+#include "NissenHaloStateMirror.hpp"
+#include "Exception.hpp"
+
+#include <cfloat>
+#include <cmath>
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::AbstractNissenTwoBodyForce()
+   : AbstractTwoBodyInteractionForce<ELEMENT_DIM,SPACE_DIM>(),
+     mForceComponent(ALL_COMPONENTS),
+     mFastComponentRange(3.0),
+     mNumPotentialQuadratureIntervals(64)
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::~AbstractNissenTwoBodyForce()
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+c_vector<double, SPACE_DIM> AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::CombineForceComponents(const c_vector<double, SPACE_DIM>& rRepulsion,
+                                                                                                      const c_vector<double, SPACE_DIM>& rAttraction,
+                                                                                                      double distance)
+{
+    if (mForceComponent == ALL_COMPONENTS)
+    {
+        return rRepulsion + rAttraction;
+    }
+
+    // A cubic switch, which keeps both parts continuous and differentiable in the separation
+    double switch_start = 0.8*mFastComponentRange;
+    double fast_fraction = 1.0;
+    if (distance >= mFastComponentRange)
+    {
+        fast_fraction = 0.0;
+    }
+    else if (distance > switch_start)
+    {
+        double x = (distance - switch_start)/(mFastComponentRange - switch_start);
+        fast_fraction = 1.0 - x*x*(3.0 - 2.0*x);
+    }
+
+    if (mForceComponent == FAST_COMPONENT)
+    {
+        return fast_fraction*rRepulsion;
+    }
+    return (1.0 - fast_fraction)*rRepulsion + rAttraction;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+c_vector<double, SPACE_DIM> AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBetweenNodes(unsigned nodeAGlobalIndex,
+                                                                                                          unsigned nodeBGlobalIndex,
+                                                                                                          AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
+{
+    const c_vector<double, SPACE_DIM>& r_node_A_location = rCellPopulation.GetNode(nodeAGlobalIndex)->rGetLocation();
+    const c_vector<double, SPACE_DIM>& r_node_B_location = rCellPopulation.GetNode(nodeBGlobalIndex)->rGetLocation();
+
+    // Use the mesh method GetVectorFromAtoB(), which may be overloaded (e.g. for a periodic mesh)
+    c_vector<double, SPACE_DIM> vector_from_A_to_B = rCellPopulation.rGetMesh().GetVectorFromAtoB(r_node_A_location, r_node_B_location);
+
+    return CalculateForceFromPairGeometry(nodeAGlobalIndex, nodeBGlobalIndex, vector_from_A_to_B, norm_2(vector_from_A_to_B), rCellPopulation);
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::GetMaximumInteractionRange()
+{
+    return this->mUseCutOffLength ? this->GetCutOffLength() : DBL_MAX;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::CalculateRepulsionStiffness(double distance, double repulsionLength)
+{
+    // The repulsion exp(-2r/L) on a node, for a separation r in cell diameters, falls at a rate (2/L)exp(-2r/L)
+    return (2.0/repulsionLength)*exp(-2.0*distance/repulsionLength);
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::CalculatePairStiffness(unsigned nodeAGlobalIndex,
+                                                                                 unsigned nodeBGlobalIndex,
+                                                                                 double distance,
+                                                                                 AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
+{
+    if (distance >= GetMaximumInteractionRange())
+    {
+        return 0.0;
+    }
+    return CalculateRepulsionStiffness(distance, 1.0);
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::GetFastInteractionRange()
+{
+    return 0.5*mFastComponentRange;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+typename AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::ForceComponent AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::GetForceComponent()
+{
+    return mForceComponent;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::SetForceComponent(ForceComponent forceComponent)
+{
+    mForceComponent = forceComponent;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::GetFastComponentRange()
+{
+    return mFastComponentRange;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::SetFastComponentRange(double fastComponentRange)
+{
+    assert(fastComponentRange > 0.0);
+    mFastComponentRange = fastComponentRange;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::CalculatePairPotential(unsigned nodeAGlobalIndex,
+                                                                                 unsigned nodeBGlobalIndex,
+                                                                                 const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                                                 double distance,
+                                                                                 AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
+{
+    double range = GetMaximumInteractionRange();
+    if (range == DBL_MAX)
+    {
+        EXCEPTION("The potential energy of a Dhall two-body force is only defined when it has a cutoff length");
+    }
+    if (distance >= range)
+    {
+        return 0.0;
+    }
+
+    /*
+     * The force on A is F(s) = V'(s) u, where u is the unit vector from A to B, so with V zero at the range
+     * V(distance) = -(integral from distance to range of F(s).u ds).
+     */
+    c_vector<double, SPACE_DIM> unit_vector_from_A_to_B = rVectorFromAtoB/distance;
+    double interval = (range - distance)/mNumPotentialQuadratureIntervals;
+    double integral = 0.0;
+    for (unsigned k=0; k<mNumPotentialQuadratureIntervals; k++)
+    {
+        // The last point is at the range, where the force is zero
+        double weight = (k == 0) ? 1.0 : ((k%2 == 1) ? 4.0 : 2.0);
+        double separation = distance + k*interval;
+        c_vector<double, SPACE_DIM> force = CalculateForceFromPairGeometry(nodeAGlobalIndex,
+                                                                           nodeBGlobalIndex,
+                                                                           separation*unit_vector_from_A_to_B,
+                                                                           separation,
+                                                                           rCellPopulation);
+        integral += weight*inner_prod(force, unit_vector_from_A_to_B);
+    }
+    return -integral*interval/3.0;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::CalculatePotentialEnergy(AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
+{
+    NodeBasedCellPopulation<SPACE_DIM>* p_node_based_population = dynamic_cast<NodeBasedCellPopulation<SPACE_DIM>*>(&rCellPopulation);
+    if (p_node_based_population == nullptr)
+    {
+        EXCEPTION("The potential energy of a Dhall two-body force is only implemented for a NodeBasedCellPopulation");
+    }
+
+    NissenHaloStateMirror<SPACE_DIM>* p_mirror = NissenHaloStateMirror<SPACE_DIM>::Instance();
+    p_mirror->Refresh(*p_node_based_population);
+
+    const std::vector<typename NissenPairGeometryCache<SPACE_DIM>::PairGeometry>& r_pairs =
+        NissenPairGeometryCache<SPACE_DIM>::Instance()->rGetPairs(*p_node_based_population);
+
+    double energy = 0.0;
+    for (unsigned i=0; i<r_pairs.size(); i++)
+    {
+        const typename NissenPairGeometryCache<SPACE_DIM>::PairGeometry& r_pair = r_pairs[i];
+        double potential = CalculatePairPotential(r_pair.mNodeAIndex,
+                                                  r_pair.mNodeBIndex,
+                                                  r_pair.mVectorFromAtoB,
+                                                  r_pair.mDistance,
+                                                  rCellPopulation);
+
+        // The other process holding a pair with a halo node counts the other half
+        if (p_mirror->IsHaloNode(r_pair.mNodeAIndex) || p_mirror->IsHaloNode(r_pair.mNodeBIndex))
+        {
+            potential *= 0.5;
+        }
+        energy += potential;
+    }
+    return energy;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::GetNumPotentialQuadratureIntervals()
+{
+    return mNumPotentialQuadratureIntervals;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::SetNumPotentialQuadratureIntervals(unsigned numPotentialQuadratureIntervals)
+{
+    assert(numPotentialQuadratureIntervals > 0 && numPotentialQuadratureIntervals%2 == 0);
+    mNumPotentialQuadratureIntervals = numPotentialQuadratureIntervals;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::AddForceContribution(AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
+{
+    NodeBasedCellPopulation<SPACE_DIM>* p_node_based_population = dynamic_cast<NodeBasedCellPopulation<SPACE_DIM>*>(&rCellPopulation);
+    if (p_node_based_population == nullptr)
+    {
+        AbstractTwoBodyInteractionForce<ELEMENT_DIM,SPACE_DIM>::AddForceContribution(rCellPopulation);
+        return;
+    }
+
+    // In a distributed run, bring the polarity of the halo nodes up to date with their owners
+    NissenHaloStateMirror<SPACE_DIM>::Instance()->Refresh(*p_node_based_population);
+
+    const std::vector<typename NissenPairGeometryCache<SPACE_DIM>::PairGeometry>& r_pairs =
+        NissenPairGeometryCache<SPACE_DIM>::Instance()->rGetPairs(*p_node_based_population);
+
+    // Only close pairs have a fast part
+    double max_distance = (mForceComponent == FAST_COMPONENT) ? GetFastInteractionRange() : DBL_MAX;
+
+    for (unsigned i=0; i<r_pairs.size(); i++)
+    {
+        const typename NissenPairGeometryCache<SPACE_DIM>::PairGeometry& r_pair = r_pairs[i];
+        if (r_pair.mDistance >= max_distance)
+        {
+            continue;
+        }
+
+        // Calculate the force between nodes
+        c_vector<double, SPACE_DIM> force = CalculateForceFromPairGeometry(r_pair.mNodeAIndex,
+                                                                           r_pair.mNodeBIndex,
+                                                                           r_pair.mVectorFromAtoB,
+                                                                           r_pair.mDistance,
+                                                                           rCellPopulation);
+        for (unsigned j=0; j<SPACE_DIM; j++)
+        {
+            assert(!std::isnan(force[j]));
+        }
+
+        // Add the force contribution to each node
+        c_vector<double, SPACE_DIM> negative_force = -1.0*force;
+        rCellPopulation.GetNode(r_pair.mNodeAIndex)->AddAppliedForceContribution(force);
+        rCellPopulation.GetNode(r_pair.mNodeBIndex)->AddAppliedForceContribution(negative_force);
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<FastComponentRange>" << mFastComponentRange << "</FastComponentRange>\n";
+    *rParamsFile << "\t\t\t<NumPotentialQuadratureIntervals>" << mNumPotentialQuadratureIntervals << "</NumPotentialQuadratureIntervals>\n";
+
+    // Call method on direct parent class
+    AbstractTwoBodyInteractionForce<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class AbstractNissenTwoBodyForce<1,1>;
+template class AbstractNissenTwoBodyForce<1,2>;
+template class AbstractNissenTwoBodyForce<2,2>;
+template class AbstractNissenTwoBodyForce<1,3>;
+template class AbstractNissenTwoBodyForce<2,3>;
+template class AbstractNissenTwoBodyForce<3,3>;
@@ -0,0 +1,249 @@
+
+#ifndef ABSTRACTNISSENTWOBODYFORCE_HPP_
+#define ABSTRACTNISSENTWOBODYFORCE_HPP_
+
+#include "AbstractTwoBodyInteractionForce.hpp"
+
+#include "ChasteSerialization.hpp"
+#include "ClassIsAbstract.hpp"
+#include <boost/serialization/base_object.hpp>
+
+/**
+ * Common base class for the Dhall two-body forces.
+ *
+ * For a NodeBasedCellPopulation, AddForceContribution() reads the displacement vector and distance
+ * of each node pair from the shared NissenPairGeometryCache instead of asking the mesh for them, so
+ * that several forces (and CellPolarityTrackingModifier) do not each repeat this work. Subclasses
+ * implement CalculateForceFromPairGeometry(), which receives this geometry.
+ *
+ * The Nissen potentials combine a stiff short-range repulsion with a soft long-range attraction (and,
+ * for trophectoderm, polarity terms). So that a multiple-time-step method such as
+ * NissenMultipleTimeStepNumericalMethod can evaluate these at different rates, subclasses assemble each
+ * force from its two parts with CombineForceComponents(), and SetForceComponent() selects which part is
+ * returned. The repulsion is handed from the fast part to the slow part by a smooth switch, from 1 at
+ * 0.8*mFastComponentRange to 0 at mFastComponentRange (in cell radii), so that the two parts always sum
+ * to the whole force; the fast part is then only non-zero for close pairs, and when it alone is selected
+ * AddForceContribution() skips every pair further apart than GetFastInteractionRange().
+ *
+ * CalculatePairPotential() and CalculatePotentialEnergy() give the potential energy of the force, so that an
+ * energy minimiser such as NissenFireMinimiser can report its progress. By default the pair potential is
+ * the work done against the force as the pair is separated along the line between them out to the
+ * maximum interaction range, which is the potential of any force acting along that line.
+ */
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
+class AbstractNissenTwoBodyForce : public AbstractTwoBodyInteractionForce<ELEMENT_DIM, SPACE_DIM>
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the object and its member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractTwoBodyInteractionForce<ELEMENT_DIM, SPACE_DIM> >(*this);
+        archive & mFastComponentRange;
+        archive & mNumPotentialQuadratureIntervals;
+    }
+
+public:
+
+    /** The parts of the force that may be selected. */
+    enum ForceComponent
+    {
+        ALL_COMPONENTS = 0,  /**< The whole force. */
+        FAST_COMPONENT = 1,  /**< The switched short-range repulsion. */
+        SLOW_COMPONENT = 2   /**< The attraction, polarity terms and the rest of the repulsion. */
+    };
+
+private:
+
+    /** The part of the force returned. Defaults to ALL_COMPONENTS; set only while a numerical method evaluates the force, so not archived. */
+    ForceComponent mForceComponent;
+
+    /** The separation, in cell radii, beyond which the repulsion belongs wholly to the slow part. Defaults to 3. */
+    double mFastComponentRange;
+
+    /** The number of intervals (which must be even) in the quadrature of CalculatePairPotential(). Defaults to 64. */
+    unsigned mNumPotentialQuadratureIntervals;
+
+protected:
+
+    /**
+     * @return the part of a pair force selected by mForceComponent.
+     *
+     * @param rRepulsion the short-range repulsive part of the force
+     * @param rAttraction the remainder of the force: attraction and any polarity terms
+     * @param distance the separation, in cell radii, of the points between which the force acts
+     */
+    c_vector<double, SPACE_DIM> CombineForceComponents(const c_vector<double, SPACE_DIM>& rRepulsion,
+                                                       const c_vector<double, SPACE_DIM>& rAttraction,
+                                                       double distance);
+
+    /**
+     * @return the radial stiffness of a repulsion exp(-d/repulsionLength), where d is the separation in cell radii.
+     *
+     * @param distance the separation in cell diameters, the units of the mesh
+     * @param repulsionLength the decay length of the repulsion in cell radii
+     */
+    static double CalculateRepulsionStiffness(double distance, double repulsionLength);
+
+public:
+
+    /**
+     * Constructor.
+     */
+    AbstractNissenTwoBodyForce();
+
+    /**
+     * Destructor.
+     */
+    virtual ~AbstractNissenTwoBodyForce();
+
+    /**
+     * Overridden CalculateForceBetweenNodes() method.
+     *
+     * Computes the geometry of the pair using the mesh and passes it to CalculateForceFromPairGeometry().
+     *
+     * @param nodeAGlobalIndex index of one neighbouring node
+     * @param nodeBGlobalIndex index of the other neighbouring node
+     * @param rCellPopulation the cell population
+     *
+     * @return The force exerted on Node A by Node B.
+     */
+    c_vector<double, SPACE_DIM> CalculateForceBetweenNodes(unsigned nodeAGlobalIndex,
+                                                           unsigned nodeBGlobalIndex,
+                                                           AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
+
+    /**
+     * Calculate the force between two nodes, given the vector between them and its length.
+     *
+     * @param nodeAGlobalIndex index of one neighbouring node
+     * @param nodeBGlobalIndex index of the other neighbouring node
+     * @param rVectorFromAtoB the vector from node A to node B
+     * @param distance the length of rVectorFromAtoB
+     * @param rCellPopulation the cell population
+     *
+     * @return The force exerted on Node A by Node B.
+     */
+    virtual c_vector<double, SPACE_DIM> CalculateForceFromPairGeometry(unsigned nodeAGlobalIndex,
+                                                                       unsigned nodeBGlobalIndex,
+                                                                       const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                                       double distance,
+                                                                       AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)=0;
+
+    /**
+     * @return the largest distance between two nodes at which this force can be non-zero, or DBL_MAX
+     * if the force has no cutoff. By default this is the cutoff length.
+     */
+    virtual double GetMaximumInteractionRange();
+
+    /**
+     * @return the radial stiffness of the repulsion between two nodes: the rate at which the repulsive force on
+     * node A from node B falls as the nodes separate. Used by NissenSemiImplicitNumericalMethod to linearise the
+     * repulsion. By default this is the stiffness of the exp(-d) repulsion (d in cell radii) common to most cell
+     * pairs, or zero beyond GetMaximumInteractionRange(); subclasses with a softer repulsion for some pairs override it.
+     *
+     * @param nodeAGlobalIndex index of one neighbouring node
+     * @param nodeBGlobalIndex index of the other neighbouring node
+     * @param distance the distance between the nodes
+     * @param rCellPopulation the cell population
+     */
+    virtual double CalculatePairStiffness(unsigned nodeAGlobalIndex,
+                                          unsigned nodeBGlobalIndex,
+                                          double distance,
+                                          AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
+
+    /**
+     * @return the potential energy of the interaction between two nodes, which is zero at and beyond
+     * GetMaximumInteractionRange(). By default it is found by integrating the component along rVectorFromAtoB
+     * of CalculateForceFromPairGeometry() from the current distance out to that range with Simpson's rule
+     * over mNumPotentialQuadratureIntervals intervals. Forces which are not the gradient of a pair potential
+     * (such as those acting between polarity-dependent foci) override this to throw an exception.
+     *
+     * @param nodeAGlobalIndex index of one neighbouring node
+     * @param nodeBGlobalIndex index of the other neighbouring node
+     * @param rVectorFromAtoB the vector from node A to node B
+     * @param distance the length of rVectorFromAtoB
+     * @param rCellPopulation the cell population
+     */
+    virtual double CalculatePairPotential(unsigned nodeAGlobalIndex,
+                                          unsigned nodeBGlobalIndex,
+                                          const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                          double distance,
+                                          AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
+
+    /**
+     * @return the potential energy of this force: the sum of CalculatePairPotential() over the node pairs of
+     * a NodeBasedCellPopulation. In a distributed run a pair with a halo node is counted as half on each of
+     * the two processes that hold it, so the total energy is the sum of the values on all processes.
+     *
+     * @param rCellPopulation the cell population
+     */
+    double CalculatePotentialEnergy(AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
+
+    /**
+     * @return the largest distance between two nodes at which the fast part of this force can be non-zero.
+     * By default this is half mFastComponentRange, converted from cell radii to cell diameters; subclasses
+     * whose forces act between points offset from the nodes add the largest offset.
+     */
+    virtual double GetFastInteractionRange();
+
+    /** @return mForceComponent */
+    ForceComponent GetForceComponent();
+
+    /**
+     * Set mForceComponent.
+     *
+     * @param forceComponent the part of the force to return
+     */
+    void SetForceComponent(ForceComponent forceComponent);
+
+    /** @return mFastComponentRange */
+    double GetFastComponentRange();
+
+    /**
+     * Set mFastComponentRange.
+     *
+     * @param fastComponentRange the separation, in cell radii, beyond which the repulsion is wholly slow
+     */
+    void SetFastComponentRange(double fastComponentRange);
+
+    /** @return mNumPotentialQuadratureIntervals */
+    unsigned GetNumPotentialQuadratureIntervals();
+
+    /**
+     * Set mNumPotentialQuadratureIntervals.
+     *
+     * @param numPotentialQuadratureIntervals the number of intervals in the quadrature, which must be even
+     */
+    void SetNumPotentialQuadratureIntervals(unsigned numPotentialQuadratureIntervals);
+
+    /**
+     * Overridden OutputForceParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputForceParameters(out_stream& rParamsFile);
+
+    /**
+     * Overridden AddForceContribution() method.
+     *
+     * Uses the shared NissenPairGeometryCache for a NodeBasedCellPopulation, and the
+     * method on the parent class otherwise. For a NodeBasedCellPopulation the NissenHaloStateMirror
+     * is refreshed first, so that in a distributed run the polarity of halo nodes is current. When only
+     * the fast part is selected, pairs further apart than GetFastInteractionRange() are skipped.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void AddForceContribution(AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
+};
+
+TEMPLATED_CLASS_IS_ABSTRACT_2_UNSIGNED(AbstractNissenTwoBodyForce)
+
+#endif /*ABSTRACTNISSENTWOBODYFORCE_HPP_*/
@@ -10,7 +10,7 @@
 
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
 NissenForce<ELEMENT_DIM,SPACE_DIM>::NissenForce()
-   : AbstractTwoBodyInteractionForce<ELEMENT_DIM,SPACE_DIM>(),
+   : AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>(),
      mS_ICM_ICM(0.6), // ICM-ICM interaction strength - NOTE: Before TE specification all cells are considered ICM-like in their adhesion properties
      mS_TE_ICM(0.4),  // TE-ICM interaction strength
      mS_TE_EPI(0.6),  // TE-EPI interaction strength
@@ -33,27 +33,20 @@ NissenForce<ELEMENT_DIM,SPACE_DIM>::~NissenForce()
 }
 
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
-c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBetweenNodes(unsigned nodeAGlobalIndex,
-                                                                                            unsigned nodeBGlobalIndex,
-                                                                                            AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
+c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceFromPairGeometry(unsigned nodeAGlobalIndex,
+                                                                                               unsigned nodeBGlobalIndex,
+                                                                                               const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                                                               double distance,
+                                                                                               AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
 {
     // We should only ever calculate the force between two distinct nodes
     assert(nodeAGlobalIndex != nodeBGlobalIndex);
     
-    // Assign labels to each node in the pair
-    Node<SPACE_DIM>* p_node_A = rCellPopulation.GetNode(nodeAGlobalIndex);
-    Node<SPACE_DIM>* p_node_B = rCellPopulation.GetNode(nodeBGlobalIndex);
-
-    // Find locations of each node in the pair
-    const c_vector<double, SPACE_DIM>& r_node_A_location = p_node_A->rGetLocation();
-    const c_vector<double, SPACE_DIM>& r_node_B_location = p_node_B->rGetLocation();
-
-    // Work out the vector from node A to node B and use the GetVector method from rGetMesh
-    c_vector<double, SPACE_DIM> unit_vector_from_A_to_B;
-    unit_vector_from_A_to_B = rCellPopulation.rGetMesh().GetVectorFromAtoB(r_node_A_location, r_node_B_location);
+    // The vector from node A to node B (from the GetVector method of rGetMesh) and its length are supplied by AddForceContribution()
+    c_vector<double, SPACE_DIM> unit_vector_from_A_to_B = rVectorFromAtoB;
 
     // Distance between the two nodes
-    double d = norm_2(unit_vector_from_A_to_B);
+    double d = distance;
     
     // Normalise the vector between A and B
     unit_vector_from_A_to_B /= d;
@@ -176,7 +169,9 @@ c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBe
           
             //force = potential_gradient*polarity_factor*s + potential_gradient_repulsion + centrally_acting_polarity_contribution + extra_polarity_contribution_A + extra_polarity_contribution_B;
             double s = mS_TE_TE;
-            force = -potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 -potential_gradient*s,
+                                                 d);
             return force;
           
              
@@ -195,7 +190,9 @@ c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBe
           
             double s = mS_TE_EPI;
           
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
  
        }
@@ -213,7 +210,9 @@ c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBe
             
             double s = mS_TE_ICM;
           
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
 
        }
@@ -231,7 +230,9 @@ c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBe
             
             double s = mS_TE_PrE;
      
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
 
        }
@@ -275,7 +276,9 @@ c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBe
                //}
             //}
           
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
         }
        //CASE 2-2: Cell B is Epiblast
@@ -285,7 +288,9 @@ c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBe
             
             double s = mS_EPI_ICM;
           
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
         }
        //CASE 2-3: Cell B is Primitive Endoderm
@@ -293,7 +298,9 @@ c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBe
         {        
             double s = mS_PrE_ICM;
 
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
         }
        //CASE 2-4: Cell B is Trophectoderm
@@ -310,7 +317,9 @@ c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBe
             
             double s = mS_TE_ICM;
 
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
           
         }
@@ -345,7 +354,9 @@ c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBe
                //}
             //}
           
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
        }
        //CASE 3-2 Cell B is Undetermined ICM
@@ -353,7 +364,9 @@ c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBe
        {        
             double s = mS_EPI_ICM;
     
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
        }
        //CASE 3-3 Cell B is Primitive Endoderm
@@ -361,7 +374,9 @@ c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBe
        {
             double s = mS_PrE_EPI;
          
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
        }
        //CASE 3-4 Cell B is Trophectoderm
@@ -378,7 +393,9 @@ c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBe
             
             double s = mS_TE_EPI;
           
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
        }
        else
@@ -394,7 +411,9 @@ c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBe
        {           
             double s = mS_PrE_ICM;
           
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
        }
        //CASE 4-2 Cell B is Epiblast
@@ -402,7 +421,9 @@ c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBe
        {
             double s = mS_PrE_EPI;
             
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
        }
        //CASE 4-3 Cell B is Primitive Endoderm
@@ -428,7 +449,9 @@ c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBe
                //}
             //}
           
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
        }
        //CASE 4-4 Cell B is Trophectoderm
@@ -445,7 +468,9 @@ c_vector<double, SPACE_DIM> NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBe
             
             double s = mS_TE_PrE;
           
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
 
        }
@@ -608,7 +633,28 @@ void NissenForce<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(out_stream& rPara
     *rParamsFile << "\t\t\t<S_PrE_PrE>" << mS_PrE_PrE << "</S_PrE_PrE>\n";
     *rParamsFile << "\t\t\t<S_ICM_ICM>" << mS_ICM_ICM << "</S_ICM>\n";
     *rParamsFile << "\t\t\t<GrowthDuration>" << mGrowthDuration << "</GrowthDuration>\n";
-    AbstractTwoBodyInteractionForce<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(rParamsFile);
+    AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(rParamsFile);
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenForce<ELEMENT_DIM,SPACE_DIM>::CalculatePairStiffness(unsigned nodeAGlobalIndex,
+                                                                  unsigned nodeBGlobalIndex,
+                                                                  double distance,
+                                                                  AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
+{
+    if (distance >= this->GetMaximumInteractionRange())
+    {
+        return 0.0;
+    }
+
+    CellPtr p_cell_A = rCellPopulation.GetCellUsingLocationIndex(nodeAGlobalIndex);
+    CellPtr p_cell_B = rCellPopulation.GetCellUsingLocationIndex(nodeBGlobalIndex);
+    if (p_cell_A->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>()
+        && p_cell_B->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>())
+    {
+        return this->CalculateRepulsionStiffness(distance, 2.0);
+    }
+    return this->CalculateRepulsionStiffness(distance, 1.0);
 }
 
 //Explicit Instantiation of the Force
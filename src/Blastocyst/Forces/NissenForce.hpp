@@ -2,7 +2,7 @@
 #ifndef NISSENFORCE_HPP_
 #define NISSENFORCE_HPP_
 
-#include "AbstractTwoBodyInteractionForce.hpp"
+#include "AbstractNissenTwoBodyForce.hpp"
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
@@ -10,7 +10,7 @@
 // NOTE: It is not a good idea to include "Test" in a class name, to avoid confusion with test suite names.
 
 template<unsigned  ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
-class NissenForce : public AbstractTwoBodyInteractionForce<ELEMENT_DIM, SPACE_DIM>
+class NissenForce : public AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>
 {
 private:
 
@@ -18,7 +18,7 @@ private:
     template<class Archive>
     void serialize(Archive & archive, const unsigned int version)
     {
-        archive & boost::serialization::base_object<AbstractTwoBodyInteractionForce<ELEMENT_DIM, SPACE_DIM> >(*this);
+        archive & boost::serialization::base_object<AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM> >(*this);
         archive & mS_ICM_ICM;
         archive & mS_TE_ICM;
         archive & mS_TE_EPI;
@@ -51,9 +51,11 @@ public:
 
     virtual ~NissenForce();
 
-    c_vector<double, SPACE_DIM> CalculateForceBetweenNodes(unsigned nodeAGlobalIndex,
-                                                           unsigned nodeBGlobalIndex,
-                                                           AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
+    c_vector<double, SPACE_DIM> CalculateForceFromPairGeometry(unsigned nodeAGlobalIndex,
+                                                               unsigned nodeBGlobalIndex,
+                                                               const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                               double distance,
+                                                               AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
 
     double GetS_ICM_ICM();
     void SetS_ICM_ICM(double s);
@@ -89,6 +91,22 @@ public:
     void SetGrowthDuration(double GrowthDuration);
 
     virtual void OutputForceParameters(out_stream& rParamsFile);
+
+    /**
+     * Overridden CalculatePairStiffness() method.
+     *
+     * Two trophectoderm cells repel each other through the softer exp(-d/2).
+     *
+     * @param nodeAGlobalIndex index of one neighbouring node
+     * @param nodeBGlobalIndex index of the other neighbouring node
+     * @param distance the distance between the nodes
+     * @param rCellPopulation the cell population
+     * @return the radial stiffness of the repulsion between the nodes
+     */
+    double CalculatePairStiffness(unsigned nodeAGlobalIndex,
+                                  unsigned nodeBGlobalIndex,
+                                  double distance,
+                                  AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
 };
 
 #include "SerializationExportWrapper.hpp"
@@ -10,7 +10,7 @@
 
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
 NissenForceNoTroph<ELEMENT_DIM,SPACE_DIM>::NissenForceNoTroph()
-   : AbstractTwoBodyInteractionForce<ELEMENT_DIM,SPACE_DIM>(),
+   : AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>(),
      mS_ICM_ICM(0.6), // ICM-ICM interaction strength - NOTE: Before TE specification all cells are considered ICM-like in their adhesion properties
      mS_PrE_PrE(0.4), // PrE-PrE interaction strength
      mS_PrE_EPI(0.4), // Pre-EPI interaction strength
@@ -29,27 +29,20 @@ NissenForceNoTroph<ELEMENT_DIM,SPACE_DIM>::~NissenForceNoTroph()
 }
 
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
-c_vector<double, SPACE_DIM> NissenForceNoTroph<ELEMENT_DIM,SPACE_DIM>::CalculateForceBetweenNodes(unsigned nodeAGlobalIndex,
-                                                                                            unsigned nodeBGlobalIndex,
-                                                                                            AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
+c_vector<double, SPACE_DIM> NissenForceNoTroph<ELEMENT_DIM,SPACE_DIM>::CalculateForceFromPairGeometry(unsigned nodeAGlobalIndex,
+                                                                                                      unsigned nodeBGlobalIndex,
+                                                                                                      const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                                                                      double distance,
+                                                                                                      AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
 {
     // We should only ever calculate the force between two distinct nodes
     assert(nodeAGlobalIndex != nodeBGlobalIndex);
     
-    // Assign labels to each node in the pair
-    Node<SPACE_DIM>* p_node_A = rCellPopulation.GetNode(nodeAGlobalIndex);
-    Node<SPACE_DIM>* p_node_B = rCellPopulation.GetNode(nodeBGlobalIndex);
-
-    // Find locations of each node in the pair
-    const c_vector<double, SPACE_DIM>& r_node_A_location = p_node_A->rGetLocation();
-    const c_vector<double, SPACE_DIM>& r_node_B_location = p_node_B->rGetLocation();
-
-    // Work out the vector from node A to node B and use the GetVector method from rGetMesh
-    c_vector<double, SPACE_DIM> unit_vector_from_A_to_B;
-    unit_vector_from_A_to_B = rCellPopulation.rGetMesh().GetVectorFromAtoB(r_node_A_location, r_node_B_location);
+    // The vector from node A to node B (from the GetVector method of rGetMesh) and its length are supplied by AddForceContribution()
+    c_vector<double, SPACE_DIM> unit_vector_from_A_to_B = rVectorFromAtoB;
 
     // Distance between the two nodes
-    double d = norm_2(unit_vector_from_A_to_B);
+    double d = distance;
     
     // Normalise the vector between A and B
     unit_vector_from_A_to_B /= d;
@@ -110,7 +103,9 @@ c_vector<double, SPACE_DIM> NissenForceNoTroph<ELEMENT_DIM,SPACE_DIM>::Calculate
                //}
             //}
           
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
         }
        //CASE 2-2: Cell B is Epiblast
@@ -120,7 +115,9 @@ c_vector<double, SPACE_DIM> NissenForceNoTroph<ELEMENT_DIM,SPACE_DIM>::Calculate
             
             double s = mS_EPI_ICM;
           
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
         }
        //CASE 2-3: Cell B is Primitive Endoderm
@@ -128,7 +125,9 @@ c_vector<double, SPACE_DIM> NissenForceNoTroph<ELEMENT_DIM,SPACE_DIM>::Calculate
         {        
             double s = mS_PrE_ICM;
 
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
         }
        else
@@ -162,7 +161,9 @@ c_vector<double, SPACE_DIM> NissenForceNoTroph<ELEMENT_DIM,SPACE_DIM>::Calculate
                //}
             //}
           
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
        }
        //CASE 3-2 Cell B is Undetermined ICM
@@ -170,7 +171,9 @@ c_vector<double, SPACE_DIM> NissenForceNoTroph<ELEMENT_DIM,SPACE_DIM>::Calculate
        {        
             double s = mS_EPI_ICM;
     
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
        }
        //CASE 3-3 Cell B is Primitive Endoderm
@@ -178,7 +181,9 @@ c_vector<double, SPACE_DIM> NissenForceNoTroph<ELEMENT_DIM,SPACE_DIM>::Calculate
        {
             double s = mS_PrE_EPI;
          
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
        }
        else
@@ -194,7 +199,9 @@ c_vector<double, SPACE_DIM> NissenForceNoTroph<ELEMENT_DIM,SPACE_DIM>::Calculate
        {           
             double s = mS_PrE_ICM;
           
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
        }
        //CASE 4-2 Cell B is Epiblast
@@ -202,7 +209,9 @@ c_vector<double, SPACE_DIM> NissenForceNoTroph<ELEMENT_DIM,SPACE_DIM>::Calculate
        {
             double s = mS_PrE_EPI;
             
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
        }
        //CASE 4-3 Cell B is Primitive Endoderm
@@ -228,7 +237,9 @@ c_vector<double, SPACE_DIM> NissenForceNoTroph<ELEMENT_DIM,SPACE_DIM>::Calculate
                //}
             //}
           
-            force = potential_gradient*s + potential_gradient_repulsion;
+            force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                 potential_gradient*s,
+                                                 d);
             return force;
        }
        else
@@ -338,7 +349,7 @@ void NissenForceNoTroph<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(out_stream
     *rParamsFile << "\t\t\t<S_PrE_PrE>" << mS_PrE_PrE << "</S_PrE_PrE>\n";
     *rParamsFile << "\t\t\t<S_ICM_ICM>" << mS_ICM_ICM << "</S_ICM>\n";
     *rParamsFile << "\t\t\t<GrowthDuration>" << mGrowthDuration << "</GrowthDuration>\n";
-    AbstractTwoBodyInteractionForce<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(rParamsFile);
+    AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(rParamsFile);
 }
 
 //Explicit Instantiation of the Force
@@ -1,7 +1,7 @@
 #ifndef NISSENFORCENOTROPH_HPP_
 #define NISSENFORCENOTROPH_HPP_
 
-#include "AbstractTwoBodyInteractionForce.hpp"
+#include "AbstractNissenTwoBodyForce.hpp"
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
@@ -9,7 +9,7 @@
 // NOTE: It is not a good idea to include "Test" in a class name, to avoid confusion with test suite names.
 
 template<unsigned  ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
-class NissenForceNoTroph : public AbstractTwoBodyInteractionForce<ELEMENT_DIM, SPACE_DIM>
+class NissenForceNoTroph : public AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>
 {
 private:
 
@@ -17,7 +17,7 @@ private:
     template<class Archive>
     void serialize(Archive & archive, const unsigned int version)
     {
-        archive & boost::serialization::base_object<AbstractTwoBodyInteractionForce<ELEMENT_DIM, SPACE_DIM> >(*this);
+        archive & boost::serialization::base_object<AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM> >(*this);
         archive & mS_ICM_ICM;;
         archive & mS_PrE_PrE;
         archive & mS_PrE_EPI;
@@ -42,9 +42,11 @@ public:
 
     virtual ~NissenForceNoTroph();
 
-    c_vector<double, SPACE_DIM> CalculateForceBetweenNodes(unsigned nodeAGlobalIndex,
-                                                           unsigned nodeBGlobalIndex,
-                                                           AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
+    c_vector<double, SPACE_DIM> CalculateForceFromPairGeometry(unsigned nodeAGlobalIndex,
+                                                               unsigned nodeBGlobalIndex,
+                                                               const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                               double distance,
+                                                               AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
 
     double GetS_ICM_ICM();
     void SetS_ICM_ICM(double s);
@@ -5,12 +5,15 @@
 #include "EpiblastCellProliferativeType.hpp"
 #include "PrECellProliferativeType.hpp"
 #include "TransitCellProliferativeType.hpp"
-#include "CellPolaritySrnModel.hpp"
+#include "NissenHaloStateMirror.hpp"
+#include "Exception.hpp"
 #include "Debug.hpp"
 
+#include <cfloat>
+
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
 NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::NissenForceTrophectoderm()
-   : AbstractTwoBodyInteractionForce<ELEMENT_DIM,SPACE_DIM>(),
+   : AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>(),
      mS_TE_ICM(0.6),  // TE-ICM interaction strength
      mS_TE_EPI(0.6),  // TE-EPI interaction strength
      mS_TE_PrE(0.4),  // TE-PrE interaction strength
@@ -27,9 +30,11 @@ NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::~NissenForceTrophectoderm()
 }
 
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
-c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::CalculateForceBetweenNodes(unsigned nodeAGlobalIndex,
-                                                                                            unsigned nodeBGlobalIndex,
-                                                                                            AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
+c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::CalculateForceFromPairGeometry(unsigned nodeAGlobalIndex,
+                                                                                                            unsigned nodeBGlobalIndex,
+                                                                                                            const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                                                                            double distance,
+                                                                                                            AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
 {
     // We should only ever calculate the force between two distinct nodes
     assert(nodeAGlobalIndex != nodeBGlobalIndex);
@@ -42,12 +47,11 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
     const c_vector<double, SPACE_DIM>& r_node_A_location = p_node_A->rGetLocation();
     const c_vector<double, SPACE_DIM>& r_node_B_location = p_node_B->rGetLocation();
 
-    // Work out the vector from node A to node B and use the GetVector method from rGetMesh
-    c_vector<double, SPACE_DIM> unit_vector_from_A_to_B;
-    unit_vector_from_A_to_B = rCellPopulation.rGetMesh().GetVectorFromAtoB(r_node_A_location, r_node_B_location);
+    // The vector from node A to node B (from the GetVector method of rGetMesh) and its length are supplied by AddForceContribution()
+    c_vector<double, SPACE_DIM> unit_vector_from_A_to_B = rVectorFromAtoB;
 
     // Distance between the two nodes
-    double d = norm_2(unit_vector_from_A_to_B);
+    double d = distance;
     
     // Normalise the vector between A and B
     unit_vector_from_A_to_B /= d;
@@ -95,8 +99,7 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
        c_vector<double, SPACE_DIM> p_cell_A_second_focus;
        
        // Fill vectors using the polarity_vector data which should be stored when specifiying trophectoderm (See TestNodeBasedMorula.hpp)
-       CellPolaritySrnModel* p_srn_model_A = static_cast<CellPolaritySrnModel*>(p_cell_A->GetSrnModel());
-       double angle_A = p_srn_model_A->GetPolarityAngle();
+       double angle_A = NissenHaloStateMirror<SPACE_DIM>::Instance()->GetPolarityAngle(p_cell_A, nodeAGlobalIndex);
        //initialise the perpendicular vector to the polarity of the trophectoderm cell A to define the axis of our pseudo-elipse
        c_vector<double, SPACE_DIM> perp_polarity_vector_A;
        perp_polarity_vector_A[0] = -sin(angle_A);
@@ -120,8 +123,7 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
             
           
             //First thing we want to do is get the polarity angle for the trophectoderm cell B
-            CellPolaritySrnModel* p_srn_model_B = static_cast<CellPolaritySrnModel*>(p_cell_B->GetSrnModel());
-            double angle_B = p_srn_model_B->GetPolarityAngle();
+            double angle_B = NissenHaloStateMirror<SPACE_DIM>::Instance()->GetPolarityAngle(p_cell_B, nodeBGlobalIndex);
           
             //Need to store the polarity vectors as they have direct effects on the forces between TE cells
             c_vector<double, SPACE_DIM> polarity_vector_A;
@@ -161,7 +163,9 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
                c_vector<double, SPACE_DIM> extra_polarity_contribution_A = -s*exp(-normalised_distance/15.0)*e_B_dot_r_AB*(3/normalised_distance)*polarity_vector_A;
                c_vector<double, SPACE_DIM> extra_polarity_contribution_B = -s*exp(-normalised_distance/15.0)*e_A_dot_r_AB*(3/normalised_distance)*polarity_vector_B;
                
-               force = potential_gradient*polarity_factor*s + potential_gradient_repulsion + centrally_acting_polarity_contribution + extra_polarity_contribution_A + extra_polarity_contribution_B;
+               force = this->CombineForceComponents(potential_gradient_repulsion,
+                                                    potential_gradient*polarity_factor*s + centrally_acting_polarity_contribution + extra_polarity_contribution_A + extra_polarity_contribution_B,
+                                                    d);
                return force;
             }
 
@@ -267,8 +271,9 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
                c_vector<double, SPACE_DIM> extra_polarity_contribution_B_A1B1 = -s*exp(-normalised_d_A1_B1/5.0)*e_A_dot_r_A1B1*(1/normalised_d_A1_B1)*polarity_vector_B;
                
                
-               force_first_A_focus_first_B_focus = potential_gradient*polarity_factor*s + potential_gradient_repulsion + centrally_acting_polarity_contribution_A1B1 
-                                                   + extra_polarity_contribution_A_A1B1 + extra_polarity_contribution_B_A1B1;
+               force_first_A_focus_first_B_focus = this->CombineForceComponents(potential_gradient_repulsion,
+                                                                                potential_gradient*polarity_factor*s + centrally_acting_polarity_contribution_A1B1 + extra_polarity_contribution_A_A1B1 + extra_polarity_contribution_B_A1B1,
+                                                                                d_A1_B1);
                number_of_active_forces += 1.0;
                //check the force exists
                for (unsigned j=0; j<SPACE_DIM; j++)
@@ -298,8 +303,9 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
                c_vector<double, SPACE_DIM> extra_polarity_contribution_B_A1B2 = -s*exp(-normalised_d_A1_B2/5.0)*e_A_dot_r_A1B2*(1/normalised_d_A1_B2)*polarity_vector_B;
                
                
-               force_first_A_focus_second_B_focus = potential_gradient*polarity_factor*s + potential_gradient_repulsion + centrally_acting_polarity_contribution_A1B2 
-                                                   + extra_polarity_contribution_A_A1B2 + extra_polarity_contribution_B_A1B2;
+               force_first_A_focus_second_B_focus = this->CombineForceComponents(potential_gradient_repulsion,
+                                                                                 potential_gradient*polarity_factor*s + centrally_acting_polarity_contribution_A1B2 + extra_polarity_contribution_A_A1B2 + extra_polarity_contribution_B_A1B2,
+                                                                                 d_A1_B2);
                number_of_active_forces += 1.0;
                //check the force exists
                for (unsigned j=0; j<SPACE_DIM; j++)
@@ -329,8 +335,9 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
                c_vector<double, SPACE_DIM> extra_polarity_contribution_B_A2B1 = -s*exp(-normalised_d_A2_B1/5.0)*e_A_dot_r_A2B1*(1/normalised_d_A2_B1)*polarity_vector_B;
                
                
-               force_second_A_focus_first_B_focus = potential_gradient*polarity_factor*s + potential_gradient_repulsion + centrally_acting_polarity_contribution_A2B1 
-                                                   + extra_polarity_contribution_A_A2B1 + extra_polarity_contribution_B_A2B1;
+               force_second_A_focus_first_B_focus = this->CombineForceComponents(potential_gradient_repulsion,
+                                                                                 potential_gradient*polarity_factor*s + centrally_acting_polarity_contribution_A2B1 + extra_polarity_contribution_A_A2B1 + extra_polarity_contribution_B_A2B1,
+                                                                                 d_A2_B1);
                number_of_active_forces += 1.0;
                //check the force exists
                for (unsigned j=0; j<SPACE_DIM; j++)
@@ -360,8 +367,9 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
                c_vector<double, SPACE_DIM> extra_polarity_contribution_B_A2B2 = -s*exp(-normalised_d_A2_B2/5.0)*e_A_dot_r_A2B2*(1/normalised_d_A2_B2)*polarity_vector_B;
                
                
-               force_second_A_focus_second_B_focus = potential_gradient*polarity_factor*s + potential_gradient_repulsion + centrally_acting_polarity_contribution_A2B2 
-                                                   + extra_polarity_contribution_A_A2B2 + extra_polarity_contribution_B_A2B2;
+               force_second_A_focus_second_B_focus = this->CombineForceComponents(potential_gradient_repulsion,
+                                                                                  potential_gradient*polarity_factor*s + centrally_acting_polarity_contribution_A2B2 + extra_polarity_contribution_A_A2B2 + extra_polarity_contribution_B_A2B2,
+                                                                                  d_A2_B2);
                number_of_active_forces += 1.0;
                //check the force exists
                for (unsigned j=0; j<SPACE_DIM; j++)
@@ -430,7 +438,9 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
                potential_gradient = exp(-d_A1_B/5.0)*unit_vector_from_A1_to_B/5.0;
                potential_gradient_repulsion = -exp(-d_A1_B)*unit_vector_from_A1_to_B;
                
-               force_first_A_focus_B = potential_gradient*s + potential_gradient_repulsion;
+               force_first_A_focus_B = this->CombineForceComponents(potential_gradient_repulsion,
+                                                                    potential_gradient*s,
+                                                                    d_A1_B);
                number_of_active_forces += 1.0;
             }
             if(d_A2_B/2.0 < this->GetCutOffLength())
@@ -438,7 +448,9 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
                potential_gradient = exp(-d_A2_B/5.0)*unit_vector_from_A2_to_B/5.0;
                potential_gradient_repulsion = -exp(-d_A2_B)*unit_vector_from_A2_to_B;
                
-               force_second_A_focus_B = potential_gradient*s + potential_gradient_repulsion;
+               force_second_A_focus_B = this->CombineForceComponents(potential_gradient_repulsion,
+                                                                     potential_gradient*s,
+                                                                     d_A2_B);
                number_of_active_forces += 1.0;
             }
           
@@ -490,7 +502,9 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
                potential_gradient = exp(-d_A1_B/5.0)*unit_vector_from_A1_to_B/5.0;
                potential_gradient_repulsion = -exp(-d_A1_B)*unit_vector_from_A1_to_B;
                
-               force_first_A_focus_B = potential_gradient*s + potential_gradient_repulsion;
+               force_first_A_focus_B = this->CombineForceComponents(potential_gradient_repulsion,
+                                                                    potential_gradient*s,
+                                                                    d_A1_B);
                number_of_active_forces += 1.0;
                
                for (unsigned j=0; j<SPACE_DIM; j++)
@@ -511,7 +525,9 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
                potential_gradient = exp(-d_A2_B/5.0)*unit_vector_from_A2_to_B/5.0;
                potential_gradient_repulsion = -exp(-d_A2_B)*unit_vector_from_A2_to_B;
                
-               force_second_A_focus_B = potential_gradient*s + potential_gradient_repulsion;
+               force_second_A_focus_B = this->CombineForceComponents(potential_gradient_repulsion,
+                                                                     potential_gradient*s,
+                                                                     d_A2_B);
                number_of_active_forces += 1.0;
               
                for (unsigned j=0; j<SPACE_DIM; j++)
@@ -579,7 +595,9 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
                potential_gradient = exp(-d_A1_B/5.0)*unit_vector_from_A1_to_B/5.0;
                potential_gradient_repulsion = -exp(-d_A1_B)*unit_vector_from_A1_to_B;
                
-               force_first_A_focus_B = potential_gradient*s + potential_gradient_repulsion;
+               force_first_A_focus_B = this->CombineForceComponents(potential_gradient_repulsion,
+                                                                    potential_gradient*s,
+                                                                    d_A1_B);
                number_of_active_forces += 1.0;
             }
             if(d_A2_B/2.0 < this->GetCutOffLength())
@@ -587,7 +605,9 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
                potential_gradient = exp(-d_A2_B/5.0)*unit_vector_from_A2_to_B/5.0;
                potential_gradient_repulsion = -exp(-d_A2_B)*unit_vector_from_A2_to_B;
                
-               force_second_A_focus_B = potential_gradient*s + potential_gradient_repulsion;
+               force_second_A_focus_B = this->CombineForceComponents(potential_gradient_repulsion,
+                                                                     potential_gradient*s,
+                                                                     d_A2_B);
                number_of_active_forces += 1.0;
             }
           
@@ -623,8 +643,7 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
        if(p_cell_B->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>())
        {
             //First thing we want to do is get the polarity angle for the trophectoderm cell B
-            CellPolaritySrnModel* p_srn_model_B = static_cast<CellPolaritySrnModel*>(p_cell_B->GetSrnModel());
-            double angle_B = p_srn_model_B->GetPolarityAngle();
+            double angle_B = NissenHaloStateMirror<SPACE_DIM>::Instance()->GetPolarityAngle(p_cell_B, nodeBGlobalIndex);
           
             //initialise the perpendicular vector to the polarity of the trophectoderm cell B
             c_vector<double, SPACE_DIM> perp_polarity_vector_B;
@@ -667,7 +686,9 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
                potential_gradient = exp(-d_A_B1/5.0)*unit_vector_from_A_to_B1/5.0;
                potential_gradient_repulsion = -exp(-d_A_B1)*unit_vector_from_A_to_B1;
                
-               force_A_first_B_focus = potential_gradient*s + potential_gradient_repulsion;
+               force_A_first_B_focus = this->CombineForceComponents(potential_gradient_repulsion,
+                                                                    potential_gradient*s,
+                                                                    d_A_B1);
                number_of_active_forces += 1.0;
                for (unsigned j=0; j<SPACE_DIM; j++)
                {
@@ -688,7 +709,9 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
                potential_gradient = exp(-d_A_B2/5.0)*unit_vector_from_A_to_B2/5.0;
                potential_gradient_repulsion = -exp(-d_A_B2)*unit_vector_from_A_to_B2;
                
-               force_A_second_B_focus = potential_gradient*s + potential_gradient_repulsion;
+               force_A_second_B_focus = this->CombineForceComponents(potential_gradient_repulsion,
+                                                                     potential_gradient*s,
+                                                                     d_A_B2);
                number_of_active_forces += 1.0;
                for (unsigned j=0; j<SPACE_DIM; j++)
                {
@@ -728,8 +751,7 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
        {
           
             //First thing we want to do is get the polarity angle for the trophectoderm cell B
-            CellPolaritySrnModel* p_srn_model_B = static_cast<CellPolaritySrnModel*>(p_cell_B->GetSrnModel());
-            double angle_B = p_srn_model_B->GetPolarityAngle();
+            double angle_B = NissenHaloStateMirror<SPACE_DIM>::Instance()->GetPolarityAngle(p_cell_B, nodeBGlobalIndex);
           
             //initialise the perpendicular vector to the polarity of the trophectoderm cell B
             c_vector<double, SPACE_DIM> perp_polarity_vector_B;
@@ -775,7 +797,9 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
                potential_gradient = exp(-d_A_B1/5.0)*unit_vector_from_A_to_B1/5.0;
                potential_gradient_repulsion = -exp(-d_A_B1)*unit_vector_from_A_to_B1;
                
-               force_A_first_B_focus = potential_gradient*s + potential_gradient_repulsion;
+               force_A_first_B_focus = this->CombineForceComponents(potential_gradient_repulsion,
+                                                                    potential_gradient*s,
+                                                                    d_A_B1);
                number_of_active_forces += 1.0;
             }
             if(d_A_B2/2.0 < this->GetCutOffLength())
@@ -783,7 +807,9 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
                potential_gradient = exp(-d_A_B2/5.0)*unit_vector_from_A_to_B2/5.0;
                potential_gradient_repulsion = -exp(-d_A_B2)*unit_vector_from_A_to_B2;
                
-               force_A_second_B_focus = potential_gradient*s + potential_gradient_repulsion;
+               force_A_second_B_focus = this->CombineForceComponents(potential_gradient_repulsion,
+                                                                     potential_gradient*s,
+                                                                     d_A_B2);
                number_of_active_forces += 1.0;
             }
           
@@ -810,8 +836,7 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
        if(p_cell_B->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>())
        {
             //First thing we want to do is get the polarity angle for the trophectoderm cell B
-            CellPolaritySrnModel* p_srn_model_B = static_cast<CellPolaritySrnModel*>(p_cell_B->GetSrnModel());
-            double angle_B = p_srn_model_B->GetPolarityAngle();
+            double angle_B = NissenHaloStateMirror<SPACE_DIM>::Instance()->GetPolarityAngle(p_cell_B, nodeBGlobalIndex);
           
             //initialise the perpendicular vector to the polarity of the trophectoderm cell B
             c_vector<double, SPACE_DIM> perp_polarity_vector_B;
@@ -857,7 +882,9 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
                potential_gradient = exp(-d_A_B1/5.0)*unit_vector_from_A_to_B1/5.0;
                potential_gradient_repulsion = -exp(-d_A_B1)*unit_vector_from_A_to_B1;
                
-               force_A_first_B_focus = potential_gradient*s + potential_gradient_repulsion;
+               force_A_first_B_focus = this->CombineForceComponents(potential_gradient_repulsion,
+                                                                    potential_gradient*s,
+                                                                    d_A_B1);
                number_of_active_forces += 1.0;
             }
             if(d_A_B2/2.0 < this->GetCutOffLength())
@@ -865,7 +892,9 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
                potential_gradient = exp(-d_A_B2/5.0)*unit_vector_from_A_to_B2/5.0;
                potential_gradient_repulsion = -exp(-d_A_B2)*unit_vector_from_A_to_B2;
                
-               force_A_second_B_focus = potential_gradient*s + potential_gradient_repulsion;
+               force_A_second_B_focus = this->CombineForceComponents(potential_gradient_repulsion,
+                                                                     potential_gradient*s,
+                                                                     d_A_B2);
                number_of_active_forces += 1.0;
             }
           
@@ -894,6 +923,51 @@ c_vector<double, SPACE_DIM> NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::Cal
 }
 
 
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::GetMaximumInteractionRange()
+{
+    double range = AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::GetMaximumInteractionRange();
+    return (range == DBL_MAX) ? range : range + 0.5;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::GetFastInteractionRange()
+{
+    // Without a cutoff, two trophectoderm cells interact through the foci of both
+    return AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::GetFastInteractionRange() + 1.0;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::CalculatePairStiffness(unsigned nodeAGlobalIndex,
+                                                                               unsigned nodeBGlobalIndex,
+                                                                               double distance,
+                                                                               AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
+{
+    bool is_A_trophectoderm = rCellPopulation.GetCellUsingLocationIndex(nodeAGlobalIndex)->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>();
+    bool is_B_trophectoderm = rCellPopulation.GetCellUsingLocationIndex(nodeBGlobalIndex)->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>();
+    if ((!is_A_trophectoderm && !is_B_trophectoderm) || distance >= this->GetMaximumInteractionRange())
+    {
+        return 0.0;
+    }
+
+    // Within two cell radii two trophectoderm cells interact through their centres
+    if (is_A_trophectoderm && is_B_trophectoderm && 2.0*distance < 2.0)
+    {
+        return this->CalculateRepulsionStiffness(distance, 3.0);
+    }
+    return this->CalculateRepulsionStiffness(distance, 1.0);
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::CalculatePairPotential(unsigned nodeAGlobalIndex,
+                                                                               unsigned nodeBGlobalIndex,
+                                                                               const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                                               double distance,
+                                                                               AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
+{
+    EXCEPTION("NissenForceTrophectoderm acts between polarity-dependent foci and has no pair potential");
+}
+
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
 double NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::GetS_TE_ICM()
 {
@@ -962,7 +1036,7 @@ void NissenForceTrophectoderm<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(out_
     *rParamsFile << "\t\t\t<S_TE_EPI>" << mS_TE_EPI << "</S_TE_EPI>\n";
     *rParamsFile << "\t\t\t<S_TE_PrE>" << mS_TE_PrE << "</S_TE_PrE>\n";
     *rParamsFile << "\t\t\t<GrowthDuration>" << mGrowthDuration << "</GrowthDuration>\n";
-    AbstractTwoBodyInteractionForce<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(rParamsFile);
+    AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(rParamsFile);
 }
 
 //Explicit Instantiation of the Force
@@ -1,7 +1,7 @@
 #ifndef NISSENFORCETROPHECTODERM_HPP_
 #define NISSENFORCETROPHECTODERM_HPP_
 
-#include "AbstractTwoBodyInteractionForce.hpp"
+#include "AbstractNissenTwoBodyForce.hpp"
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
@@ -9,7 +9,7 @@
 // NOTE: It is not a good idea to include "Test" in a class name, to avoid confusion with test suite names.
 
 template<unsigned  ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
-class NissenForceTrophectoderm : public AbstractTwoBodyInteractionForce<ELEMENT_DIM, SPACE_DIM>
+class NissenForceTrophectoderm : public AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>
 {
 private:
 
@@ -17,7 +17,7 @@ private:
     template<class Archive>
     void serialize(Archive & archive, const unsigned int version)
     {
-        archive & boost::serialization::base_object<AbstractTwoBodyInteractionForce<ELEMENT_DIM, SPACE_DIM> >(*this);
+        archive & boost::serialization::base_object<AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM> >(*this);
         archive & mS_TE_ICM;
         archive & mS_TE_EPI;
         archive & mS_TE_PrE;
@@ -38,9 +38,65 @@ public:
 
     virtual ~NissenForceTrophectoderm();
 
-    c_vector<double, SPACE_DIM> CalculateForceBetweenNodes(unsigned nodeAGlobalIndex,
-                                                           unsigned nodeBGlobalIndex,
-                                                           AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
+    c_vector<double, SPACE_DIM> CalculateForceFromPairGeometry(unsigned nodeAGlobalIndex,
+                                                               unsigned nodeBGlobalIndex,
+                                                               const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                               double distance,
+                                                               AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
+
+    /**
+     * Overridden GetMaximumInteractionRange() method.
+     *
+     * A trophectoderm cell interacts with a non-trophectoderm cell through its two foci, which lie half a
+     * cell diameter either side of its centre, so the nodes may be up to this much further apart than the cutoff.
+     *
+     * @return the largest distance between two nodes at which this force can be non-zero.
+     */
+    double GetMaximumInteractionRange();
+
+    /**
+     * Overridden GetFastInteractionRange() method.
+     *
+     * @return the largest distance between two nodes at which the fast part of this force can be non-zero,
+     * allowing for the foci of both cells.
+     */
+    double GetFastInteractionRange();
+
+    /**
+     * Overridden CalculatePairStiffness() method.
+     *
+     * Two trophectoderm cells within two cell radii repel each other through their centres by the softer
+     * exp(-d/3); pairs without a trophectoderm cell are left to other forces.
+     *
+     * @param nodeAGlobalIndex index of one neighbouring node
+     * @param nodeBGlobalIndex index of the other neighbouring node
+     * @param distance the distance between the nodes
+     * @param rCellPopulation the cell population
+     * @return the radial stiffness of the repulsion between the nodes
+     */
+    double CalculatePairStiffness(unsigned nodeAGlobalIndex,
+                                  unsigned nodeBGlobalIndex,
+                                  double distance,
+                                  AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
+
+    /**
+     * Overridden CalculatePairPotential() method.
+     *
+     * The forces on trophectoderm cells act between foci placed by the cells' polarity, so are not the
+     * gradient of a potential in the node positions, and this throws an exception.
+     *
+     * @param nodeAGlobalIndex index of one neighbouring node
+     * @param nodeBGlobalIndex index of the other neighbouring node
+     * @param rVectorFromAtoB the vector from node A to node B
+     * @param distance the length of rVectorFromAtoB
+     * @param rCellPopulation the cell population
+     * @return never returns
+     */
+    double CalculatePairPotential(unsigned nodeAGlobalIndex,
+                                  unsigned nodeBGlobalIndex,
+                                  const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                  double distance,
+                                  AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
     
     double GetS_TE_ICM();
     void SetS_TE_ICM(double s);
@@ -0,0 +1,319 @@
+
+#include "NissenForceTrophectoderm3d.hpp"
+#include "TrophectodermCellProliferativeType.hpp"
+#include "EpiblastCellProliferativeType.hpp"
+#include "PrECellProliferativeType.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "CellPolarityVectors.hpp"
+#include "NissenHaloStateMirror.hpp"
+#include "Exception.hpp"
+
+#include <cfloat>
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::NissenForceTrophectoderm3d()
+   : AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>(),
+     mS_TE_ICM(0.6),
+     mS_TE_EPI(0.6),
+     mS_TE_PrE(0.4),
+     mS_TE_TE(-1.4)
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::~NissenForceTrophectoderm3d()
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+c_vector<double, SPACE_DIM> NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::CalculateFocusForce(const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                                                                   double s)
+{
+    double distance = norm_2(rVectorFromAtoB);
+    if (distance == 0.0)
+    {
+        return zero_vector<double>(SPACE_DIM);
+    }
+
+    // NISSEN DISTANCES ARE GIVEN IN UNITS OF CELL RADII
+    double d = 2.0*distance;
+    c_vector<double, SPACE_DIM> unit_vector_from_A_to_B = rVectorFromAtoB/distance;
+    return this->CombineForceComponents(-exp(-d)*unit_vector_from_A_to_B,
+                                        s*exp(-d/5.0)/5.0*unit_vector_from_A_to_B,
+                                        d);
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+c_vector<double, SPACE_DIM> NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::CalculatePolarForce(const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                                                                   const c_vector<double, SPACE_DIM>& rPolarityA,
+                                                                                                   const c_vector<double, SPACE_DIM>& rPolarityB,
+                                                                                                   bool isCentral)
+{
+    double distance = norm_2(rVectorFromAtoB);
+    if (distance == 0.0)
+    {
+        return zero_vector<double>(SPACE_DIM);
+    }
+    c_vector<double, SPACE_DIM> unit_vector_from_A_to_B = rVectorFromAtoB/distance;
+    double d = 2.0*distance;
+
+    // Cells in close contact interact through their centres, with longer-ranged adhesion and softer repulsion
+    double attraction_length = isCentral ? 15.0 : 5.0;
+    double repulsion_length = isCentral ? 3.0 : 1.0;
+    double polarity_coefficient = isCentral ? 3.0 : 1.0;
+
+    double s = mS_TE_TE;
+    double e_A_dot_r_AB = inner_prod(rPolarityA, unit_vector_from_A_to_B);
+    double e_B_dot_r_AB = inner_prod(rPolarityB, unit_vector_from_A_to_B);
+
+    // Equal to -sin(phi - alpha_A)*sin(phi - alpha_B) in 2D, where phi is the angle of the vector from A to B
+    double polarity_factor = e_A_dot_r_AB*e_B_dot_r_AB - inner_prod(rPolarityA, rPolarityB);
+    double attraction = exp(-d/attraction_length);
+
+    double central_magnitude = s*polarity_factor*attraction/5.0
+                               + (2.0*polarity_coefficient*s/d)*e_A_dot_r_AB*e_B_dot_r_AB*attraction;
+    double extra_magnitude = -s*attraction*polarity_coefficient/d;
+
+    return this->CombineForceComponents(-exp(-d/repulsion_length)*unit_vector_from_A_to_B,
+                                        central_magnitude*unit_vector_from_A_to_B
+                                            + extra_magnitude*(e_B_dot_r_AB*rPolarityA + e_A_dot_r_AB*rPolarityB),
+                                        d);
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+c_vector<double, SPACE_DIM> NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::CalculateForceOnTrophectodermCell(const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                                                                                 const c_vector<double, SPACE_DIM>& rPolarityA,
+                                                                                                                 double s,
+                                                                                                                 bool average)
+{
+    c_vector<double, SPACE_DIM> focus_offset = 0.5*CellPolarityVectors::GetFocusDirection<SPACE_DIM>(rPolarityA, rVectorFromAtoB);
+
+    c_vector<double, SPACE_DIM> force = zero_vector<double>(SPACE_DIM);
+    unsigned num_active_foci = 0;
+    for (int sign=-1; sign<=1; sign+=2)
+    {
+        c_vector<double, SPACE_DIM> vector_from_focus_to_B = rVectorFromAtoB - double(sign)*focus_offset;
+        if (norm_2(vector_from_focus_to_B) < this->GetCutOffLength())
+        {
+            force += CalculateFocusForce(vector_from_focus_to_B, s);
+            num_active_foci++;
+        }
+    }
+
+    if (average && num_active_foci > 0)
+    {
+        force /= double(num_active_foci);
+    }
+    return force;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+c_vector<double, SPACE_DIM> NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::CalculateForceFromPairGeometry(unsigned nodeAGlobalIndex,
+                                                                                                              unsigned nodeBGlobalIndex,
+                                                                                                              const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                                                                              double distance,
+                                                                                                              AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
+{
+    // We should only ever calculate the force between two distinct nodes
+    assert(nodeAGlobalIndex != nodeBGlobalIndex);
+
+    CellPtr p_cell_A = rCellPopulation.GetCellUsingLocationIndex(nodeAGlobalIndex);
+    CellPtr p_cell_B = rCellPopulation.GetCellUsingLocationIndex(nodeBGlobalIndex);
+
+    bool is_A_trophectoderm = p_cell_A->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>();
+    bool is_B_trophectoderm = p_cell_B->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>();
+
+    // Interactions not involving the trophectoderm are left to other forces
+    if (!is_A_trophectoderm && !is_B_trophectoderm)
+    {
+        return zero_vector<double>(SPACE_DIM);
+    }
+
+    if (is_A_trophectoderm && is_B_trophectoderm)
+    {
+        if (this->mUseCutOffLength && distance >= this->GetCutOffLength())
+        {
+            return zero_vector<double>(SPACE_DIM);
+        }
+
+        c_vector<double, SPACE_DIM> polarity_A = NissenHaloStateMirror<SPACE_DIM>::Instance()->GetPolarityVector(p_cell_A, nodeAGlobalIndex);
+        c_vector<double, SPACE_DIM> polarity_B = NissenHaloStateMirror<SPACE_DIM>::Instance()->GetPolarityVector(p_cell_B, nodeBGlobalIndex);
+
+        // Within two cell radii (NISSEN DISTANCES ARE GIVEN IN UNITS OF CELL RADII) the cells interact through their centres
+        double d = 2.0*distance;
+        if (d < 2.0)
+        {
+            return CalculatePolarForce(rVectorFromAtoB, polarity_A, polarity_B, true);
+        }
+
+        // Otherwise through each pair of foci, on the rims of A and B nearest to and furthest from each other
+        c_vector<double, SPACE_DIM> focus_offset_A = 0.5*CellPolarityVectors::GetFocusDirection<SPACE_DIM>(polarity_A, rVectorFromAtoB);
+        c_vector<double, SPACE_DIM> focus_offset_B = 0.5*CellPolarityVectors::GetFocusDirection<SPACE_DIM>(polarity_B, -rVectorFromAtoB);
+
+        c_vector<double, SPACE_DIM> force = zero_vector<double>(SPACE_DIM);
+        for (int sign_A=-1; sign_A<=1; sign_A+=2)
+        {
+            for (int sign_B=-1; sign_B<=1; sign_B+=2)
+            {
+                c_vector<double, SPACE_DIM> vector_between_foci = rVectorFromAtoB + double(sign_B)*focus_offset_B - double(sign_A)*focus_offset_A;
+
+                // As in NissenForceTrophectoderm, foci interact within half the cutoff
+                if (2.0*norm_2(vector_between_foci) < this->GetCutOffLength())
+                {
+                    force += CalculatePolarForce(vector_between_foci, polarity_A, polarity_B, false);
+                }
+            }
+        }
+        return force;
+    }
+
+    // One cell is trophectoderm: its foci interact with the centre of the other
+    CellPtr p_other_cell = is_A_trophectoderm ? p_cell_B : p_cell_A;
+    double s;
+    bool average;
+    if (p_other_cell->GetCellProliferativeType()->template IsType<TransitCellProliferativeType>())
+    {
+        s = mS_TE_ICM;
+        average = false;
+    }
+    else if (p_other_cell->GetCellProliferativeType()->template IsType<EpiblastCellProliferativeType>())
+    {
+        s = mS_TE_EPI;
+        average = true;
+    }
+    else if (p_other_cell->GetCellProliferativeType()->template IsType<PrECellProliferativeType>())
+    {
+        s = mS_TE_PrE;
+        average = true;
+    }
+    else
+    {
+        return zero_vector<double>(SPACE_DIM);
+    }
+
+    if (is_A_trophectoderm)
+    {
+        c_vector<double, SPACE_DIM> polarity_A = NissenHaloStateMirror<SPACE_DIM>::Instance()->GetPolarityVector(p_cell_A, nodeAGlobalIndex);
+        return CalculateForceOnTrophectodermCell(rVectorFromAtoB, polarity_A, s, average);
+    }
+    else
+    {
+        // The force law is odd in the separation, so the force on A is minus that on the trophectoderm cell B
+        c_vector<double, SPACE_DIM> polarity_B = NissenHaloStateMirror<SPACE_DIM>::Instance()->GetPolarityVector(p_cell_B, nodeBGlobalIndex);
+        c_vector<double, SPACE_DIM> vector_from_B_to_A = -rVectorFromAtoB;
+        return -CalculateForceOnTrophectodermCell(vector_from_B_to_A, polarity_B, s, average);
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::GetMaximumInteractionRange()
+{
+    double range = AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::GetMaximumInteractionRange();
+    return (range == DBL_MAX) ? range : range + 0.5;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::GetFastInteractionRange()
+{
+    return AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::GetFastInteractionRange() + 0.5;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::CalculatePairStiffness(unsigned nodeAGlobalIndex,
+                                                                                 unsigned nodeBGlobalIndex,
+                                                                                 double distance,
+                                                                                 AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
+{
+    bool is_A_trophectoderm = rCellPopulation.GetCellUsingLocationIndex(nodeAGlobalIndex)->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>();
+    bool is_B_trophectoderm = rCellPopulation.GetCellUsingLocationIndex(nodeBGlobalIndex)->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>();
+    if ((!is_A_trophectoderm && !is_B_trophectoderm) || distance >= this->GetMaximumInteractionRange())
+    {
+        return 0.0;
+    }
+
+    // Within two cell radii two trophectoderm cells interact through their centres
+    if (is_A_trophectoderm && is_B_trophectoderm && 2.0*distance < 2.0)
+    {
+        return this->CalculateRepulsionStiffness(distance, 3.0);
+    }
+    return this->CalculateRepulsionStiffness(distance, 1.0);
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::CalculatePairPotential(unsigned nodeAGlobalIndex,
+                                                                                 unsigned nodeBGlobalIndex,
+                                                                                 const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                                                 double distance,
+                                                                                 AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
+{
+    EXCEPTION("NissenForceTrophectoderm3d acts between polarity-dependent foci and has no pair potential");
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::GetS_TE_ICM()
+{
+    return mS_TE_ICM;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::SetS_TE_ICM(double s)
+{
+    mS_TE_ICM = s;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::GetS_TE_EPI()
+{
+    return mS_TE_EPI;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::SetS_TE_EPI(double s)
+{
+    mS_TE_EPI = s;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::GetS_TE_PrE()
+{
+    return mS_TE_PrE;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::SetS_TE_PrE(double s)
+{
+    mS_TE_PrE = s;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::GetS_TE_TE()
+{
+    return mS_TE_TE;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::SetS_TE_TE(double s)
+{
+    mS_TE_TE = s;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenForceTrophectoderm3d<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<S_TE_TE>" << mS_TE_TE << "</S_TE_TE>\n";
+    *rParamsFile << "\t\t\t<S_TE_ICM>" << mS_TE_ICM << "</S_TE_ICM>\n";
+    *rParamsFile << "\t\t\t<S_TE_EPI>" << mS_TE_EPI << "</S_TE_EPI>\n";
+    *rParamsFile << "\t\t\t<S_TE_PrE>" << mS_TE_PrE << "</S_TE_PrE>\n";
+    AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class NissenForceTrophectoderm3d<1,1>;
+template class NissenForceTrophectoderm3d<1,2>;
+template class NissenForceTrophectoderm3d<2,2>;
+template class NissenForceTrophectoderm3d<1,3>;
+template class NissenForceTrophectoderm3d<2,3>;
+template class NissenForceTrophectoderm3d<3,3>;
+
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(NissenForceTrophectoderm3d)
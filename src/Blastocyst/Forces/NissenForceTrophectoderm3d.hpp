@@ -0,0 +1,228 @@
+#ifndef NISSENFORCETROPHECTODERM3D_HPP_
+#define NISSENFORCETROPHECTODERM3D_HPP_
+
+#include "AbstractNissenTwoBodyForce.hpp"
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+/**
+ * The trophectoderm force law of NissenForceTrophectoderm, written for polarity vectors so that it applies
+ * in 3D as well as 2D.
+ *
+ * Each trophectoderm cell is pictured as a disc normal to its polarity, with its foci on a ring half a cell
+ * diameter from its centre (see CellPolarityVectors). For each pair of cells the two foci used are the
+ * points of the ring nearest to and furthest from the other cell; in 2D these are the two foci of
+ * NissenForceTrophectoderm. The angular polarity factor -sin(phi - alpha_A)*sin(phi - alpha_B) of the 2D
+ * law is replaced by its vector form (e_A.r)(e_B.r) - e_A.e_B, which agrees with it in 2D, so that no
+ * trigonometry is needed. Polarities are read from a CellPolarityVectorSrnModel, or from a
+ * CellPolaritySrnModel in 2D.
+ *
+ * Unlike NissenForceTrophectoderm, every focus distance is converted to cell radii exactly once, so the two
+ * foci of a trophectoderm cell act symmetrically on a non-trophectoderm neighbour.
+ */
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
+class NissenForceTrophectoderm3d : public AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the object and its member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM> >(*this);
+        archive & mS_TE_ICM;
+        archive & mS_TE_EPI;
+        archive & mS_TE_PrE;
+        archive & mS_TE_TE;
+    }
+
+    /** TE-ICM interaction strength. Defaults to 0.6. */
+    double mS_TE_ICM;
+
+    /** TE-EPI interaction strength. Defaults to 0.6. */
+    double mS_TE_EPI;
+
+    /** TE-PrE interaction strength. Defaults to 0.4. */
+    double mS_TE_PrE;
+
+    /** TE-TE interaction strength, multiplied by the polarity factor. Defaults to -1.4. */
+    double mS_TE_TE;
+
+    /**
+     * @return the force on one focus (or centre) from another, for cells without interacting polarities.
+     *
+     * @param rVectorFromAtoB the vector between the two points
+     * @param s the interaction strength
+     */
+    c_vector<double, SPACE_DIM> CalculateFocusForce(const c_vector<double, SPACE_DIM>& rVectorFromAtoB, double s);
+
+    /**
+     * @return the polarity-dependent force on one trophectoderm focus (or centre) from another.
+     *
+     * @param rVectorFromAtoB the vector between the two points
+     * @param rPolarityA the unit polarity of cell A
+     * @param rPolarityB the unit polarity of cell B
+     * @param isCentral whether the points are the cell centres, which use the longer-ranged close-contact law
+     */
+    c_vector<double, SPACE_DIM> CalculatePolarForce(const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                    const c_vector<double, SPACE_DIM>& rPolarityA,
+                                                    const c_vector<double, SPACE_DIM>& rPolarityB,
+                                                    bool isCentral);
+
+    /**
+     * @return the force on a trophectoderm cell A from a cell B of another type, summed or averaged over
+     * the foci of A.
+     *
+     * @param rVectorFromAtoB the vector between the centres of the cells
+     * @param rPolarityA the unit polarity of cell A
+     * @param s the interaction strength
+     * @param average whether to average, rather than sum, the forces from the foci within the cutoff
+     */
+    c_vector<double, SPACE_DIM> CalculateForceOnTrophectodermCell(const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                                  const c_vector<double, SPACE_DIM>& rPolarityA,
+                                                                  double s,
+                                                                  bool average);
+
+public:
+
+    /**
+     * Constructor.
+     */
+    NissenForceTrophectoderm3d();
+
+    /**
+     * Destructor.
+     */
+    virtual ~NissenForceTrophectoderm3d();
+
+    /**
+     * Overridden CalculateForceFromPairGeometry() method.
+     *
+     * @param nodeAGlobalIndex index of one neighbouring node
+     * @param nodeBGlobalIndex index of the other neighbouring node
+     * @param rVectorFromAtoB the vector from node A to node B
+     * @param distance the length of rVectorFromAtoB
+     * @param rCellPopulation the cell population
+     *
+     * @return The force exerted on Node A by Node B.
+     */
+    c_vector<double, SPACE_DIM> CalculateForceFromPairGeometry(unsigned nodeAGlobalIndex,
+                                                               unsigned nodeBGlobalIndex,
+                                                               const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                               double distance,
+                                                               AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
+
+    /**
+     * Overridden GetMaximumInteractionRange() method.
+     *
+     * A trophectoderm cell interacts with a non-trophectoderm cell through foci half a cell diameter from
+     * its centre, so the nodes may be up to this much further apart than the cutoff.
+     *
+     * @return the largest distance between two nodes at which this force can be non-zero.
+     */
+    double GetMaximumInteractionRange();
+
+    /**
+     * Overridden GetFastInteractionRange() method.
+     *
+     * @return the largest distance between two nodes at which the fast part of this force can be non-zero,
+     * allowing for the foci of a trophectoderm cell.
+     */
+    double GetFastInteractionRange();
+
+    /**
+     * Overridden CalculatePairStiffness() method.
+     *
+     * Two trophectoderm cells within two cell radii repel each other through their centres by the softer
+     * exp(-d/3); pairs without a trophectoderm cell are left to other forces.
+     *
+     * @param nodeAGlobalIndex index of one neighbouring node
+     * @param nodeBGlobalIndex index of the other neighbouring node
+     * @param distance the distance between the nodes
+     * @param rCellPopulation the cell population
+     * @return the radial stiffness of the repulsion between the nodes
+     */
+    double CalculatePairStiffness(unsigned nodeAGlobalIndex,
+                                  unsigned nodeBGlobalIndex,
+                                  double distance,
+                                  AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
+
+    /**
+     * Overridden CalculatePairPotential() method.
+     *
+     * The forces on trophectoderm cells act between foci placed by the cells' polarity, so are not the
+     * gradient of a potential in the node positions, and this throws an exception.
+     *
+     * @param nodeAGlobalIndex index of one neighbouring node
+     * @param nodeBGlobalIndex index of the other neighbouring node
+     * @param rVectorFromAtoB the vector from node A to node B
+     * @param distance the length of rVectorFromAtoB
+     * @param rCellPopulation the cell population
+     * @return never returns
+     */
+    double CalculatePairPotential(unsigned nodeAGlobalIndex,
+                                  unsigned nodeBGlobalIndex,
+                                  const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                  double distance,
+                                  AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
+
+    /** @return mS_TE_ICM */
+    double GetS_TE_ICM();
+
+    /**
+     * Set mS_TE_ICM.
+     *
+     * @param s the new value
+     */
+    void SetS_TE_ICM(double s);
+
+    /** @return mS_TE_EPI */
+    double GetS_TE_EPI();
+
+    /**
+     * Set mS_TE_EPI.
+     *
+     * @param s the new value
+     */
+    void SetS_TE_EPI(double s);
+
+    /** @return mS_TE_PrE */
+    double GetS_TE_PrE();
+
+    /**
+     * Set mS_TE_PrE.
+     *
+     * @param s the new value
+     */
+    void SetS_TE_PrE(double s);
+
+    /** @return mS_TE_TE */
+    double GetS_TE_TE();
+
+    /**
+     * Set mS_TE_TE.
+     *
+     * @param s the new value
+     */
+    void SetS_TE_TE(double s);
+
+    /**
+     * Overridden OutputForceParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputForceParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(NissenForceTrophectoderm3d)
+
+#endif /*NISSENFORCETROPHECTODERM3D_HPP_*/
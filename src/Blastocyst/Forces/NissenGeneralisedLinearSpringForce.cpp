@@ -27,10 +27,10 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "NissenGeneralisedLinearSpringForce.hpp"
 #include "TrophectodermCellProliferativeType.hpp"
-#include "CellPolaritySrnModel.hpp"
+#include "NissenHaloStateMirror.hpp"
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
 NissenGeneralisedLinearSpringForce<ELEMENT_DIM,SPACE_DIM>::NissenGeneralisedLinearSpringForce()
-   : AbstractTwoBodyInteractionForce<ELEMENT_DIM,SPACE_DIM>(),
+   : AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>(),
      mMeinekeSpringStiffness(15.0),        // denoted by mu in Meineke et al, 2001 (doi:10.1046/j.0960-7722.2001.00216.x)
      mMeinekeDivisionRestingSpringLength(0.5),
      mMeinekeSpringGrowthDuration(1.0)
@@ -56,9 +56,11 @@ NissenGeneralisedLinearSpringForce<ELEMENT_DIM,SPACE_DIM>::~NissenGeneralisedLin
 }
 
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
-c_vector<double, SPACE_DIM> NissenGeneralisedLinearSpringForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceBetweenNodes(unsigned nodeAGlobalIndex,
-                                                                                    unsigned nodeBGlobalIndex,
-                                                                                    AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
+c_vector<double, SPACE_DIM> NissenGeneralisedLinearSpringForce<ELEMENT_DIM,SPACE_DIM>::CalculateForceFromPairGeometry(unsigned nodeAGlobalIndex,
+                                                                                                                      unsigned nodeBGlobalIndex,
+                                                                                                                      const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                                                                                      double distance,
+                                                                                                                      AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
 {
     // We should only ever calculate the force between two distinct nodes
     assert(nodeAGlobalIndex != nodeBGlobalIndex);
@@ -66,10 +68,6 @@ c_vector<double, SPACE_DIM> NissenGeneralisedLinearSpringForce<ELEMENT_DIM,SPACE
     Node<SPACE_DIM>* p_node_a = rCellPopulation.GetNode(nodeAGlobalIndex);
     Node<SPACE_DIM>* p_node_b = rCellPopulation.GetNode(nodeBGlobalIndex);
 
-    // Get the node locations
-    const c_vector<double, SPACE_DIM>& r_node_a_location = p_node_a->rGetLocation();
-    const c_vector<double, SPACE_DIM>& r_node_b_location = p_node_b->rGetLocation();
-
     // Get the node radii for a NodeBasedCellPopulation
     double node_a_radius = 0.0;
     double node_b_radius = 0.0;
@@ -80,18 +78,16 @@ c_vector<double, SPACE_DIM> NissenGeneralisedLinearSpringForce<ELEMENT_DIM,SPACE
         node_b_radius = p_node_b->GetRadius();
     }
 
-    // Get the unit vector parallel to the line joining the two nodes
-    c_vector<double, SPACE_DIM> unit_difference;
     /*
-     * We use the mesh method GetVectorFromAtoB() to compute the direction of the
-     * unit vector along the line joining the two nodes, rather than simply subtract
-     * their positions, because this method can be overloaded (e.g. to enforce a
-     * periodic boundary in Cylindrical2dMesh).
+     * Get the unit vector parallel to the line joining the two nodes. The vector is
+     * supplied by AddForceContribution(), having been computed once using the mesh
+     * method GetVectorFromAtoB() (which can be overloaded, e.g. to enforce a periodic
+     * boundary in Cylindrical2dMesh).
      */
-    unit_difference = rCellPopulation.rGetMesh().GetVectorFromAtoB(r_node_a_location, r_node_b_location);
+    c_vector<double, SPACE_DIM> unit_difference = rVectorFromAtoB;
 
-    // Calculate the distance between the two nodes
-    double distance_between_nodes = norm_2(unit_difference);
+    // The distance between the two nodes
+    double distance_between_nodes = distance;
     assert(distance_between_nodes > 0);
     assert(!std::isnan(distance_between_nodes));
 
@@ -193,17 +189,14 @@ c_vector<double, SPACE_DIM> NissenGeneralisedLinearSpringForce<ELEMENT_DIM,SPACE
     //Initialise a polarity factor which does nothing to the force unless both cell A and cell B are trophectoderm
     if(p_cell_A->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>() && p_cell_B->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>())
     {      
-        CellPolaritySrnModel* p_srn_model_A = static_cast<CellPolaritySrnModel*>(p_cell_A->GetSrnModel());
-        double angle_A = p_srn_model_A->GetPolarityAngle();
-        CellPolaritySrnModel* p_srn_model_B = static_cast<CellPolaritySrnModel*>(p_cell_B->GetSrnModel());
-        double angle_B = p_srn_model_B->GetPolarityAngle();
-        
-        
-        double cell_difference_angle = atan2(unit_difference[1],unit_difference[0]);
-        
-        double polarity_factor = -(cos(angle_A)*sin(cell_difference_angle) - sin(angle_A)*cos(cell_difference_angle))*
-        (sin(angle_B)*cos(cell_difference_angle) - cos(angle_B)*cos(cell_difference_angle));
-       
+        c_vector<double, SPACE_DIM> polarity_A = NissenHaloStateMirror<SPACE_DIM>::Instance()->GetPolarityVector(p_cell_A, nodeAGlobalIndex);
+        c_vector<double, SPACE_DIM> polarity_B = NissenHaloStateMirror<SPACE_DIM>::Instance()->GetPolarityVector(p_cell_B, nodeBGlobalIndex);
+
+        // sin(phi - alpha_A)*sin(phi - alpha_B) in 2D, where phi is the angle of unit_difference: largest for
+        // neighbours side by side with aligned polarities
+        double polarity_factor = inner_prod(polarity_A, polarity_B)
+                                 - inner_prod(polarity_A, unit_difference)*inner_prod(polarity_B, unit_difference);
+
         // Although in this class the 'spring constant' is a constant parameter, in
         // subclasses it can depend on properties of each of the cells. The rest length is a property of polarity factor - two cells with a high
         // polarity factor have a lower rest length, cells with zero polarity factor have a slightly longer rest lenght, and cells with a negative
@@ -217,7 +210,9 @@ c_vector<double, SPACE_DIM> NissenGeneralisedLinearSpringForce<ELEMENT_DIM,SPACE
                                                     
         if (bool(dynamic_cast<MeshBasedCellPopulation<ELEMENT_DIM,SPACE_DIM>*>(&rCellPopulation)))
         {
-            return multiplication_factor * spring_stiffness * unit_difference * overlap;
+            c_vector<double, SPACE_DIM> temp = multiplication_factor * spring_stiffness * unit_difference * overlap;
+            return is_closer_than_rest_length ? this->CombineForceComponents(temp, zero_vector<double>(SPACE_DIM), 2.0*distance_between_nodes)
+                                              : this->CombineForceComponents(zero_vector<double>(SPACE_DIM), temp, 2.0*distance_between_nodes);
         }
         else
         {
@@ -227,13 +222,13 @@ c_vector<double, SPACE_DIM> NissenGeneralisedLinearSpringForce<ELEMENT_DIM,SPACE
                 //log(x+1) is undefined for x<=-1
                 assert(-overlap < this->GetCutOffLength());
                 c_vector<double, SPACE_DIM> temp = multiplication_factor*spring_stiffness * unit_difference * (this->GetCutOffLength())* log(1.0 + overlap/(this->GetCutOffLength()));
-                return temp;
+                return this->CombineForceComponents(temp, zero_vector<double>(SPACE_DIM), 2.0*distance_between_nodes);
             }
             else
             {
                 double alpha = 5.0;
                 c_vector<double, SPACE_DIM> temp = multiplication_factor*spring_stiffness * unit_difference * overlap * exp(-alpha * overlap/(this->GetCutOffLength()));
-                return temp;
+                return this->CombineForceComponents(zero_vector<double>(SPACE_DIM), temp, 2.0*distance_between_nodes);
             }
         }
     }
@@ -249,7 +244,9 @@ c_vector<double, SPACE_DIM> NissenGeneralisedLinearSpringForce<ELEMENT_DIM,SPACE
 
         if (bool(dynamic_cast<MeshBasedCellPopulation<ELEMENT_DIM,SPACE_DIM>*>(&rCellPopulation)))
         {
-            return multiplication_factor * spring_stiffness * unit_difference * overlap;
+            c_vector<double, SPACE_DIM> temp = multiplication_factor * spring_stiffness * unit_difference * overlap;
+            return is_closer_than_rest_length ? this->CombineForceComponents(temp, zero_vector<double>(SPACE_DIM), 2.0*distance_between_nodes)
+                                              : this->CombineForceComponents(zero_vector<double>(SPACE_DIM), temp, 2.0*distance_between_nodes);
         }
         else
         {
@@ -259,13 +256,13 @@ c_vector<double, SPACE_DIM> NissenGeneralisedLinearSpringForce<ELEMENT_DIM,SPACE
                 //log(x+1) is undefined for x<=-1
                 assert(overlap > -rest_length_final);
                 c_vector<double, SPACE_DIM> temp = multiplication_factor*spring_stiffness * unit_difference * rest_length_final* log(1.0 + overlap/rest_length_final);
-                return temp;
+                return this->CombineForceComponents(temp, zero_vector<double>(SPACE_DIM), 2.0*distance_between_nodes);
             }
             else
             {
                 double alpha = 5.0;
                 c_vector<double, SPACE_DIM> temp = multiplication_factor*spring_stiffness * unit_difference * overlap * exp(-alpha * overlap/rest_length_final);
-                return temp;
+                return this->CombineForceComponents(zero_vector<double>(SPACE_DIM), temp, 2.0*distance_between_nodes);
             }
         }
     }
@@ -313,6 +310,15 @@ void NissenGeneralisedLinearSpringForce<ELEMENT_DIM,SPACE_DIM>::SetMeinekeSpring
     mMeinekeSpringGrowthDuration = springGrowthDuration;
 }
 
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenGeneralisedLinearSpringForce<ELEMENT_DIM,SPACE_DIM>::CalculatePairStiffness(unsigned nodeAGlobalIndex,
+                                                                                         unsigned nodeBGlobalIndex,
+                                                                                         double distance,
+                                                                                         AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation)
+{
+    return 0.0;
+}
+
 template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
 void NissenGeneralisedLinearSpringForce<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(out_stream& rParamsFile)
 {
@@ -321,7 +327,7 @@ void NissenGeneralisedLinearSpringForce<ELEMENT_DIM,SPACE_DIM>::OutputForceParam
     *rParamsFile << "\t\t\t<MeinekeSpringGrowthDuration>" << mMeinekeSpringGrowthDuration << "</MeinekeSpringGrowthDuration>\n";
 
     // Call method on direct parent class
-    AbstractTwoBodyInteractionForce<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(rParamsFile);
+    AbstractNissenTwoBodyForce<ELEMENT_DIM,SPACE_DIM>::OutputForceParameters(rParamsFile);
 }
 
 // Explicit instantiation
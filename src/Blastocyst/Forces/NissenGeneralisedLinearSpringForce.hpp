@@ -36,7 +36,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef NISSENGENERALISEDLINEARSPRINGFORCE_HPP_
 #define NISSENGENERALISEDLINEARSPRINGFORCE_HPP_
 
-#include "AbstractTwoBodyInteractionForce.hpp"
+#include "AbstractNissenTwoBodyForce.hpp"
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
@@ -62,7 +62,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  * Time is in hours.
  */
 template<unsigned  ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
-class NissenGeneralisedLinearSpringForce : public AbstractTwoBodyInteractionForce<ELEMENT_DIM, SPACE_DIM>
+class NissenGeneralisedLinearSpringForce : public AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>
 {
     friend class TestForces;
 
@@ -79,7 +79,7 @@ private:
     template<class Archive>
     void serialize(Archive & archive, const unsigned int version)
     {
-        archive & boost::serialization::base_object<AbstractTwoBodyInteractionForce<ELEMENT_DIM, SPACE_DIM> >(*this);
+        archive & boost::serialization::base_object<AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM> >(*this);
         archive & mMeinekeSpringStiffness;
         archive & mMeinekeDivisionRestingSpringLength;
         archive & mMeinekeSpringGrowthDuration;
@@ -144,7 +144,7 @@ public:
                                                               bool isCloserThanRestLength);
 
     /**
-     * Overridden CalculateForceBetweenNodes() method.
+     * Overridden CalculateForceFromPairGeometry() method.
      *
      * Calculates the force between two nodes.
      *
@@ -152,12 +152,16 @@ public:
      *
      * @param nodeAGlobalIndex index of one neighbouring node
      * @param nodeBGlobalIndex index of the other neighbouring node
+     * @param rVectorFromAtoB the vector from node A to node B
+     * @param distance the length of rVectorFromAtoB
      * @param rCellPopulation the cell population
      * @return The force exerted on Node A by Node B.
      */
-    c_vector<double, SPACE_DIM> CalculateForceBetweenNodes(unsigned nodeAGlobalIndex,
-                                                     unsigned nodeBGlobalIndex,
-                                                     AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
+    c_vector<double, SPACE_DIM> CalculateForceFromPairGeometry(unsigned nodeAGlobalIndex,
+                                                               unsigned nodeBGlobalIndex,
+                                                               const c_vector<double, SPACE_DIM>& rVectorFromAtoB,
+                                                               double distance,
+                                                               AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
     /**
      * @return mMeinekeSpringStiffness
      */
@@ -194,6 +198,22 @@ public:
      */
     void SetMeinekeSpringGrowthDuration(double springGrowthDuration);
 
+    /**
+     * Overridden CalculatePairStiffness() method.
+     *
+     * The springs are not stiff at close contact, so they are left explicit.
+     *
+     * @param nodeAGlobalIndex index of one neighbouring node
+     * @param nodeBGlobalIndex index of the other neighbouring node
+     * @param distance the distance between the nodes
+     * @param rCellPopulation the cell population
+     * @return zero
+     */
+    double CalculatePairStiffness(unsigned nodeAGlobalIndex,
+                                  unsigned nodeBGlobalIndex,
+                                  double distance,
+                                  AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>& rCellPopulation);
+
     /**
      * Overridden OutputForceParameters() method.
      *
@@ -1,12 +1,18 @@
 
 #include "NissenNoiseForce.hpp"
 #include "NodeBasedCellPopulation.hpp"
+#include "BatchedNormalDeviateGenerator.hpp"
+#include "CounterBasedRandomStreams.hpp"
+
+#include <climits>
 
 // Constructor
 template<unsigned DIM>
 NissenNoiseForce<DIM>::NissenNoiseForce()
     : AbstractForce<DIM>(),
-      mNoiseStandardDev(1.0e-3) // default to Value in Nissen paper
+      mNoiseStandardDev(1.0e-3), // default to Value in Nissen paper
+      mLastTimeStep(UINT_MAX),
+      mNumCallsInTimeStep(0)
 {
 }
 
@@ -34,7 +40,45 @@ double NissenNoiseForce<DIM>::GetNoiseStandardDev()
 template<unsigned DIM>
 void NissenNoiseForce<DIM>::AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation)
 {
+    CounterBasedRandomStreams* p_streams = CounterBasedRandomStreams::Instance();
+    if (p_streams->IsEnabled())
+    {
+        unsigned time_step = CounterBasedRandomStreams::GetAbsoluteTimeStep();
+        if (time_step != mLastTimeStep)
+        {
+            mLastTimeStep = time_step;
+            mNumCallsInTimeStep = 0;
+        }
+
+        // Draw the noise of each node from the stream of its cell, whatever the order of the nodes
+        for (typename AbstractMesh<DIM, DIM>::NodeIterator node_iter = rCellPopulation.rGetMesh().GetNodeIteratorBegin();
+             node_iter != rCellPopulation.rGetMesh().GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            unsigned cell_id = rCellPopulation.GetCellUsingLocationIndex(node_iter->GetIndex())->GetCellId();
+            c_vector<double, DIM> force_contribution;
+            for (unsigned i=0; i<DIM; i++)
+            {
+                force_contribution[i] = p_streams->NormalRandomDeviate(0.0, mNoiseStandardDev, cell_id,
+                                                                       CounterBasedRandomStreams::NOISE_FORCE,
+                                                                       mNumCallsInTimeStep*DIM + i);
+            }
+            node_iter->AddAppliedForceContribution(force_contribution);
+        }
+        mNumCallsInTimeStep++;
+        return;
+    }
+
+    // Generate the noise for every node at once
+    unsigned num_nodes = rCellPopulation.rGetMesh().GetNumNodes();
+    std::vector<double> noise(num_nodes*DIM);
+    if (!noise.empty())
+    {
+        BatchedNormalDeviateGenerator::Instance()->Fill(&noise[0], noise.size(), 0.0, mNoiseStandardDev);
+    }
+
     // Iterate over the nodes
+    unsigned index = 0;
     for (typename AbstractMesh<DIM, DIM>::NodeIterator node_iter = rCellPopulation.rGetMesh().GetNodeIteratorBegin();
          node_iter != rCellPopulation.rGetMesh().GetNodeIteratorEnd();
          ++node_iter)
@@ -43,9 +87,7 @@ void NissenNoiseForce<DIM>::AddForceContribution(AbstractCellPopulation<DIM>& rC
         c_vector<double, DIM> force_contribution;
         for (unsigned i=0; i<DIM; i++)
         {
-            double xi = RandomNumberGenerator::Instance()->NormalRandomDeviate(0.0, mNoiseStandardDev);
-
-            force_contribution[i] = xi;
+            force_contribution[i] = noise[index++];
         }
         node_iter->AddAppliedForceContribution(force_contribution);
     }
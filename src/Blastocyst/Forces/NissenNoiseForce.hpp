@@ -12,7 +12,9 @@
 /**
  * A 'diffusion force' class to model the random movement of nodes.
  *
- * This class works with all off-lattice cell populations.
+ * This class works with all off-lattice cell populations. The noise for every node is generated in one batch
+ * each time step by BatchedNormalDeviateGenerator or, if they are enabled, drawn for each cell from
+ * CounterBasedRandomStreams.
  */
 template<unsigned DIM>
 class NissenNoiseForce : public AbstractForce<DIM>
@@ -24,6 +26,15 @@ private :
      */
     double mNoiseStandardDev;
 
+    /** The time step of the last call to AddForceContribution(). */
+    unsigned mLastTimeStep;
+
+    /**
+     * The number of calls to AddForceContribution() in the current time step, so that a numerical method
+     * which evaluates the forces several times in a step draws fresh counter-based noise for each.
+     */
+    unsigned mNumCallsInTimeStep;
+
     /**
      * Archiving.
      */
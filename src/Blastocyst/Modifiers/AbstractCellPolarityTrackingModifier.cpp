@@ -0,0 +1,239 @@
+#include "AbstractCellPolarityTrackingModifier.hpp"
+#include "CellPolarityOdeSystem.hpp"
+#include "SimulationTime.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "NissenPairGeometryCache.hpp"
+#include "NissenHaloStateMirror.hpp"
+#include "CellPopulationStateTracker.hpp"
+#include "BatchedNormalDeviateGenerator.hpp"
+#include "Warnings.hpp"
+
+#include <algorithm>
+#include <climits>
+
+template<unsigned DIM>
+AbstractCellPolarityTrackingModifier<DIM>::AbstractCellPolarityTrackingModifier()
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mCellDataOutputInterval(0),
+      mSamplingTimestepMultiple(1),
+      mCouplingRadius(2.5),
+      mMaxPolarityUpdateInterval(1),
+      mPolarityUpdateInterval(1),
+      mNextPolarityUpdateStep(0),
+      mStablePolarityUpdateInterval(UINT_MAX)
+{
+}
+
+template<unsigned DIM>
+AbstractCellPolarityTrackingModifier<DIM>::~AbstractCellPolarityTrackingModifier()
+{
+}
+
+template<unsigned DIM>
+void AbstractCellPolarityTrackingModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    // The SRN models solve their ODEs at the start of the next time step, using the drive computed here
+    if (SimulationTime::Instance()->GetTimeStepsElapsed() >= mNextPolarityUpdateStep)
+    {
+        UpdateCellData(rCellPopulation);
+    }
+
+    // The simulation writes its results after the modifiers have been updated, so refresh CellData for the writers
+    unsigned cell_data_output_interval = (mCellDataOutputInterval > 0) ? mCellDataOutputInterval : mSamplingTimestepMultiple;
+    if (SimulationTime::Instance()->GetTimeStepsElapsed() % cell_data_output_interval == 0)
+    {
+        WriteCellData(rCellPopulation);
+    }
+}
+
+template<unsigned DIM>
+void AbstractCellPolarityTrackingModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    // The buffered polarity noise is not archived, so start from the RandomNumberGenerator as it now stands
+    BatchedNormalDeviateGenerator::Instance()->Reset();
+
+    mNextPolarityUpdateStep = SimulationTime::Instance()->GetTimeStepsElapsed();
+    mPolarityUpdateInterval = 1;
+    UpdateCellData(rCellPopulation);
+    WriteCellData(rCellPopulation);
+}
+
+template<unsigned DIM>
+void AbstractCellPolarityTrackingModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    // Polarity updates may lag the mechanics by part of an interval, so catch up before leaving Solve()
+    SynchroniseSrnModels(rCellPopulation);
+    WriteCellData(rCellPopulation);
+}
+
+template<unsigned DIM>
+void AbstractCellPolarityTrackingModifier<DIM>::GetCellsInSpatialOrder(AbstractCellPopulation<DIM,DIM>& rCellPopulation,
+                                                                      std::vector<CellPtr>& rCells,
+                                                                      std::vector<unsigned>& rHaloLocationIndices)
+{
+    // Make sure the node pairs cover the coupling radius; the population is only updated if they might not
+    CellPopulationStateTracker<DIM>::Instance()->EnsureState(rCellPopulation,
+                                                             CellPopulationStateTracker<DIM>::NODE_LOCATIONS | CellPopulationStateTracker<DIM>::NODE_PAIRS,
+                                                             mCouplingRadius);
+
+    rCells.clear();
+    rHaloLocationIndices.clear();
+
+    NodeBasedCellPopulation<DIM>* p_node_based_population = dynamic_cast<NodeBasedCellPopulation<DIM>*>(&rCellPopulation);
+    if (p_node_based_population != nullptr)
+    {
+        // In a distributed run, trophectoderm halo nodes couple to owned cells through their mirrored state
+        NissenHaloStateMirror<DIM>* p_mirror = NissenHaloStateMirror<DIM>::Instance();
+        p_mirror->Refresh(*p_node_based_population);
+        rHaloLocationIndices = p_mirror->GetHaloNodeIndices(NissenHaloStateMirror<DIM>::TROPHECTODERM_TYPE);
+
+        const std::vector<unsigned>& r_node_ordering = NissenPairGeometryCache<DIM>::Instance()->rGetNodeOrdering(*p_node_based_population);
+        rCells.reserve(r_node_ordering.size());
+        for (unsigned k=0; k<r_node_ordering.size(); k++)
+        {
+            rCells.push_back(rCellPopulation.GetCellUsingLocationIndex(r_node_ordering[k]));
+        }
+    }
+    else
+    {
+        for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+             cell_iter != rCellPopulation.End();
+             ++cell_iter)
+        {
+            rCells.push_back(*cell_iter);
+        }
+    }
+}
+
+template<unsigned DIM>
+unsigned AbstractCellPolarityTrackingModifier<DIM>::CalculateStablePolarityUpdateInterval()
+{
+    unsigned max_num_neighbours = mTrophectodermGraph.GetMaxNumNeighbours();
+
+    if (IsPolarityUpdateUnconditionallyStable() || max_num_neighbours == 0)
+    {
+        return UINT_MAX;
+    }
+
+    double eigenvalue_bound = 2.0*CellPolarityOdeSystem::GetCouplingStrength()*max_num_neighbours;
+    double dt = SimulationTime::Instance()->GetTimeStep();
+
+    if (dt*eigenvalue_bound > 1.0)
+    {
+        // Subcycling the mechanics within a polarity step would need a custom numerical method
+        WARN_ONCE_ONLY("The explicit polarity coupling is stiffer than the mechanics time step; consider a smaller time step or an implicit polarity update.");
+        return 1;
+    }
+
+    double stable_interval = floor(1.0/(dt*eigenvalue_bound));
+    return (stable_interval < UINT_MAX) ? std::max(1u, static_cast<unsigned>(stable_interval)) : UINT_MAX;
+}
+
+template<unsigned DIM>
+unsigned AbstractCellPolarityTrackingModifier<DIM>::ChoosePolarityUpdateInterval()
+{
+    mStablePolarityUpdateInterval = CalculateStablePolarityUpdateInterval();
+    return std::min(mMaxPolarityUpdateInterval, mStablePolarityUpdateInterval);
+}
+
+template<unsigned DIM>
+void AbstractCellPolarityTrackingModifier<DIM>::ScheduleNextPolarityUpdate()
+{
+    mPolarityUpdateInterval = ChoosePolarityUpdateInterval();
+    mNextPolarityUpdateStep = SimulationTime::Instance()->GetTimeStepsElapsed() + mPolarityUpdateInterval;
+}
+
+template<unsigned DIM>
+unsigned AbstractCellPolarityTrackingModifier<DIM>::GetSrnUpdateInterval(unsigned locationIndex)
+{
+    if (!mpLocalTimeSteppingNumericalMethod)
+    {
+        return mPolarityUpdateInterval;
+    }
+    return std::min(mpLocalTimeSteppingNumericalMethod->GetPolarityUpdateInterval(locationIndex), mStablePolarityUpdateInterval);
+}
+
+template<unsigned DIM>
+bool AbstractCellPolarityTrackingModifier<DIM>::IsPolarityUpdateUnconditionallyStable()
+{
+    return false;
+}
+
+template<unsigned DIM>
+unsigned AbstractCellPolarityTrackingModifier<DIM>::GetCellDataOutputInterval()
+{
+    return mCellDataOutputInterval;
+}
+
+template<unsigned DIM>
+void AbstractCellPolarityTrackingModifier<DIM>::SetCellDataOutputInterval(unsigned cellDataOutputInterval)
+{
+    mCellDataOutputInterval = cellDataOutputInterval;
+}
+
+template<unsigned DIM>
+unsigned AbstractCellPolarityTrackingModifier<DIM>::GetSamplingTimestepMultiple()
+{
+    return mSamplingTimestepMultiple;
+}
+
+template<unsigned DIM>
+void AbstractCellPolarityTrackingModifier<DIM>::SetSamplingTimestepMultiple(unsigned samplingTimestepMultiple)
+{
+    assert(samplingTimestepMultiple > 0);
+    mSamplingTimestepMultiple = samplingTimestepMultiple;
+}
+
+template<unsigned DIM>
+double AbstractCellPolarityTrackingModifier<DIM>::GetCouplingRadius()
+{
+    return mCouplingRadius;
+}
+
+template<unsigned DIM>
+void AbstractCellPolarityTrackingModifier<DIM>::SetCouplingRadius(double couplingRadius)
+{
+    assert(couplingRadius > 0.0);
+    mCouplingRadius = couplingRadius;
+}
+
+template<unsigned DIM>
+unsigned AbstractCellPolarityTrackingModifier<DIM>::GetMaxPolarityUpdateInterval()
+{
+    return mMaxPolarityUpdateInterval;
+}
+
+template<unsigned DIM>
+void AbstractCellPolarityTrackingModifier<DIM>::SetMaxPolarityUpdateInterval(unsigned maxPolarityUpdateInterval)
+{
+    assert(maxPolarityUpdateInterval > 0);
+    mMaxPolarityUpdateInterval = maxPolarityUpdateInterval;
+}
+
+template<unsigned DIM>
+unsigned AbstractCellPolarityTrackingModifier<DIM>::GetPolarityUpdateInterval()
+{
+    return mPolarityUpdateInterval;
+}
+
+template<unsigned DIM>
+void AbstractCellPolarityTrackingModifier<DIM>::SetLocalTimeSteppingNumericalMethod(boost::shared_ptr<NissenLocalTimeSteppingNumericalMethod<DIM,DIM> > pMethod)
+{
+    mpLocalTimeSteppingNumericalMethod = pMethod;
+}
+
+template<unsigned DIM>
+void AbstractCellPolarityTrackingModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<CellDataOutputInterval>" << mCellDataOutputInterval << "</CellDataOutputInterval>\n";
+    *rParamsFile << "\t\t\t<CouplingRadius>" << mCouplingRadius << "</CouplingRadius>\n";
+    *rParamsFile << "\t\t\t<MaxPolarityUpdateInterval>" << mMaxPolarityUpdateInterval << "</MaxPolarityUpdateInterval>\n";
+
+    // Next, call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class AbstractCellPolarityTrackingModifier<1>;
+template class AbstractCellPolarityTrackingModifier<2>;
+template class AbstractCellPolarityTrackingModifier<3>;
@@ -0,0 +1,297 @@
+#ifndef ABSTRACTCELLPOLARITYTRACKINGMODIFIER_HPP_
+#define ABSTRACTCELLPOLARITYTRACKINGMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include "ClassIsAbstract.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "CellCouplingGraph.hpp"
+#include "NissenLocalTimeSteppingNumericalMethod.hpp"
+
+/**
+ * Common base class for the modifiers which couple the polarities of neighbouring trophectoderm cells,
+ * CellPolarityTrackingModifier (polarity angles, in 2D) and CellPolarityVectorTrackingModifier (polarity
+ * vectors, in 3D).
+ *
+ * This class schedules the polarity updates and the refreshes of the polarity CellData items. The drive
+ * on the SRN models is recomputed by UpdateCellData() every mPolarityUpdateInterval time steps, where the
+ * interval is chosen at each update from a stability estimate and never exceeds mMaxPolarityUpdateInterval.
+ * The CellData items are refreshed by WriteCellData() at the start and end of the simulation and every
+ * mCellDataOutputInterval time steps or, by default, on every time step at which the simulation writes its
+ * results, so that the cell writers never see stale polarities.
+ *
+ * This class is the only one to set the update intervals of the polarity SRN models. Every SRN model is solved
+ * every mPolarityUpdateInterval time steps, unless a NissenLocalTimeSteppingNumericalMethod has been given with
+ * SetLocalTimeSteppingNumericalMethod(), in which case each model takes the interval the method chose for its
+ * node in the last time step, within the stability bound of the explicit coupling.
+ *
+ * Subclasses gather their cells with GetCellsInSpatialOrder(), build mTrophectodermGraph over the trophectoderm
+ * cells and call ScheduleNextPolarityUpdate() once the drive has been computed.
+ */
+template<unsigned DIM>
+class AbstractCellPolarityTrackingModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mCellDataOutputInterval;
+        archive & mCouplingRadius;
+        archive & mMaxPolarityUpdateInterval;
+        archive & mPolarityUpdateInterval;
+        archive & mNextPolarityUpdateStep;
+    }
+
+protected:
+
+    /**
+     * Number of time steps between refreshes of the polarity CellData items. If zero, CellData is
+     * refreshed every mSamplingTimestepMultiple time steps. Defaults to zero.
+     */
+    unsigned mCellDataOutputInterval;
+
+    /**
+     * The number of time steps between the simulation writing its results. NissenOffLatticeSimulation sets
+     * this at the start of each Solve(); with any other simulation it is 1, so that CellData is refreshed
+     * every time step unless mCellDataOutputInterval is given. Not archived.
+     */
+    unsigned mSamplingTimestepMultiple;
+
+    /**
+     * Trophectoderm cells whose centres are closer than this distance are coupled
+     * through their polarities. Defaults to 2.5.
+     */
+    double mCouplingRadius;
+
+    /**
+     * The largest number of mechanics time steps over which the polarity may be advanced in one
+     * update. The interval actually used is chosen from a stability estimate at each update and
+     * never exceeds this value. Defaults to 1, so that polarity and mechanics are in lock-step.
+     */
+    unsigned mMaxPolarityUpdateInterval;
+
+    /** The number of mechanics time steps covered by the current polarity update. */
+    unsigned mPolarityUpdateInterval;
+
+    /** The time step at which the polarity drive is next recomputed. */
+    unsigned mNextPolarityUpdateStep;
+
+    /** The largest stable polarity update interval, chosen along with mPolarityUpdateInterval. */
+    unsigned mStablePolarityUpdateInterval;
+
+    /** The pairs of trophectoderm cells coupled through their polarities, rebuilt in each call to UpdateCellData(). */
+    CellCouplingGraph<DIM> mTrophectodermGraph;
+
+    /** The local time stepping method whose per-node polarity update intervals are used, if any. Not archived. */
+    boost::shared_ptr<NissenLocalTimeSteppingNumericalMethod<DIM,DIM> > mpLocalTimeSteppingNumericalMethod;
+
+    /**
+     * Make sure the node pairs of the population cover mCouplingRadius and collect its cells. For a
+     * NodeBasedCellPopulation the cells are in the spatial ordering kept by NissenPairGeometryCache, so
+     * that arrays built from them hold neighbouring cells close together, and the NissenHaloStateMirror
+     * is refreshed so that the states of trophectoderm halo nodes may be read from it.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param rCells filled with the cells of the population
+     * @param rHaloLocationIndices filled with the location indices of the trophectoderm halo nodes
+     */
+    void GetCellsInSpatialOrder(AbstractCellPopulation<DIM,DIM>& rCellPopulation,
+                                std::vector<CellPtr>& rCells,
+                                std::vector<unsigned>& rHaloLocationIndices);
+
+    /**
+     * Find the largest number of mechanics time steps for which the polarity update is stable. The largest
+     * eigenvalue of the linearised coupling is bounded by twice the coupling strength times the largest number
+     * of trophectoderm neighbours in mTrophectodermGraph; the explicit update stays non-oscillatory while the
+     * step times this bound is at most one, whereas an update for which IsPolarityUpdateUnconditionallyStable()
+     * is not limited at all.
+     *
+     * @return the stable interval, or UINT_MAX if there is no limit
+     */
+    unsigned CalculateStablePolarityUpdateInterval();
+
+    /**
+     * Choose the number of mechanics time steps for the next polarity update, the stable interval
+     * limited by mMaxPolarityUpdateInterval.
+     *
+     * @return the chosen interval
+     */
+    unsigned ChoosePolarityUpdateInterval();
+
+    /**
+     * Choose the interval of the following polarity update and the time step at which it starts.
+     * Called by UpdateCellData() once the drive covering the interval ending now has been computed.
+     */
+    void ScheduleNextPolarityUpdate();
+
+    /**
+     * @return the number of time steps between solves of the polarity SRN model of a cell until the next
+     *     polarity update: mPolarityUpdateInterval, or the interval chosen for the cell's node by
+     *     mpLocalTimeSteppingNumericalMethod, if given, within the stability bound
+     *
+     * @param locationIndex the location index of the cell
+     */
+    unsigned GetSrnUpdateInterval(unsigned locationIndex);
+
+    /**
+     * @return whether the polarity update is stable for any interval. Defaults to false.
+     */
+    virtual bool IsPolarityUpdateUnconditionallyStable();
+
+    /**
+     * Bring the SRN model of every cell up to the current time.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void SynchroniseSrnModels(AbstractCellPopulation<DIM,DIM>& rCellPopulation)=0;
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    AbstractCellPolarityTrackingModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~AbstractCellPolarityTrackingModifier();
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Recomputes the polarity drive when the next polarity update is due, and refreshes CellData
+     * every mCellDataOutputInterval time steps or, if this is zero, every mSamplingTimestepMultiple
+     * time steps. Modifiers are updated before the simulation writes its results, so CellData is
+     * current whenever it is written.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Computes the drive for the first time step and initialises CellData, which must be done here
+     * so that it has been fully initialised by the time we enter the main time loop.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method.
+     *
+     * Brings every SRN model up to the current time and refreshes the CellData items so
+     * that they are consistent with the SRN models.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Compute the polarity drive on each cell from its trophectoderm neighbours and pass it to the cell's
+     * SRN model, together with the number of time steps until the following update.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation)=0;
+
+    /**
+     * Copy each cell's polarity from its SRN model into CellData, for writers and other code that reads CellData.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void WriteCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation)=0;
+
+    /**
+     * @return mCellDataOutputInterval
+     */
+    unsigned GetCellDataOutputInterval();
+
+    /**
+     * Set mCellDataOutputInterval.
+     *
+     * @param cellDataOutputInterval the number of time steps between CellData refreshes (0 to refresh it
+     *     whenever the simulation writes its results)
+     */
+    void SetCellDataOutputInterval(unsigned cellDataOutputInterval);
+
+    /**
+     * @return mSamplingTimestepMultiple
+     */
+    unsigned GetSamplingTimestepMultiple();
+
+    /**
+     * Set mSamplingTimestepMultiple. NissenOffLatticeSimulation calls this at the start of each Solve().
+     *
+     * @param samplingTimestepMultiple the number of time steps between the simulation writing its results
+     */
+    void SetSamplingTimestepMultiple(unsigned samplingTimestepMultiple);
+
+    /**
+     * @return mCouplingRadius
+     */
+    double GetCouplingRadius();
+
+    /**
+     * Set mCouplingRadius.
+     *
+     * @param couplingRadius the distance within which trophectoderm polarities are coupled
+     */
+    void SetCouplingRadius(double couplingRadius);
+
+    /**
+     * @return mMaxPolarityUpdateInterval
+     */
+    unsigned GetMaxPolarityUpdateInterval();
+
+    /**
+     * Set mMaxPolarityUpdateInterval.
+     *
+     * The polarities relax far more slowly than the mechanics, so the polarity drive and SRN
+     * models may be updated every few mechanics time steps with a correspondingly larger step.
+     *
+     * @param maxPolarityUpdateInterval the largest number of time steps between polarity updates
+     */
+    void SetMaxPolarityUpdateInterval(unsigned maxPolarityUpdateInterval);
+
+    /**
+     * @return the number of mechanics time steps covered by the current polarity update.
+     */
+    unsigned GetPolarityUpdateInterval();
+
+    /**
+     * Set mpLocalTimeSteppingNumericalMethod. NissenOffLatticeSimulation calls this at the start of each
+     * Solve() with its numerical method, if it is a NissenLocalTimeSteppingNumericalMethod.
+     *
+     * @param pMethod the local time stepping method, or an empty pointer for none
+     */
+    void SetLocalTimeSteppingNumericalMethod(boost::shared_ptr<NissenLocalTimeSteppingNumericalMethod<DIM,DIM> > pMethod);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+TEMPLATED_CLASS_IS_ABSTRACT_1_UNSIGNED(AbstractCellPolarityTrackingModifier)
+
+#endif /*ABSTRACTCELLPOLARITYTRACKINGMODIFIER_HPP_*/
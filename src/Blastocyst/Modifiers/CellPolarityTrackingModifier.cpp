@@ -1,12 +1,21 @@
 
 #include "CellPolarityTrackingModifier.hpp"
 #include "CellPolaritySrnModel.hpp"
+#include "CellPolarityOdeSystem.hpp"
 #include "TrophectodermCellProliferativeType.hpp"
+#include "SimulationTime.hpp"
+#include "NissenHaloStateMirror.hpp"
+#include "OutputFileHandler.hpp"
+#include "PetscTools.hpp"
 #include "Debug.hpp"
 
+#include <algorithm>
+
 template<unsigned DIM>
 CellPolarityTrackingModifier<DIM>::CellPolarityTrackingModifier()
-    : AbstractCellBasedSimulationModifier<DIM>()
+    : AbstractCellPolarityTrackingModifier<DIM>(),
+      mUseImplicitPolarityIntegration(false),
+      mOutputMultiRateDiagnostics(false)
 {
 }
 
@@ -15,13 +24,6 @@ CellPolarityTrackingModifier<DIM>::~CellPolarityTrackingModifier()
 {
 }
 
-template<unsigned DIM>
-void CellPolarityTrackingModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
-{
-//    TRACE("Now attempting UpdateAtEndOfTimeStep within the CellPolarityTrackingModifier");
-	UpdateCellData(rCellPopulation);
-}
-
 template<unsigned DIM>
 void CellPolarityTrackingModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
 {
@@ -30,104 +32,281 @@ void CellPolarityTrackingModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DI
      * We must update CellData in SetupSolve(), otherwise it will not have been
      * fully initialised by the time we enter the main time loop.
      */
-    UpdateCellData(rCellPopulation);
+    if (mOutputMultiRateDiagnostics)
+    {
+        OutputFileHandler output_file_handler(outputDirectory + "/", false);
+        mpMultiRateDiagnosticsFile = output_file_handler.OpenOutputFile("polaritymultirate.dat");
+        *mpMultiRateDiagnosticsFile << "# time\tinterval\tmax_eigenvalue_bound\tmax_difference_from_lock_step\n";
+    }
+
+    AbstractCellPolarityTrackingModifier<DIM>::SetupSolve(rCellPopulation, outputDirectory);
+}
+
+template<unsigned DIM>
+void CellPolarityTrackingModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    AbstractCellPolarityTrackingModifier<DIM>::UpdateAtEndOfSolve(rCellPopulation);
+
+    if (mOutputMultiRateDiagnostics && mpMultiRateDiagnosticsFile)
+    {
+        mpMultiRateDiagnosticsFile->close();
+    }
+}
+
+template<unsigned DIM>
+void CellPolarityTrackingModifier<DIM>::SynchroniseSrnModels(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        static_cast<CellPolaritySrnModel*>(cell_iter->GetSrnModel())->SynchroniseToCurrentTime();
+    }
 }
 
 template<unsigned DIM>
 void CellPolarityTrackingModifier<DIM>::UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
 {
     //TRACE("Now attempting to update cell data within CellPolarityTrackingModifier");
-    // Make sure the cell population is updated
-    rCellPopulation.Update();
-    
-    //for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
-         //cell_iter != rCellPopulation.End();
-         //++cell_iter)
-    //{
-	//CellPolaritySrnModel* p_srn_model = static_cast<CellPolaritySrnModel*>(cell_iter->GetSrnModel());
+    // Gather the trophectoderm cells; every other cell just has its polarity evolve via random noise
+    mTrophectodermSrnModels.clear();
+    mTrophectodermAngles.clear();
+    mOtherSrnModels.clear();
+    std::vector<unsigned> location_indices;
+    std::vector<unsigned> other_location_indices;
+
+    std::vector<CellPtr> cells;
+    std::vector<unsigned> halo_location_indices;
+    this->GetCellsInSpatialOrder(rCellPopulation, cells, halo_location_indices);
+
+    // In a distributed run, trophectoderm halo nodes couple to owned cells through their mirrored angles
+    std::vector<double> halo_angles;
+    for (unsigned h=0; h<halo_location_indices.size(); h++)
+    {
+        halo_angles.push_back(NissenHaloStateMirror<DIM>::Instance()->rGetHaloNodeState(halo_location_indices[h]).mPolarityAngle);
+    }
+
+    for (unsigned i=0; i<cells.size(); i++)
+    {
+        CellPolaritySrnModel* p_srn_model = static_cast<CellPolaritySrnModel*>(cells[i]->GetSrnModel());
+
+        // NOTE: Here we assert that the cell does actually have the right SRN model
+        assert(p_srn_model != nullptr);
+
+        if (cells[i]->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>())
+        {
+            mTrophectodermSrnModels.push_back(p_srn_model);
+            mTrophectodermAngles.push_back(p_srn_model->GetPolarityAngle());
+            location_indices.push_back(rCellPopulation.GetLocationIndexUsingCell(cells[i]));
+        }
+        else
+        {
+            p_srn_model->SetdVpdAlpha(0.0);
+            mOtherSrnModels.push_back(p_srn_model);
+            other_location_indices.push_back(rCellPopulation.GetLocationIndexUsingCell(cells[i]));
+        }
+    }
+
+    // Build the trophectoderm coupling graph, storing each cell's neighbours contiguously
+    unsigned num_te_cells = mTrophectodermSrnModels.size();
+    this->mTrophectodermGraph.Build(rCellPopulation, location_indices, this->mCouplingRadius, halo_location_indices);
+    const std::vector<unsigned>& r_neighbour_starts = this->mTrophectodermGraph.rGetNeighbourStarts();
+    const std::vector<unsigned>& r_neighbour_indices = this->mTrophectodermGraph.rGetNeighbourIndices();
+    const std::vector<unsigned>& r_halo_neighbour_starts = this->mTrophectodermGraph.rGetHaloNeighbourStarts();
+    const std::vector<unsigned>& r_halo_neighbour_indices = this->mTrophectodermGraph.rGetHaloNeighbourIndices();
+
+    // The explicit drive on each cell is the sum of sin(alpha_A - alpha_B) over its trophectoderm neighbours
+    std::vector<double> sum_sin_angles(num_te_cells, 0.0);
+    for (unsigned a=0; a<num_te_cells; a++)
+    {
+        for (unsigned k=r_neighbour_starts[a]; k<r_neighbour_starts[a+1]; k++)
+        {
+            sum_sin_angles[a] += sin(mTrophectodermAngles[a] - mTrophectodermAngles[r_neighbour_indices[k]]);
+        }
+        for (unsigned k=r_halo_neighbour_starts[a]; k<r_halo_neighbour_starts[a+1]; k++)
+        {
+            sum_sin_angles[a] += sin(mTrophectodermAngles[a] - halo_angles[r_halo_neighbour_indices[k]]);
+        }
+    }
+
+    if (mUseImplicitPolarityIntegration)
+    {
+        /*
+         * Linearly implicit step for the coupled network. With c the coupling strength and h the
+         * step the SRN models will take, we solve (I + h*c*L)y = sum_sin_angles, where L is the
+         * Jacobian of the drive: the graph Laplacian weighted by cos(alpha_A - alpha_B). Only the
+         * aligning (positive) weights are kept so that the matrix is symmetric positive definite.
+         * Passing y in place of the explicit drive makes each SRN model take exactly this step.
+         *
+         * In a distributed run the angles of halo neighbours are held fixed over the step, so they
+         * only add to the diagonal.
+         */
+        double h = this->mPolarityUpdateInterval*SimulationTime::Instance()->GetTimeStep();
+        double h_c = h*CellPolarityOdeSystem::GetCouplingStrength();
+
+        mPolarityMatrix.Clear(num_te_cells);
+        for (unsigned a=0; a<num_te_cells; a++)
+        {
+            double diagonal = 1.0;
+            for (unsigned k=r_neighbour_starts[a]; k<r_neighbour_starts[a+1]; k++)
+            {
+                double weight = cos(mTrophectodermAngles[a] - mTrophectodermAngles[r_neighbour_indices[k]]);
+                if (weight > 0.0)
+                {
+                    diagonal += h_c*weight;
+                    mPolarityMatrix.AddEntry(r_neighbour_indices[k], -h_c*weight);
+                }
+            }
+            for (unsigned k=r_halo_neighbour_starts[a]; k<r_halo_neighbour_starts[a+1]; k++)
+            {
+                double weight = cos(mTrophectodermAngles[a] - halo_angles[r_halo_neighbour_indices[k]]);
+                if (weight > 0.0)
+                {
+                    diagonal += h_c*weight;
+                }
+            }
+            mPolarityMatrix.AddEntry(a, diagonal);
+            mPolarityMatrix.FinishRow();
+        }
+
+        std::vector<double> implicit_drive = sum_sin_angles;
+        mPolarityMatrix.SolveWithConjugateGradient(sum_sin_angles, implicit_drive);
+        sum_sin_angles.swap(implicit_drive);
+    }
+
+    if (mOutputMultiRateDiagnostics)
+    {
+        WriteMultiRateDiagnostics(sum_sin_angles);
+    }
 
-	// NOTE: Here we assert that the cell does actually have the right SRN model
-	//assert(p_srn_model != nullptr);
+    // This drive covers the interval ending now; choose the length of the following one
+    this->ScheduleNextPolarityUpdate();
+
+    for (unsigned a=0; a<num_te_cells; a++)
+    {
+        mTrophectodermSrnModels[a]->SetdVpdAlpha(sum_sin_angles[a]);
+        mTrophectodermSrnModels[a]->SetUpdateInterval(this->GetSrnUpdateInterval(location_indices[a]));
+    }
+    for (unsigned i=0; i<mOtherSrnModels.size(); i++)
+    {
+        mOtherSrnModels[i]->SetUpdateInterval(this->GetSrnUpdateInterval(other_location_indices[i]));
+    }
+}
 
-        //this_alpha = p_srn_model->GetPolarityAngle();
+template<unsigned DIM>
+bool CellPolarityTrackingModifier<DIM>::IsPolarityUpdateUnconditionallyStable()
+{
+    return mUseImplicitPolarityIntegration;
+}
 
-        // Note that the state variables must be in the same order as listed in DeltaNotchOdeSystem
-        //cell_iter->GetCellData()->SetItem("Polarity Angle", this_alpha);
-    //}
+template<unsigned DIM>
+void CellPolarityTrackingModifier<DIM>::WriteMultiRateDiagnostics(const std::vector<double>& rDrive)
+{
+    double dt = SimulationTime::Instance()->GetTimeStep();
+    double coupling = CellPolarityOdeSystem::GetCouplingStrength();
+    unsigned num_te_cells = mTrophectodermAngles.size();
+    const std::vector<unsigned>& r_neighbour_starts = this->mTrophectodermGraph.rGetNeighbourStarts();
+    const std::vector<unsigned>& r_neighbour_indices = this->mTrophectodermGraph.rGetNeighbourIndices();
 
-    //Iterate over the population to compute and store each cell's neighbouring polarity angle in the srn model
+    // Lock-step reference: recompute the drive from the current angles at every time step
+    std::vector<double> lock_step_angles = mTrophectodermAngles;
+    std::vector<double> drive(num_te_cells);
+    for (unsigned step=0; step<this->mPolarityUpdateInterval; step++)
+    {
+        for (unsigned a=0; a<num_te_cells; a++)
+        {
+            drive[a] = 0.0;
+            for (unsigned k=r_neighbour_starts[a]; k<r_neighbour_starts[a+1]; k++)
+            {
+                drive[a] += sin(lock_step_angles[a] - lock_step_angles[r_neighbour_indices[k]]);
+            }
+        }
+        for (unsigned a=0; a<num_te_cells; a++)
+        {
+            lock_step_angles[a] -= dt*coupling*drive[a];
+        }
+    }
+
+    unsigned max_num_neighbours = 0;
+    double max_difference = 0.0;
+    for (unsigned a=0; a<num_te_cells; a++)
+    {
+        double multi_rate_angle = mTrophectodermAngles[a] - this->mPolarityUpdateInterval*dt*coupling*rDrive[a];
+        max_difference = std::max(max_difference, fabs(multi_rate_angle - lock_step_angles[a]));
+        max_num_neighbours = std::max(max_num_neighbours, r_neighbour_starts[a+1] - r_neighbour_starts[a]);
+    }
+
+    *mpMultiRateDiagnosticsFile << SimulationTime::Instance()->GetTime() << "\t"
+                                << this->mPolarityUpdateInterval << "\t"
+                                << 2.0*coupling*max_num_neighbours << "\t"
+                                << max_difference << "\n";
+}
+
+template<unsigned DIM>
+void CellPolarityTrackingModifier<DIM>::WriteCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
     for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
          cell_iter != rCellPopulation.End();
          ++cell_iter)
     {
-        //For our cell get the srn model
-	CellPolaritySrnModel* p_srn_model_A = static_cast<CellPolaritySrnModel*>(cell_iter->GetSrnModel());
-	
-	// NOTE: Here we assert that the cell does actually have the right SRN model
-	assert(p_srn_model_A != nullptr);
-	//Use the srn model to get the polarity angle for 
-        double this_alpha = p_srn_model_A->GetPolarityAngle();
-	cell_iter->GetCellData()->SetItem("Polarity Angle", this_alpha);
-	    
-	//Test if the cell is trophectoderm
-	if (cell_iter->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>() == true)
-        {
-	    //If the cell is trophectoderm then initialise the sum of neighbouring polarities to update the current polarity
-	    double sum_sin_angles = 0.0;
-	    //Get cell index for the cell in question	
-	    unsigned cell_A_index = rCellPopulation.GetLocationIndexUsingCell(*cell_iter);
-		
-	    //Iterate through the cells again to first check if a taget cell is close and then if it is trophectoderm  
-	    for (typename AbstractCellPopulation<DIM>::Iterator cell_B_iter = rCellPopulation.Begin();
-		 cell_B_iter != rCellPopulation.End(); ++cell_B_iter)
-	    {
-		    unsigned cell_B_index = rCellPopulation.GetLocationIndexUsingCell(*cell_B_iter);
-
-    		    // Assign labels to each node in the pair
-    		    Node<DIM>* p_node_A = rCellPopulation.GetNode(cell_A_index);
-   		    Node<DIM>* p_node_B = rCellPopulation.GetNode(cell_B_index);
-		    
-		    // Find locations of each node in the pair
-    		    const c_vector<double, DIM>& r_node_A_location = p_node_A->rGetLocation();
-    		    const c_vector<double, DIM>& r_node_B_location = p_node_B->rGetLocation();
-
-    		    // Work out the vector from node A to node B and use the GetVector method from rGetMesh
-    		    c_vector<double, DIM> vector_from_A_to_B;
-                    vector_from_A_to_B = rCellPopulation.rGetMesh().GetVectorFromAtoB(r_node_A_location, r_node_B_location);
-
-    	            // Distance between the two nodes
-    		    double d = norm_2(vector_from_A_to_B);
-		    if (d < 2.5)
-		    {
-			    if(cell_B_iter->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>() == true)
-			    {
-				  CellPolaritySrnModel* p_srn_model_B = static_cast<CellPolaritySrnModel*>(cell_B_iter->GetSrnModel());
-				  // NOTE: Here we assert that the cell does actually have the right SRN model
-	    			  assert(p_srn_model_B != nullptr);
-	    			  //Use the srn model to get the polarity angle for cell B
-            			  double alpha_B_cell = p_srn_model_B->GetPolarityAngle();
-				  cell_B_iter->GetCellData()->SetItem("Polarity Angle", alpha_B_cell);
-				  //Work out the correct polarity force
-                        	  sum_sin_angles += sin(this_alpha - alpha_B_cell); 
-			    }
-		    }
-	    }
-	    //whatever our final sum_sin_angles is must be applied to the current trophectoderm cell
-	    cell_iter->GetCellData()->SetItem("dVpdAlpha", sum_sin_angles);
-        }
-        else
+        CellPolaritySrnModel* p_srn_model = static_cast<CellPolaritySrnModel*>(cell_iter->GetSrnModel());
+        assert(p_srn_model != nullptr);
+
+        cell_iter->GetCellData()->SetItem("Polarity Angle", p_srn_model->GetPolarityAngle());
+        cell_iter->GetCellData()->SetItem("dVpdAlpha", p_srn_model->GetdVpdAlpha());
+    }
+}
+
+template<unsigned DIM>
+bool CellPolarityTrackingModifier<DIM>::GetUseImplicitPolarityIntegration()
+{
+    return mUseImplicitPolarityIntegration;
+}
+
+template<unsigned DIM>
+void CellPolarityTrackingModifier<DIM>::SetUseImplicitPolarityIntegration(bool useImplicitPolarityIntegration)
+{
+    mUseImplicitPolarityIntegration = useImplicitPolarityIntegration;
+}
+
+template<unsigned DIM>
+double CellPolarityTrackingModifier<DIM>::GetPolarityOrderParameter()
+{
+    const std::vector<unsigned>& r_neighbour_starts = this->mTrophectodermGraph.rGetNeighbourStarts();
+    const std::vector<unsigned>& r_neighbour_indices = this->mTrophectodermGraph.rGetNeighbourIndices();
+
+    // Each pair is stored once in each direction, which does not change the mean
+    double local_sums[2] = {0.0, 0.0};
+    for (unsigned a=0; a<mTrophectodermAngles.size(); a++)
+    {
+        for (unsigned k=r_neighbour_starts[a]; k<r_neighbour_starts[a+1]; k++)
         {
-            // For non-trophectoderm cells we just set the polarity potential to zero - we don't care what happens to their polarity angle so we just let it evolve via random noise
-            cell_iter->GetCellData()->SetItem("dVpdAlpha",0.0);
+            local_sums[0] += cos(mTrophectodermAngles[a] - mTrophectodermAngles[r_neighbour_indices[k]]);
+            local_sums[1] += 1.0;
         }
     }
+
+    double sums[2] = {local_sums[0], local_sums[1]};
+    if (PetscTools::IsParallel())
+    {
+        MPI_Allreduce(local_sums, sums, 2, MPI_DOUBLE, MPI_SUM, PETSC_COMM_WORLD);
+    }
+    return (sums[1] > 0.0) ? sums[0]/sums[1] : 0.0;
+}
+
+template<unsigned DIM>
+void CellPolarityTrackingModifier<DIM>::SetOutputMultiRateDiagnostics(bool outputMultiRateDiagnostics)
+{
+    mOutputMultiRateDiagnostics = outputMultiRateDiagnostics;
 }
 
 template<unsigned DIM>
 void CellPolarityTrackingModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
 {
-    // No parameters to output, so just call method on direct parent class
-    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+    *rParamsFile << "\t\t\t<UseImplicitPolarityIntegration>" << mUseImplicitPolarityIntegration << "</UseImplicitPolarityIntegration>\n";
+
+    // Next, call method on direct parent class
+    AbstractCellPolarityTrackingModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
 }
 
 // Explicit instantiation
@@ -5,15 +5,25 @@
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
 
-#include "AbstractCellBasedSimulationModifier.hpp"
+#include "AbstractCellPolarityTrackingModifier.hpp"
+#include "SparseSymmetricMatrix.hpp"
+
+class CellPolaritySrnModel;
 
 /**
  * A modifier class in which the sum of the sin of polarity angles in neighbouring cells
- * are computed and stored in CellData. To be used in conjunction with polarity cell cycle
- * models.
+ * are computed and passed to each cell's CellPolaritySrnModel. To be used in conjunction
+ * with polarity cell cycle models.
+ *
+ * The values are set through the typed accessors of CellPolaritySrnModel. The polarity updates
+ * and the refreshes of the string-keyed CellData items "Polarity Angle" and "dVpdAlpha" are
+ * scheduled by AbstractCellPolarityTrackingModifier.
+ *
+ * In a distributed run, the angles of trophectoderm halo nodes are read from the NissenHaloStateMirror,
+ * so each cell is driven by the same neighbours as in a sequential run.
  */
 template<unsigned DIM>
-class CellPolarityTrackingModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+class CellPolarityTrackingModifier : public AbstractCellPolarityTrackingModifier<DIM>
 {
     /** Needed for serialization. */
     friend class boost::serialization::access;
@@ -27,9 +37,61 @@ class CellPolarityTrackingModifier : public AbstractCellBasedSimulationModifier<
     template<class Archive>
     void serialize(Archive & archive, const unsigned int version)
     {
-        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & boost::serialization::base_object<AbstractCellPolarityTrackingModifier<DIM> >(*this);
+        archive & mUseImplicitPolarityIntegration;
+        archive & mOutputMultiRateDiagnostics;
     }
 
+    /**
+     * Whether to advance the coupled trophectoderm polarity angles with a linearly implicit
+     * step rather than with neighbour angles frozen at the start of the step. Defaults to false.
+     */
+    bool mUseImplicitPolarityIntegration;
+
+    /**
+     * Whether to write polaritymultirate.dat, comparing each polarity update with the
+     * equivalent noise-free lock-step update. Defaults to false.
+     */
+    bool mOutputMultiRateDiagnostics;
+
+    /** Output file for the multi-rate diagnostics. */
+    out_stream mpMultiRateDiagnosticsFile;
+
+    /** SRN models of the trophectoderm cells, rebuilt in each call to UpdateCellData(). */
+    std::vector<CellPolaritySrnModel*> mTrophectodermSrnModels;
+
+    /** Polarity angles of the trophectoderm cells, in the same order as mTrophectodermSrnModels. */
+    std::vector<double> mTrophectodermAngles;
+
+    /** SRN models of all other cells, rebuilt in each call to UpdateCellData(). */
+    std::vector<CellPolaritySrnModel*> mOtherSrnModels;
+
+    /**
+     * Overridden IsPolarityUpdateUnconditionallyStable() method.
+     *
+     * @return mUseImplicitPolarityIntegration, as the implicit update is limited only by mMaxPolarityUpdateInterval
+     */
+    bool IsPolarityUpdateUnconditionallyStable();
+
+    /**
+     * Overridden SynchroniseSrnModels() method.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void SynchroniseSrnModels(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Write a line of polaritymultirate.dat, comparing the noise-free angles reached by a single
+     * polarity update over mPolarityUpdateInterval time steps with those reached by recomputing
+     * the drive at every time step (as the lock-step scheme would).
+     *
+     * @param rDrive the drive passed to the SRN models for this update
+     */
+    void WriteMultiRateDiagnostics(const std::vector<double>& rDrive);
+
+    /** The matrix of the implicit polarity step, kept to reuse its storage. */
+    SparseSymmetricMatrix mPolarityMatrix;
+
 public:
 
     /**
@@ -43,35 +105,75 @@ public:
     virtual ~CellPolarityTrackingModifier();
 
     /**
-     * Overridden UpdateAtEndOfTimeStep() method.
+     * Overridden SetupSolve() method.
      *
-     * Specifies what to do in the simulation at the end of each time step.
+     * Opens polaritymultirate.dat, if requested, before the first polarity update.
      *
      * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
      */
-    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
 
     /**
-     * Overridden SetupSolve() method.
+     * Overridden UpdateAtEndOfSolve() method.
      *
-     * Specifies what to do in the simulation before the start of the time loop.
+     * Brings every SRN model up to the current time, refreshes the CellData items and closes
+     * polaritymultirate.dat.
      *
      * @param rCellPopulation reference to the cell population
-     * @param outputDirectory the output directory, relative to where Chaste output is stored
      */
-    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
 
     /**
-     * Helper method to compute the sum of the sin of polarity angles in each cell's neighbours and store these in the CellData.
+     * Overridden UpdateCellData() method.
      *
-     * Note: If using a CaBasedCellPopulation, we assume a Moore neighbourhood and unit carrying capacity.
-     * If a cell has no neighbours (such as an isolated cell in a CaBasedCellPopulation), we store the
-     * value -1 in the CellData.
+     * Computes the sum of the sin of polarity angles in each cell's neighbours and passes these
+     * to each cell's SRN model, together with the number of time steps until the following update.
      *
      * @param rCellPopulation reference to the cell population
      */
     void UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
 
+    /**
+     * Overridden WriteCellData() method.
+     *
+     * Copies each cell's polarity angle and dVpdAlpha from its SRN model into the string-keyed
+     * CellData items "Polarity Angle" and "dVpdAlpha", for writers and other code that reads CellData.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void WriteCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * @return mUseImplicitPolarityIntegration
+     */
+    bool GetUseImplicitPolarityIntegration();
+
+    /**
+     * Set mUseImplicitPolarityIntegration.
+     *
+     * The polarity coupling is a gradient flow, so with the explicit update the stable time step
+     * shrinks as cells gain neighbours. The implicit update remains stable for much larger steps.
+     *
+     * @param useImplicitPolarityIntegration whether to use the implicit polarity update
+     */
+    void SetUseImplicitPolarityIntegration(bool useImplicitPolarityIntegration);
+
+    /**
+     * @return the polarity order parameter of the trophectoderm: the mean of cos(alpha_A - alpha_B) over the
+     * coupled pairs of trophectoderm cells, using the angles at the last polarity update, or zero if there
+     * are no such pairs. This is 1 when neighbouring polarities are aligned. In a distributed run the mean is
+     * taken over the pairs of cells owned by the same process, on all processes, so every process must call this.
+     */
+    double GetPolarityOrderParameter();
+
+    /**
+     * Set mOutputMultiRateDiagnostics.
+     *
+     * @param outputMultiRateDiagnostics whether to write polaritymultirate.dat
+     */
+    void SetOutputMultiRateDiagnostics(bool outputMultiRateDiagnostics);
+
     /**
      * Overridden OutputSimulationModifierParameters() method.
      * Output any simulation modifier parameters to file.
@@ -0,0 +1,145 @@
+
+#include "CellPolarityVectorTrackingModifier.hpp"
+#include "CellPolarityVectorSrnModel.hpp"
+#include "TrophectodermCellProliferativeType.hpp"
+#include "NissenHaloStateMirror.hpp"
+
+template<unsigned DIM>
+CellPolarityVectorTrackingModifier<DIM>::CellPolarityVectorTrackingModifier()
+    : AbstractCellPolarityTrackingModifier<DIM>()
+{
+}
+
+template<unsigned DIM>
+CellPolarityVectorTrackingModifier<DIM>::~CellPolarityVectorTrackingModifier()
+{
+}
+
+template<unsigned DIM>
+void CellPolarityVectorTrackingModifier<DIM>::SynchroniseSrnModels(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        static_cast<CellPolarityVectorSrnModel*>(cell_iter->GetSrnModel())->SynchroniseToCurrentTime();
+    }
+}
+
+template<unsigned DIM>
+void CellPolarityVectorTrackingModifier<DIM>::UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    mTrophectodermSrnModels.clear();
+    mTrophectodermPolarities.clear();
+    mOtherSrnModels.clear();
+    std::vector<unsigned> location_indices;
+    std::vector<unsigned> other_location_indices;
+
+    std::vector<CellPtr> cells;
+    std::vector<unsigned> halo_location_indices;
+    this->GetCellsInSpatialOrder(rCellPopulation, cells, halo_location_indices);
+
+    // In a distributed run, trophectoderm halo nodes add their mirrored polarities to the drive
+    std::vector<c_vector<double, DIM> > halo_polarities;
+    for (unsigned h=0; h<halo_location_indices.size(); h++)
+    {
+        halo_polarities.push_back(NissenHaloStateMirror<DIM>::Instance()->rGetHaloNodeState(halo_location_indices[h]).mPolarity);
+    }
+
+    for (unsigned i=0; i<cells.size(); i++)
+    {
+        CellPolarityVectorSrnModel* p_srn_model = static_cast<CellPolarityVectorSrnModel*>(cells[i]->GetSrnModel());
+
+        // NOTE: Here we assert that the cell does actually have the right SRN model
+        assert(p_srn_model != nullptr);
+        p_srn_model->SetNumDimensions(DIM);
+
+        if (cells[i]->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>())
+        {
+            const std::vector<double>& r_polarity = p_srn_model->rGetPolarityVector();
+            mTrophectodermSrnModels.push_back(p_srn_model);
+            mTrophectodermPolarities.insert(mTrophectodermPolarities.end(), r_polarity.begin(), r_polarity.begin() + 3);
+            location_indices.push_back(rCellPopulation.GetLocationIndexUsingCell(cells[i]));
+        }
+        else
+        {
+            p_srn_model->SetPolarityDrive(0.0, 0.0, 0.0);
+            mOtherSrnModels.push_back(p_srn_model);
+            other_location_indices.push_back(rCellPopulation.GetLocationIndexUsingCell(cells[i]));
+        }
+    }
+
+    unsigned num_te_cells = mTrophectodermSrnModels.size();
+    this->mTrophectodermGraph.Build(rCellPopulation, location_indices, this->mCouplingRadius, halo_location_indices);
+    const std::vector<unsigned>& r_neighbour_starts = this->mTrophectodermGraph.rGetNeighbourStarts();
+    const std::vector<unsigned>& r_neighbour_indices = this->mTrophectodermGraph.rGetNeighbourIndices();
+    const std::vector<unsigned>& r_halo_neighbour_starts = this->mTrophectodermGraph.rGetHaloNeighbourStarts();
+    const std::vector<unsigned>& r_halo_neighbour_indices = this->mTrophectodermGraph.rGetHaloNeighbourIndices();
+
+    // The drive on each cell is the sum of the polarity vectors of its trophectoderm neighbours
+    std::vector<double> drive(3*num_te_cells, 0.0);
+    for (unsigned a=0; a<num_te_cells; a++)
+    {
+        for (unsigned k=r_neighbour_starts[a]; k<r_neighbour_starts[a+1]; k++)
+        {
+            const double* p_polarity_b = &mTrophectodermPolarities[3*r_neighbour_indices[k]];
+            drive[3*a] += p_polarity_b[0];
+            drive[3*a+1] += p_polarity_b[1];
+            drive[3*a+2] += p_polarity_b[2];
+        }
+        for (unsigned k=r_halo_neighbour_starts[a]; k<r_halo_neighbour_starts[a+1]; k++)
+        {
+            const c_vector<double, DIM>& r_halo_polarity = halo_polarities[r_halo_neighbour_indices[k]];
+            for (unsigned i=0; i<DIM; i++)
+            {
+                drive[3*a+i] += r_halo_polarity(i);
+            }
+        }
+    }
+
+    // This drive covers the interval ending now; choose the length of the following one
+    this->ScheduleNextPolarityUpdate();
+
+    for (unsigned a=0; a<num_te_cells; a++)
+    {
+        mTrophectodermSrnModels[a]->SetPolarityDrive(drive[3*a], drive[3*a+1], drive[3*a+2]);
+        mTrophectodermSrnModels[a]->SetUpdateInterval(this->GetSrnUpdateInterval(location_indices[a]));
+    }
+    for (unsigned i=0; i<mOtherSrnModels.size(); i++)
+    {
+        mOtherSrnModels[i]->SetUpdateInterval(this->GetSrnUpdateInterval(other_location_indices[i]));
+    }
+}
+
+template<unsigned DIM>
+void CellPolarityVectorTrackingModifier<DIM>::WriteCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        CellPolarityVectorSrnModel* p_srn_model = static_cast<CellPolarityVectorSrnModel*>(cell_iter->GetSrnModel());
+        assert(p_srn_model != nullptr);
+
+        const std::vector<double>& r_polarity = p_srn_model->rGetPolarityVector();
+        cell_iter->GetCellData()->SetItem("Polarity X", r_polarity[0]);
+        cell_iter->GetCellData()->SetItem("Polarity Y", r_polarity[1]);
+        cell_iter->GetCellData()->SetItem("Polarity Z", r_polarity[2]);
+    }
+}
+
+template<unsigned DIM>
+void CellPolarityVectorTrackingModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    // No parameters to output, so just call method on direct parent class
+    AbstractCellPolarityTrackingModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class CellPolarityVectorTrackingModifier<1>;
+template class CellPolarityVectorTrackingModifier<2>;
+template class CellPolarityVectorTrackingModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(CellPolarityVectorTrackingModifier)
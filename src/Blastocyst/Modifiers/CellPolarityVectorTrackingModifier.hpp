@@ -0,0 +1,103 @@
+
+#ifndef CELLPOLARITYVECTORTRACKINGMODIFIER_HPP_
+#define CELLPOLARITYVECTORTRACKINGMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "AbstractCellPolarityTrackingModifier.hpp"
+
+class CellPolarityVectorSrnModel;
+
+/**
+ * The counterpart of CellPolarityTrackingModifier for cells carrying a CellPolarityVectorSrnModel, for use
+ * in 3D. The drive on each trophectoderm cell is the sum of the polarity vectors of the trophectoderm cells
+ * within mCouplingRadius, which is passed to the cell's SRN model; other cells evolve by noise alone.
+ *
+ * The polarity vectors are gathered into a flat array, three components per cell, in the spatial order kept
+ * by NissenPairGeometryCache, and the drive is a sum over the compressed rows of a CellCouplingGraph, so no
+ * trigonometry is needed. In a distributed run, the polarities of trophectoderm halo nodes are read from the
+ * NissenHaloStateMirror.
+ *
+ * The polarity updates and the refreshes of the CellData items "Polarity X", "Polarity Y" and "Polarity Z"
+ * are scheduled by AbstractCellPolarityTrackingModifier.
+ */
+template<unsigned DIM>
+class CellPolarityVectorTrackingModifier : public AbstractCellPolarityTrackingModifier<DIM>
+{
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellPolarityTrackingModifier<DIM> >(*this);
+    }
+
+    /** SRN models of the trophectoderm cells, rebuilt in each call to UpdateCellData(). */
+    std::vector<CellPolarityVectorSrnModel*> mTrophectodermSrnModels;
+
+    /** Polarity vectors of the trophectoderm cells, three components each, in the order of mTrophectodermSrnModels. */
+    std::vector<double> mTrophectodermPolarities;
+
+    /** SRN models of all other cells, rebuilt in each call to UpdateCellData(). */
+    std::vector<CellPolarityVectorSrnModel*> mOtherSrnModels;
+
+    /**
+     * Overridden SynchroniseSrnModels() method.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void SynchroniseSrnModels(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    CellPolarityVectorTrackingModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~CellPolarityVectorTrackingModifier();
+
+    /**
+     * Overridden UpdateCellData() method.
+     *
+     * Computes the sum of the polarity vectors of each trophectoderm cell's neighbours and passes these
+     * to each cell's SRN model, together with the number of time steps until the following update.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden WriteCellData() method.
+     *
+     * Copies each cell's polarity vector from its SRN model into the CellData items "Polarity X",
+     * "Polarity Y" and "Polarity Z".
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void WriteCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(CellPolarityVectorTrackingModifier)
+
+#endif /*CELLPOLARITYVECTORTRACKINGMODIFIER_HPP_*/
@@ -0,0 +1,146 @@
+
+#include "MemoryAccountingModifier.hpp"
+#include "OutputFileHandler.hpp"
+#include "SimulationTime.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+template<unsigned DIM>
+MemoryAccountingModifier<DIM>::MemoryAccountingModifier()
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mReportInterval(100)
+{
+}
+
+template<unsigned DIM>
+MemoryAccountingModifier<DIM>::~MemoryAccountingModifier()
+{
+}
+
+template<unsigned DIM>
+void MemoryAccountingModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (mReportInterval > 0
+        && SimulationTime::Instance()->GetTimeStepsElapsed() % mReportInterval == 0)
+    {
+        Report(rCellPopulation);
+    }
+}
+
+template<unsigned DIM>
+void MemoryAccountingModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    if (mPhaseName.empty())
+    {
+        std::stringstream phase_name;
+        phase_name << "phase_" << mPhaseNames.size();
+        mPhaseNames.push_back(phase_name.str());
+    }
+    else
+    {
+        mPhaseNames.push_back(mPhaseName);
+        mPhaseName.clear();
+    }
+    mPhasePeakBytes.push_back(0.0);
+    mPhasePeakBytesPerCell.push_back(0.0);
+
+    mOutputDirectory = outputDirectory;
+    OutputFileHandler output_file_handler(outputDirectory + "/", false);
+    mpMemoryFile = output_file_handler.OpenOutputFile("memory.dat");
+    *mpMemoryFile << "# time\tnum_cells";
+    for (unsigned component=0; component<CellMemoryReport<DIM>::NUM_COMPONENTS; component++)
+    {
+        *mpMemoryFile << "\t" << CellMemoryReport<DIM>::GetComponentName(component);
+    }
+    *mpMemoryFile << "\tbytes_per_cell\ttotal_bytes\n";
+
+    Report(rCellPopulation);
+}
+
+template<unsigned DIM>
+void MemoryAccountingModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    Report(rCellPopulation);
+    mpMemoryFile->close();
+
+    OutputFileHandler output_file_handler(mOutputDirectory + "/", false);
+    out_stream p_peaks_file = output_file_handler.OpenOutputFile("memorypeaks.dat");
+    *p_peaks_file << "# phase\tpeak_total_bytes\tpeak_bytes_per_cell\n";
+    for (unsigned phase=0; phase<mPhaseNames.size(); phase++)
+    {
+        *p_peaks_file << mPhaseNames[phase] << "\t" << mPhasePeakBytes[phase] << "\t" << mPhasePeakBytesPerCell[phase] << "\n";
+    }
+    p_peaks_file->close();
+}
+
+template<unsigned DIM>
+void MemoryAccountingModifier<DIM>::Report(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    mReport.Compute(rCellPopulation);
+
+    *mpMemoryFile << SimulationTime::Instance()->GetTime() << "\t" << mReport.GetNumCells();
+    for (unsigned component=0; component<CellMemoryReport<DIM>::NUM_COMPONENTS; component++)
+    {
+        *mpMemoryFile << "\t" << mReport.GetBytesPerCell(component);
+    }
+    *mpMemoryFile << "\t" << mReport.GetTotalBytesPerCell() << "\t" << mReport.GetTotalBytes() << "\n";
+
+    mPhasePeakBytes.back() = std::max(mPhasePeakBytes.back(), static_cast<double>(mReport.GetTotalBytes()));
+    mPhasePeakBytesPerCell.back() = std::max(mPhasePeakBytesPerCell.back(), mReport.GetTotalBytesPerCell());
+}
+
+template<unsigned DIM>
+const CellMemoryReport<DIM>& MemoryAccountingModifier<DIM>::rGetReport() const
+{
+    return mReport;
+}
+
+template<unsigned DIM>
+unsigned MemoryAccountingModifier<DIM>::GetReportInterval()
+{
+    return mReportInterval;
+}
+
+template<unsigned DIM>
+void MemoryAccountingModifier<DIM>::SetReportInterval(unsigned reportInterval)
+{
+    mReportInterval = reportInterval;
+}
+
+template<unsigned DIM>
+void MemoryAccountingModifier<DIM>::SetPhaseName(const std::string& phaseName)
+{
+    mPhaseName = phaseName;
+}
+
+template<unsigned DIM>
+double MemoryAccountingModifier<DIM>::GetPhasePeakBytes(unsigned phase)
+{
+    assert(phase < mPhasePeakBytes.size());
+    return mPhasePeakBytes[phase];
+}
+
+template<unsigned DIM>
+unsigned MemoryAccountingModifier<DIM>::GetNumPhases()
+{
+    return mPhaseNames.size();
+}
+
+template<unsigned DIM>
+void MemoryAccountingModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<ReportInterval>" << mReportInterval << "</ReportInterval>\n";
+
+    // Next, call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class MemoryAccountingModifier<1>;
+template class MemoryAccountingModifier<2>;
+template class MemoryAccountingModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(MemoryAccountingModifier)
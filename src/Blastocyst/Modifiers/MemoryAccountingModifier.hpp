@@ -0,0 +1,165 @@
+
+#ifndef MEMORYACCOUNTINGMODIFIER_HPP_
+#define MEMORYACCOUNTINGMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "CellMemoryReport.hpp"
+
+/**
+ * A modifier which records the estimated memory used per cell, broken down by component (see
+ * CellMemoryReport), and the peak memory of each simulation phase.
+ *
+ * Each call to Solve() is treated as a phase, named by SetPhaseName() or otherwise numbered. Every
+ * mReportInterval time steps, and at the start and end of each phase, a line is written to memory.dat in
+ * the phase's output directory giving the number of cells, the bytes per cell of each component and the
+ * total. At the end of each phase, the peak total memory and bytes per cell of every phase so far are
+ * written to memorypeaks.dat.
+ */
+template<unsigned DIM>
+class MemoryAccountingModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mReportInterval;
+        archive & mPhaseName;
+        archive & mPhaseNames;
+        archive & mPhasePeakBytes;
+        archive & mPhasePeakBytesPerCell;
+    }
+
+    /** Number of time steps between reports. Defaults to 100. */
+    unsigned mReportInterval;
+
+    /** The name to give the next phase, or empty to number it. */
+    std::string mPhaseName;
+
+    /** The names of the phases so far. */
+    std::vector<std::string> mPhaseNames;
+
+    /** The peak total memory of each phase so far, in bytes. */
+    std::vector<double> mPhasePeakBytes;
+
+    /** The peak memory per cell of each phase so far, in bytes. */
+    std::vector<double> mPhasePeakBytesPerCell;
+
+    /** The most recent report. */
+    CellMemoryReport<DIM> mReport;
+
+    /** Output file for the reports of the current phase. */
+    out_stream mpMemoryFile;
+
+    /** The output directory of the current phase. */
+    std::string mOutputDirectory;
+
+    /**
+     * Compute a report, write it to mpMemoryFile and update the peaks of the current phase.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void Report(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    MemoryAccountingModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~MemoryAccountingModifier();
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Reports every mReportInterval time steps.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Starts a new phase and reports.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method.
+     *
+     * Reports, then writes the peaks of every phase so far.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * @return the most recent report.
+     */
+    const CellMemoryReport<DIM>& rGetReport() const;
+
+    /**
+     * @return mReportInterval
+     */
+    unsigned GetReportInterval();
+
+    /**
+     * Set mReportInterval.
+     *
+     * @param reportInterval the number of time steps between reports
+     */
+    void SetReportInterval(unsigned reportInterval);
+
+    /**
+     * Set the name of the next phase, i.e. the next call to Solve().
+     *
+     * @param phaseName the name, which should not contain whitespace
+     */
+    void SetPhaseName(const std::string& phaseName);
+
+    /**
+     * @return the peak total memory of a phase, in bytes.
+     *
+     * @param phase the index of the phase
+     */
+    double GetPhasePeakBytes(unsigned phase);
+
+    /**
+     * @return the number of phases so far.
+     */
+    unsigned GetNumPhases();
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(MemoryAccountingModifier)
+
+#endif /*MEMORYACCOUNTINGMODIFIER_HPP_*/
@@ -0,0 +1,276 @@
+
+#include "SteadyStateDetectionModifier.hpp"
+#include "StemCellProliferativeType.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "DefaultCellProliferativeType.hpp"
+#include "TrophectodermCellProliferativeType.hpp"
+#include "EpiblastCellProliferativeType.hpp"
+#include "PrECellProliferativeType.hpp"
+#include "OutputFileHandler.hpp"
+#include "PetscTools.hpp"
+#include "SimulationTime.hpp"
+
+#include <algorithm>
+
+/** The number of proliferative types counted. */
+static const unsigned NUM_LINEAGES = 7;
+
+template<unsigned DIM>
+SteadyStateDetectionModifier<DIM>::SteadyStateDetectionModifier()
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mWindowLength(200),
+      mDisplacementThreshold(1e-4),
+      mOrderParameterThreshold(1e-3),
+      mLineageCountThreshold(0),
+      mHasReachedSteadyState(false),
+      mSteadyStateTime(-1.0)
+{
+}
+
+template<unsigned DIM>
+SteadyStateDetectionModifier<DIM>::~SteadyStateDetectionModifier()
+{
+}
+
+template<unsigned DIM>
+double SteadyStateDetectionModifier<DIM>::CalculateMeanDisplacement(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    std::map<unsigned, c_vector<double, DIM> > locations;
+    double local_sums[2] = {0.0, 0.0};
+    for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = rCellPopulation.rGetMesh().GetNodeIteratorBegin();
+         node_iter != rCellPopulation.rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        unsigned index = node_iter->GetIndex();
+        const c_vector<double, DIM>& r_location = node_iter->rGetLocation();
+        typename std::map<unsigned, c_vector<double, DIM> >::iterator previous = mPreviousLocations.find(index);
+        if (previous != mPreviousLocations.end())
+        {
+            local_sums[0] += norm_2(rCellPopulation.rGetMesh().GetVectorFromAtoB(previous->second, r_location));
+            local_sums[1] += 1.0;
+        }
+        locations[index] = r_location;
+    }
+    mPreviousLocations.swap(locations);
+
+    double sums[2] = {local_sums[0], local_sums[1]};
+    if (PetscTools::IsParallel())
+    {
+        MPI_Allreduce(local_sums, sums, 2, MPI_DOUBLE, MPI_SUM, PETSC_COMM_WORLD);
+    }
+    return (sums[1] > 0.0) ? sums[0]/sums[1] : 0.0;
+}
+
+template<unsigned DIM>
+std::vector<unsigned> SteadyStateDetectionModifier<DIM>::CountLineages(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    std::vector<unsigned> local_counts(NUM_LINEAGES, 0);
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        boost::shared_ptr<AbstractCellProperty> p_type = cell_iter->GetCellProliferativeType();
+        if (p_type->template IsType<StemCellProliferativeType>())
+        {
+            local_counts[0]++;
+        }
+        else if (p_type->template IsType<TransitCellProliferativeType>())
+        {
+            local_counts[1]++;
+        }
+        else if (p_type->template IsType<DifferentiatedCellProliferativeType>())
+        {
+            local_counts[2]++;
+        }
+        else if (p_type->template IsType<DefaultCellProliferativeType>())
+        {
+            local_counts[3]++;
+        }
+        else if (p_type->template IsType<TrophectodermCellProliferativeType>())
+        {
+            local_counts[4]++;
+        }
+        else if (p_type->template IsType<EpiblastCellProliferativeType>())
+        {
+            local_counts[5]++;
+        }
+        else if (p_type->template IsType<PrECellProliferativeType>())
+        {
+            local_counts[6]++;
+        }
+    }
+
+    std::vector<unsigned> counts = local_counts;
+    if (PetscTools::IsParallel())
+    {
+        MPI_Allreduce(&local_counts[0], &counts[0], NUM_LINEAGES, MPI_UNSIGNED, MPI_SUM, PETSC_COMM_WORLD);
+    }
+    return counts;
+}
+
+template<unsigned DIM>
+void SteadyStateDetectionModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    mMeanDisplacements.push_back(CalculateMeanDisplacement(rCellPopulation));
+    mOrderParameters.push_back(mpPolarityTrackingModifier ? mpPolarityTrackingModifier->GetPolarityOrderParameter() : 0.0);
+    mLineageCounts.push_back(CountLineages(rCellPopulation));
+    if (mMeanDisplacements.size() > mWindowLength)
+    {
+        mMeanDisplacements.pop_front();
+        mOrderParameters.pop_front();
+        mLineageCounts.pop_front();
+    }
+
+    if (mHasReachedSteadyState || mMeanDisplacements.size() < mWindowLength)
+    {
+        return;
+    }
+
+    double max_mean_displacement = *std::max_element(mMeanDisplacements.begin(), mMeanDisplacements.end());
+    double order_parameter_range = *std::max_element(mOrderParameters.begin(), mOrderParameters.end())
+                                   - *std::min_element(mOrderParameters.begin(), mOrderParameters.end());
+    unsigned max_count_change = 0;
+    for (unsigned lineage=0; lineage<NUM_LINEAGES; lineage++)
+    {
+        unsigned min_count = mLineageCounts.front()[lineage];
+        unsigned max_count = min_count;
+        for (unsigned k=1; k<mLineageCounts.size(); k++)
+        {
+            min_count = std::min(min_count, mLineageCounts[k][lineage]);
+            max_count = std::max(max_count, mLineageCounts[k][lineage]);
+        }
+        max_count_change = std::max(max_count_change, max_count - min_count);
+    }
+
+    if (max_mean_displacement < mDisplacementThreshold
+        && order_parameter_range < mOrderParameterThreshold
+        && max_count_change <= mLineageCountThreshold)
+    {
+        mHasReachedSteadyState = true;
+        mSteadyStateTime = SimulationTime::Instance()->GetTime();
+        if (PetscTools::AmMaster())
+        {
+            *mpSteadyStateFile << mSteadyStateTime << "\t" << max_mean_displacement << "\t" << order_parameter_range
+                               << "\t" << max_count_change << "\n";
+        }
+    }
+}
+
+template<unsigned DIM>
+void SteadyStateDetectionModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    mMeanDisplacements.clear();
+    mOrderParameters.clear();
+    mLineageCounts.clear();
+    mHasReachedSteadyState = false;
+    mSteadyStateTime = -1.0;
+
+    // Record the starting locations
+    mPreviousLocations.clear();
+    CalculateMeanDisplacement(rCellPopulation);
+
+    if (PetscTools::AmMaster())
+    {
+        OutputFileHandler output_file_handler(outputDirectory + "/", false);
+        mpSteadyStateFile = output_file_handler.OpenOutputFile("steadystate.dat");
+        *mpSteadyStateFile << "# time\tmax_mean_displacement\torder_parameter_range\tmax_lineage_count_change\n";
+    }
+}
+
+template<unsigned DIM>
+void SteadyStateDetectionModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (mpSteadyStateFile)
+    {
+        mpSteadyStateFile->close();
+    }
+}
+
+template<unsigned DIM>
+bool SteadyStateDetectionModifier<DIM>::HasReachedSteadyState()
+{
+    return mHasReachedSteadyState;
+}
+
+template<unsigned DIM>
+double SteadyStateDetectionModifier<DIM>::GetSteadyStateTime()
+{
+    return mSteadyStateTime;
+}
+
+template<unsigned DIM>
+void SteadyStateDetectionModifier<DIM>::SetPolarityTrackingModifier(boost::shared_ptr<CellPolarityTrackingModifier<DIM> > pPolarityTrackingModifier)
+{
+    mpPolarityTrackingModifier = pPolarityTrackingModifier;
+}
+
+template<unsigned DIM>
+unsigned SteadyStateDetectionModifier<DIM>::GetWindowLength()
+{
+    return mWindowLength;
+}
+
+template<unsigned DIM>
+void SteadyStateDetectionModifier<DIM>::SetWindowLength(unsigned windowLength)
+{
+    assert(windowLength > 0);
+    mWindowLength = windowLength;
+}
+
+template<unsigned DIM>
+double SteadyStateDetectionModifier<DIM>::GetDisplacementThreshold()
+{
+    return mDisplacementThreshold;
+}
+
+template<unsigned DIM>
+void SteadyStateDetectionModifier<DIM>::SetDisplacementThreshold(double displacementThreshold)
+{
+    mDisplacementThreshold = displacementThreshold;
+}
+
+template<unsigned DIM>
+double SteadyStateDetectionModifier<DIM>::GetOrderParameterThreshold()
+{
+    return mOrderParameterThreshold;
+}
+
+template<unsigned DIM>
+void SteadyStateDetectionModifier<DIM>::SetOrderParameterThreshold(double orderParameterThreshold)
+{
+    mOrderParameterThreshold = orderParameterThreshold;
+}
+
+template<unsigned DIM>
+unsigned SteadyStateDetectionModifier<DIM>::GetLineageCountThreshold()
+{
+    return mLineageCountThreshold;
+}
+
+template<unsigned DIM>
+void SteadyStateDetectionModifier<DIM>::SetLineageCountThreshold(unsigned lineageCountThreshold)
+{
+    mLineageCountThreshold = lineageCountThreshold;
+}
+
+template<unsigned DIM>
+void SteadyStateDetectionModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<WindowLength>" << mWindowLength << "</WindowLength>\n";
+    *rParamsFile << "\t\t\t<DisplacementThreshold>" << mDisplacementThreshold << "</DisplacementThreshold>\n";
+    *rParamsFile << "\t\t\t<OrderParameterThreshold>" << mOrderParameterThreshold << "</OrderParameterThreshold>\n";
+    *rParamsFile << "\t\t\t<LineageCountThreshold>" << mLineageCountThreshold << "</LineageCountThreshold>\n";
+
+    // Next, call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class SteadyStateDetectionModifier<1>;
+template class SteadyStateDetectionModifier<2>;
+template class SteadyStateDetectionModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(SteadyStateDetectionModifier)
@@ -0,0 +1,216 @@
+
+#ifndef STEADYSTATEDETECTIONMODIFIER_HPP_
+#define STEADYSTATEDETECTIONMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "CellPolarityTrackingModifier.hpp"
+
+/**
+ * A modifier which detects when the embryo has stopped changing, so that NissenOffLatticeSimulation can end
+ * a phase before its end time.
+ *
+ * At the end of each time step three convergence metrics are sampled: the mean distance moved by the nodes
+ * over the step, the trophectoderm polarity order parameter of a CellPolarityTrackingModifier (if one has been
+ * given with SetPolarityTrackingModifier()) and the number of cells of each proliferative type. Steady state
+ * is reached once mWindowLength samples have been taken and, over the last mWindowLength of them, the mean
+ * displacement per step has stayed below mDisplacementThreshold, the order parameter has varied by less than
+ * mOrderParameterThreshold, and no lineage count has changed by more than mLineageCountThreshold. The time at
+ * which this happens, and the metrics over the window, are written to steadystate.dat in the output directory,
+ * and NissenOffLatticeSimulation then stops Solve() (see HasReachedSteadyState()).
+ *
+ * The lineage counts are those of CellProliferativeTypesCountWriter (stem, transit, differentiated and default)
+ * together with trophectoderm, epiblast and primitive endoderm, which that writer does not count. Each call to
+ * Solve() starts a fresh window. In a distributed run the metrics are taken over all processes, so every
+ * process stops at the same time step.
+ */
+template<unsigned DIM>
+class SteadyStateDetectionModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mWindowLength;
+        archive & mDisplacementThreshold;
+        archive & mOrderParameterThreshold;
+        archive & mLineageCountThreshold;
+    }
+
+    /** The number of time steps over which the metrics must stay below their thresholds. Defaults to 200. */
+    unsigned mWindowLength;
+
+    /** The mean displacement per time step, in cell diameters, below which the cells are taken to be still. Defaults to 1e-4. */
+    double mDisplacementThreshold;
+
+    /** The largest variation of the polarity order parameter over the window. Defaults to 1e-3. */
+    double mOrderParameterThreshold;
+
+    /** The largest change in the number of cells of any proliferative type over the window. Defaults to 0. */
+    unsigned mLineageCountThreshold;
+
+    /** The modifier whose polarity order parameter is tracked, if any. Set by the user, so not archived. */
+    boost::shared_ptr<CellPolarityTrackingModifier<DIM> > mpPolarityTrackingModifier;
+
+    /** Node locations at the end of the previous time step, indexed by node global index. */
+    std::map<unsigned, c_vector<double, DIM> > mPreviousLocations;
+
+    /** The mean displacements per step over the current window. */
+    std::deque<double> mMeanDisplacements;
+
+    /** The polarity order parameters over the current window. */
+    std::deque<double> mOrderParameters;
+
+    /** The lineage counts over the current window. */
+    std::deque<std::vector<unsigned> > mLineageCounts;
+
+    /** Whether steady state has been reached in the current call to Solve(). */
+    bool mHasReachedSteadyState;
+
+    /** The time at which steady state was reached, or -1 if it has not been. */
+    double mSteadyStateTime;
+
+    /** Output file for the time at which steady state is reached. */
+    out_stream mpSteadyStateFile;
+
+    /**
+     * @return the mean distance moved by the nodes since mPreviousLocations was recorded, over nodes present
+     * at both times and all processes, and record the current locations.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    double CalculateMeanDisplacement(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * @return the number of cells of each proliferative type, summed over all processes.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    std::vector<unsigned> CountLineages(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    SteadyStateDetectionModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~SteadyStateDetectionModifier();
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Samples the metrics and checks whether steady state has been reached.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Starts a fresh window and opens steadystate.dat.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method.
+     *
+     * Closes steadystate.dat.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * @return whether steady state has been reached in the current call to Solve().
+     */
+    bool HasReachedSteadyState();
+
+    /**
+     * @return the time at which steady state was reached in the last call to Solve(), or -1 if it was not.
+     */
+    double GetSteadyStateTime();
+
+    /**
+     * Set the modifier whose polarity order parameter is tracked.
+     *
+     * @param pPolarityTrackingModifier the CellPolarityTrackingModifier of the simulation
+     */
+    void SetPolarityTrackingModifier(boost::shared_ptr<CellPolarityTrackingModifier<DIM> > pPolarityTrackingModifier);
+
+    /** @return mWindowLength */
+    unsigned GetWindowLength();
+
+    /**
+     * Set mWindowLength.
+     *
+     * @param windowLength the number of time steps over which the metrics must stay below their thresholds
+     */
+    void SetWindowLength(unsigned windowLength);
+
+    /** @return mDisplacementThreshold */
+    double GetDisplacementThreshold();
+
+    /**
+     * Set mDisplacementThreshold.
+     *
+     * @param displacementThreshold the mean displacement per time step below which the cells are taken to be still
+     */
+    void SetDisplacementThreshold(double displacementThreshold);
+
+    /** @return mOrderParameterThreshold */
+    double GetOrderParameterThreshold();
+
+    /**
+     * Set mOrderParameterThreshold.
+     *
+     * @param orderParameterThreshold the largest variation of the polarity order parameter over the window
+     */
+    void SetOrderParameterThreshold(double orderParameterThreshold);
+
+    /** @return mLineageCountThreshold */
+    unsigned GetLineageCountThreshold();
+
+    /**
+     * Set mLineageCountThreshold.
+     *
+     * @param lineageCountThreshold the largest change in the number of cells of any proliferative type over the window
+     */
+    void SetLineageCountThreshold(unsigned lineageCountThreshold);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(SteadyStateDetectionModifier)
+
+#endif /*STEADYSTATEDETECTIONMODIFIER_HPP_*/
@@ -0,0 +1,169 @@
+
+#include "TrophectodermSpecificationModifier.hpp"
+#include "SimulationTime.hpp"
+#include "CellLabel.hpp"
+#include "PolarityCellProperty.hpp"
+#include "TrophectodermCellProliferativeType.hpp"
+#include "CellPolarityVectors.hpp"
+
+template<unsigned DIM>
+TrophectodermSpecificationModifier<DIM>::TrophectodermSpecificationModifier()
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mSpecificationInterval(0),
+      mAlpha(0.8),
+      mTrophectodermTargetArea(1.5),
+      mHasSpecified(false),
+      mDetector(0.8),
+      mNumSpecifiedCells(0)
+{
+}
+
+template<unsigned DIM>
+TrophectodermSpecificationModifier<DIM>::~TrophectodermSpecificationModifier()
+{
+}
+
+template<unsigned DIM>
+void TrophectodermSpecificationModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (mSpecificationInterval > 0
+        && SimulationTime::Instance()->GetTimeStepsElapsed() % mSpecificationInterval == 0)
+    {
+        SpecifyTrophectoderm(rCellPopulation);
+    }
+}
+
+template<unsigned DIM>
+void TrophectodermSpecificationModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    if (!mHasSpecified || mSpecificationInterval > 0)
+    {
+        SpecifyTrophectoderm(rCellPopulation);
+    }
+}
+
+template<unsigned DIM>
+void TrophectodermSpecificationModifier<DIM>::SpecifyTrophectoderm(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    mDetector.SetAlpha(mAlpha);
+    mDetector.Compute(rCellPopulation);
+    mHasSpecified = true;
+
+    if (mDetector.GetNumBoundaryNodes() == 0)
+    {
+        return;
+    }
+
+    /*
+     * The cell population has already called CellPropertyRegistry::TakeOwnership(), so we must
+     * access the cell properties via the existing cell property registry.
+     */
+    CellPropertyRegistry* p_registry = rCellPopulation.Begin()->rGetCellPropertyCollection().GetCellPropertyRegistry();
+    boost::shared_ptr<AbstractCellProperty> p_label = p_registry->Get<CellLabel>();
+    boost::shared_ptr<AbstractCellProperty> p_pol = p_registry->Get<PolarityCellProperty>();
+    boost::shared_ptr<AbstractCellProperty> p_troph = p_registry->Get<TrophectodermCellProliferativeType>();
+
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        unsigned node_index = rCellPopulation.GetLocationIndexUsingCell(*cell_iter);
+        if (!mDetector.IsOnBoundary(node_index)
+            || cell_iter->GetCellProliferativeType()->template IsType<TrophectodermCellProliferativeType>())
+        {
+            continue;
+        }
+
+        cell_iter->AddCellProperty(p_pol);
+        cell_iter->AddCellProperty(p_label);
+        cell_iter->SetCellProliferativeType(p_troph);
+        cell_iter->GetCellData()->SetItem("target area", mTrophectodermTargetArea);
+
+        // The polarity points along the outward normal
+        CellPolarityVectors::SetPolarityVector<DIM>(*cell_iter, mDetector.rGetOutwardNormal(node_index));
+
+        mNewlySpecifiedCells.push_back(*cell_iter);
+        mNumSpecifiedCells++;
+    }
+}
+
+template<unsigned DIM>
+const std::vector<CellPtr>& TrophectodermSpecificationModifier<DIM>::rGetNewlySpecifiedCells() const
+{
+    return mNewlySpecifiedCells;
+}
+
+template<unsigned DIM>
+void TrophectodermSpecificationModifier<DIM>::ClearNewlySpecifiedCells()
+{
+    mNewlySpecifiedCells.clear();
+}
+
+template<unsigned DIM>
+unsigned TrophectodermSpecificationModifier<DIM>::GetNumSpecifiedCells() const
+{
+    return mNumSpecifiedCells;
+}
+
+template<unsigned DIM>
+const TrophectodermBoundaryDetector<DIM>& TrophectodermSpecificationModifier<DIM>::rGetBoundaryDetector() const
+{
+    return mDetector;
+}
+
+template<unsigned DIM>
+unsigned TrophectodermSpecificationModifier<DIM>::GetSpecificationInterval()
+{
+    return mSpecificationInterval;
+}
+
+template<unsigned DIM>
+void TrophectodermSpecificationModifier<DIM>::SetSpecificationInterval(unsigned specificationInterval)
+{
+    mSpecificationInterval = specificationInterval;
+}
+
+template<unsigned DIM>
+double TrophectodermSpecificationModifier<DIM>::GetAlpha()
+{
+    return mAlpha;
+}
+
+template<unsigned DIM>
+void TrophectodermSpecificationModifier<DIM>::SetAlpha(double alpha)
+{
+    assert(alpha > 0.0);
+    mAlpha = alpha;
+}
+
+template<unsigned DIM>
+double TrophectodermSpecificationModifier<DIM>::GetTrophectodermTargetArea()
+{
+    return mTrophectodermTargetArea;
+}
+
+template<unsigned DIM>
+void TrophectodermSpecificationModifier<DIM>::SetTrophectodermTargetArea(double trophectodermTargetArea)
+{
+    mTrophectodermTargetArea = trophectodermTargetArea;
+}
+
+template<unsigned DIM>
+void TrophectodermSpecificationModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<SpecificationInterval>" << mSpecificationInterval << "</SpecificationInterval>\n";
+    *rParamsFile << "\t\t\t<Alpha>" << mAlpha << "</Alpha>\n";
+    *rParamsFile << "\t\t\t<TrophectodermTargetArea>" << mTrophectodermTargetArea << "</TrophectodermTargetArea>\n";
+
+    // Next, call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class TrophectodermSpecificationModifier<1>;
+template class TrophectodermSpecificationModifier<2>;
+template class TrophectodermSpecificationModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(TrophectodermSpecificationModifier)
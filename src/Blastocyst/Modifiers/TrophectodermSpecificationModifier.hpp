@@ -0,0 +1,174 @@
+
+#ifndef TROPHECTODERMSPECIFICATIONMODIFIER_HPP_
+#define TROPHECTODERMSPECIFICATIONMODIFIER_HPP_
+
+#include <vector>
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "TrophectodermBoundaryDetector.hpp"
+
+/**
+ * A modifier which specifies the outer cells of the embryo as trophectoderm.
+ *
+ * The outer cells and their outward normals are found by a TrophectodermBoundaryDetector. Each outer cell
+ * that is not already trophectoderm is given the trophectoderm proliferative type, the polarity property
+ * and a label, its target area is set to mTrophectodermTargetArea and its polarity is set to its outward
+ * normal, if it has a CellPolarityVectorSrnModel or, in 2D, a CellPolaritySrnModel.
+ *
+ * If mSpecificationInterval is 0, the cells are specified once, at the start of the first Solve() after
+ * the modifier is added. Otherwise they are specified at the start of every Solve() and every
+ * mSpecificationInterval time steps, so that cells reaching the surface become trophectoderm as the
+ * embryo grows. A NissenOffLatticeSimulation reschedules the division of each newly specified cell.
+ */
+template<unsigned DIM>
+class TrophectodermSpecificationModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mSpecificationInterval;
+        archive & mAlpha;
+        archive & mTrophectodermTargetArea;
+        archive & mHasSpecified;
+    }
+
+    /** Number of time steps between specifications, or 0 to specify only once. Defaults to 0. */
+    unsigned mSpecificationInterval;
+
+    /** The probe radius used by the boundary detector. Defaults to 0.8. */
+    double mAlpha;
+
+    /** The target area given to newly specified cells. Defaults to 1.5. */
+    double mTrophectodermTargetArea;
+
+    /** Whether cells have been specified since the modifier was created. */
+    bool mHasSpecified;
+
+    /** The boundary detector. */
+    TrophectodermBoundaryDetector<DIM> mDetector;
+
+    /** Cells specified since the last call to ClearNewlySpecifiedCells(). */
+    std::vector<CellPtr> mNewlySpecifiedCells;
+
+    /** The number of cells specified by the modifier. */
+    unsigned mNumSpecifiedCells;
+
+    /**
+     * Find the outer cells and specify those that are not yet trophectoderm.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void SpecifyTrophectoderm(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    TrophectodermSpecificationModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~TrophectodermSpecificationModifier();
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * Specifies cells every mSpecificationInterval time steps, if this is not 0.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Specifies cells, unless mSpecificationInterval is 0 and this has already been done.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * @return the cells specified since the last call to ClearNewlySpecifiedCells().
+     */
+    const std::vector<CellPtr>& rGetNewlySpecifiedCells() const;
+
+    /**
+     * Forget the cells specified so far, once their divisions have been rescheduled.
+     */
+    void ClearNewlySpecifiedCells();
+
+    /**
+     * @return the number of cells specified by the modifier.
+     */
+    unsigned GetNumSpecifiedCells() const;
+
+    /**
+     * @return the boundary detector, as used at the last specification.
+     */
+    const TrophectodermBoundaryDetector<DIM>& rGetBoundaryDetector() const;
+
+    /**
+     * @return mSpecificationInterval
+     */
+    unsigned GetSpecificationInterval();
+
+    /**
+     * Set mSpecificationInterval.
+     *
+     * @param specificationInterval the number of time steps between specifications, or 0 to specify only once
+     */
+    void SetSpecificationInterval(unsigned specificationInterval);
+
+    /**
+     * @return mAlpha
+     */
+    double GetAlpha();
+
+    /**
+     * Set mAlpha.
+     *
+     * @param alpha the probe radius used by the boundary detector
+     */
+    void SetAlpha(double alpha);
+
+    /**
+     * @return mTrophectodermTargetArea
+     */
+    double GetTrophectodermTargetArea();
+
+    /**
+     * Set mTrophectodermTargetArea.
+     *
+     * @param trophectodermTargetArea the target area given to newly specified cells
+     */
+    void SetTrophectodermTargetArea(double trophectodermTargetArea);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(TrophectodermSpecificationModifier)
+
+#endif /*TROPHECTODERMSPECIFICATIONMODIFIER_HPP_*/
@@ -0,0 +1,284 @@
+
+#include "NissenAdaptiveNumericalMethod.hpp"
+#include "AbstractNissenTwoBodyForce.hpp"
+#include "NissenNoiseForce.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "CellPopulationStateTracker.hpp"
+#include "PetscTools.hpp"
+#include "Warnings.hpp"
+
+#include <algorithm>
+#include <cfloat>
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::NissenAdaptiveNumericalMethod()
+    : AbstractNumericalMethod<ELEMENT_DIM,SPACE_DIM>(),
+      mDisplacementTolerance(0.05),
+      mForceTolerance(1.0),
+      mMinimumSubstep(1e-6),
+      mMaximumGrowthFactor(2.0),
+      mProposedSubstep(DBL_MAX),
+      mNumSubsteps(0),
+      mNumRejectedSubsteps(0),
+      mSmallestSubstep(0.0),
+      mLargestSubstep(0.0)
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::~NissenAdaptiveNumericalMethod()
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetGlobalMaximum(double localValue)
+{
+    double global_value = localValue;
+    if (PetscTools::IsParallel())
+    {
+        MPI_Allreduce(&localValue, &global_value, 1, MPI_DOUBLE, MPI_MAX, PETSC_COMM_WORLD);
+    }
+    return global_value;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::CalculatePairRadius()
+{
+    double radius = 0.0;
+    for (typename std::vector<boost::shared_ptr<AbstractForce<ELEMENT_DIM, SPACE_DIM> > >::iterator iter = this->mpForceCollection->begin();
+         iter != this->mpForceCollection->end();
+         ++iter)
+    {
+        AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>* p_force = dynamic_cast<AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>*>(iter->get());
+        if (p_force != nullptr)
+        {
+            radius = std::max(radius, p_force->GetMaximumInteractionRange());
+        }
+        else if (dynamic_cast<NissenNoiseForce<SPACE_DIM>*>(iter->get()) == nullptr)
+        {
+            return DBL_MAX;
+        }
+    }
+    return radius;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::UpdateAllNodePositions(double dt)
+{
+    mNumSubsteps = 0;
+    mNumRejectedSubsteps = 0;
+    mSmallestSubstep = DBL_MAX;
+    mLargestSubstep = 0.0;
+
+    // The forces divided by the damping constants, in the order of the node iterator
+    std::vector<c_vector<double, SPACE_DIM> > velocities = this->ComputeForcesIncludingDamping();
+
+    /*
+     * The simulation only updates the node pairs between time steps, but the substeps of a long time step may
+     * move the nodes further than the skin of the mesh's interaction distance. Before each substep, make sure
+     * the node pairs will still cover the force range once every node has moved by the displacement tolerance.
+     */
+    NodeBasedCellPopulation<SPACE_DIM>* p_node_based_population = dynamic_cast<NodeBasedCellPopulation<SPACE_DIM>*>(this->mpCellPopulation);
+    CellPopulationStateTracker<SPACE_DIM>* p_tracker = CellPopulationStateTracker<SPACE_DIM>::Instance();
+    double pair_radius = CalculatePairRadius();
+    if (pair_radius < DBL_MAX)
+    {
+        pair_radius += 2.0*mDisplacementTolerance;
+    }
+
+    double time_remaining = dt;
+    while (time_remaining > 0.0)
+    {
+        if (p_node_based_population != nullptr)
+        {
+            unsigned num_updates = p_tracker->GetNumUpdatesPerformed();
+            p_tracker->EnsureState(*p_node_based_population, CellPopulationStateTracker<SPACE_DIM>::NODE_PAIRS, pair_radius);
+            if (p_tracker->GetNumUpdatesPerformed() != num_updates)
+            {
+                // The forces may include new pairs, and in a distributed run Update() may have moved nodes between processes
+                velocities = this->ComputeForcesIncludingDamping();
+            }
+        }
+
+        double max_speed = 0.0;
+        for (unsigned i=0; i<velocities.size(); i++)
+        {
+            max_speed = std::max(max_speed, norm_2(velocities[i]));
+        }
+        max_speed = GetGlobalMaximum(max_speed);
+
+        double substep = std::min(mProposedSubstep, time_remaining);
+        if (max_speed*substep > mDisplacementTolerance)
+        {
+            substep = mDisplacementTolerance/max_speed;
+        }
+        substep = std::max(substep, std::min(mMinimumSubstep, time_remaining));
+        bool is_limited = (substep < mProposedSubstep);
+
+        std::vector<c_vector<double, SPACE_DIM> > old_locations = this->SaveCurrentLocations();
+
+        unsigned index = 0;
+        for (typename AbstractMesh<ELEMENT_DIM, SPACE_DIM>::NodeIterator node_iter = this->mpCellPopulation->rGetMesh().GetNodeIteratorBegin();
+             node_iter != this->mpCellPopulation->rGetMesh().GetNodeIteratorEnd();
+             ++node_iter, ++index)
+        {
+            c_vector<double, SPACE_DIM> displacement = substep*velocities[index];
+            this->DetectStepSizeExceptions(node_iter->GetIndex(), displacement, substep);
+            c_vector<double, SPACE_DIM> new_location = old_locations[index] + displacement;
+            this->SafeNodePositionUpdate(node_iter->GetIndex(), new_location);
+        }
+
+        std::vector<c_vector<double, SPACE_DIM> > new_velocities = this->ComputeForcesIncludingDamping();
+
+        double max_change = 0.0;
+        for (unsigned i=0; i<velocities.size(); i++)
+        {
+            max_change = std::max(max_change, norm_2(new_velocities[i] - velocities[i]));
+        }
+        max_change = GetGlobalMaximum(max_change);
+
+        if (max_change > mForceTolerance)
+        {
+            if (substep > mMinimumSubstep)
+            {
+                // Undo the substep and try again with a shorter one; the forces at the old positions are still in velocities
+                index = 0;
+                for (typename AbstractMesh<ELEMENT_DIM, SPACE_DIM>::NodeIterator node_iter = this->mpCellPopulation->rGetMesh().GetNodeIteratorBegin();
+                     node_iter != this->mpCellPopulation->rGetMesh().GetNodeIteratorEnd();
+                     ++node_iter, ++index)
+                {
+                    this->SafeNodePositionUpdate(node_iter->GetIndex(), old_locations[index]);
+                }
+                mProposedSubstep = std::max(mMinimumSubstep, substep*std::max(0.2, 0.9*mForceTolerance/max_change));
+                mNumRejectedSubsteps++;
+                continue;
+            }
+            WARN_ONCE_ONLY("The force tolerance of NissenAdaptiveNumericalMethod was not met by the minimum substep.");
+        }
+
+        // Accept the substep
+        velocities.swap(new_velocities);
+        time_remaining = (substep >= time_remaining) ? 0.0 : time_remaining - substep;
+        mNumSubsteps++;
+        mSmallestSubstep = std::min(mSmallestSubstep, substep);
+        mLargestSubstep = std::max(mLargestSubstep, substep);
+
+        // The error of a forward Euler substep is proportional to the change in force, which is proportional to the substep
+        double growth = mMaximumGrowthFactor;
+        if (max_change > 0.0)
+        {
+            growth = std::max(0.2, std::min(growth, 0.9*mForceTolerance/max_change));
+        }
+        if (!(is_limited && growth >= 1.0))
+        {
+            // A substep cut short by the displacement tolerance or the end of the time step says nothing about a longer one
+            mProposedSubstep = std::max(mMinimumSubstep, substep*growth);
+        }
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetDisplacementTolerance()
+{
+    return mDisplacementTolerance;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::SetDisplacementTolerance(double displacementTolerance)
+{
+    assert(displacementTolerance > 0.0);
+    mDisplacementTolerance = displacementTolerance;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetForceTolerance()
+{
+    return mForceTolerance;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::SetForceTolerance(double forceTolerance)
+{
+    assert(forceTolerance > 0.0);
+    mForceTolerance = forceTolerance;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetMinimumSubstep()
+{
+    return mMinimumSubstep;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::SetMinimumSubstep(double minimumSubstep)
+{
+    assert(minimumSubstep > 0.0);
+    mMinimumSubstep = minimumSubstep;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetMaximumGrowthFactor()
+{
+    return mMaximumGrowthFactor;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::SetMaximumGrowthFactor(double maximumGrowthFactor)
+{
+    assert(maximumGrowthFactor > 1.0);
+    mMaximumGrowthFactor = maximumGrowthFactor;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetProposedSubstep()
+{
+    return mProposedSubstep;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetNumSubstepsInLastStep()
+{
+    return mNumSubsteps;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetNumRejectedSubstepsInLastStep()
+{
+    return mNumRejectedSubsteps;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetSmallestSubstepInLastStep()
+{
+    return mSmallestSubstep;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetLargestSubstepInLastStep()
+{
+    return mLargestSubstep;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenAdaptiveNumericalMethod<ELEMENT_DIM,SPACE_DIM>::OutputNumericalMethodParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<DisplacementTolerance>" << mDisplacementTolerance << "</DisplacementTolerance>\n";
+    *rParamsFile << "\t\t\t<ForceTolerance>" << mForceTolerance << "</ForceTolerance>\n";
+    *rParamsFile << "\t\t\t<MinimumSubstep>" << mMinimumSubstep << "</MinimumSubstep>\n";
+    *rParamsFile << "\t\t\t<MaximumGrowthFactor>" << mMaximumGrowthFactor << "</MaximumGrowthFactor>\n";
+
+    // Call method on direct parent class
+    AbstractNumericalMethod<ELEMENT_DIM,SPACE_DIM>::OutputNumericalMethodParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class NissenAdaptiveNumericalMethod<1,1>;
+template class NissenAdaptiveNumericalMethod<1,2>;
+template class NissenAdaptiveNumericalMethod<2,2>;
+template class NissenAdaptiveNumericalMethod<1,3>;
+template class NissenAdaptiveNumericalMethod<2,3>;
+template class NissenAdaptiveNumericalMethod<3,3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(NissenAdaptiveNumericalMethod)
@@ -0,0 +1,188 @@
+
+#ifndef NISSENADAPTIVENUMERICALMETHOD_HPP_
+#define NISSENADAPTIVENUMERICALMETHOD_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "AbstractNumericalMethod.hpp"
+
+/**
+ * A forward Euler numerical method which divides each simulation time step into substeps of its own choosing.
+ *
+ * The simulation time step is left fixed, so that cell cycles, SRN models, modifiers and output all run on
+ * exact times, but it may be set many times larger than a fixed forward Euler step would allow: within it,
+ * the nodes are moved by substeps chosen from the forces on them. Before each substep the largest speed of
+ * any node (its force divided by its damping constant) is found, and the substep is shortened so that no
+ * node moves further than mDisplacementTolerance. After the substep the forces are computed again at the
+ * new positions, and if the largest change in the damped force on any node exceeds mForceTolerance the
+ * substep is undone and retried with a shorter one. The change in force over a substep is a measure of the
+ * local error of the forward Euler step (which is half the substep times this change), so mForceTolerance
+ * controls accuracy and mDisplacementTolerance guards against jumps through the steep core of the Nissen
+ * potentials when daughters are placed close to their neighbours.
+ *
+ * The forces computed at the end of an accepted substep are used for the next, so an accepted substep costs
+ * one force evaluation. The proposed substep grows by up to mMaximumGrowthFactor after each accepted
+ * substep and carries over between time steps, so during quiet relaxation each time step is taken in a
+ * single substep, and after a division wave the substeps shrink only for as long as the forces change
+ * quickly. No substep is made shorter than mMinimumSubstep.
+ *
+ * In a distributed run the largest speed and force change are taken over all processes, so every process
+ * takes the same substeps (the Dhall forces communicate, and must be called the same number of times on each).
+ *
+ * Use with NissenOffLatticeSimulation to write the substeps taken in each time step to adaptivetimestep.dat.
+ */
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
+class NissenAdaptiveNumericalMethod : public AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM>
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the object and its member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM> >(*this);
+        archive & mDisplacementTolerance;
+        archive & mForceTolerance;
+        archive & mMinimumSubstep;
+        archive & mMaximumGrowthFactor;
+        archive & mProposedSubstep;
+    }
+
+    /** The furthest any node may move in one substep. Defaults to 0.05. */
+    double mDisplacementTolerance;
+
+    /** The largest change in the damped force on any node allowed over one substep. Defaults to 1.0. */
+    double mForceTolerance;
+
+    /** The shortest substep taken, even if the tolerances are not then met. Defaults to 1e-6. */
+    double mMinimumSubstep;
+
+    /** The largest factor by which the substep may grow after an accepted substep. Defaults to 2. */
+    double mMaximumGrowthFactor;
+
+    /** The substep to try next, before the displacement tolerance and the end of the time step are applied. */
+    double mProposedSubstep;
+
+    /** The number of substeps accepted in the last call to UpdateAllNodePositions(). */
+    unsigned mNumSubsteps;
+
+    /** The number of substeps rejected in the last call to UpdateAllNodePositions(). */
+    unsigned mNumRejectedSubsteps;
+
+    /** The shortest substep accepted in the last call to UpdateAllNodePositions(). */
+    double mSmallestSubstep;
+
+    /** The longest substep accepted in the last call to UpdateAllNodePositions(). */
+    double mLargestSubstep;
+
+    /**
+     * @return the largest value over all processes of a quantity computed on each.
+     *
+     * @param localValue the value on this process
+     */
+    double GetGlobalMaximum(double localValue);
+
+    /**
+     * @return the largest range of the Dhall two-body forces, or DBL_MAX if some other force, whose range is
+     * unknown, is present.
+     */
+    double CalculatePairRadius();
+
+public:
+
+    /**
+     * Constructor.
+     */
+    NissenAdaptiveNumericalMethod();
+
+    /**
+     * Destructor.
+     */
+    virtual ~NissenAdaptiveNumericalMethod();
+
+    /**
+     * Overridden UpdateAllNodePositions() method.
+     *
+     * Moves the nodes through one simulation time step by as many forward Euler substeps as the tolerances require.
+     * For a NodeBasedCellPopulation, the node pairs are updated through CellPopulationStateTracker whenever the
+     * substeps so far may have moved the nodes beyond the skin of the mesh's maximum interaction distance.
+     *
+     * @param dt the simulation time step
+     */
+    virtual void UpdateAllNodePositions(double dt);
+
+    /** @return mDisplacementTolerance */
+    double GetDisplacementTolerance();
+
+    /**
+     * Set mDisplacementTolerance.
+     *
+     * @param displacementTolerance the furthest any node may move in one substep
+     */
+    void SetDisplacementTolerance(double displacementTolerance);
+
+    /** @return mForceTolerance */
+    double GetForceTolerance();
+
+    /**
+     * Set mForceTolerance.
+     *
+     * @param forceTolerance the largest change in the damped force on any node allowed over one substep
+     */
+    void SetForceTolerance(double forceTolerance);
+
+    /** @return mMinimumSubstep */
+    double GetMinimumSubstep();
+
+    /**
+     * Set mMinimumSubstep.
+     *
+     * @param minimumSubstep the shortest substep taken
+     */
+    void SetMinimumSubstep(double minimumSubstep);
+
+    /** @return mMaximumGrowthFactor */
+    double GetMaximumGrowthFactor();
+
+    /**
+     * Set mMaximumGrowthFactor.
+     *
+     * @param maximumGrowthFactor the largest factor by which the substep may grow, which must exceed 1
+     */
+    void SetMaximumGrowthFactor(double maximumGrowthFactor);
+
+    /** @return the substep that will be tried next, before it is limited by the displacement tolerance or the time step. */
+    double GetProposedSubstep();
+
+    /** @return the number of substeps accepted in the last time step. */
+    unsigned GetNumSubstepsInLastStep();
+
+    /** @return the number of substeps rejected in the last time step. */
+    unsigned GetNumRejectedSubstepsInLastStep();
+
+    /** @return the shortest substep accepted in the last time step. */
+    double GetSmallestSubstepInLastStep();
+
+    /** @return the longest substep accepted in the last time step. */
+    double GetLargestSubstepInLastStep();
+
+    /**
+     * Overridden OutputNumericalMethodParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputNumericalMethodParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(NissenAdaptiveNumericalMethod)
+
+#endif /*NISSENADAPTIVENUMERICALMETHOD_HPP_*/
@@ -0,0 +1,327 @@
+
+#include "NissenHealthMonitoredNumericalMethod.hpp"
+#include "CellPolarityVectors.hpp"
+#include "Exception.hpp"
+#include "PetscTools.hpp"
+#include "SimulationTime.hpp"
+
+#include <cmath>
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::NissenHealthMonitoredNumericalMethod()
+    : AbstractNumericalMethod<ELEMENT_DIM,SPACE_DIM>(),
+      mMaxDisplacement(0.1),
+      mPolarityTolerance(0.1),
+      mSnapshotInterval(10),
+      mRecoveryWindow(50),
+      mMaxNumHalvings(10),
+      mNumSubsteps(1),
+      mNumSubstepsInLastStep(0),
+      mNumRecoveryStepsRemaining(0),
+      mNumStepsTaken(0),
+      mTotalNumEvents(0)
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::~NissenHealthMonitoredNumericalMethod()
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetGlobalMaximum(unsigned localValue)
+{
+    unsigned global_value = localValue;
+    if (PetscTools::IsParallel())
+    {
+        MPI_Allreduce(&localValue, &global_value, 1, MPI_UNSIGNED, MPI_MAX, PETSC_COMM_WORLD);
+    }
+    return global_value;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::RecordEvent(HealthCheck failedCheck)
+{
+    HealthEvent event;
+    event.mTime = SimulationTime::Instance()->GetTime();
+    event.mFailedCheck = failedCheck;
+    event.mNumSubsteps = mNumSubsteps;
+    mEventsInLastStep.push_back(event);
+    mTotalNumEvents++;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::CheckPolarities()
+{
+    unsigned local_failure = 0;
+    for (typename AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>::Iterator cell_iter = this->mpCellPopulation->Begin();
+         cell_iter != this->mpCellPopulation->End();
+         ++cell_iter)
+    {
+        // Cells with no polarity SRN model have zero polarity, and are not checked
+        double length = norm_2(CellPolarityVectors::GetPolarityVector<SPACE_DIM>(*cell_iter));
+        if (length != 0.0 && !(std::isfinite(length) && fabs(length - 1.0) <= mPolarityTolerance))
+        {
+            typename std::map<unsigned, c_vector<double, SPACE_DIM> >::iterator snapshot = mPolaritySnapshot.find(cell_iter->GetCellId());
+            if (snapshot != mPolaritySnapshot.end())
+            {
+                CellPolarityVectors::SetPolarityVector<SPACE_DIM>(*cell_iter, snapshot->second);
+            }
+            else if (std::isfinite(length))
+            {
+                // A cell born since the last snapshot has none, so keep the direction of its polarity if it has one
+                CellPolarityVectors::SetPolarityVector<SPACE_DIM>(*cell_iter, CellPolarityVectors::GetPolarityVector<SPACE_DIM>(*cell_iter)/length);
+            }
+            else
+            {
+                c_vector<double, SPACE_DIM> default_polarity = zero_vector<double>(SPACE_DIM);
+                default_polarity(SPACE_DIM - 1) = 1.0;
+                CellPolarityVectors::SetPolarityVector<SPACE_DIM>(*cell_iter, default_polarity);
+            }
+            local_failure = 1;
+        }
+    }
+
+    if (GetGlobalMaximum(local_failure) > 0)
+    {
+        RecordEvent(INVALID_POLARITY);
+    }
+    else if (mNumStepsTaken%mSnapshotInterval == 0)
+    {
+        mPolaritySnapshot.clear();
+        for (typename AbstractCellPopulation<ELEMENT_DIM,SPACE_DIM>::Iterator cell_iter = this->mpCellPopulation->Begin();
+             cell_iter != this->mpCellPopulation->End();
+             ++cell_iter)
+        {
+            c_vector<double, SPACE_DIM> polarity = CellPolarityVectors::GetPolarityVector<SPACE_DIM>(*cell_iter);
+            if (norm_2(polarity) != 0.0)
+            {
+                mPolaritySnapshot[cell_iter->GetCellId()] = polarity;
+            }
+        }
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::UpdateAllNodePositions(double dt)
+{
+    mEventsInLastStep.clear();
+    CheckPolarities();
+    mNumStepsTaken++;
+
+    // The snapshot the time step starts again from if a check fails
+    std::vector<c_vector<double, SPACE_DIM> > old_locations = this->SaveCurrentLocations();
+    for (unsigned i=0; i<old_locations.size(); i++)
+    {
+        for (unsigned d=0; d<SPACE_DIM; d++)
+        {
+            if (!std::isfinite(old_locations[i](d)))
+            {
+                EXCEPTION("A node location is not finite at the start of a time step, so there is nothing to roll back to.");
+            }
+        }
+    }
+
+    while (true)
+    {
+        double substep = dt/mNumSubsteps;
+
+        // 0 if the checks pass, 1 if a node moves too far and 2 if a force is not finite
+        unsigned failure = 0;
+        for (unsigned substep_index=0; substep_index<mNumSubsteps && failure == 0; substep_index++)
+        {
+            // The forces divided by the damping constants, in the order of the node iterator
+            std::vector<c_vector<double, SPACE_DIM> > velocities = this->ComputeForcesIncludingDamping();
+
+            unsigned local_failure = 0;
+            for (unsigned i=0; i<velocities.size() && local_failure < 2; i++)
+            {
+                for (unsigned d=0; d<SPACE_DIM; d++)
+                {
+                    if (!std::isfinite(velocities[i](d)))
+                    {
+                        local_failure = 2;
+                    }
+                }
+                if (local_failure == 0 && substep*norm_2(velocities[i]) > mMaxDisplacement)
+                {
+                    local_failure = 1;
+                }
+            }
+            failure = GetGlobalMaximum(local_failure);
+
+            if (failure == 0)
+            {
+                unsigned index = 0;
+                for (typename AbstractMesh<ELEMENT_DIM, SPACE_DIM>::NodeIterator node_iter = this->mpCellPopulation->rGetMesh().GetNodeIteratorBegin();
+                     node_iter != this->mpCellPopulation->rGetMesh().GetNodeIteratorEnd();
+                     ++node_iter, ++index)
+                {
+                    c_vector<double, SPACE_DIM> displacement = substep*velocities[index];
+                    this->DetectStepSizeExceptions(node_iter->GetIndex(), displacement, substep);
+                    c_vector<double, SPACE_DIM> new_location = node_iter->rGetLocation() + displacement;
+                    this->SafeNodePositionUpdate(node_iter->GetIndex(), new_location);
+                }
+            }
+        }
+
+        if (failure == 0)
+        {
+            break;
+        }
+
+        // Roll back to the start of the time step and take it again with the substep halved
+        unsigned index = 0;
+        for (typename AbstractMesh<ELEMENT_DIM, SPACE_DIM>::NodeIterator node_iter = this->mpCellPopulation->rGetMesh().GetNodeIteratorBegin();
+             node_iter != this->mpCellPopulation->rGetMesh().GetNodeIteratorEnd();
+             ++node_iter, ++index)
+        {
+            this->SafeNodePositionUpdate(node_iter->GetIndex(), old_locations[index]);
+        }
+
+        if (mNumSubsteps >= (1u << mMaxNumHalvings))
+        {
+            EXCEPTION("The time step still fails its health checks after the substep has been halved " << mMaxNumHalvings << " times.");
+        }
+        mNumSubsteps *= 2;
+        mNumRecoveryStepsRemaining = mRecoveryWindow;
+        RecordEvent((failure == 2) ? NON_FINITE_FORCE : EXCESSIVE_DISPLACEMENT);
+    }
+
+    mNumSubstepsInLastStep = mNumSubsteps;
+    if (mNumSubsteps > 1)
+    {
+        if (mNumRecoveryStepsRemaining > 0)
+        {
+            mNumRecoveryStepsRemaining--;
+        }
+        if (mNumRecoveryStepsRemaining == 0)
+        {
+            // Try the full time step again
+            mNumSubsteps = 1;
+        }
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+std::string NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetCheckName(HealthCheck check)
+{
+    switch (check)
+    {
+        case NON_FINITE_FORCE:
+            return "non_finite_force";
+        case EXCESSIVE_DISPLACEMENT:
+            return "excessive_displacement";
+        case INVALID_POLARITY:
+            return "invalid_polarity";
+        default:
+            NEVER_REACHED;
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetMaxDisplacement()
+{
+    return mMaxDisplacement;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::SetMaxDisplacement(double maxDisplacement)
+{
+    assert(maxDisplacement > 0.0);
+    mMaxDisplacement = maxDisplacement;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetPolarityTolerance()
+{
+    return mPolarityTolerance;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::SetPolarityTolerance(double polarityTolerance)
+{
+    assert(polarityTolerance > 0.0);
+    mPolarityTolerance = polarityTolerance;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetSnapshotInterval()
+{
+    return mSnapshotInterval;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::SetSnapshotInterval(unsigned snapshotInterval)
+{
+    assert(snapshotInterval > 0);
+    mSnapshotInterval = snapshotInterval;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetRecoveryWindow()
+{
+    return mRecoveryWindow;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::SetRecoveryWindow(unsigned recoveryWindow)
+{
+    mRecoveryWindow = recoveryWindow;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetMaxNumHalvings()
+{
+    return mMaxNumHalvings;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::SetMaxNumHalvings(unsigned maxNumHalvings)
+{
+    assert(maxNumHalvings < 20);
+    mMaxNumHalvings = maxNumHalvings;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetNumSubstepsInLastStep()
+{
+    return mNumSubstepsInLastStep;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+const std::vector<typename NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::HealthEvent>& NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::rGetEventsInLastStep() const
+{
+    return mEventsInLastStep;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetTotalNumEvents()
+{
+    return mTotalNumEvents;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenHealthMonitoredNumericalMethod<ELEMENT_DIM,SPACE_DIM>::OutputNumericalMethodParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<MaxDisplacement>" << mMaxDisplacement << "</MaxDisplacement>\n";
+    *rParamsFile << "\t\t\t<PolarityTolerance>" << mPolarityTolerance << "</PolarityTolerance>\n";
+    *rParamsFile << "\t\t\t<SnapshotInterval>" << mSnapshotInterval << "</SnapshotInterval>\n";
+    *rParamsFile << "\t\t\t<RecoveryWindow>" << mRecoveryWindow << "</RecoveryWindow>\n";
+    *rParamsFile << "\t\t\t<MaxNumHalvings>" << mMaxNumHalvings << "</MaxNumHalvings>\n";
+
+    // Call method on direct parent class
+    AbstractNumericalMethod<ELEMENT_DIM,SPACE_DIM>::OutputNumericalMethodParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class NissenHealthMonitoredNumericalMethod<1,1>;
+template class NissenHealthMonitoredNumericalMethod<1,2>;
+template class NissenHealthMonitoredNumericalMethod<2,2>;
+template class NissenHealthMonitoredNumericalMethod<1,3>;
+template class NissenHealthMonitoredNumericalMethod<2,3>;
+template class NissenHealthMonitoredNumericalMethod<3,3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(NissenHealthMonitoredNumericalMethod)
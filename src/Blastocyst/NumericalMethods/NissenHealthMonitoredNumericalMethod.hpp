@@ -0,0 +1,242 @@
+
+#ifndef NISSENHEALTHMONITOREDNUMERICALMETHOD_HPP_
+#define NISSENHEALTHMONITOREDNUMERICALMETHOD_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "AbstractNumericalMethod.hpp"
+
+/**
+ * A forward Euler numerical method which checks the health of the simulation every time step, and recovers
+ * from a step that would blow up rather than carrying on and leaving the failure to be found in the output.
+ *
+ * Within each time step the nodes are moved by one forward Euler substep or, while recovering, by several.
+ * Before each substep the damped forces are checked to be finite, and the displacement of every node to be no
+ * more than mMaxDisplacement. If either check fails, the nodes are put back where they were at the start of
+ * the time step and the step is taken again with the substep halved; the halved substep is kept for the next
+ * mRecoveryWindow time steps before the full time step is tried again. If the substep has been halved
+ * mMaxNumHalvings times and the step still fails, an exception is thrown.
+ *
+ * The polarity of each cell with a polarity SRN model is also checked at the start of every time step: it must
+ * be finite and of unit length to within mPolarityTolerance. A polarity that fails the check is restored from
+ * an in-memory snapshot of the polarities, taken every mSnapshotInterval time steps when every polarity passes.
+ * A cell born since the last snapshot has its polarity renormalised instead or, if it is not finite, pointed
+ * along the last coordinate axis.
+ *
+ * Every failed check is recorded as a HealthEvent, with the time, the check that failed and the number of
+ * substeps the time step was then to be taken in. Use with NissenOffLatticeSimulation to write the events to
+ * healthmonitor.dat. The checks cost one pass over the nodes and cells per substep, so a longer simulation time
+ * step may be chosen than a plain forward Euler method would safely allow; the substeps are only taken where
+ * the dynamics require them. The Dhall forces check for NaN with assert(), which is compiled out of optimised
+ * builds, so this method is the only guard in those.
+ *
+ * In a distributed run the checks are combined over all processes, so every process takes the same substeps.
+ */
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
+class NissenHealthMonitoredNumericalMethod : public AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM>
+{
+public:
+
+    /** The health checks. */
+    enum HealthCheck
+    {
+        NON_FINITE_FORCE,
+        EXCESSIVE_DISPLACEMENT,
+        INVALID_POLARITY
+    };
+
+    /** A failed health check. */
+    struct HealthEvent
+    {
+        /** The time at the start of the time step in which the check failed. */
+        double mTime;
+
+        /** The check that failed. */
+        HealthCheck mFailedCheck;
+
+        /** The number of substeps the time step was then to be taken in. */
+        unsigned mNumSubsteps;
+    };
+
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the object and its member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM> >(*this);
+        archive & mMaxDisplacement;
+        archive & mPolarityTolerance;
+        archive & mSnapshotInterval;
+        archive & mRecoveryWindow;
+        archive & mMaxNumHalvings;
+    }
+
+    /** The furthest any node may move in one substep, in cell diameters. Defaults to 0.1. */
+    double mMaxDisplacement;
+
+    /** The largest difference from 1 allowed in the length of a polarity vector. Defaults to 0.1. */
+    double mPolarityTolerance;
+
+    /** The number of time steps between snapshots of the polarities. Defaults to 10. */
+    unsigned mSnapshotInterval;
+
+    /** The number of time steps for which a halved substep is kept. Defaults to 50. */
+    unsigned mRecoveryWindow;
+
+    /** The largest number of times the substep may be halved in one time step. Defaults to 10. */
+    unsigned mMaxNumHalvings;
+
+    /** The number of substeps in which time steps are currently taken. */
+    unsigned mNumSubsteps;
+
+    /** The number of substeps the last time step was taken in. */
+    unsigned mNumSubstepsInLastStep;
+
+    /** The number of time steps left before the full time step is tried again. */
+    unsigned mNumRecoveryStepsRemaining;
+
+    /** The number of calls to UpdateAllNodePositions() so far. */
+    unsigned mNumStepsTaken;
+
+    /** The polarities of the cells at the last snapshot, by cell ID. */
+    std::map<unsigned, c_vector<double, SPACE_DIM> > mPolaritySnapshot;
+
+    /** The failed checks in the last call to UpdateAllNodePositions(). */
+    std::vector<HealthEvent> mEventsInLastStep;
+
+    /** The number of failed checks so far. */
+    unsigned mTotalNumEvents;
+
+    /**
+     * @return the largest value over all processes of a flag computed on each.
+     *
+     * @param localValue the value on this process
+     */
+    unsigned GetGlobalMaximum(unsigned localValue);
+
+    /**
+     * Record a failed check.
+     *
+     * @param failedCheck the check
+     */
+    void RecordEvent(HealthCheck failedCheck);
+
+    /**
+     * Check the polarity of every cell, restoring any that fail from the snapshot, and take a snapshot
+     * if they all pass and one is due.
+     */
+    void CheckPolarities();
+
+public:
+
+    /**
+     * Constructor.
+     */
+    NissenHealthMonitoredNumericalMethod();
+
+    /**
+     * Destructor.
+     */
+    virtual ~NissenHealthMonitoredNumericalMethod();
+
+    /**
+     * Overridden UpdateAllNodePositions() method.
+     *
+     * Checks the polarities, then moves the nodes through one simulation time step, halving the substep
+     * and starting again from the locations at the start of the step each time a check fails.
+     *
+     * @param dt the simulation time step
+     */
+    virtual void UpdateAllNodePositions(double dt);
+
+    /**
+     * @return the name of a health check, as written to healthmonitor.dat.
+     *
+     * @param check the check
+     */
+    static std::string GetCheckName(HealthCheck check);
+
+    /** @return mMaxDisplacement */
+    double GetMaxDisplacement();
+
+    /**
+     * Set mMaxDisplacement.
+     *
+     * @param maxDisplacement the furthest any node may move in one substep
+     */
+    void SetMaxDisplacement(double maxDisplacement);
+
+    /** @return mPolarityTolerance */
+    double GetPolarityTolerance();
+
+    /**
+     * Set mPolarityTolerance.
+     *
+     * @param polarityTolerance the largest difference from 1 allowed in the length of a polarity vector
+     */
+    void SetPolarityTolerance(double polarityTolerance);
+
+    /** @return mSnapshotInterval */
+    unsigned GetSnapshotInterval();
+
+    /**
+     * Set mSnapshotInterval.
+     *
+     * @param snapshotInterval the number of time steps between snapshots of the polarities
+     */
+    void SetSnapshotInterval(unsigned snapshotInterval);
+
+    /** @return mRecoveryWindow */
+    unsigned GetRecoveryWindow();
+
+    /**
+     * Set mRecoveryWindow.
+     *
+     * @param recoveryWindow the number of time steps for which a halved substep is kept
+     */
+    void SetRecoveryWindow(unsigned recoveryWindow);
+
+    /** @return mMaxNumHalvings */
+    unsigned GetMaxNumHalvings();
+
+    /**
+     * Set mMaxNumHalvings.
+     *
+     * @param maxNumHalvings the largest number of times the substep may be halved in one time step
+     */
+    void SetMaxNumHalvings(unsigned maxNumHalvings);
+
+    /** @return the number of substeps the last time step was taken in. */
+    unsigned GetNumSubstepsInLastStep();
+
+    /** @return the failed checks in the last time step. */
+    const std::vector<HealthEvent>& rGetEventsInLastStep() const;
+
+    /** @return the number of failed checks so far. */
+    unsigned GetTotalNumEvents();
+
+    /**
+     * Overridden OutputNumericalMethodParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputNumericalMethodParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(NissenHealthMonitoredNumericalMethod)
+
+#endif /*NISSENHEALTHMONITOREDNUMERICALMETHOD_HPP_*/
@@ -0,0 +1,383 @@
+
+#include "NissenLocalTimeSteppingNumericalMethod.hpp"
+#include "AbstractNissenTwoBodyForce.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "NissenPairGeometryCache.hpp"
+#include "NissenHaloStateMirror.hpp"
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <climits>
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+NissenLocalTimeSteppingNumericalMethod<ELEMENT_DIM,SPACE_DIM>::NissenLocalTimeSteppingNumericalMethod()
+    : AbstractNumericalMethod<ELEMENT_DIM,SPACE_DIM>(),
+      mMaxLevel(6),
+      mStabilityFactor(0.5),
+      mDisplacementTolerance(0.05),
+      mMaxPolarityUpdateInterval(1),
+      mNumNodeUpdates(0),
+      mNumPairEvaluations(0)
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+NissenLocalTimeSteppingNumericalMethod<ELEMENT_DIM,SPACE_DIM>::~NissenLocalTimeSteppingNumericalMethod()
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenLocalTimeSteppingNumericalMethod<ELEMENT_DIM,SPACE_DIM>::UpdateAllNodePositions(double dt)
+{
+    NodeBasedCellPopulation<SPACE_DIM>* p_node_based_population = dynamic_cast<NodeBasedCellPopulation<SPACE_DIM>*>(this->mpCellPopulation);
+    if (p_node_based_population == nullptr)
+    {
+        EXCEPTION("NissenLocalTimeSteppingNumericalMethod is only implemented for use with a NodeBasedCellPopulation");
+    }
+    NodesOnlyMesh<SPACE_DIM>& r_mesh = p_node_based_population->rGetMesh();
+
+    std::vector<AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>*> nissen_forces;
+    std::vector<AbstractForce<ELEMENT_DIM, SPACE_DIM>*> other_forces;
+    for (typename std::vector<boost::shared_ptr<AbstractForce<ELEMENT_DIM, SPACE_DIM> > >::iterator iter = this->mpForceCollection->begin();
+         iter != this->mpForceCollection->end();
+         ++iter)
+    {
+        AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>* p_force = dynamic_cast<AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>*>(iter->get());
+        if (p_force != nullptr)
+        {
+            nissen_forces.push_back(p_force);
+        }
+        else
+        {
+            other_forces.push_back(iter->get());
+        }
+    }
+
+    // The other forces are evaluated once, at the start of the time step
+    for (typename AbstractMesh<SPACE_DIM, SPACE_DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        node_iter->ClearAppliedForce();
+    }
+    for (unsigned f=0; f<other_forces.size(); f++)
+    {
+        other_forces[f]->AddForceContribution(*(this->mpCellPopulation));
+    }
+
+    std::vector<unsigned> node_indices;
+    std::vector<double> dampings;
+    std::vector<c_vector<double, SPACE_DIM> > other_velocities;
+    std::vector<c_vector<double, SPACE_DIM> > old_locations;
+    unsigned max_index = 0;
+    for (typename AbstractMesh<SPACE_DIM, SPACE_DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        double damping = this->mpCellPopulation->GetDampingConstant(node_iter->GetIndex());
+        node_indices.push_back(node_iter->GetIndex());
+        dampings.push_back(damping);
+        other_velocities.push_back(node_iter->rGetAppliedForce()/damping);
+        old_locations.push_back(node_iter->rGetLocation());
+        max_index = std::max(max_index, node_iter->GetIndex());
+    }
+    unsigned num_nodes = node_indices.size();
+
+    // Halo nodes are not iterated over, so are left without a row and held where they are
+    std::vector<unsigned> row_of_node(max_index + 1, UINT_MAX);
+    for (unsigned a=0; a<num_nodes; a++)
+    {
+        row_of_node[node_indices[a]] = a;
+    }
+
+    // In a distributed run, bring the polarity of the halo nodes up to date with their owners
+    NissenHaloStateMirror<SPACE_DIM>::Instance()->Refresh(*p_node_based_population);
+
+    // The pairs at the start of the step, with their rows, and the stiffness of each node
+    const std::vector<typename NissenPairGeometryCache<SPACE_DIM>::PairGeometry>& r_pairs =
+        NissenPairGeometryCache<SPACE_DIM>::Instance()->rGetPairs(*p_node_based_population);
+    std::vector<std::pair<unsigned, unsigned> > pair_nodes;
+    std::vector<std::pair<unsigned, unsigned> > pair_rows;
+    std::vector<double> stiffnesses(num_nodes, 0.0);
+    for (unsigned i=0; i<r_pairs.size(); i++)
+    {
+        const typename NissenPairGeometryCache<SPACE_DIM>::PairGeometry& r_pair = r_pairs[i];
+        unsigned a = (r_pair.mNodeAIndex <= max_index) ? row_of_node[r_pair.mNodeAIndex] : UINT_MAX;
+        unsigned b = (r_pair.mNodeBIndex <= max_index) ? row_of_node[r_pair.mNodeBIndex] : UINT_MAX;
+        if (a == UINT_MAX && b == UINT_MAX)
+        {
+            continue;
+        }
+        pair_nodes.push_back(std::make_pair(r_pair.mNodeAIndex, r_pair.mNodeBIndex));
+        pair_rows.push_back(std::make_pair(a, b));
+
+        double stiffness = 0.0;
+        for (unsigned f=0; f<nissen_forces.size(); f++)
+        {
+            stiffness += nissen_forces[f]->CalculatePairStiffness(r_pair.mNodeAIndex, r_pair.mNodeBIndex, r_pair.mDistance, *(this->mpCellPopulation));
+        }
+        if (a != UINT_MAX)
+        {
+            stiffnesses[a] += stiffness;
+        }
+        if (b != UINT_MAX)
+        {
+            stiffnesses[b] += stiffness;
+        }
+    }
+
+    mNumNodeUpdates = 0;
+    mNumPairEvaluations = 0;
+
+    // Every node is active at the first micro-step, so these forces also choose the levels
+    std::vector<bool> is_active(num_nodes, true);
+    std::vector<c_vector<double, SPACE_DIM> > velocities(num_nodes, zero_vector<double>(SPACE_DIM));
+    for (unsigned p=0; p<pair_rows.size(); p++)
+    {
+        unsigned a = pair_rows[p].first;
+        unsigned b = pair_rows[p].second;
+        const c_vector<double, SPACE_DIM>& r_location_a = r_mesh.GetNodeOrHaloNode(pair_nodes[p].first)->rGetLocation();
+        const c_vector<double, SPACE_DIM>& r_location_b = r_mesh.GetNodeOrHaloNode(pair_nodes[p].second)->rGetLocation();
+        c_vector<double, SPACE_DIM> vector_from_a_to_b = r_mesh.GetVectorFromAtoB(r_location_a, r_location_b);
+        double distance = norm_2(vector_from_a_to_b);
+        for (unsigned f=0; f<nissen_forces.size(); f++)
+        {
+            c_vector<double, SPACE_DIM> force = nissen_forces[f]->CalculateForceFromPairGeometry(pair_nodes[p].first, pair_nodes[p].second,
+                                                                                                 vector_from_a_to_b, distance, *(this->mpCellPopulation));
+            if (a != UINT_MAX)
+            {
+                velocities[a] += force/dampings[a];
+            }
+            if (b != UINT_MAX)
+            {
+                velocities[b] -= force/dampings[b];
+            }
+        }
+        mNumPairEvaluations++;
+    }
+
+    // The smallest level meeting both limits
+    std::vector<unsigned> levels(num_nodes, 0);
+    for (unsigned a=0; a<num_nodes; a++)
+    {
+        double speed = norm_2(velocities[a] + other_velocities[a]);
+        double rate = stiffnesses[a]/dampings[a];
+        double substep = dt;
+        while (levels[a] < mMaxLevel
+               && (substep*rate > mStabilityFactor || substep*speed > mDisplacementTolerance))
+        {
+            levels[a]++;
+            substep *= 0.5;
+        }
+    }
+
+    // Neighbouring levels may differ by at most one; each sweep spreads a level one more pair along
+    bool has_changed = true;
+    for (unsigned sweep=0; sweep<mMaxLevel && has_changed; sweep++)
+    {
+        has_changed = false;
+        for (unsigned p=0; p<pair_rows.size(); p++)
+        {
+            unsigned a = pair_rows[p].first;
+            unsigned b = pair_rows[p].second;
+            if (a == UINT_MAX || b == UINT_MAX)
+            {
+                continue;
+            }
+            if (levels[a] + 1 < levels[b])
+            {
+                levels[a] = levels[b] - 1;
+                has_changed = true;
+            }
+            else if (levels[b] + 1 < levels[a])
+            {
+                levels[b] = levels[a] - 1;
+                has_changed = true;
+            }
+        }
+    }
+
+    unsigned top_level = 0;
+    mNumNodesAtLevel.assign(mMaxLevel + 1, 0);
+    for (unsigned a=0; a<num_nodes; a++)
+    {
+        top_level = std::max(top_level, levels[a]);
+        mNumNodesAtLevel[levels[a]]++;
+    }
+
+    unsigned num_micro_steps = 1u << top_level;
+    for (unsigned micro_step=0; micro_step<num_micro_steps; micro_step++)
+    {
+        if (micro_step > 0)
+        {
+            // A node is active at the micro-steps which are multiples of its substep
+            for (unsigned a=0; a<num_nodes; a++)
+            {
+                is_active[a] = (micro_step%(1u << (top_level - levels[a])) == 0);
+                if (is_active[a])
+                {
+                    velocities[a] = zero_vector<double>(SPACE_DIM);
+                }
+            }
+
+            for (unsigned p=0; p<pair_rows.size(); p++)
+            {
+                unsigned a = pair_rows[p].first;
+                unsigned b = pair_rows[p].second;
+                bool is_a_active = (a != UINT_MAX && is_active[a]);
+                bool is_b_active = (b != UINT_MAX && is_active[b]);
+                if (!is_a_active && !is_b_active)
+                {
+                    continue;
+                }
+
+                const c_vector<double, SPACE_DIM>& r_location_a = r_mesh.GetNodeOrHaloNode(pair_nodes[p].first)->rGetLocation();
+                const c_vector<double, SPACE_DIM>& r_location_b = r_mesh.GetNodeOrHaloNode(pair_nodes[p].second)->rGetLocation();
+                c_vector<double, SPACE_DIM> vector_from_a_to_b = r_mesh.GetVectorFromAtoB(r_location_a, r_location_b);
+                double distance = norm_2(vector_from_a_to_b);
+                for (unsigned f=0; f<nissen_forces.size(); f++)
+                {
+                    c_vector<double, SPACE_DIM> force = nissen_forces[f]->CalculateForceFromPairGeometry(pair_nodes[p].first, pair_nodes[p].second,
+                                                                                                         vector_from_a_to_b, distance, *(this->mpCellPopulation));
+                    if (is_a_active)
+                    {
+                        velocities[a] += force/dampings[a];
+                    }
+                    if (is_b_active)
+                    {
+                        velocities[b] -= force/dampings[b];
+                    }
+                }
+                mNumPairEvaluations++;
+            }
+        }
+
+        // Move the active nodes only once all their forces have been found at the current locations
+        for (unsigned a=0; a<num_nodes; a++)
+        {
+            if (is_active[a])
+            {
+                double substep = dt/(1u << levels[a]);
+                c_vector<double, SPACE_DIM> new_location = r_mesh.GetNode(node_indices[a])->rGetLocation()
+                                                           + substep*(velocities[a] + other_velocities[a]);
+                this->SafeNodePositionUpdate(node_indices[a], new_location);
+                mNumNodeUpdates++;
+            }
+        }
+    }
+
+    for (unsigned a=0; a<num_nodes; a++)
+    {
+        c_vector<double, SPACE_DIM> displacement = r_mesh.GetVectorFromAtoB(old_locations[a], r_mesh.GetNode(node_indices[a])->rGetLocation());
+        this->DetectStepSizeExceptions(node_indices[a], displacement, dt);
+    }
+
+    // Quiet cells may advance their polarity with longer steps, down the same hierarchy
+    mPolarityUpdateIntervals.assign(max_index + 1, 1);
+    for (unsigned a=0; a<num_nodes; a++)
+    {
+        mPolarityUpdateIntervals[node_indices[a]] = std::max(1u, mMaxPolarityUpdateInterval >> levels[a]);
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenLocalTimeSteppingNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetMaxLevel()
+{
+    return mMaxLevel;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenLocalTimeSteppingNumericalMethod<ELEMENT_DIM,SPACE_DIM>::SetMaxLevel(unsigned maxLevel)
+{
+    assert(maxLevel < 20);
+    mMaxLevel = maxLevel;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenLocalTimeSteppingNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetStabilityFactor()
+{
+    return mStabilityFactor;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenLocalTimeSteppingNumericalMethod<ELEMENT_DIM,SPACE_DIM>::SetStabilityFactor(double stabilityFactor)
+{
+    assert(stabilityFactor > 0.0);
+    mStabilityFactor = stabilityFactor;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenLocalTimeSteppingNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetDisplacementTolerance()
+{
+    return mDisplacementTolerance;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenLocalTimeSteppingNumericalMethod<ELEMENT_DIM,SPACE_DIM>::SetDisplacementTolerance(double displacementTolerance)
+{
+    assert(displacementTolerance > 0.0);
+    mDisplacementTolerance = displacementTolerance;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenLocalTimeSteppingNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetMaxPolarityUpdateInterval()
+{
+    return mMaxPolarityUpdateInterval;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenLocalTimeSteppingNumericalMethod<ELEMENT_DIM,SPACE_DIM>::SetMaxPolarityUpdateInterval(unsigned maxPolarityUpdateInterval)
+{
+    // A power of two, so that the intervals halve down the hierarchy
+    assert(maxPolarityUpdateInterval > 0 && (maxPolarityUpdateInterval & (maxPolarityUpdateInterval - 1)) == 0);
+    mMaxPolarityUpdateInterval = maxPolarityUpdateInterval;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenLocalTimeSteppingNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetPolarityUpdateInterval(unsigned nodeIndex) const
+{
+    // Nodes added since the last step, and halo nodes, have no level yet
+    return (nodeIndex < mPolarityUpdateIntervals.size()) ? mPolarityUpdateIntervals[nodeIndex] : 1;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+const std::vector<unsigned>& NissenLocalTimeSteppingNumericalMethod<ELEMENT_DIM,SPACE_DIM>::rGetNumNodesAtLevelInLastStep() const
+{
+    return mNumNodesAtLevel;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenLocalTimeSteppingNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetNumNodeUpdatesInLastStep()
+{
+    return mNumNodeUpdates;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenLocalTimeSteppingNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetNumPairEvaluationsInLastStep()
+{
+    return mNumPairEvaluations;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenLocalTimeSteppingNumericalMethod<ELEMENT_DIM,SPACE_DIM>::OutputNumericalMethodParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<MaxLevel>" << mMaxLevel << "</MaxLevel>\n";
+    *rParamsFile << "\t\t\t<StabilityFactor>" << mStabilityFactor << "</StabilityFactor>\n";
+    *rParamsFile << "\t\t\t<DisplacementTolerance>" << mDisplacementTolerance << "</DisplacementTolerance>\n";
+    *rParamsFile << "\t\t\t<MaxPolarityUpdateInterval>" << mMaxPolarityUpdateInterval << "</MaxPolarityUpdateInterval>\n";
+
+    // Call method on direct parent class
+    AbstractNumericalMethod<ELEMENT_DIM,SPACE_DIM>::OutputNumericalMethodParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class NissenLocalTimeSteppingNumericalMethod<1,1>;
+template class NissenLocalTimeSteppingNumericalMethod<1,2>;
+template class NissenLocalTimeSteppingNumericalMethod<2,2>;
+template class NissenLocalTimeSteppingNumericalMethod<1,3>;
+template class NissenLocalTimeSteppingNumericalMethod<2,3>;
+template class NissenLocalTimeSteppingNumericalMethod<3,3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(NissenLocalTimeSteppingNumericalMethod)
@@ -0,0 +1,178 @@
+
+#ifndef NISSENLOCALTIMESTEPPINGNUMERICALMETHOD_HPP_
+#define NISSENLOCALTIMESTEPPINGNUMERICALMETHOD_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include <vector>
+
+#include "AbstractNumericalMethod.hpp"
+
+/**
+ * A forward Euler numerical method in which each node advances with its own step, so that the work done in a
+ * time step follows the local stiffness of the embryo rather than its stiffest pair.
+ *
+ * At the start of each simulation time step every node is given a level l between 0 and mMaxLevel, and within
+ * the time step it is moved by 2^l substeps of dt/2^l. Its level is the smallest for which its substep is no
+ * longer than mStabilityFactor over its stiffness (the sum of AbstractNissenTwoBodyForce::CalculatePairStiffness()
+ * over its pairs, divided by its damping constant) and its displacement in one substep, at its speed at the start
+ * of the step, is no more than mDisplacementTolerance. The levels of neighbouring nodes are then made to differ by
+ * at most one. Freshly placed daughters and compressed clusters take small substeps; the quiet trophectoderm shell
+ * is moved in one step.
+ *
+ * The time step is divided into 2^L micro-steps, where L is the highest level in use. At each micro-step the nodes
+ * whose level divides it (those at a shared time level of their own hierarchy) are active: the Dhall two-body forces
+ * on them are evaluated from the pairs with an active node, at the current locations of both nodes, and they are
+ * moved by their own substep. A node which is not active is held where it was at its last update. Pairs with no
+ * active node are not evaluated, so the number of node updates in a step is the sum of 2^l over the nodes.
+ *
+ * Forces other than the Dhall two-body forces, such as NissenNoiseForce, are evaluated once at the start of the
+ * time step and spread over each node's substeps, so the noise keeps the variance of a forward Euler-Maruyama step
+ * of dt. Each node is also given a polarity update interval of mMaxPolarityUpdateInterval/2^l time steps (at
+ * least one), which a polarity tracking modifier passes on to the cell's polarity SRN model (see
+ * AbstractCellPolarityTrackingModifier::SetLocalTimeSteppingNumericalMethod()), so the polarity of quiet cells
+ * is advanced with a step as many times longer than the mechanics as the fastest cells are shorter.
+ *
+ * Only a NodeBasedCellPopulation is supported. The pairs are those found at the start of the time step, as for
+ * the other methods. In a distributed run each process chooses its own levels, and halo nodes are held at their
+ * locations at the start of the step.
+ */
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
+class NissenLocalTimeSteppingNumericalMethod : public AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM>
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the object and its member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM> >(*this);
+        archive & mMaxLevel;
+        archive & mStabilityFactor;
+        archive & mDisplacementTolerance;
+        archive & mMaxPolarityUpdateInterval;
+    }
+
+    /** The highest level, whose nodes take substeps of dt/2^mMaxLevel. Defaults to 6. */
+    unsigned mMaxLevel;
+
+    /** The largest product of a node's substep and its stiffness. Defaults to 0.5. */
+    double mStabilityFactor;
+
+    /** The furthest any node may move in one substep at its speed at the start of the step. Defaults to 0.05. */
+    double mDisplacementTolerance;
+
+    /** The number of time steps between solves of the polarity SRN models of the cells at level 0. Defaults to 1. */
+    unsigned mMaxPolarityUpdateInterval;
+
+    /** The polarity update interval of each node, by node index, in the last call to UpdateAllNodePositions(). */
+    std::vector<unsigned> mPolarityUpdateIntervals;
+
+    /** The number of nodes at each level in the last call to UpdateAllNodePositions(). */
+    std::vector<unsigned> mNumNodesAtLevel;
+
+    /** The number of node updates in the last call to UpdateAllNodePositions(). */
+    unsigned mNumNodeUpdates;
+
+    /** The number of pair force evaluations in the last call to UpdateAllNodePositions(). */
+    unsigned mNumPairEvaluations;
+
+public:
+
+    /**
+     * Constructor.
+     */
+    NissenLocalTimeSteppingNumericalMethod();
+
+    /**
+     * Destructor.
+     */
+    virtual ~NissenLocalTimeSteppingNumericalMethod();
+
+    /**
+     * Overridden UpdateAllNodePositions() method.
+     *
+     * Chooses the level of each node, then moves the nodes through one simulation time step by the micro-steps.
+     *
+     * @param dt the simulation time step
+     */
+    virtual void UpdateAllNodePositions(double dt);
+
+    /** @return mMaxLevel */
+    unsigned GetMaxLevel();
+
+    /**
+     * Set mMaxLevel.
+     *
+     * @param maxLevel the highest level
+     */
+    void SetMaxLevel(unsigned maxLevel);
+
+    /** @return mStabilityFactor */
+    double GetStabilityFactor();
+
+    /**
+     * Set mStabilityFactor.
+     *
+     * @param stabilityFactor the largest product of a node's substep and its stiffness
+     */
+    void SetStabilityFactor(double stabilityFactor);
+
+    /** @return mDisplacementTolerance */
+    double GetDisplacementTolerance();
+
+    /**
+     * Set mDisplacementTolerance.
+     *
+     * @param displacementTolerance the furthest any node may move in one substep
+     */
+    void SetDisplacementTolerance(double displacementTolerance);
+
+    /** @return mMaxPolarityUpdateInterval */
+    unsigned GetMaxPolarityUpdateInterval();
+
+    /**
+     * Set mMaxPolarityUpdateInterval.
+     *
+     * @param maxPolarityUpdateInterval the number of time steps between solves of the polarity SRN models of
+     *     the cells at level 0, which must be a power of two
+     */
+    void SetMaxPolarityUpdateInterval(unsigned maxPolarityUpdateInterval);
+
+    /**
+     * @return the number of time steps between solves of the polarity SRN model of a cell, from the level of
+     *     its node in the last time step, or 1 if the node had no level then
+     *
+     * @param nodeIndex the index of the cell's node
+     */
+    unsigned GetPolarityUpdateInterval(unsigned nodeIndex) const;
+
+    /** @return the number of nodes at each level in the last time step. */
+    const std::vector<unsigned>& rGetNumNodesAtLevelInLastStep() const;
+
+    /** @return the number of node updates in the last time step. */
+    unsigned GetNumNodeUpdatesInLastStep();
+
+    /** @return the number of pair force evaluations in the last time step. */
+    unsigned GetNumPairEvaluationsInLastStep();
+
+    /**
+     * Overridden OutputNumericalMethodParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputNumericalMethodParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(NissenLocalTimeSteppingNumericalMethod)
+
+#endif /*NISSENLOCALTIMESTEPPINGNUMERICALMETHOD_HPP_*/
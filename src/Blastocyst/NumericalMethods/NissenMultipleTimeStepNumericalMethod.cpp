@@ -0,0 +1,114 @@
+
+#include "NissenMultipleTimeStepNumericalMethod.hpp"
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+NissenMultipleTimeStepNumericalMethod<ELEMENT_DIM,SPACE_DIM>::NissenMultipleTimeStepNumericalMethod()
+    : AbstractNumericalMethod<ELEMENT_DIM,SPACE_DIM>(),
+      mNumInnerSteps(4)
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+NissenMultipleTimeStepNumericalMethod<ELEMENT_DIM,SPACE_DIM>::~NissenMultipleTimeStepNumericalMethod()
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+std::vector<c_vector<double, SPACE_DIM> > NissenMultipleTimeStepNumericalMethod<ELEMENT_DIM,SPACE_DIM>::ComputeForceComponentIncludingDamping(typename AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>::ForceComponent forceComponent)
+{
+    AbstractMesh<ELEMENT_DIM, SPACE_DIM>& r_mesh = this->mpCellPopulation->rGetMesh();
+    for (typename AbstractMesh<ELEMENT_DIM, SPACE_DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        node_iter->ClearAppliedForce();
+    }
+
+    for (typename std::vector<boost::shared_ptr<AbstractForce<ELEMENT_DIM, SPACE_DIM> > >::iterator iter = this->mpForceCollection->begin();
+         iter != this->mpForceCollection->end();
+         ++iter)
+    {
+        AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>* p_force = dynamic_cast<AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>*>(iter->get());
+        if (p_force != nullptr)
+        {
+            p_force->SetForceComponent(forceComponent);
+            p_force->AddForceContribution(*(this->mpCellPopulation));
+            p_force->SetForceComponent(AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>::ALL_COMPONENTS);
+        }
+        else if (forceComponent != AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>::FAST_COMPONENT)
+        {
+            (*iter)->AddForceContribution(*(this->mpCellPopulation));
+        }
+    }
+
+    std::vector<c_vector<double, SPACE_DIM> > forces;
+    forces.reserve(this->mpCellPopulation->GetNumNodes());
+    for (typename AbstractMesh<ELEMENT_DIM, SPACE_DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        double damping = this->mpCellPopulation->GetDampingConstant(node_iter->GetIndex());
+        forces.push_back(node_iter->rGetAppliedForce()/damping);
+    }
+    return forces;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenMultipleTimeStepNumericalMethod<ELEMENT_DIM,SPACE_DIM>::UpdateAllNodePositions(double dt)
+{
+    std::vector<c_vector<double, SPACE_DIM> > slow_forces =
+        ComputeForceComponentIncludingDamping(AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>::SLOW_COMPONENT);
+
+    double inner_dt = dt/mNumInnerSteps;
+    for (unsigned step=0; step<mNumInnerSteps; step++)
+    {
+        std::vector<c_vector<double, SPACE_DIM> > fast_forces =
+            ComputeForceComponentIncludingDamping(AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>::FAST_COMPONENT);
+
+        unsigned index = 0;
+        for (typename AbstractMesh<ELEMENT_DIM, SPACE_DIM>::NodeIterator node_iter = this->mpCellPopulation->rGetMesh().GetNodeIteratorBegin();
+             node_iter != this->mpCellPopulation->rGetMesh().GetNodeIteratorEnd();
+             ++node_iter, ++index)
+        {
+            c_vector<double, SPACE_DIM> displacement = inner_dt*(fast_forces[index] + slow_forces[index]);
+            this->DetectStepSizeExceptions(node_iter->GetIndex(), displacement, inner_dt);
+
+            c_vector<double, SPACE_DIM> new_location = node_iter->rGetLocation() + displacement;
+            this->SafeNodePositionUpdate(node_iter->GetIndex(), new_location);
+        }
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenMultipleTimeStepNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetNumInnerSteps()
+{
+    return mNumInnerSteps;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenMultipleTimeStepNumericalMethod<ELEMENT_DIM,SPACE_DIM>::SetNumInnerSteps(unsigned numInnerSteps)
+{
+    assert(numInnerSteps > 0);
+    mNumInnerSteps = numInnerSteps;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenMultipleTimeStepNumericalMethod<ELEMENT_DIM,SPACE_DIM>::OutputNumericalMethodParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<NumInnerSteps>" << mNumInnerSteps << "</NumInnerSteps>\n";
+
+    // Call method on direct parent class
+    AbstractNumericalMethod<ELEMENT_DIM,SPACE_DIM>::OutputNumericalMethodParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class NissenMultipleTimeStepNumericalMethod<1,1>;
+template class NissenMultipleTimeStepNumericalMethod<1,2>;
+template class NissenMultipleTimeStepNumericalMethod<2,2>;
+template class NissenMultipleTimeStepNumericalMethod<1,3>;
+template class NissenMultipleTimeStepNumericalMethod<2,3>;
+template class NissenMultipleTimeStepNumericalMethod<3,3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(NissenMultipleTimeStepNumericalMethod)
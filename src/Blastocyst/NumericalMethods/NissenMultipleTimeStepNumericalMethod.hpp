@@ -0,0 +1,100 @@
+
+#ifndef NISSENMULTIPLETIMESTEPNUMERICALMETHOD_HPP_
+#define NISSENMULTIPLETIMESTEPNUMERICALMETHOD_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "AbstractNumericalMethod.hpp"
+#include "AbstractNissenTwoBodyForce.hpp"
+
+/**
+ * A multiple-time-step forward Euler numerical method, which evaluates the stiff short-range part of the Dhall
+ * two-body forces more often than the rest.
+ *
+ * Each simulation time step (the outer step) begins by evaluating the slow part of every force once: for the
+ * Dhall two-body forces this is the attraction, the polarity terms and the repulsion beyond the fast range (see
+ * AbstractNissenTwoBodyForce::CombineForceComponents()), and any other force (such as NissenNoiseForce) is
+ * wholly slow. The outer step is then divided into mNumInnerSteps inner steps, at each of which only the fast
+ * part of the Dhall forces (the switched repulsion between close pairs) is evaluated again, and the nodes are
+ * moved by the sum of the fast force and the slow force held from the start of the outer step.
+ *
+ * Since the fast part is zero beyond a short range, an inner step only computes the forces between the close
+ * pairs, so the outer step may be set mNumInnerSteps times longer than a forward Euler step would allow for a
+ * fraction of the pair work. The polarity modifiers, which run once per simulation time step, are also
+ * updated at the outer step. Forces on ghost nodes are not supported.
+ */
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
+class NissenMultipleTimeStepNumericalMethod : public AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM>
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the object and its member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM> >(*this);
+        archive & mNumInnerSteps;
+    }
+
+    /** The number of inner steps in each simulation time step. Defaults to 4. */
+    unsigned mNumInnerSteps;
+
+    /**
+     * Clear the applied forces, add the contribution of the selected part of each force and return the
+     * resulting forces divided by the damping constants, in the order of the node iterator.
+     *
+     * @param forceComponent the part of the Dhall two-body forces to evaluate; other forces are only
+     *     evaluated with the slow part
+     * @return the damped forces
+     */
+    std::vector<c_vector<double, SPACE_DIM> > ComputeForceComponentIncludingDamping(typename AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>::ForceComponent forceComponent);
+
+public:
+
+    /**
+     * Constructor.
+     */
+    NissenMultipleTimeStepNumericalMethod();
+
+    /**
+     * Destructor.
+     */
+    virtual ~NissenMultipleTimeStepNumericalMethod();
+
+    /**
+     * Overridden UpdateAllNodePositions() method.
+     *
+     * @param dt the simulation time step, which is the outer step
+     */
+    virtual void UpdateAllNodePositions(double dt);
+
+    /** @return mNumInnerSteps */
+    unsigned GetNumInnerSteps();
+
+    /**
+     * Set mNumInnerSteps.
+     *
+     * @param numInnerSteps the number of inner steps in each simulation time step
+     */
+    void SetNumInnerSteps(unsigned numInnerSteps);
+
+    /**
+     * Overridden OutputNumericalMethodParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputNumericalMethodParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(NissenMultipleTimeStepNumericalMethod)
+
+#endif /*NISSENMULTIPLETIMESTEPNUMERICALMETHOD_HPP_*/
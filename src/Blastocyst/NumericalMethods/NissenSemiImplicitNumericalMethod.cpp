@@ -0,0 +1,249 @@
+
+#include "NissenSemiImplicitNumericalMethod.hpp"
+#include "AbstractNissenTwoBodyForce.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "NissenPairGeometryCache.hpp"
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <climits>
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+NissenSemiImplicitNumericalMethod<ELEMENT_DIM,SPACE_DIM>::NissenSemiImplicitNumericalMethod()
+    : AbstractNumericalMethod<ELEMENT_DIM,SPACE_DIM>(),
+      mMaxIterations(20),
+      mRelativeTolerance(1e-6),
+      mNumIterations(0)
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+NissenSemiImplicitNumericalMethod<ELEMENT_DIM,SPACE_DIM>::~NissenSemiImplicitNumericalMethod()
+{
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenSemiImplicitNumericalMethod<ELEMENT_DIM,SPACE_DIM>::UpdateAllNodePositions(double dt)
+{
+    NodeBasedCellPopulation<SPACE_DIM>* p_node_based_population = dynamic_cast<NodeBasedCellPopulation<SPACE_DIM>*>(this->mpCellPopulation);
+    if (p_node_based_population == nullptr)
+    {
+        EXCEPTION("NissenSemiImplicitNumericalMethod is only implemented for use with a NodeBasedCellPopulation");
+    }
+
+    // The forces divided by the damping constants, in the order of the node iterator
+    std::vector<c_vector<double, SPACE_DIM> > velocities = this->ComputeForcesIncludingDamping();
+
+    AbstractMesh<ELEMENT_DIM, SPACE_DIM>& r_mesh = this->mpCellPopulation->rGetMesh();
+    std::vector<unsigned> node_indices;
+    std::vector<double> dampings;
+    node_indices.reserve(velocities.size());
+    dampings.reserve(velocities.size());
+    unsigned max_index = 0;
+    for (typename AbstractMesh<ELEMENT_DIM, SPACE_DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        node_indices.push_back(node_iter->GetIndex());
+        dampings.push_back(this->mpCellPopulation->GetDampingConstant(node_iter->GetIndex()));
+        max_index = std::max(max_index, node_iter->GetIndex());
+    }
+    unsigned num_nodes = node_indices.size();
+
+    // Halo nodes are not iterated over, so are left without a row
+    std::vector<unsigned> row_of_node(max_index + 1, UINT_MAX);
+    for (unsigned a=0; a<num_nodes; a++)
+    {
+        row_of_node[node_indices[a]] = a;
+    }
+
+    std::vector<AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>*> nissen_forces;
+    for (typename std::vector<boost::shared_ptr<AbstractForce<ELEMENT_DIM, SPACE_DIM> > >::iterator iter = this->mpForceCollection->begin();
+         iter != this->mpForceCollection->end();
+         ++iter)
+    {
+        AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>* p_force = dynamic_cast<AbstractNissenTwoBodyForce<ELEMENT_DIM, SPACE_DIM>*>(iter->get());
+        if (p_force != nullptr)
+        {
+            nissen_forces.push_back(p_force);
+        }
+    }
+
+    /*
+     * The blocks k_AB u_AB u_AB^T of the stiff pairs. Each joins two rows, or for a pair with a halo
+     * node one row and UINT_MAX, in which case it only adds to the diagonal block of that row.
+     */
+    std::vector<std::pair<unsigned, unsigned> > stiff_pairs;
+    std::vector<c_matrix<double, SPACE_DIM, SPACE_DIM> > blocks;
+    std::vector<c_matrix<double, SPACE_DIM, SPACE_DIM> > diagonal_blocks(num_nodes, zero_matrix<double>(SPACE_DIM, SPACE_DIM));
+
+    const std::vector<typename NissenPairGeometryCache<SPACE_DIM>::PairGeometry>& r_pairs =
+        NissenPairGeometryCache<SPACE_DIM>::Instance()->rGetPairs(*p_node_based_population);
+    for (unsigned i=0; i<r_pairs.size(); i++)
+    {
+        const typename NissenPairGeometryCache<SPACE_DIM>::PairGeometry& r_pair = r_pairs[i];
+        if (r_pair.mDistance <= 0.0)
+        {
+            continue;
+        }
+
+        double stiffness = 0.0;
+        for (unsigned f=0; f<nissen_forces.size(); f++)
+        {
+            stiffness += nissen_forces[f]->CalculatePairStiffness(r_pair.mNodeAIndex, r_pair.mNodeBIndex, r_pair.mDistance, *(this->mpCellPopulation));
+        }
+        if (stiffness <= 0.0)
+        {
+            continue;
+        }
+
+        unsigned a = (r_pair.mNodeAIndex <= max_index) ? row_of_node[r_pair.mNodeAIndex] : UINT_MAX;
+        unsigned b = (r_pair.mNodeBIndex <= max_index) ? row_of_node[r_pair.mNodeBIndex] : UINT_MAX;
+        if (a == UINT_MAX && b == UINT_MAX)
+        {
+            continue;
+        }
+
+        c_vector<double, SPACE_DIM> unit_vector = r_pair.mVectorFromAtoB/r_pair.mDistance;
+        c_matrix<double, SPACE_DIM, SPACE_DIM> block = stiffness*outer_prod(unit_vector, unit_vector);
+        if (a != UINT_MAX)
+        {
+            diagonal_blocks[a] += block;
+        }
+        if (b != UINT_MAX)
+        {
+            diagonal_blocks[b] += block;
+        }
+        if (a != UINT_MAX && b != UINT_MAX)
+        {
+            stiff_pairs.push_back(std::make_pair(a, b));
+            blocks.push_back(block);
+        }
+    }
+
+    // Gather the off-diagonal blocks of each row, as the rows of the matrix are assembled in order
+    std::vector<unsigned> row_starts(num_nodes + 1, 0);
+    for (unsigned p=0; p<stiff_pairs.size(); p++)
+    {
+        row_starts[stiff_pairs[p].first + 1]++;
+        row_starts[stiff_pairs[p].second + 1]++;
+    }
+    for (unsigned a=0; a<num_nodes; a++)
+    {
+        row_starts[a+1] += row_starts[a];
+    }
+    std::vector<unsigned> next_entry(row_starts.begin(), row_starts.end() - 1);
+    std::vector<unsigned> neighbours(row_starts[num_nodes]);
+    std::vector<unsigned> neighbour_blocks(row_starts[num_nodes]);
+    for (unsigned p=0; p<stiff_pairs.size(); p++)
+    {
+        unsigned a = stiff_pairs[p].first;
+        unsigned b = stiff_pairs[p].second;
+        neighbours[next_entry[a]] = b;
+        neighbour_blocks[next_entry[a]++] = p;
+        neighbours[next_entry[b]] = a;
+        neighbour_blocks[next_entry[b]++] = p;
+    }
+
+    mMatrix.Clear(SPACE_DIM*num_nodes);
+    std::vector<double> rhs(SPACE_DIM*num_nodes);
+    std::vector<double> displacements(SPACE_DIM*num_nodes);
+    for (unsigned a=0; a<num_nodes; a++)
+    {
+        for (unsigned i=0; i<SPACE_DIM; i++)
+        {
+            for (unsigned j=0; j<SPACE_DIM; j++)
+            {
+                double value = diagonal_blocks[a](i,j);
+                if (i == j)
+                {
+                    value += dampings[a]/dt;
+                }
+                mMatrix.AddEntry(SPACE_DIM*a + j, value);
+            }
+            for (unsigned k=row_starts[a]; k<row_starts[a+1]; k++)
+            {
+                for (unsigned j=0; j<SPACE_DIM; j++)
+                {
+                    mMatrix.AddEntry(SPACE_DIM*neighbours[k] + j, -blocks[neighbour_blocks[k]](i,j));
+                }
+            }
+            mMatrix.FinishRow();
+
+            rhs[SPACE_DIM*a + i] = dampings[a]*velocities[a][i];
+            displacements[SPACE_DIM*a + i] = dt*velocities[a][i];
+        }
+    }
+
+    mNumIterations = mMatrix.SolveWithConjugateGradient(rhs, displacements, mRelativeTolerance, mMaxIterations);
+
+    unsigned index = 0;
+    for (typename AbstractMesh<ELEMENT_DIM, SPACE_DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter, ++index)
+    {
+        c_vector<double, SPACE_DIM> displacement;
+        for (unsigned i=0; i<SPACE_DIM; i++)
+        {
+            displacement[i] = displacements[SPACE_DIM*index + i];
+        }
+        this->DetectStepSizeExceptions(node_iter->GetIndex(), displacement, dt);
+
+        c_vector<double, SPACE_DIM> new_location = node_iter->rGetLocation() + displacement;
+        this->SafeNodePositionUpdate(node_iter->GetIndex(), new_location);
+    }
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenSemiImplicitNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetMaxIterations()
+{
+    return mMaxIterations;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenSemiImplicitNumericalMethod<ELEMENT_DIM,SPACE_DIM>::SetMaxIterations(unsigned maxIterations)
+{
+    assert(maxIterations > 0);
+    mMaxIterations = maxIterations;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double NissenSemiImplicitNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetRelativeTolerance()
+{
+    return mRelativeTolerance;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenSemiImplicitNumericalMethod<ELEMENT_DIM,SPACE_DIM>::SetRelativeTolerance(double relativeTolerance)
+{
+    assert(relativeTolerance > 0.0);
+    mRelativeTolerance = relativeTolerance;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+unsigned NissenSemiImplicitNumericalMethod<ELEMENT_DIM,SPACE_DIM>::GetNumIterationsInLastStep()
+{
+    return mNumIterations;
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void NissenSemiImplicitNumericalMethod<ELEMENT_DIM,SPACE_DIM>::OutputNumericalMethodParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<MaxIterations>" << mMaxIterations << "</MaxIterations>\n";
+    *rParamsFile << "\t\t\t<RelativeTolerance>" << mRelativeTolerance << "</RelativeTolerance>\n";
+
+    // Call method on direct parent class
+    AbstractNumericalMethod<ELEMENT_DIM,SPACE_DIM>::OutputNumericalMethodParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class NissenSemiImplicitNumericalMethod<1,1>;
+template class NissenSemiImplicitNumericalMethod<1,2>;
+template class NissenSemiImplicitNumericalMethod<2,2>;
+template class NissenSemiImplicitNumericalMethod<1,3>;
+template class NissenSemiImplicitNumericalMethod<2,3>;
+template class NissenSemiImplicitNumericalMethod<3,3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(NissenSemiImplicitNumericalMethod)
@@ -0,0 +1,118 @@
+
+#ifndef NISSENSEMIIMPLICITNUMERICALMETHOD_HPP_
+#define NISSENSEMIIMPLICITNUMERICALMETHOD_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "AbstractNumericalMethod.hpp"
+#include "SparseSymmetricMatrix.hpp"
+
+/**
+ * A linearly implicit (semi-implicit) Euler numerical method, which treats the repulsion between close pairs
+ * implicitly and everything else explicitly.
+ *
+ * In a dense compacted morula the forward Euler step is limited by the steep short-range repulsion of the
+ * Nissen potentials rather than by the accuracy wanted. This method linearises that repulsion about the
+ * current configuration and takes a backward Euler step with it: with eta_A the damping constant of node A,
+ * F_A the total force on it and k_AB the radial stiffness of the repulsion between A and B (given analytically
+ * by AbstractNissenTwoBodyForce::CalculatePairStiffness()), the displacements solve
+ *
+ *     (eta_A/dt) dx_A + sum_B k_AB u_AB u_AB^T (dx_A - dx_B) = F_A,
+ *
+ * where u_AB is the unit vector between the nodes. The transverse part of the Jacobian, which may be
+ * indefinite, is left out, so the matrix is symmetric positive definite and the system is solved by a few
+ * iterations of the Jacobi-preconditioned conjugate gradient method, starting from the forward Euler step.
+ * Leaving terms out of the Jacobian changes the stability of the step but not the configurations at which
+ * the nodes come to rest.
+ *
+ * Only NodeBasedCellPopulation is supported, as the pairs are taken from NissenPairGeometryCache. In a
+ * distributed run each process solves for its own nodes and holds its halo nodes fixed over the step.
+ */
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM=ELEMENT_DIM>
+class NissenSemiImplicitNumericalMethod : public AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM>
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the object and its member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractNumericalMethod<ELEMENT_DIM, SPACE_DIM> >(*this);
+        archive & mMaxIterations;
+        archive & mRelativeTolerance;
+    }
+
+    /** The largest number of conjugate gradient iterations in each time step. Defaults to 20. */
+    unsigned mMaxIterations;
+
+    /** The reduction in the residual at which the conjugate gradient iterations stop. Defaults to 1e-6. */
+    double mRelativeTolerance;
+
+    /** The number of conjugate gradient iterations in the last call to UpdateAllNodePositions(). */
+    unsigned mNumIterations;
+
+    /** The linear system, kept between time steps so that its storage is reused. */
+    SparseSymmetricMatrix mMatrix;
+
+public:
+
+    /**
+     * Constructor.
+     */
+    NissenSemiImplicitNumericalMethod();
+
+    /**
+     * Destructor.
+     */
+    virtual ~NissenSemiImplicitNumericalMethod();
+
+    /**
+     * Overridden UpdateAllNodePositions() method.
+     *
+     * @param dt the simulation time step
+     */
+    virtual void UpdateAllNodePositions(double dt);
+
+    /** @return mMaxIterations */
+    unsigned GetMaxIterations();
+
+    /**
+     * Set mMaxIterations.
+     *
+     * @param maxIterations the largest number of conjugate gradient iterations in each time step
+     */
+    void SetMaxIterations(unsigned maxIterations);
+
+    /** @return mRelativeTolerance */
+    double GetRelativeTolerance();
+
+    /**
+     * Set mRelativeTolerance.
+     *
+     * @param relativeTolerance the reduction in the residual at which the iterations stop
+     */
+    void SetRelativeTolerance(double relativeTolerance);
+
+    /** @return the number of conjugate gradient iterations in the last time step. */
+    unsigned GetNumIterationsInLastStep();
+
+    /**
+     * Overridden OutputNumericalMethodParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputNumericalMethodParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(NissenSemiImplicitNumericalMethod)
+
+#endif /*NISSENSEMIIMPLICITNUMERICALMETHOD_HPP_*/
@@ -0,0 +1,312 @@
+
+#include "NissenFireMinimiser.hpp"
+#include "AbstractNissenTwoBodyForce.hpp"
+#include "NissenNoiseForce.hpp"
+#include "CellPopulationStateTracker.hpp"
+#include "PetscTools.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+template<unsigned DIM>
+NissenFireMinimiser<DIM>::NissenFireMinimiser(AbstractCellPopulation<DIM>& rCellPopulation)
+    : mrCellPopulation(rCellPopulation),
+      mInitialTimeStep(0.01),
+      mMaximumTimeStep(0.1),
+      mForceTolerance(1e-3),
+      mMaxDisplacement(0.05),
+      mMaxIterations(1000),
+      mNumIterations(0),
+      mFinalMaximumForce(DBL_MAX)
+{
+}
+
+template<unsigned DIM>
+NissenFireMinimiser<DIM>::NissenFireMinimiser(OffLatticeSimulation<DIM>& rSimulation)
+    : mrCellPopulation(rSimulation.rGetCellPopulation()),
+      mForceCollection(rSimulation.rGetForceCollection()),
+      mInitialTimeStep(0.01),
+      mMaximumTimeStep(0.1),
+      mForceTolerance(1e-3),
+      mMaxDisplacement(0.05),
+      mMaxIterations(1000),
+      mNumIterations(0),
+      mFinalMaximumForce(DBL_MAX)
+{
+}
+
+template<unsigned DIM>
+void NissenFireMinimiser<DIM>::AddForce(boost::shared_ptr<AbstractForce<DIM> > pForce)
+{
+    mForceCollection.push_back(pForce);
+}
+
+template<unsigned DIM>
+std::vector<c_vector<double, DIM> > NissenFireMinimiser<DIM>::ComputeDampedForces()
+{
+    AbstractMesh<DIM, DIM>& r_mesh = mrCellPopulation.rGetMesh();
+    for (typename AbstractMesh<DIM, DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        node_iter->ClearAppliedForce();
+    }
+
+    for (typename std::vector<boost::shared_ptr<AbstractForce<DIM> > >::iterator iter = mForceCollection.begin();
+         iter != mForceCollection.end();
+         ++iter)
+    {
+        // The noise is frozen along with the rest of the dynamics
+        if (dynamic_cast<NissenNoiseForce<DIM>*>(iter->get()) == nullptr)
+        {
+            (*iter)->AddForceContribution(mrCellPopulation);
+        }
+    }
+
+    std::vector<c_vector<double, DIM> > forces;
+    forces.reserve(mrCellPopulation.GetNumNodes());
+    for (typename AbstractMesh<DIM, DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        double damping = mrCellPopulation.GetDampingConstant(node_iter->GetIndex());
+        forces.push_back(node_iter->rGetAppliedForce()/damping);
+    }
+    return forces;
+}
+
+template<unsigned DIM>
+double NissenFireMinimiser<DIM>::CalculatePairRadius()
+{
+    double radius = 0.0;
+    for (typename std::vector<boost::shared_ptr<AbstractForce<DIM> > >::iterator iter = mForceCollection.begin();
+         iter != mForceCollection.end();
+         ++iter)
+    {
+        AbstractNissenTwoBodyForce<DIM>* p_force = dynamic_cast<AbstractNissenTwoBodyForce<DIM>*>(iter->get());
+        if (p_force != nullptr)
+        {
+            radius = std::max(radius, p_force->GetMaximumInteractionRange());
+        }
+        else if (dynamic_cast<NissenNoiseForce<DIM>*>(iter->get()) == nullptr)
+        {
+            return DBL_MAX;
+        }
+    }
+    return radius;
+}
+
+template<unsigned DIM>
+bool NissenFireMinimiser<DIM>::Minimise()
+{
+    // The standard FIRE parameters
+    const unsigned num_steps_before_increase = 5;
+    const double time_step_increase = 1.1;
+    const double time_step_decrease = 0.5;
+    const double initial_mixing = 0.1;
+    const double mixing_decrease = 0.99;
+
+    double pair_radius = CalculatePairRadius();
+    CellPopulationStateTracker<DIM>* p_tracker = CellPopulationStateTracker<DIM>::Instance();
+
+    double dt = mInitialTimeStep;
+    double mixing = initial_mixing;
+    unsigned num_steps_with_positive_power = 0;
+    std::vector<c_vector<double, DIM> > velocities(mrCellPopulation.GetNumNodes(), zero_vector<double>(DIM));
+
+    mNumIterations = 0;
+    mFinalMaximumForce = DBL_MAX;
+    while (true)
+    {
+        p_tracker->EnsureState(mrCellPopulation, CellPopulationStateTracker<DIM>::NODE_PAIRS, pair_radius);
+        std::vector<c_vector<double, DIM> > forces = ComputeDampedForces();
+
+        // Local sums of the power and the squared norms of the velocity and force, and the largest force
+        double local_values[3] = {0.0, 0.0, 0.0};
+        double local_maximum_force = 0.0;
+        for (unsigned i=0; i<forces.size(); i++)
+        {
+            local_values[0] += inner_prod(velocities[i], forces[i]);
+            local_values[1] += inner_prod(velocities[i], velocities[i]);
+            local_values[2] += inner_prod(forces[i], forces[i]);
+            local_maximum_force = std::max(local_maximum_force, norm_2(forces[i]));
+        }
+        double values[3] = {local_values[0], local_values[1], local_values[2]};
+        mFinalMaximumForce = local_maximum_force;
+        if (PetscTools::IsParallel())
+        {
+            MPI_Allreduce(local_values, values, 3, MPI_DOUBLE, MPI_SUM, PETSC_COMM_WORLD);
+            MPI_Allreduce(&local_maximum_force, &mFinalMaximumForce, 1, MPI_DOUBLE, MPI_MAX, PETSC_COMM_WORLD);
+        }
+
+        if (mFinalMaximumForce < mForceTolerance || mNumIterations >= mMaxIterations)
+        {
+            break;
+        }
+        mNumIterations++;
+
+        double power = values[0];
+        if (power > 0.0)
+        {
+            // Steer the velocity towards the force, keeping its magnitude
+            double velocity_norm = sqrt(values[1]);
+            double force_norm = sqrt(values[2]);
+            for (unsigned i=0; i<velocities.size(); i++)
+            {
+                velocities[i] = (1.0 - mixing)*velocities[i] + mixing*velocity_norm*forces[i]/force_norm;
+            }
+            num_steps_with_positive_power++;
+            if (num_steps_with_positive_power > num_steps_before_increase)
+            {
+                dt = std::min(dt*time_step_increase, mMaximumTimeStep);
+                mixing *= mixing_decrease;
+            }
+        }
+        else
+        {
+            // The nodes have passed a minimum along their path, so stop them and start again more cautiously
+            for (unsigned i=0; i<velocities.size(); i++)
+            {
+                velocities[i] = zero_vector<double>(DIM);
+            }
+            dt *= time_step_decrease;
+            mixing = initial_mixing;
+            num_steps_with_positive_power = 0;
+        }
+
+        double local_maximum_speed = 0.0;
+        for (unsigned i=0; i<velocities.size(); i++)
+        {
+            velocities[i] += dt*forces[i];
+            local_maximum_speed = std::max(local_maximum_speed, norm_2(velocities[i]));
+        }
+        double maximum_speed = local_maximum_speed;
+        if (PetscTools::IsParallel())
+        {
+            MPI_Allreduce(&local_maximum_speed, &maximum_speed, 1, MPI_DOUBLE, MPI_MAX, PETSC_COMM_WORLD);
+        }
+        double step = dt;
+        if (maximum_speed*step > mMaxDisplacement)
+        {
+            step = mMaxDisplacement/maximum_speed;
+        }
+
+        unsigned index = 0;
+        for (typename AbstractMesh<DIM, DIM>::NodeIterator node_iter = mrCellPopulation.rGetMesh().GetNodeIteratorBegin();
+             node_iter != mrCellPopulation.rGetMesh().GetNodeIteratorEnd();
+             ++node_iter, ++index)
+        {
+            ChastePoint<DIM> new_point(node_iter->rGetLocation() + step*velocities[index]);
+            mrCellPopulation.SetNode(node_iter->GetIndex(), new_point);
+        }
+    }
+
+    return (mFinalMaximumForce < mForceTolerance);
+}
+
+template<unsigned DIM>
+double NissenFireMinimiser<DIM>::CalculatePotentialEnergy()
+{
+    CellPopulationStateTracker<DIM>::Instance()->EnsureState(mrCellPopulation, CellPopulationStateTracker<DIM>::NODE_PAIRS, CalculatePairRadius());
+
+    double local_energy = 0.0;
+    for (typename std::vector<boost::shared_ptr<AbstractForce<DIM> > >::iterator iter = mForceCollection.begin();
+         iter != mForceCollection.end();
+         ++iter)
+    {
+        AbstractNissenTwoBodyForce<DIM>* p_force = dynamic_cast<AbstractNissenTwoBodyForce<DIM>*>(iter->get());
+        if (p_force != nullptr)
+        {
+            local_energy += p_force->CalculatePotentialEnergy(mrCellPopulation);
+        }
+    }
+
+    double energy = local_energy;
+    if (PetscTools::IsParallel())
+    {
+        MPI_Allreduce(&local_energy, &energy, 1, MPI_DOUBLE, MPI_SUM, PETSC_COMM_WORLD);
+    }
+    return energy;
+}
+
+template<unsigned DIM>
+double NissenFireMinimiser<DIM>::GetInitialTimeStep()
+{
+    return mInitialTimeStep;
+}
+
+template<unsigned DIM>
+void NissenFireMinimiser<DIM>::SetInitialTimeStep(double initialTimeStep)
+{
+    assert(initialTimeStep > 0.0);
+    mInitialTimeStep = initialTimeStep;
+}
+
+template<unsigned DIM>
+double NissenFireMinimiser<DIM>::GetMaximumTimeStep()
+{
+    return mMaximumTimeStep;
+}
+
+template<unsigned DIM>
+void NissenFireMinimiser<DIM>::SetMaximumTimeStep(double maximumTimeStep)
+{
+    assert(maximumTimeStep > 0.0);
+    mMaximumTimeStep = maximumTimeStep;
+}
+
+template<unsigned DIM>
+double NissenFireMinimiser<DIM>::GetForceTolerance()
+{
+    return mForceTolerance;
+}
+
+template<unsigned DIM>
+void NissenFireMinimiser<DIM>::SetForceTolerance(double forceTolerance)
+{
+    assert(forceTolerance > 0.0);
+    mForceTolerance = forceTolerance;
+}
+
+template<unsigned DIM>
+double NissenFireMinimiser<DIM>::GetMaxDisplacement()
+{
+    return mMaxDisplacement;
+}
+
+template<unsigned DIM>
+void NissenFireMinimiser<DIM>::SetMaxDisplacement(double maxDisplacement)
+{
+    assert(maxDisplacement > 0.0);
+    mMaxDisplacement = maxDisplacement;
+}
+
+template<unsigned DIM>
+unsigned NissenFireMinimiser<DIM>::GetMaxIterations()
+{
+    return mMaxIterations;
+}
+
+template<unsigned DIM>
+void NissenFireMinimiser<DIM>::SetMaxIterations(unsigned maxIterations)
+{
+    mMaxIterations = maxIterations;
+}
+
+template<unsigned DIM>
+unsigned NissenFireMinimiser<DIM>::GetNumIterations()
+{
+    return mNumIterations;
+}
+
+template<unsigned DIM>
+double NissenFireMinimiser<DIM>::GetFinalMaximumForce()
+{
+    return mFinalMaximumForce;
+}
+
+// Explicit instantiation
+template class NissenFireMinimiser<1>;
+template class NissenFireMinimiser<2>;
+template class NissenFireMinimiser<3>;
@@ -0,0 +1,174 @@
+
+#ifndef NISSENFIREMINIMISER_HPP_
+#define NISSENFIREMINIMISER_HPP_
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "AbstractCellPopulation.hpp"
+#include "AbstractForce.hpp"
+#include "OffLatticeSimulation.hpp"
+
+/**
+ * Relaxes a cell population to a local minimum of the energy of its forces by the FIRE (fast inertial
+ * relaxation engine) method of Bitzek et al. (2006), for the equilibration phases between calls to Solve().
+ *
+ * Instead of following the overdamped dynamics of the simulation step by step, FIRE moves the nodes with a
+ * velocity that is accelerated by the damped forces (each force divided by the node's damping constant) and
+ * steered towards them. While the velocity keeps doing work against the energy (the power, the sum over
+ * nodes of velocity dot force, is positive) the step grows up to mMaximumTimeStep and the steering relaxes;
+ * as soon as the power turns negative the nodes are stopped, the step is halved and the steering reset. No
+ * node moves further than mMaxDisplacement in one iteration, so that the steep core of the Nissen repulsion
+ * is not overshot. The iterations stop when the largest damped force on any node falls below mForceTolerance,
+ * or after mMaxIterations.
+ *
+ * Minimise() does not advance SimulationTime, so cell cycles and the SRN models are frozen, and no modifiers
+ * are run, so the cell polarities are held fixed. NissenNoiseForce is left out. Only the forces and the node
+ * locations are used, so the method works with any force; the potential energy of the Dhall forces, where it
+ * is defined (see AbstractNissenTwoBodyForce::CalculatePotentialEnergy()), may be used to check progress.
+ *
+ * The node pairs are brought up to date through CellPopulationStateTracker only when nodes have moved far
+ * enough to need it. In a distributed run the largest force and the power are taken over all processes, so
+ * every process takes the same steps.
+ */
+template<unsigned DIM>
+class NissenFireMinimiser
+{
+private:
+
+    /** The cell population. */
+    AbstractCellPopulation<DIM>& mrCellPopulation;
+
+    /** The forces whose energy is minimised. */
+    std::vector<boost::shared_ptr<AbstractForce<DIM> > > mForceCollection;
+
+    /** The first time step of the FIRE dynamics, in hours. Defaults to 0.01. */
+    double mInitialTimeStep;
+
+    /** The largest time step of the FIRE dynamics, in hours. Defaults to 0.1. */
+    double mMaximumTimeStep;
+
+    /** The largest damped force on any node at which the population is taken to be relaxed. Defaults to 1e-3. */
+    double mForceTolerance;
+
+    /** The furthest any node may move in one iteration, in cell diameters. Defaults to 0.05. */
+    double mMaxDisplacement;
+
+    /** The largest number of iterations in each call to Minimise(). Defaults to 1000. */
+    unsigned mMaxIterations;
+
+    /** The number of iterations in the last call to Minimise(). */
+    unsigned mNumIterations;
+
+    /** The largest damped force on any node at the end of the last call to Minimise(). */
+    double mFinalMaximumForce;
+
+    /**
+     * Clear the applied forces, add the contribution of each force other than NissenNoiseForce and
+     * return the resulting forces divided by the damping constants, in the order of the node iterator.
+     *
+     * @return the damped forces
+     */
+    std::vector<c_vector<double, DIM> > ComputeDampedForces();
+
+    /**
+     * @return the range within which the node pairs must be current for the forces: the largest range of
+     * any Dhall two-body force, or DBL_MAX if there is another force that may need every pair.
+     */
+    double CalculatePairRadius();
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rCellPopulation the cell population
+     */
+    NissenFireMinimiser(AbstractCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Constructor taking the population and forces of a simulation, so that its equilibration phases
+     * may be replaced by calls to Minimise() between calls to Solve().
+     *
+     * @param rSimulation the simulation
+     */
+    NissenFireMinimiser(OffLatticeSimulation<DIM>& rSimulation);
+
+    /**
+     * Add a force whose energy is minimised.
+     *
+     * @param pForce pointer to the force
+     */
+    void AddForce(boost::shared_ptr<AbstractForce<DIM> > pForce);
+
+    /**
+     * Relax the population until the largest damped force on any node is below mForceTolerance.
+     *
+     * @return whether the force tolerance was met within mMaxIterations
+     */
+    bool Minimise();
+
+    /**
+     * @return the total potential energy of the Dhall two-body forces, summed over all processes.
+     * Throws if any of them has no pair potential.
+     */
+    double CalculatePotentialEnergy();
+
+    /** @return mInitialTimeStep */
+    double GetInitialTimeStep();
+
+    /**
+     * Set mInitialTimeStep.
+     *
+     * @param initialTimeStep the first time step of the FIRE dynamics
+     */
+    void SetInitialTimeStep(double initialTimeStep);
+
+    /** @return mMaximumTimeStep */
+    double GetMaximumTimeStep();
+
+    /**
+     * Set mMaximumTimeStep.
+     *
+     * @param maximumTimeStep the largest time step of the FIRE dynamics
+     */
+    void SetMaximumTimeStep(double maximumTimeStep);
+
+    /** @return mForceTolerance */
+    double GetForceTolerance();
+
+    /**
+     * Set mForceTolerance.
+     *
+     * @param forceTolerance the largest damped force at which the population is taken to be relaxed
+     */
+    void SetForceTolerance(double forceTolerance);
+
+    /** @return mMaxDisplacement */
+    double GetMaxDisplacement();
+
+    /**
+     * Set mMaxDisplacement.
+     *
+     * @param maxDisplacement the furthest any node may move in one iteration
+     */
+    void SetMaxDisplacement(double maxDisplacement);
+
+    /** @return mMaxIterations */
+    unsigned GetMaxIterations();
+
+    /**
+     * Set mMaxIterations.
+     *
+     * @param maxIterations the largest number of iterations in each call to Minimise()
+     */
+    void SetMaxIterations(unsigned maxIterations);
+
+    /** @return the number of iterations in the last call to Minimise(). */
+    unsigned GetNumIterations();
+
+    /** @return the largest damped force on any node at the end of the last call to Minimise(). */
+    double GetFinalMaximumForce();
+};
+
+#endif /*NISSENFIREMINIMISER_HPP_*/
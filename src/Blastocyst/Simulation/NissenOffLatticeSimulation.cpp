@@ -0,0 +1,610 @@
+
+#include "NissenOffLatticeSimulation.hpp"
+#include "AbstractNissenTwoBodyForce.hpp"
+#include "AbstractCellPolarityTrackingModifier.hpp"
+#include "TrophectodermSpecificationModifier.hpp"
+#include "SteadyStateDetectionModifier.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "NissenPairGeometryCache.hpp"
+#include "NissenBasedDivisionRule.hpp"
+#include "PreCompactionCellCycleModel.hpp"
+#include "CellPopulationStateTracker.hpp"
+#include "NissenAdaptiveNumericalMethod.hpp"
+#include "NissenHealthMonitoredNumericalMethod.hpp"
+#include "NissenLocalTimeSteppingNumericalMethod.hpp"
+#include "OutputFileHandler.hpp"
+#include "PetscTools.hpp"
+#include "SimulationTime.hpp"
+#include "Warnings.hpp"
+
+#include <algorithm>
+#include <cfloat>
+
+template<unsigned DIM>
+NissenOffLatticeSimulation<DIM>::NissenOffLatticeSimulation(AbstractCellPopulation<DIM>& rCellPopulation,
+                                                            bool deleteCellPopulationInDestructor,
+                                                            bool initialiseCells)
+    : OffLatticeSimulation<DIM>(rCellPopulation, deleteCellPopulationInDestructor, initialiseCells),
+      mUseAutomaticInteractionDistance(true),
+      mInteractionDistanceMargin(DBL_MAX),
+      mMaximumForceRange(DBL_MAX),
+      mNumCandidatePairs(0),
+      mNumRejectedPairs(0),
+      mCurrentPhase(0)
+{
+}
+
+template<unsigned DIM>
+NissenOffLatticeSimulation<DIM>::~NissenOffLatticeSimulation()
+{
+    if (mpPairRejectionFile)
+    {
+        mpPairRejectionFile->close();
+    }
+    if (mpAdaptiveTimeStepFile)
+    {
+        mpAdaptiveTimeStepFile->close();
+    }
+    if (mpPhaseFile)
+    {
+        mpPhaseFile->close();
+    }
+    if (mpHealthMonitorFile)
+    {
+        mpHealthMonitorFile->close();
+    }
+}
+
+template<unsigned DIM>
+double NissenOffLatticeSimulation<DIM>::CalculateMaximumInteractionRange()
+{
+    mMaximumForceRange = 0.0;
+    bool has_nissen_force = false;
+    for (typename std::vector<boost::shared_ptr<AbstractForce<DIM> > >::iterator iter = this->mForceCollection.begin();
+         iter != this->mForceCollection.end();
+         ++iter)
+    {
+        AbstractNissenTwoBodyForce<DIM>* p_force = dynamic_cast<AbstractNissenTwoBodyForce<DIM>*>(iter->get());
+        if (p_force != nullptr)
+        {
+            has_nissen_force = true;
+            mMaximumForceRange = std::max(mMaximumForceRange, p_force->GetMaximumInteractionRange());
+        }
+    }
+    if (!has_nissen_force)
+    {
+        // Nothing is known about the range of any other forces, so no pairs can be counted as rejected
+        mMaximumForceRange = DBL_MAX;
+        return 0.0;
+    }
+
+    double range = mMaximumForceRange;
+    for (typename std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM> > >::iterator iter = this->mSimulationModifiers.begin();
+         iter != this->mSimulationModifiers.end();
+         ++iter)
+    {
+        AbstractCellPolarityTrackingModifier<DIM>* p_modifier = dynamic_cast<AbstractCellPolarityTrackingModifier<DIM>*>(iter->get());
+        if (p_modifier != nullptr)
+        {
+            range = std::max(range, p_modifier->GetCouplingRadius());
+        }
+    }
+    return range;
+}
+
+template<unsigned DIM>
+unsigned NissenOffLatticeSimulation<DIM>::DoCellBirth()
+{
+    if (this->mNoBirth)
+    {
+        return 0;
+    }
+
+    if (mDivisionSchedule.GetNumCells() != this->mrCellPopulation.GetNumRealCells())
+    {
+        // Cells have been removed (or added other than by division) since the schedule was last updated
+        mDivisionSchedule.Rebuild(this->mrCellPopulation);
+    }
+
+    // Cells specified as trophectoderm since the last time step have new cell-cycle durations
+    RescheduleNewlySpecifiedCells();
+
+    /*
+     * Cell::ReadyToDivide() runs each cell's SRN model and updates the phase and other age-dependent state of
+     * its cell-cycle model, which writers, forces and other cell-cycle models may read, so it is still called
+     * for every cell. This is cheap; the schedule saves the room-to-divide test and the division decision.
+     */
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = this->mrCellPopulation.Begin();
+         cell_iter != this->mrCellPopulation.End();
+         ++cell_iter)
+    {
+        cell_iter->ReadyToDivide();
+    }
+
+    // Only ask the cells due to divide by now (to within half a time step) whether they are ready
+    std::vector<CellPtr> due_cells;
+    mDivisionSchedule.PopDueCells(SimulationTime::Instance()->GetTime() + 0.5*this->mDt, due_cells);
+
+    std::vector<CellPtr> dividing_cells;
+    for (unsigned i=0; i<due_cells.size(); i++)
+    {
+        if (due_cells[i]->GetAge() > 0.0
+            && due_cells[i]->ReadyToDivide()
+            && this->mrCellPopulation.IsRoomToDivide(due_cells[i]))
+        {
+            dividing_cells.push_back(due_cells[i]);
+        }
+        else
+        {
+            // Check again next time step
+            mDivisionSchedule.Schedule(due_cells[i]);
+        }
+    }
+
+    if (dividing_cells.empty())
+    {
+        return 0;
+    }
+
+    // Compute the daughter positions for the whole batch together
+    AbstractCentreBasedCellPopulation<DIM>* p_centre_based_population = dynamic_cast<AbstractCentreBasedCellPopulation<DIM>*>(&this->mrCellPopulation);
+    if (p_centre_based_population != nullptr)
+    {
+        NissenBasedDivisionRule<DIM>* p_division_rule =
+            dynamic_cast<NissenBasedDivisionRule<DIM>*>(p_centre_based_population->GetCentreBasedDivisionRule().get());
+        if (p_division_rule != nullptr)
+        {
+            p_division_rule->CalculateDivisionVectorsForBatch(dividing_cells, *p_centre_based_population);
+        }
+    }
+
+    for (unsigned i=0; i<dividing_cells.size(); i++)
+    {
+        // Record the division as AbstractCellBasedSimulation::DoCellBirth() does
+        if (this->mOutputDivisionLocations)
+        {
+            c_vector<double, DIM> cell_location = this->mrCellPopulation.GetLocationOfCellCentre(dividing_cells[i]);
+            *(this->mpDivisionLocationFile) << SimulationTime::Instance()->GetTime() << "\t";
+            for (unsigned j=0; j<DIM; j++)
+            {
+                *(this->mpDivisionLocationFile) << cell_location[j] << "\t";
+            }
+            *(this->mpDivisionLocationFile) << "\t" << dividing_cells[i]->GetAge() << "\t" << dividing_cells[i]->GetCellId() << "\n";
+        }
+
+        CellPtr p_new_cell = dividing_cells[i]->Divide();
+        this->mrCellPopulation.AddCell(p_new_cell, dividing_cells[i]);
+
+        // Both cells now have new cell-cycle durations
+        mDivisionSchedule.Schedule(dividing_cells[i]);
+        mDivisionSchedule.Schedule(p_new_cell);
+    }
+
+    return dividing_cells.size();
+}
+
+template<unsigned DIM>
+void NissenOffLatticeSimulation<DIM>::RescheduleDivision(CellPtr pCell)
+{
+    PreCompactionCellCycleModel* p_model = dynamic_cast<PreCompactionCellCycleModel*>(pCell->GetCellCycleModel());
+    if (p_model != nullptr)
+    {
+        p_model->RescaleCellCycleDurationForType();
+    }
+    mDivisionSchedule.Schedule(pCell);
+}
+
+template<unsigned DIM>
+void NissenOffLatticeSimulation<DIM>::RescheduleNewlySpecifiedCells()
+{
+    for (typename std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM> > >::iterator iter = this->mSimulationModifiers.begin();
+         iter != this->mSimulationModifiers.end();
+         ++iter)
+    {
+        TrophectodermSpecificationModifier<DIM>* p_modifier = dynamic_cast<TrophectodermSpecificationModifier<DIM>*>(iter->get());
+        if (p_modifier != nullptr)
+        {
+            const std::vector<CellPtr>& r_cells = p_modifier->rGetNewlySpecifiedCells();
+            for (unsigned i=0; i<r_cells.size(); i++)
+            {
+                if (!r_cells[i]->IsDead())
+                {
+                    RescheduleDivision(r_cells[i]);
+                }
+            }
+            p_modifier->ClearNewlySpecifiedCells();
+        }
+    }
+}
+
+template<unsigned DIM>
+void NissenOffLatticeSimulation<DIM>::SetupSolve()
+{
+    OffLatticeSimulation<DIM>::SetupSolve();
+
+    // Proliferative types may have been changed since the last Solve(), so schedule every cell afresh
+    mDivisionSchedule.Rebuild(this->mrCellPopulation);
+
+    if (mpAdaptiveTimeStepFile)
+    {
+        mpAdaptiveTimeStepFile->close();
+    }
+    if (dynamic_cast<NissenAdaptiveNumericalMethod<DIM>*>(this->mpNumericalMethod.get()) != nullptr)
+    {
+        // Every process takes the same substeps, so only the master needs to record them
+        OutputFileHandler output_file_handler(this->mSimulationOutputDirectory + "/", false);
+        if (PetscTools::AmMaster())
+        {
+            mpAdaptiveTimeStepFile = output_file_handler.OpenOutputFile("adaptivetimestep.dat");
+            *mpAdaptiveTimeStepFile << "# time\tnum_substeps\tnum_rejected_substeps\tsmallest_substep\tlargest_substep\n";
+        }
+    }
+
+    if (mpHealthMonitorFile)
+    {
+        mpHealthMonitorFile->close();
+    }
+    if (dynamic_cast<NissenHealthMonitoredNumericalMethod<DIM>*>(this->mpNumericalMethod.get()) != nullptr)
+    {
+        // The checks are combined over all processes, so only the master needs to record them
+        OutputFileHandler output_file_handler(this->mSimulationOutputDirectory + "/", false);
+        if (PetscTools::AmMaster())
+        {
+            mpHealthMonitorFile = output_file_handler.OpenOutputFile("healthmonitor.dat");
+            *mpHealthMonitorFile << "# time\tfailed_check\tnum_substeps\n";
+        }
+    }
+
+    if (!mPhases.empty())
+    {
+        if (mpPhaseFile)
+        {
+            mpPhaseFile->close();
+        }
+        OutputFileHandler output_file_handler(this->mSimulationOutputDirectory + "/", false);
+        if (PetscTools::AmMaster())
+        {
+            mpPhaseFile = output_file_handler.OpenOutputFile("phases.dat");
+            *mpPhaseFile << "# time\tphase\tname\n";
+        }
+
+        // The modifiers of the first phase are set up by Solve() along with the others
+        if (mCurrentPhase == 0 && mPhases[0]->GetStartTime() < 0.0)
+        {
+            StartCurrentPhase(false);
+        }
+    }
+
+    ConfigurePolarityModifiers();
+
+    if (dynamic_cast<NodeBasedCellPopulation<DIM>*>(&this->mrCellPopulation) == nullptr)
+    {
+        return;
+    }
+
+    UpdateMaximumInteractionDistance();
+
+    if (mpPairRejectionFile)
+    {
+        mpPairRejectionFile->close();
+    }
+    // The counts are summed over all processes, so only the master needs to record them
+    OutputFileHandler output_file_handler(this->mSimulationOutputDirectory + "/", false);
+    if (PetscTools::AmMaster())
+    {
+        mpPairRejectionFile = output_file_handler.OpenOutputFile("pairrejection.dat");
+        *mpPairRejectionFile << "# time\tnum_candidate_pairs\tnum_rejected_pairs\n";
+    }
+}
+
+template<unsigned DIM>
+void NissenOffLatticeSimulation<DIM>::UpdateMaximumInteractionDistance()
+{
+    NodeBasedCellPopulation<DIM>* p_node_based_population = dynamic_cast<NodeBasedCellPopulation<DIM>*>(&this->mrCellPopulation);
+    if (p_node_based_population == nullptr)
+    {
+        return;
+    }
+
+    double range = CalculateMaximumInteractionRange();
+    if (mUseAutomaticInteractionDistance)
+    {
+        if (range == DBL_MAX)
+        {
+            WARN_ONCE_ONLY("A Nissen force has no cutoff length, so the maximum interaction distance of the mesh has not been changed.");
+        }
+        else if (range > 0.0)
+        {
+            NodesOnlyMesh<DIM>& r_mesh = p_node_based_population->rGetMesh();
+            // Unless a margin has been set, leave the state tracker a skin of a tenth of the range
+            double margin = (mInteractionDistanceMargin == DBL_MAX) ? 0.1*range : mInteractionDistanceMargin;
+            r_mesh.SetMaximumInteractionDistance(range + margin);
+
+            // Rebuild the box collection with boxes of the new width, then find the node pairs again
+            std::vector<Node<DIM>*> nodes;
+            for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+                 node_iter != r_mesh.GetNodeIteratorEnd();
+                 ++node_iter)
+            {
+                nodes.push_back(&(*node_iter));
+            }
+            r_mesh.SetUpBoxCollection(nodes);
+
+            this->mrCellPopulation.Update();
+            CellPopulationStateTracker<DIM>::Instance()->RecordUpdate(this->mrCellPopulation);
+            NissenPairGeometryCache<DIM>::Instance()->Invalidate();
+        }
+    }
+}
+
+template<unsigned DIM>
+void NissenOffLatticeSimulation<DIM>::StartCurrentPhase(bool isDuringSolve)
+{
+    NissenSimulationPhase<DIM>& r_phase = *(mPhases[mCurrentPhase]);
+    r_phase.SetStartTime(SimulationTime::Instance()->GetTime());
+
+    if (!r_phase.rGetForceCollection().empty())
+    {
+        // Replace the contents of the collection in place, as the numerical method holds a pointer to it
+        this->mForceCollection = r_phase.rGetForceCollection();
+    }
+
+    const std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM,DIM> > >& r_modifiers = r_phase.rGetSimulationModifiers();
+    for (unsigned i=0; i<r_modifiers.size(); i++)
+    {
+        this->mSimulationModifiers.push_back(r_modifiers[i]);
+        if (isDuringSolve)
+        {
+            r_modifiers[i]->SetupSolve(this->mrCellPopulation, this->mSimulationOutputDirectory);
+        }
+    }
+
+    // Writers added now are written from the next sampling time step, appending to their files
+    for (unsigned i=0; i<r_phase.rGetCellWriters().size(); i++)
+    {
+        this->mrCellPopulation.AddCellWriter(r_phase.rGetCellWriters()[i]);
+    }
+    for (unsigned i=0; i<r_phase.rGetCellPopulationCountWriters().size(); i++)
+    {
+        this->mrCellPopulation.AddCellPopulationCountWriter(r_phase.rGetCellPopulationCountWriters()[i]);
+    }
+
+    if (isDuringSolve)
+    {
+        ConfigurePolarityModifiers();
+        UpdateMaximumInteractionDistance();
+    }
+
+    if (mpPhaseFile)
+    {
+        *mpPhaseFile << r_phase.GetStartTime() << "\t" << mCurrentPhase << "\t" << r_phase.rGetName() << "\n";
+    }
+}
+
+template<unsigned DIM>
+void NissenOffLatticeSimulation<DIM>::EndCurrentPhase()
+{
+    NissenSimulationPhase<DIM>& r_phase = *(mPhases[mCurrentPhase]);
+    r_phase.SetEndTime(SimulationTime::Instance()->GetTime());
+
+    // Cells specified by a modifier of this phase must be rescheduled before the modifier is removed
+    RescheduleNewlySpecifiedCells();
+
+    const std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM,DIM> > >& r_modifiers = r_phase.rGetSimulationModifiers();
+    for (unsigned i=0; i<r_modifiers.size(); i++)
+    {
+        r_modifiers[i]->UpdateAtEndOfSolve(this->mrCellPopulation);
+        typename std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM> > >::iterator iter =
+            std::find(this->mSimulationModifiers.begin(), this->mSimulationModifiers.end(), r_modifiers[i]);
+        if (iter != this->mSimulationModifiers.end())
+        {
+            this->mSimulationModifiers.erase(iter);
+        }
+    }
+
+    mCurrentPhase++;
+}
+
+template<unsigned DIM>
+bool NissenOffLatticeSimulation<DIM>::StoppingEventHasOccurred()
+{
+    if (!mPhases.empty())
+    {
+        // A phase may end as soon as it starts, for example if the cells have already reached its target number
+        while (mCurrentPhase < mPhases.size() && mPhases[mCurrentPhase]->HasEnded(this->mrCellPopulation))
+        {
+            EndCurrentPhase();
+            if (mCurrentPhase < mPhases.size())
+            {
+                StartCurrentPhase(true);
+            }
+        }
+        if (mCurrentPhase == mPhases.size())
+        {
+            return true;
+        }
+    }
+
+    for (typename std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM> > >::iterator iter = this->mSimulationModifiers.begin();
+         iter != this->mSimulationModifiers.end();
+         ++iter)
+    {
+        SteadyStateDetectionModifier<DIM>* p_modifier = dynamic_cast<SteadyStateDetectionModifier<DIM>*>(iter->get());
+        if (p_modifier != nullptr && p_modifier->HasReachedSteadyState())
+        {
+            return true;
+        }
+    }
+    return OffLatticeSimulation<DIM>::StoppingEventHasOccurred();
+}
+
+template<unsigned DIM>
+void NissenOffLatticeSimulation<DIM>::UpdateCellLocationsAndTopology()
+{
+    // The population was updated after this step's births and deaths, so its node pairs are current
+    if (this->mUpdateCellPopulation)
+    {
+        CellPopulationStateTracker<DIM>::Instance()->RecordUpdate(this->mrCellPopulation);
+    }
+
+    // Every process samples, as the counts are summed over all of them
+    if (SimulationTime::Instance()->GetTimeStepsElapsed()%this->mSamplingTimestepMultiple == 0)
+    {
+        SamplePairRejection();
+    }
+
+    OffLatticeSimulation<DIM>::UpdateCellLocationsAndTopology();
+
+    if (mpAdaptiveTimeStepFile)
+    {
+        NissenAdaptiveNumericalMethod<DIM>* p_method = static_cast<NissenAdaptiveNumericalMethod<DIM>*>(this->mpNumericalMethod.get());
+        *mpAdaptiveTimeStepFile << SimulationTime::Instance()->GetTime() << "\t"
+                                << p_method->GetNumSubstepsInLastStep() << "\t"
+                                << p_method->GetNumRejectedSubstepsInLastStep() << "\t"
+                                << p_method->GetSmallestSubstepInLastStep() << "\t"
+                                << p_method->GetLargestSubstepInLastStep() << "\n";
+    }
+
+    if (mpHealthMonitorFile)
+    {
+        typedef NissenHealthMonitoredNumericalMethod<DIM> HealthMonitoredMethod;
+        HealthMonitoredMethod* p_method = static_cast<HealthMonitoredMethod*>(this->mpNumericalMethod.get());
+        const std::vector<typename HealthMonitoredMethod::HealthEvent>& r_events = p_method->rGetEventsInLastStep();
+        for (unsigned i=0; i<r_events.size(); i++)
+        {
+            *mpHealthMonitorFile << r_events[i].mTime << "\t"
+                                 << HealthMonitoredMethod::GetCheckName(r_events[i].mFailedCheck) << "\t"
+                                 << r_events[i].mNumSubsteps << "\n";
+        }
+    }
+}
+
+template<unsigned DIM>
+void NissenOffLatticeSimulation<DIM>::SamplePairRejection()
+{
+    NodeBasedCellPopulation<DIM>* p_node_based_population = dynamic_cast<NodeBasedCellPopulation<DIM>*>(&this->mrCellPopulation);
+    if (p_node_based_population == nullptr)
+    {
+        return;
+    }
+
+    // Use the shared cache, so that the forces evaluated next do not have to compute the pair geometry again
+    const std::vector<typename NissenPairGeometryCache<DIM>::PairGeometry>& r_pairs =
+        NissenPairGeometryCache<DIM>::Instance()->rGetPairs(*p_node_based_population);
+
+    unsigned local_counts[2] = {static_cast<unsigned>(r_pairs.size()), 0};
+    for (unsigned i=0; i<r_pairs.size(); i++)
+    {
+        if (r_pairs[i].mDistance >= mMaximumForceRange)
+        {
+            local_counts[1]++;
+        }
+    }
+
+    unsigned counts[2] = {local_counts[0], local_counts[1]};
+    if (PetscTools::IsParallel())
+    {
+        MPI_Allreduce(local_counts, counts, 2, MPI_UNSIGNED, MPI_SUM, PETSC_COMM_WORLD);
+    }
+
+    mNumCandidatePairs += counts[0];
+    mNumRejectedPairs += counts[1];
+
+    if (mpPairRejectionFile)
+    {
+        *mpPairRejectionFile << SimulationTime::Instance()->GetTime() << "\t"
+                             << counts[0] << "\t"
+                             << counts[1] << "\n";
+    }
+}
+
+template<unsigned DIM>
+void NissenOffLatticeSimulation<DIM>::ConfigurePolarityModifiers()
+{
+    boost::shared_ptr<NissenLocalTimeSteppingNumericalMethod<DIM> > p_local_method =
+        boost::dynamic_pointer_cast<NissenLocalTimeSteppingNumericalMethod<DIM> >(this->mpNumericalMethod);
+
+    for (typename std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM> > >::iterator iter = this->mSimulationModifiers.begin();
+         iter != this->mSimulationModifiers.end();
+         ++iter)
+    {
+        AbstractCellPolarityTrackingModifier<DIM>* p_modifier = dynamic_cast<AbstractCellPolarityTrackingModifier<DIM>*>(iter->get());
+        if (p_modifier != nullptr)
+        {
+            p_modifier->SetLocalTimeSteppingNumericalMethod(p_local_method);
+            p_modifier->SetSamplingTimestepMultiple(this->mSamplingTimestepMultiple);
+        }
+    }
+}
+
+template<unsigned DIM>
+void NissenOffLatticeSimulation<DIM>::AddPhase(boost::shared_ptr<NissenSimulationPhase<DIM> > pPhase)
+{
+    mPhases.push_back(pPhase);
+}
+
+template<unsigned DIM>
+const std::vector<boost::shared_ptr<NissenSimulationPhase<DIM> > >& NissenOffLatticeSimulation<DIM>::rGetPhases() const
+{
+    return mPhases;
+}
+
+template<unsigned DIM>
+unsigned NissenOffLatticeSimulation<DIM>::GetCurrentPhase() const
+{
+    return mCurrentPhase;
+}
+
+template<unsigned DIM>
+bool NissenOffLatticeSimulation<DIM>::GetUseAutomaticInteractionDistance()
+{
+    return mUseAutomaticInteractionDistance;
+}
+
+template<unsigned DIM>
+void NissenOffLatticeSimulation<DIM>::SetUseAutomaticInteractionDistance(bool useAutomaticInteractionDistance)
+{
+    mUseAutomaticInteractionDistance = useAutomaticInteractionDistance;
+}
+
+template<unsigned DIM>
+double NissenOffLatticeSimulation<DIM>::GetInteractionDistanceMargin()
+{
+    return mInteractionDistanceMargin;
+}
+
+template<unsigned DIM>
+void NissenOffLatticeSimulation<DIM>::SetInteractionDistanceMargin(double interactionDistanceMargin)
+{
+    assert(interactionDistanceMargin >= 0.0);
+    mInteractionDistanceMargin = interactionDistanceMargin;
+}
+
+template<unsigned DIM>
+double NissenOffLatticeSimulation<DIM>::GetRejectedPairFraction()
+{
+    if (mNumCandidatePairs == 0)
+    {
+        return 0.0;
+    }
+    return static_cast<double>(mNumRejectedPairs)/mNumCandidatePairs;
+}
+
+template<unsigned DIM>
+void NissenOffLatticeSimulation<DIM>::OutputSimulationParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t<UseAutomaticInteractionDistance>" << mUseAutomaticInteractionDistance << "</UseAutomaticInteractionDistance>\n";
+    *rParamsFile << "\t\t<InteractionDistanceMargin>" << mInteractionDistanceMargin << "</InteractionDistanceMargin>\n";
+
+    // Call method on direct parent class
+    OffLatticeSimulation<DIM>::OutputSimulationParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class NissenOffLatticeSimulation<1>;
+template class NissenOffLatticeSimulation<2>;
+template class NissenOffLatticeSimulation<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(NissenOffLatticeSimulation)
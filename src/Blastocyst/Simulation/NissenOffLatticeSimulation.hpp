@@ -0,0 +1,313 @@
+
+#ifndef NISSENOFFLATTICESIMULATION_HPP_
+#define NISSENOFFLATTICESIMULATION_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "OffLatticeSimulation.hpp"
+#include "CellDivisionSchedule.hpp"
+#include "NissenSimulationPhase.hpp"
+
+/**
+ * An OffLatticeSimulation which sizes the box collection of a NodeBasedCellPopulation to match the forces in use.
+ *
+ * At the start of each call to Solve(), the maximum interaction distance of the NodesOnlyMesh is set to the
+ * largest range of any Dhall two-body force (see AbstractNissenTwoBodyForce::GetMaximumInteractionRange()) or
+ * the coupling radius of a CellPolarityTrackingModifier or CellPolarityVectorTrackingModifier, plus an optional
+ * margin, and the box collection is rebuilt. This replaces the hand-chosen distance passed to
+ * ConstructNodesWithoutMesh(), which is only used until the first call to Solve().
+ *
+ * Every mSamplingTimestepMultiple time steps the simulation also counts the node pairs found by the box
+ * collection that lie beyond the range of every force and are therefore rejected by the cutoff test in the
+ * forces. The counts are written to pairrejection.dat in the output directory.
+ *
+ * Cell divisions within a time step are processed as a batch. The cells due to divide are taken from a
+ * CellDivisionSchedule, so that only they are tested for room to divide and divided, rather than every
+ * cell every time step. Cell::ReadyToDivide() is still called on every cell each time step, so that the SRN
+ * models and the phases of the cell-cycle models stay current. If a cell's division time changes other than by dividing, for example because its
+ * proliferative type has been changed by a modifier, RescheduleDivision() must be called; this is done
+ * automatically for cells specified by a TrophectodermSpecificationModifier. If the population uses a
+ * NissenBasedDivisionRule, their daughter positions are computed together before any daughter is added. After the population is updated each time step, the shared
+ * CellPopulationStateTracker is told, so that the node pairs just computed (including those of any new
+ * daughters) are reused by modifiers rather than triggering a second full update after a division wave.
+ *
+ * If the numerical method is a NissenAdaptiveNumericalMethod, the number of substeps it took in each time step,
+ * the number it rejected and the shortest and longest substeps are written to adaptivetimestep.dat. If it is a
+ * NissenHealthMonitoredNumericalMethod, each failed health check is written to healthmonitor.dat.
+ *
+ * If a SteadyStateDetectionModifier has been added, Solve() stops as soon as it reports steady state, rather
+ * than running on to the end time.
+ *
+ * A protocol of several phases may be run in a single call to Solve() by adding NissenSimulationPhase objects
+ * with AddPhase(). The first phase starts at the start of Solve(). At the end of each time step the triggers of
+ * the current phase are checked and, if one has fired, its modifiers are removed and the next phase starts, its
+ * forces, modifiers and writers being swapped in without restarting the simulation; the maximum interaction
+ * distance of the mesh is then set again for the new forces. Each transition is written to phases.dat. Once the
+ * last phase has ended, Solve() stops. The end time of the simulation is then only a limit on the protocol.
+ */
+template<unsigned DIM>
+class NissenOffLatticeSimulation : public OffLatticeSimulation<DIM>
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the object and its member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<OffLatticeSimulation<DIM> >(*this);
+        archive & mUseAutomaticInteractionDistance;
+        archive & mInteractionDistanceMargin;
+    }
+
+    /** Whether to set the maximum interaction distance of the mesh from the forces and modifiers. Defaults to true. */
+    bool mUseAutomaticInteractionDistance;
+
+    /**
+     * Distance added to the largest interaction range when setting the maximum interaction distance, which is the
+     * skin within which CellPopulationStateTracker may reuse the node pairs. Defaults to DBL_MAX, meaning a tenth
+     * of the range.
+     */
+    double mInteractionDistanceMargin;
+
+    /** The largest range of any Dhall two-body force at the start of the last Solve(), or DBL_MAX if unbounded. */
+    double mMaximumForceRange;
+
+    /** The total number of node pairs counted when sampling. */
+    unsigned mNumCandidatePairs;
+
+    /** The total number of those pairs lying beyond mMaximumForceRange. */
+    unsigned mNumRejectedPairs;
+
+    /** Output file for the pair rejection counts. */
+    out_stream mpPairRejectionFile;
+
+    /** Output file for the substeps taken in each time step, if the numerical method is a NissenAdaptiveNumericalMethod. */
+    out_stream mpAdaptiveTimeStepFile;
+
+    /** Output file for the failed health checks, if the numerical method is a NissenHealthMonitoredNumericalMethod. */
+    out_stream mpHealthMonitorFile;
+
+    /** The times at which cells are due to divide. Rebuilt at the start of each Solve(), so not archived. */
+    CellDivisionSchedule<DIM> mDivisionSchedule;
+
+    /** The phases of the protocol, in order. Set up by the user, so not archived. */
+    std::vector<boost::shared_ptr<NissenSimulationPhase<DIM> > > mPhases;
+
+    /** The index of the current phase in mPhases, or the number of phases once they have all ended. */
+    unsigned mCurrentPhase;
+
+    /** Output file for the phase transitions. */
+    out_stream mpPhaseFile;
+
+    /**
+     * Set the maximum interaction distance of the mesh from the current forces and modifiers and rebuild its
+     * box collection, if required.
+     */
+    void UpdateMaximumInteractionDistance();
+
+    /**
+     * Reschedule the division of the cells newly specified by any TrophectodermSpecificationModifier.
+     */
+    void RescheduleNewlySpecifiedCells();
+
+    /**
+     * Start the current phase, swapping in its forces, modifiers and writers.
+     *
+     * @param isDuringSolve whether the phase is starting part way through Solve(), in which case SetupSolve()
+     *     is called on its modifiers and the maximum interaction distance is set again
+     */
+    void StartCurrentPhase(bool isDuringSolve);
+
+    /**
+     * End the current phase, removing its modifiers, and move on to the next.
+     */
+    void EndCurrentPhase();
+
+    /**
+     * Count the node pairs of the population and how many of them lie beyond mMaximumForceRange,
+     * summed over all processes, adding these to the totals and writing them to mpPairRejectionFile
+     * on the master process. Must be called on every process.
+     */
+    void SamplePairRejection();
+
+    /**
+     * Give each polarity tracking modifier the numerical method if it is a NissenLocalTimeSteppingNumericalMethod,
+     * so that the modifier, which alone sets the update intervals of the polarity SRN models, uses its per-node
+     * intervals; otherwise clear any method given before. Also give each the sampling timestep multiple, so that
+     * by default it refreshes the polarity CellData just before the results are written.
+     */
+    void ConfigurePolarityModifiers();
+
+protected:
+
+    /**
+     * Overridden DoCellBirth() method.
+     *
+     * Calls Cell::ReadyToDivide() on every cell, to keep its SRN and cell-cycle models current, finds the cells that are due to divide
+     * and ready to do so, computes the daughter positions for the whole batch, then adds the daughters.
+     *
+     * @return the number of births that occurred.
+     */
+    virtual unsigned DoCellBirth();
+
+    /**
+     * Overridden SetupSolve() method.
+     *
+     * Sets the maximum interaction distance of the mesh and rebuilds its box collection, if required.
+     */
+    virtual void SetupSolve();
+
+    /**
+     * Overridden UpdateCellLocationsAndTopology() method.
+     *
+     * Records the update of the population made earlier in the time step with CellPopulationStateTracker,
+     * and samples the pair rejection counts every mSamplingTimestepMultiple time steps, before moving the cells.
+     * Afterwards records the substeps taken by a NissenAdaptiveNumericalMethod, or the failed checks of a
+     * NissenHealthMonitoredNumericalMethod.
+     */
+    virtual void UpdateCellLocationsAndTopology();
+
+    /**
+     * Overridden StoppingEventHasOccurred() method.
+     *
+     * Moves on to the next phase of the protocol, if the current one has ended.
+     *
+     * @return whether the last phase has ended, or any SteadyStateDetectionModifier outside the phases has
+     *     detected steady state in this call to Solve().
+     */
+    virtual bool StoppingEventHasOccurred();
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rCellPopulation A cell population object
+     * @param deleteCellPopulationInDestructor Whether to delete the cell population on destruction to
+     *     free up memory (defaults to false)
+     * @param initialiseCells Whether to initialise cells (defaults to true, set to false when loading
+     *     from an archive)
+     */
+    NissenOffLatticeSimulation(AbstractCellPopulation<DIM>& rCellPopulation,
+                               bool deleteCellPopulationInDestructor=false,
+                               bool initialiseCells=true);
+
+    /**
+     * Destructor.
+     */
+    virtual ~NissenOffLatticeSimulation();
+
+    /**
+     * Update the division time of a cell whose proliferative type has changed during a simulation. If the cell
+     * has a PreCompactionCellCycleModel, its cell-cycle duration is first rescaled for its new type.
+     *
+     * @param pCell the cell
+     */
+    void RescheduleDivision(CellPtr pCell);
+
+    /**
+     * Add a phase to the end of the protocol. Phases must be added before the first call to Solve().
+     *
+     * @param pPhase pointer to the phase
+     */
+    void AddPhase(boost::shared_ptr<NissenSimulationPhase<DIM> > pPhase);
+
+    /**
+     * @return the phases of the protocol.
+     */
+    const std::vector<boost::shared_ptr<NissenSimulationPhase<DIM> > >& rGetPhases() const;
+
+    /**
+     * @return the index of the current phase, or the number of phases once they have all ended.
+     */
+    unsigned GetCurrentPhase() const;
+
+    /**
+     * @return the largest range of any Dhall two-body force or polarity tracking modifier coupling radius
+     * in the simulation, DBL_MAX if some Dhall force has no cutoff, or 0 if there are none.
+     */
+    double CalculateMaximumInteractionRange();
+
+    /**
+     * @return mUseAutomaticInteractionDistance
+     */
+    bool GetUseAutomaticInteractionDistance();
+
+    /**
+     * Set mUseAutomaticInteractionDistance.
+     *
+     * @param useAutomaticInteractionDistance whether to set the maximum interaction distance of the mesh automatically
+     */
+    void SetUseAutomaticInteractionDistance(bool useAutomaticInteractionDistance);
+
+    /**
+     * @return mInteractionDistanceMargin
+     */
+    double GetInteractionDistanceMargin();
+
+    /**
+     * Set mInteractionDistanceMargin.
+     *
+     * @param interactionDistanceMargin the distance added to the largest interaction range, or DBL_MAX for a tenth of it
+     */
+    void SetInteractionDistanceMargin(double interactionDistanceMargin);
+
+    /**
+     * @return the fraction of the sampled node pairs, over all processes, lying beyond the range of every force,
+     * or 0 if none have been sampled.
+     */
+    double GetRejectedPairFraction();
+
+    /**
+     * Overridden OutputSimulationParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputSimulationParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(NissenOffLatticeSimulation)
+
+namespace boost
+{
+namespace serialization
+{
+/**
+ * Serialize information required to construct a NissenOffLatticeSimulation.
+ */
+template<class Archive, unsigned DIM>
+inline void save_construct_data(
+    Archive & ar, const NissenOffLatticeSimulation<DIM> * t, const unsigned int file_version)
+{
+    // Save data required to construct instance
+    const AbstractCellPopulation<DIM>* p_cell_population = &(t->rGetCellPopulation());
+    ar & p_cell_population;
+}
+
+/**
+ * De-serialize constructor parameters and initialise a NissenOffLatticeSimulation.
+ */
+template<class Archive, unsigned DIM>
+inline void load_construct_data(
+    Archive & ar, NissenOffLatticeSimulation<DIM> * t, const unsigned int file_version)
+{
+    // Retrieve data from archive required to construct new instance
+    AbstractCellPopulation<DIM>* p_cell_population;
+    ar >> p_cell_population;
+
+    // Invoke inplace constructor to initialise instance
+    ::new(t)NissenOffLatticeSimulation<DIM>(*p_cell_population, true, false);
+}
+}
+} // namespace ...
+
+#endif /*NISSENOFFLATTICESIMULATION_HPP_*/
@@ -0,0 +1,166 @@
+
+#include "NissenSimulationPhase.hpp"
+#include "PetscTools.hpp"
+#include "SimulationTime.hpp"
+
+#include <cfloat>
+
+template<unsigned DIM>
+NissenSimulationPhase<DIM>::NissenSimulationPhase(const std::string& rName)
+    : mName(rName),
+      mTargetNumCells(0),
+      mDuration(DBL_MAX),
+      mStartTime(-1.0),
+      mEndTime(-1.0)
+{
+}
+
+template<unsigned DIM>
+void NissenSimulationPhase<DIM>::AddForce(boost::shared_ptr<AbstractForce<DIM> > pForce)
+{
+    mForceCollection.push_back(pForce);
+}
+
+template<unsigned DIM>
+void NissenSimulationPhase<DIM>::AddSimulationModifier(boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM,DIM> > pSimulationModifier)
+{
+    mSimulationModifiers.push_back(pSimulationModifier);
+}
+
+template<unsigned DIM>
+void NissenSimulationPhase<DIM>::AddCellWriter(boost::shared_ptr<AbstractCellWriter<DIM,DIM> > pCellWriter)
+{
+    mCellWriters.push_back(pCellWriter);
+}
+
+template<unsigned DIM>
+void NissenSimulationPhase<DIM>::AddCellPopulationCountWriter(boost::shared_ptr<AbstractCellPopulationCountWriter<DIM,DIM> > pCellPopulationCountWriter)
+{
+    mCellPopulationCountWriters.push_back(pCellPopulationCountWriter);
+}
+
+template<unsigned DIM>
+void NissenSimulationPhase<DIM>::SetTargetNumCells(unsigned targetNumCells)
+{
+    mTargetNumCells = targetNumCells;
+}
+
+template<unsigned DIM>
+void NissenSimulationPhase<DIM>::SetDuration(double duration)
+{
+    assert(duration > 0.0);
+    mDuration = duration;
+}
+
+template<unsigned DIM>
+void NissenSimulationPhase<DIM>::SetEndAtSteadyState(boost::shared_ptr<SteadyStateDetectionModifier<DIM> > pSteadyStateModifier)
+{
+    mpSteadyStateModifier = pSteadyStateModifier;
+    mSimulationModifiers.push_back(pSteadyStateModifier);
+}
+
+template<unsigned DIM>
+bool NissenSimulationPhase<DIM>::HasEnded(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    assert(mStartTime >= 0.0);
+
+    if (mpSteadyStateModifier && mpSteadyStateModifier->HasReachedSteadyState())
+    {
+        return true;
+    }
+
+    // Allow for rounding in the time, which advances by whole time steps
+    SimulationTime* p_simulation_time = SimulationTime::Instance();
+    if (mDuration < DBL_MAX
+        && p_simulation_time->GetTime() >= mStartTime + mDuration - 0.5*p_simulation_time->GetTimeStep())
+    {
+        return true;
+    }
+
+    if (mTargetNumCells > 0)
+    {
+        unsigned local_num_cells = rCellPopulation.GetNumRealCells();
+        unsigned num_cells = local_num_cells;
+        if (PetscTools::IsParallel())
+        {
+            MPI_Allreduce(&local_num_cells, &num_cells, 1, MPI_UNSIGNED, MPI_SUM, PETSC_COMM_WORLD);
+        }
+        if (num_cells >= mTargetNumCells)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+template<unsigned DIM>
+const std::string& NissenSimulationPhase<DIM>::rGetName() const
+{
+    return mName;
+}
+
+template<unsigned DIM>
+const std::vector<boost::shared_ptr<AbstractForce<DIM> > >& NissenSimulationPhase<DIM>::rGetForceCollection() const
+{
+    return mForceCollection;
+}
+
+template<unsigned DIM>
+const std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM,DIM> > >& NissenSimulationPhase<DIM>::rGetSimulationModifiers() const
+{
+    return mSimulationModifiers;
+}
+
+template<unsigned DIM>
+const std::vector<boost::shared_ptr<AbstractCellWriter<DIM,DIM> > >& NissenSimulationPhase<DIM>::rGetCellWriters() const
+{
+    return mCellWriters;
+}
+
+template<unsigned DIM>
+const std::vector<boost::shared_ptr<AbstractCellPopulationCountWriter<DIM,DIM> > >& NissenSimulationPhase<DIM>::rGetCellPopulationCountWriters() const
+{
+    return mCellPopulationCountWriters;
+}
+
+template<unsigned DIM>
+unsigned NissenSimulationPhase<DIM>::GetTargetNumCells() const
+{
+    return mTargetNumCells;
+}
+
+template<unsigned DIM>
+double NissenSimulationPhase<DIM>::GetDuration() const
+{
+    return mDuration;
+}
+
+template<unsigned DIM>
+double NissenSimulationPhase<DIM>::GetStartTime() const
+{
+    return mStartTime;
+}
+
+template<unsigned DIM>
+void NissenSimulationPhase<DIM>::SetStartTime(double startTime)
+{
+    mStartTime = startTime;
+}
+
+template<unsigned DIM>
+double NissenSimulationPhase<DIM>::GetEndTime() const
+{
+    return mEndTime;
+}
+
+template<unsigned DIM>
+void NissenSimulationPhase<DIM>::SetEndTime(double endTime)
+{
+    mEndTime = endTime;
+}
+
+// Explicit instantiation
+template class NissenSimulationPhase<1>;
+template class NissenSimulationPhase<2>;
+template class NissenSimulationPhase<3>;
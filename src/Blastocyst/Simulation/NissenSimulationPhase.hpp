@@ -0,0 +1,177 @@
+
+#ifndef NISSENSIMULATIONPHASE_HPP_
+#define NISSENSIMULATIONPHASE_HPP_
+
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "AbstractCellPopulation.hpp"
+#include "AbstractForce.hpp"
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "AbstractCellWriter.hpp"
+#include "AbstractCellPopulationCountWriter.hpp"
+#include "SteadyStateDetectionModifier.hpp"
+
+/**
+ * One phase of the protocol run by a NissenOffLatticeSimulation (see NissenOffLatticeSimulation::AddPhase()),
+ * such as the morula, trophectoderm specification and trophectoderm force phases of TestNodeBasedMorula.
+ *
+ * A phase declares what changes when it starts and the event that ends it. When the phase starts:
+ *  - if any forces have been added with AddForce(), they replace the force collection of the simulation;
+ *    otherwise the forces of the previous phase are kept;
+ *  - the modifiers added with AddSimulationModifier() are added to the simulation, and are removed again
+ *    when the phase ends;
+ *  - the writers added with AddCellWriter() and AddCellPopulationCountWriter() are added to the cell
+ *    population, and are kept for the rest of the simulation.
+ *
+ * The phase ends at the end of the first time step at which any of its triggers has fired: the number of
+ * real cells has reached mTargetNumCells, mDuration hours have passed since the phase started, or the
+ * SteadyStateDetectionModifier given to SetEndAtSteadyState() has detected steady state. A phase with no
+ * triggers runs until the end time of the simulation.
+ */
+template<unsigned DIM>
+class NissenSimulationPhase
+{
+private:
+
+    /** The name of the phase. */
+    std::string mName;
+
+    /** The forces which replace those of the simulation when the phase starts, if any. */
+    std::vector<boost::shared_ptr<AbstractForce<DIM> > > mForceCollection;
+
+    /** The modifiers used during the phase. */
+    std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM,DIM> > > mSimulationModifiers;
+
+    /** The cell writers added to the population when the phase starts. */
+    std::vector<boost::shared_ptr<AbstractCellWriter<DIM,DIM> > > mCellWriters;
+
+    /** The cell population count writers added to the population when the phase starts. */
+    std::vector<boost::shared_ptr<AbstractCellPopulationCountWriter<DIM,DIM> > > mCellPopulationCountWriters;
+
+    /** The number of real cells at which the phase ends, or 0 if the phase is not ended by the number of cells. */
+    unsigned mTargetNumCells;
+
+    /** The time in hours after which the phase ends, or DBL_MAX if the phase is not ended by its duration. */
+    double mDuration;
+
+    /** The modifier whose detection of steady state ends the phase, if any. */
+    boost::shared_ptr<SteadyStateDetectionModifier<DIM> > mpSteadyStateModifier;
+
+    /** The time at which the phase started, or -1 if it has not. */
+    double mStartTime;
+
+    /** The time at which the phase ended, or -1 if it has not. */
+    double mEndTime;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rName the name of the phase, written to phases.dat when it starts
+     */
+    NissenSimulationPhase(const std::string& rName);
+
+    /**
+     * Add a force to those used during the phase.
+     *
+     * @param pForce pointer to the force
+     */
+    void AddForce(boost::shared_ptr<AbstractForce<DIM> > pForce);
+
+    /**
+     * Add a modifier to those used during the phase.
+     *
+     * @param pSimulationModifier pointer to the modifier
+     */
+    void AddSimulationModifier(boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM,DIM> > pSimulationModifier);
+
+    /**
+     * Add a cell writer to the population when the phase starts.
+     *
+     * @param pCellWriter pointer to the writer
+     */
+    void AddCellWriter(boost::shared_ptr<AbstractCellWriter<DIM,DIM> > pCellWriter);
+
+    /**
+     * Add a cell population count writer to the population when the phase starts.
+     *
+     * @param pCellPopulationCountWriter pointer to the writer
+     */
+    void AddCellPopulationCountWriter(boost::shared_ptr<AbstractCellPopulationCountWriter<DIM,DIM> > pCellPopulationCountWriter);
+
+    /**
+     * End the phase once the number of real cells reaches targetNumCells.
+     *
+     * @param targetNumCells the number of cells, or 0 not to end the phase by the number of cells
+     */
+    void SetTargetNumCells(unsigned targetNumCells);
+
+    /**
+     * End the phase once it has run for a given time.
+     *
+     * @param duration the time in hours, or DBL_MAX not to end the phase by its duration
+     */
+    void SetDuration(double duration);
+
+    /**
+     * End the phase once a SteadyStateDetectionModifier detects steady state. The modifier is added to those
+     * used during the phase, so its window starts afresh when the phase starts.
+     *
+     * @param pSteadyStateModifier pointer to the modifier
+     */
+    void SetEndAtSteadyState(boost::shared_ptr<SteadyStateDetectionModifier<DIM> > pSteadyStateModifier);
+
+    /**
+     * @return whether any trigger of the phase has fired. In a distributed run the number of cells is
+     * taken over all processes, so every process ends the phase at the same time step.
+     *
+     * @param rCellPopulation the cell population
+     */
+    bool HasEnded(AbstractCellPopulation<DIM>& rCellPopulation);
+
+    /** @return mName */
+    const std::string& rGetName() const;
+
+    /** @return the forces which replace those of the simulation when the phase starts. */
+    const std::vector<boost::shared_ptr<AbstractForce<DIM> > >& rGetForceCollection() const;
+
+    /** @return the modifiers used during the phase. */
+    const std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM,DIM> > >& rGetSimulationModifiers() const;
+
+    /** @return the cell writers added when the phase starts. */
+    const std::vector<boost::shared_ptr<AbstractCellWriter<DIM,DIM> > >& rGetCellWriters() const;
+
+    /** @return the cell population count writers added when the phase starts. */
+    const std::vector<boost::shared_ptr<AbstractCellPopulationCountWriter<DIM,DIM> > >& rGetCellPopulationCountWriters() const;
+
+    /** @return mTargetNumCells */
+    unsigned GetTargetNumCells() const;
+
+    /** @return mDuration */
+    double GetDuration() const;
+
+    /** @return the time at which the phase started, or -1 if it has not. */
+    double GetStartTime() const;
+
+    /**
+     * Record the time at which the phase started.
+     *
+     * @param startTime the time
+     */
+    void SetStartTime(double startTime);
+
+    /** @return the time at which the phase ended, or -1 if it has not. */
+    double GetEndTime() const;
+
+    /**
+     * Record the time at which the phase ended.
+     *
+     * @param endTime the time
+     */
+    void SetEndTime(double endTime);
+};
+
+#endif /*NISSENSIMULATIONPHASE_HPP_*/
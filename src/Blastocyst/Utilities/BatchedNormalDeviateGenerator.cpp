@@ -0,0 +1,143 @@
+
+#include "BatchedNormalDeviateGenerator.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include <cassert>
+#include <climits>
+#include <cmath>
+
+BatchedNormalDeviateGenerator* BatchedNormalDeviateGenerator::mpInstance = nullptr;
+
+BatchedNormalDeviateGenerator::BatchedNormalDeviateGenerator()
+    : mBufferSize(1024),
+      mNumUsed(0),
+      mNumBatches(0)
+{
+    for (unsigned i=0; i<4; i++)
+    {
+        mState[i] = 0;
+    }
+}
+
+BatchedNormalDeviateGenerator* BatchedNormalDeviateGenerator::Instance()
+{
+    if (mpInstance == nullptr)
+    {
+        mpInstance = new BatchedNormalDeviateGenerator;
+    }
+    return mpInstance;
+}
+
+void BatchedNormalDeviateGenerator::Destroy()
+{
+    if (mpInstance)
+    {
+        delete mpInstance;
+        mpInstance = nullptr;
+    }
+}
+
+void BatchedNormalDeviateGenerator::SeedBatch()
+{
+    // A seed of 64 bits, so that the seeds of different batches are unlikely to coincide even in a long simulation
+    RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+    uint64_t seed = ((uint64_t)p_gen->randMod(UINT_MAX) << 32) | p_gen->randMod(UINT_MAX);
+
+    // Spread the seed over the state with splitmix64, which never leaves it all zero
+    for (unsigned i=0; i<4; i++)
+    {
+        seed += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+        mState[i] = z ^ (z >> 31);
+    }
+    mNumBatches++;
+}
+
+uint64_t BatchedNormalDeviateGenerator::NextUniformBits()
+{
+    uint64_t result = mState[0] + mState[3];
+    uint64_t t = mState[1] << 17;
+    mState[2] ^= mState[0];
+    mState[3] ^= mState[1];
+    mState[1] ^= mState[2];
+    mState[0] ^= mState[3];
+    mState[2] ^= t;
+    mState[3] = (mState[3] << 45) | (mState[3] >> 19);
+    return result;
+}
+
+void BatchedNormalDeviateGenerator::GenerateStandardDeviates(double* pDeviates, unsigned numDeviates)
+{
+    if (numDeviates == 0)
+    {
+        return;
+    }
+    SeedBatch();
+
+    // The top 53 bits give a uniform deviate in (0,1], whose logarithm is finite
+    unsigned num_pairs = (numDeviates + 1)/2;
+    mUniforms.resize(2*num_pairs);
+    for (unsigned i=0; i<2*num_pairs; i++)
+    {
+        mUniforms[i] = ((NextUniformBits() >> 11) + 1.0)*(1.0/9007199254740992.0);
+    }
+
+    const double two_pi = 2.0*M_PI;
+    for (unsigned i=0; i<numDeviates/2; i++)
+    {
+        double radius = sqrt(-2.0*log(mUniforms[2*i]));
+        double angle = two_pi*mUniforms[2*i+1];
+        pDeviates[2*i] = radius*cos(angle);
+        pDeviates[2*i+1] = radius*sin(angle);
+    }
+    if (numDeviates%2 == 1)
+    {
+        unsigned i = num_pairs - 1;
+        pDeviates[2*i] = sqrt(-2.0*log(mUniforms[2*i]))*cos(two_pi*mUniforms[2*i+1]);
+    }
+}
+
+void BatchedNormalDeviateGenerator::Fill(double* pDeviates, unsigned numDeviates, double mean, double sd)
+{
+    GenerateStandardDeviates(pDeviates, numDeviates);
+    for (unsigned i=0; i<numDeviates; i++)
+    {
+        pDeviates[i] = mean + sd*pDeviates[i];
+    }
+}
+
+double BatchedNormalDeviateGenerator::NormalRandomDeviate(double mean, double sd)
+{
+    if (mNumUsed == mBuffer.size())
+    {
+        mBuffer.resize(mBufferSize);
+        GenerateStandardDeviates(&mBuffer[0], mBufferSize);
+        mNumUsed = 0;
+    }
+    return mean + sd*mBuffer[mNumUsed++];
+}
+
+void BatchedNormalDeviateGenerator::Reset()
+{
+    mBuffer.clear();
+    mNumUsed = 0;
+}
+
+unsigned BatchedNormalDeviateGenerator::GetBufferSize() const
+{
+    return mBufferSize;
+}
+
+void BatchedNormalDeviateGenerator::SetBufferSize(unsigned bufferSize)
+{
+    assert(bufferSize > 0);
+    mBufferSize = bufferSize;
+    Reset();
+}
+
+unsigned BatchedNormalDeviateGenerator::GetNumBatches() const
+{
+    return mNumBatches;
+}
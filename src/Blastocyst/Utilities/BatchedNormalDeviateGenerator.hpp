@@ -0,0 +1,122 @@
+
+#ifndef BATCHEDNORMALDEVIATEGENERATOR_HPP_
+#define BATCHEDNORMALDEVIATEGENERATOR_HPP_
+
+#include <vector>
+#include <stdint.h>
+
+/**
+ * A generator of normal random deviates in batches, used for the noise of NissenNoiseForce and of the
+ * polarity ODE systems in place of one call to RandomNumberGenerator::NormalRandomDeviate() per deviate.
+ *
+ * Each batch is generated from its own 64-bit seed, drawn with two calls to the Chaste RandomNumberGenerator.
+ * The uniform deviates of the batch come from a xoshiro256+ generator started from that seed, and are then
+ * transformed in pairs by the Box-Muller method. Both passes are plain loops over contiguous arrays, so the
+ * compiler can vectorise them. Since the only state carried from one batch to the next is that of the
+ * RandomNumberGenerator, the deviates are reproducible from its seed and continue correctly from a checkpoint.
+ *
+ * Fill() generates a whole batch into an array, for a caller that knows how many deviates it needs, such as
+ * the noise force at each time step. NormalRandomDeviate() returns one deviate from a buffer of mBufferSize,
+ * which is refilled as a batch when it runs out; the deviates left in the buffer are not archived, so call
+ * Reset() (or Destroy()) whenever the RandomNumberGenerator is reseeded. The polarity tracking modifiers,
+ * whose ODE systems draw from the buffer, call Reset() in SetupSolve(), so that a simulation reseeded or
+ * loaded from a checkpoint before Solve() does not use deviates left over from before.
+ */
+class BatchedNormalDeviateGenerator
+{
+private:
+
+    /** Pointer to the single instance. */
+    static BatchedNormalDeviateGenerator* mpInstance;
+
+    /** The number of deviates generated each time the buffer is refilled. Defaults to 1024. */
+    unsigned mBufferSize;
+
+    /** Standard normal deviates for NormalRandomDeviate(). */
+    std::vector<double> mBuffer;
+
+    /** The number of deviates in mBuffer already returned. */
+    unsigned mNumUsed;
+
+    /** The number of batches generated. */
+    unsigned mNumBatches;
+
+    /** Uniform deviates, in (0,1], for the Box-Muller transform. */
+    std::vector<double> mUniforms;
+
+    /** The state of the xoshiro256+ generator for the current batch. */
+    uint64_t mState[4];
+
+    /**
+     * Default constructor. Private, as this is a singleton.
+     */
+    BatchedNormalDeviateGenerator();
+
+    /**
+     * Start a new batch, seeding the xoshiro256+ generator from the RandomNumberGenerator.
+     */
+    void SeedBatch();
+
+    /**
+     * @return the next output of the xoshiro256+ generator.
+     */
+    uint64_t NextUniformBits();
+
+    /**
+     * Generate a batch of standard normal deviates.
+     *
+     * @param pDeviates the array to fill
+     * @param numDeviates the number of deviates
+     */
+    void GenerateStandardDeviates(double* pDeviates, unsigned numDeviates);
+
+public:
+
+    /**
+     * @return the single instance of the generator, creating it if necessary.
+     */
+    static BatchedNormalDeviateGenerator* Instance();
+
+    /**
+     * Destroy the single instance of the generator.
+     */
+    static void Destroy();
+
+    /**
+     * Fill an array with normal deviates, generated as one batch.
+     *
+     * @param pDeviates the array to fill
+     * @param numDeviates the number of deviates
+     * @param mean the mean of the distribution
+     * @param sd the standard deviation of the distribution
+     */
+    void Fill(double* pDeviates, unsigned numDeviates, double mean, double sd);
+
+    /**
+     * @return a normal deviate from the buffer, refilling it if necessary.
+     *
+     * @param mean the mean of the distribution
+     * @param sd the standard deviation of the distribution
+     */
+    double NormalRandomDeviate(double mean, double sd);
+
+    /**
+     * Discard the deviates left in the buffer, so that the next is from a new batch.
+     */
+    void Reset();
+
+    /** @return mBufferSize */
+    unsigned GetBufferSize() const;
+
+    /**
+     * Set mBufferSize. The buffer is discarded.
+     *
+     * @param bufferSize the number of deviates generated each time the buffer is refilled
+     */
+    void SetBufferSize(unsigned bufferSize);
+
+    /** @return the number of batches generated. */
+    unsigned GetNumBatches() const;
+};
+
+#endif /*BATCHEDNORMALDEVIATEGENERATOR_HPP_*/
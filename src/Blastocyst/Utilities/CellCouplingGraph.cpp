@@ -0,0 +1,187 @@
+
+#include "CellCouplingGraph.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "NissenPairGeometryCache.hpp"
+#include "PetscTools.hpp"
+
+#include <algorithm>
+#include <climits>
+
+template<unsigned DIM>
+CellCouplingGraph<DIM>::CellCouplingGraph()
+    : mMaxNumNeighbours(0)
+{
+}
+
+template<unsigned DIM>
+void CellCouplingGraph<DIM>::Build(AbstractCellPopulation<DIM,DIM>& rCellPopulation,
+                                   const std::vector<unsigned>& rLocationIndices,
+                                   double radius,
+                                   const std::vector<unsigned>& rHaloLocationIndices)
+{
+    unsigned num_members = rLocationIndices.size();
+    unsigned num_halo_members = rHaloLocationIndices.size();
+
+    // Each coupled pair (a, b), stored once in each direction, and each coupling (a, h) of a member to a halo member
+    std::vector<std::pair<unsigned, unsigned> > edges;
+    std::vector<std::pair<unsigned, unsigned> > halo_edges;
+
+    NodeBasedCellPopulation<DIM>* p_node_based_population = dynamic_cast<NodeBasedCellPopulation<DIM>*>(&rCellPopulation);
+    if (p_node_based_population != nullptr
+        && p_node_based_population->rGetMesh().GetMaximumInteractionDistance() >= radius)
+    {
+        // Every pair within the coupling radius is among the node pairs, so reuse their cached geometry
+        unsigned max_location_index = 0;
+        for (unsigned a=0; a<num_members; a++)
+        {
+            max_location_index = std::max(max_location_index, rLocationIndices[a]);
+        }
+        for (unsigned h=0; h<num_halo_members; h++)
+        {
+            max_location_index = std::max(max_location_index, rHaloLocationIndices[h]);
+        }
+        std::vector<unsigned> member_index_of_node(max_location_index + 1, UINT_MAX);
+        std::vector<unsigned> halo_member_index_of_node(num_halo_members > 0 ? max_location_index + 1 : 0, UINT_MAX);
+        for (unsigned a=0; a<num_members; a++)
+        {
+            member_index_of_node[rLocationIndices[a]] = a;
+        }
+        for (unsigned h=0; h<num_halo_members; h++)
+        {
+            halo_member_index_of_node[rHaloLocationIndices[h]] = h;
+        }
+
+        const std::vector<typename NissenPairGeometryCache<DIM>::PairGeometry>& r_pairs =
+            NissenPairGeometryCache<DIM>::Instance()->rGetPairs(*p_node_based_population);
+
+        for (unsigned i=0; i<r_pairs.size(); i++)
+        {
+            const typename NissenPairGeometryCache<DIM>::PairGeometry& r_pair = r_pairs[i];
+            if (r_pair.mDistance < radius
+                && r_pair.mNodeAIndex <= max_location_index
+                && r_pair.mNodeBIndex <= max_location_index)
+            {
+                unsigned a = member_index_of_node[r_pair.mNodeAIndex];
+                unsigned b = member_index_of_node[r_pair.mNodeBIndex];
+                if (a != UINT_MAX && b != UINT_MAX)
+                {
+                    edges.push_back(std::make_pair(a, b));
+                    edges.push_back(std::make_pair(b, a));
+                }
+                else if (num_halo_members > 0)
+                {
+                    // A pair never joins two halo nodes, so at most one of these applies
+                    if (a != UINT_MAX && halo_member_index_of_node[r_pair.mNodeBIndex] != UINT_MAX)
+                    {
+                        halo_edges.push_back(std::make_pair(a, halo_member_index_of_node[r_pair.mNodeBIndex]));
+                    }
+                    else if (b != UINT_MAX && halo_member_index_of_node[r_pair.mNodeAIndex] != UINT_MAX)
+                    {
+                        halo_edges.push_back(std::make_pair(b, halo_member_index_of_node[r_pair.mNodeAIndex]));
+                    }
+                }
+            }
+        }
+    }
+    else
+    {
+        // Otherwise check every pair of members, and every member against every halo member
+        for (unsigned a=0; a<num_members; a++)
+        {
+            const c_vector<double, DIM>& r_node_A_location = rCellPopulation.GetNode(rLocationIndices[a])->rGetLocation();
+            for (unsigned b=a+1; b<num_members; b++)
+            {
+                const c_vector<double, DIM>& r_node_B_location = rCellPopulation.GetNode(rLocationIndices[b])->rGetLocation();
+                if (norm_2(rCellPopulation.rGetMesh().GetVectorFromAtoB(r_node_A_location, r_node_B_location)) < radius)
+                {
+                    edges.push_back(std::make_pair(a, b));
+                    edges.push_back(std::make_pair(b, a));
+                }
+            }
+            for (unsigned h=0; h<num_halo_members; h++)
+            {
+                const c_vector<double, DIM>& r_halo_location = rCellPopulation.GetNode(rHaloLocationIndices[h])->rGetLocation();
+                if (norm_2(rCellPopulation.rGetMesh().GetVectorFromAtoB(r_node_A_location, r_halo_location)) < radius)
+                {
+                    halo_edges.push_back(std::make_pair(a, h));
+                }
+            }
+        }
+    }
+
+    ConvertToCompressedRows(edges, num_members, mNeighbourStarts, mNeighbourIndices);
+    ConvertToCompressedRows(halo_edges, num_members, mHaloNeighbourStarts, mHaloNeighbourIndices);
+
+    mMaxNumNeighbours = 0;
+    for (unsigned a=0; a<num_members; a++)
+    {
+        mMaxNumNeighbours = std::max(mMaxNumNeighbours,
+                                     mNeighbourStarts[a+1] - mNeighbourStarts[a] + mHaloNeighbourStarts[a+1] - mHaloNeighbourStarts[a]);
+    }
+
+    // Callers choose time steps from this, which must agree across processes
+    if (PetscTools::IsParallel())
+    {
+        unsigned local_max_num_neighbours = mMaxNumNeighbours;
+        MPI_Allreduce(&local_max_num_neighbours, &mMaxNumNeighbours, 1, MPI_UNSIGNED, MPI_MAX, PETSC_COMM_WORLD);
+    }
+}
+
+template<unsigned DIM>
+void CellCouplingGraph<DIM>::ConvertToCompressedRows(const std::vector<std::pair<unsigned, unsigned> >& rEdges,
+                                                     unsigned numRows,
+                                                     std::vector<unsigned>& rStarts,
+                                                     std::vector<unsigned>& rIndices)
+{
+    rStarts.assign(numRows + 1, 0);
+    for (unsigned i=0; i<rEdges.size(); i++)
+    {
+        rStarts[rEdges[i].first + 1]++;
+    }
+    for (unsigned a=0; a<numRows; a++)
+    {
+        rStarts[a+1] += rStarts[a];
+    }
+
+    rIndices.resize(rEdges.size());
+    std::vector<unsigned> next_slot(rStarts.begin(), rStarts.end() - 1);
+    for (unsigned i=0; i<rEdges.size(); i++)
+    {
+        rIndices[next_slot[rEdges[i].first]++] = rEdges[i].second;
+    }
+}
+
+template<unsigned DIM>
+const std::vector<unsigned>& CellCouplingGraph<DIM>::rGetNeighbourStarts() const
+{
+    return mNeighbourStarts;
+}
+
+template<unsigned DIM>
+const std::vector<unsigned>& CellCouplingGraph<DIM>::rGetNeighbourIndices() const
+{
+    return mNeighbourIndices;
+}
+
+template<unsigned DIM>
+const std::vector<unsigned>& CellCouplingGraph<DIM>::rGetHaloNeighbourStarts() const
+{
+    return mHaloNeighbourStarts;
+}
+
+template<unsigned DIM>
+const std::vector<unsigned>& CellCouplingGraph<DIM>::rGetHaloNeighbourIndices() const
+{
+    return mHaloNeighbourIndices;
+}
+
+template<unsigned DIM>
+unsigned CellCouplingGraph<DIM>::GetMaxNumNeighbours() const
+{
+    return mMaxNumNeighbours;
+}
+
+// Explicit instantiation
+template class CellCouplingGraph<1>;
+template class CellCouplingGraph<2>;
+template class CellCouplingGraph<3>;
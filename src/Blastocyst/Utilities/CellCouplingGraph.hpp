@@ -0,0 +1,104 @@
+
+#ifndef CELLCOUPLINGGRAPH_HPP_
+#define CELLCOUPLINGGRAPH_HPP_
+
+#include <vector>
+#include "AbstractCellPopulation.hpp"
+
+/**
+ * The graph of pairs of cells, from a chosen subset, whose centres lie within a coupling radius, stored in
+ * compressed rows: the neighbours of member a are rGetNeighbourIndices()[k] for k from rGetNeighbourStarts()[a]
+ * to rGetNeighbourStarts()[a+1]. Members are numbered by their position in the list of location indices
+ * passed to Build().
+ *
+ * Used by the polarity tracking modifiers to couple neighbouring trophectoderm cells.
+ *
+ * In a distributed run, members may also be coupled to halo members, the halo nodes of the chosen subset.
+ * These couplings are stored separately, in the same form: the halo neighbours of member a are
+ * rGetHaloNeighbourIndices()[k] for k from rGetHaloNeighbourStarts()[a] to rGetHaloNeighbourStarts()[a+1],
+ * numbered by their position in the list of halo location indices passed to Build().
+ */
+template<unsigned DIM>
+class CellCouplingGraph
+{
+private:
+
+    /** Start of each member's neighbours in mNeighbourIndices, with one extra entry at the end. */
+    std::vector<unsigned> mNeighbourStarts;
+
+    /** Neighbouring members, as positions in the list passed to Build(). */
+    std::vector<unsigned> mNeighbourIndices;
+
+    /** Start of each member's halo neighbours in mHaloNeighbourIndices, with one extra entry at the end. */
+    std::vector<unsigned> mHaloNeighbourStarts;
+
+    /** Neighbouring halo members, as positions in the list of halo location indices passed to Build(). */
+    std::vector<unsigned> mHaloNeighbourIndices;
+
+    /** The largest number of neighbours, including halo neighbours, of any member on any process. */
+    unsigned mMaxNumNeighbours;
+
+    /**
+     * Convert a list of edges to compressed rows.
+     *
+     * @param rEdges the edges, as (row, column) pairs
+     * @param numRows the number of rows
+     * @param rStarts filled with the start of each row in rIndices, with one extra entry at the end
+     * @param rIndices filled with the column of each edge, row by row
+     */
+    static void ConvertToCompressedRows(const std::vector<std::pair<unsigned, unsigned> >& rEdges,
+                                        unsigned numRows,
+                                        std::vector<unsigned>& rStarts,
+                                        std::vector<unsigned>& rIndices);
+
+public:
+
+    /**
+     * Constructor.
+     */
+    CellCouplingGraph();
+
+    /**
+     * Rebuild the graph. For a NodeBasedCellPopulation whose interaction distance covers the radius, the
+     * pairs are read from the shared NissenPairGeometryCache; otherwise every pair of members is checked.
+     *
+     * Must be called on every process in a distributed run, since the largest number of neighbours is
+     * found across all processes.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param rLocationIndices the location index of each member
+     * @param radius members whose centres are closer than this are coupled
+     * @param rHaloLocationIndices the location index of each halo member (empty by default)
+     */
+    void Build(AbstractCellPopulation<DIM,DIM>& rCellPopulation,
+               const std::vector<unsigned>& rLocationIndices,
+               double radius,
+               const std::vector<unsigned>& rHaloLocationIndices=std::vector<unsigned>());
+
+    /**
+     * @return the start of each member's neighbours in rGetNeighbourIndices(), with one extra entry at the end.
+     */
+    const std::vector<unsigned>& rGetNeighbourStarts() const;
+
+    /**
+     * @return the neighbours of all members, as positions in the list passed to Build().
+     */
+    const std::vector<unsigned>& rGetNeighbourIndices() const;
+
+    /**
+     * @return the start of each member's halo neighbours in rGetHaloNeighbourIndices(), with one extra entry at the end.
+     */
+    const std::vector<unsigned>& rGetHaloNeighbourStarts() const;
+
+    /**
+     * @return the halo neighbours of all members, as positions in the list of halo location indices passed to Build().
+     */
+    const std::vector<unsigned>& rGetHaloNeighbourIndices() const;
+
+    /**
+     * @return the largest number of neighbours, including halo neighbours, of any member on any process.
+     */
+    unsigned GetMaxNumNeighbours() const;
+};
+
+#endif /*CELLCOUPLINGGRAPH_HPP_*/
@@ -0,0 +1,120 @@
+
+#include "CellDivisionSchedule.hpp"
+#include "AbstractSimpleCellCycleModel.hpp"
+
+#include <algorithm>
+#include <cfloat>
+
+template<unsigned DIM>
+CellDivisionSchedule<DIM>::CellDivisionSchedule()
+    : mNextSequenceNumber(0),
+      mNumCells(0)
+{
+}
+
+template<unsigned DIM>
+void CellDivisionSchedule<DIM>::Rebuild(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    mQueue = std::priority_queue<ScheduledDivision, std::vector<ScheduledDivision>, std::greater<ScheduledDivision> >();
+    mCurrentSequenceNumbers.clear();
+    mUnscheduledCells.clear();
+    mNextSequenceNumber = 0;
+    mNumCells = 0;
+
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        Schedule(*cell_iter);
+    }
+}
+
+template<unsigned DIM>
+void CellDivisionSchedule<DIM>::Schedule(CellPtr pCell)
+{
+    AbstractSimpleCellCycleModel* p_model = dynamic_cast<AbstractSimpleCellCycleModel*>(pCell->GetCellCycleModel());
+    if (p_model == nullptr)
+    {
+        if (std::find(mUnscheduledCells.begin(), mUnscheduledCells.end(), pCell) == mUnscheduledCells.end())
+        {
+            mUnscheduledCells.push_back(pCell);
+            mNumCells++;
+        }
+        return;
+    }
+
+    if (mCurrentSequenceNumbers.find(pCell.get()) == mCurrentSequenceNumbers.end())
+    {
+        mNumCells++;
+    }
+    mCurrentSequenceNumbers[pCell.get()] = mNextSequenceNumber;
+
+    // Cells that never divide are counted but not queued
+    double duration = p_model->GetCellCycleDuration();
+    if (duration == DBL_MAX)
+    {
+        mNextSequenceNumber++;
+        return;
+    }
+
+    ScheduledDivision entry;
+    entry.mTime = p_model->GetBirthTime() + duration;
+    entry.mSequenceNumber = mNextSequenceNumber++;
+    entry.mpCell = pCell;
+    mQueue.push(entry);
+}
+
+template<unsigned DIM>
+void CellDivisionSchedule<DIM>::PopDueCells(double time, std::vector<CellPtr>& rDueCells)
+{
+    while (!mQueue.empty() && mQueue.top().mTime <= time)
+    {
+        ScheduledDivision entry = mQueue.top();
+        mQueue.pop();
+
+        typename std::map<Cell*, unsigned>::iterator iter = mCurrentSequenceNumbers.find(entry.mpCell.get());
+        if (iter == mCurrentSequenceNumbers.end() || iter->second != entry.mSequenceNumber)
+        {
+            // Superseded by a later call to Schedule()
+            continue;
+        }
+        if (entry.mpCell->IsDead())
+        {
+            mCurrentSequenceNumbers.erase(iter);
+            mNumCells--;
+            continue;
+        }
+
+        mCurrentSequenceNumbers.erase(iter);
+        mNumCells--;
+        rDueCells.push_back(entry.mpCell);
+    }
+
+    // Cells with other cell-cycle models are returned every time
+    for (unsigned i=0; i<mUnscheduledCells.size(); i++)
+    {
+        if (!mUnscheduledCells[i]->IsDead())
+        {
+            rDueCells.push_back(mUnscheduledCells[i]);
+        }
+    }
+    mNumCells -= mUnscheduledCells.size();
+    mUnscheduledCells.clear();
+}
+
+template<unsigned DIM>
+unsigned CellDivisionSchedule<DIM>::GetNumCells() const
+{
+    return mNumCells;
+}
+
+template<unsigned DIM>
+unsigned CellDivisionSchedule<DIM>::GetQueueSize() const
+{
+    return mQueue.size();
+}
+
+// Explicit instantiation
+template class CellDivisionSchedule<1>;
+template class CellDivisionSchedule<2>;
+template class CellDivisionSchedule<3>;
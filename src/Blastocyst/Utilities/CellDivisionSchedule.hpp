@@ -0,0 +1,109 @@
+
+#ifndef CELLDIVISIONSCHEDULE_HPP_
+#define CELLDIVISIONSCHEDULE_HPP_
+
+#include <map>
+#include <queue>
+#include <vector>
+#include "AbstractCellPopulation.hpp"
+
+/**
+ * A priority queue of the times at which the cells of a population are due to divide.
+ *
+ * For a cell whose cell-cycle model is an AbstractSimpleCellCycleModel, such as PreCompactionCellCycleModel,
+ * the division time is its birth time plus its cell-cycle duration, which is known as soon as the cell is
+ * born. Such cells are only returned by PopDueCells() once this time has been reached, so that a simulation
+ * need only ask the cells that are due whether they are ready to divide. Cells with any other cell-cycle
+ * model are returned every time step.
+ *
+ * Cells returned by PopDueCells() are removed from the schedule and must be scheduled again by the caller,
+ * whether or not they divide. A cell must also be rescheduled with Schedule() whenever its division time
+ * changes, for example when its proliferative type changes; entries superseded in this way are skipped.
+ */
+template<unsigned DIM>
+class CellDivisionSchedule
+{
+private:
+
+    /**
+     * An entry in the queue.
+     */
+    struct ScheduledDivision
+    {
+        /** The time at which the cell is due to divide. */
+        double mTime;
+
+        /** The order in which the entry was added, used to break ties deterministically. */
+        unsigned mSequenceNumber;
+
+        /** The cell. */
+        CellPtr mpCell;
+
+        /**
+         * @return whether this entry is due after another.
+         *
+         * @param rOther the other entry
+         */
+        bool operator>(const ScheduledDivision& rOther) const
+        {
+            return (mTime > rOther.mTime) || (mTime == rOther.mTime && mSequenceNumber > rOther.mSequenceNumber);
+        }
+    };
+
+    /** The queue, with the earliest division time on top. */
+    std::priority_queue<ScheduledDivision, std::vector<ScheduledDivision>, std::greater<ScheduledDivision> > mQueue;
+
+    /** The sequence number of the current entry for each scheduled cell. */
+    std::map<Cell*, unsigned> mCurrentSequenceNumbers;
+
+    /** Cells whose division time cannot be predicted, which are returned by every call to PopDueCells(). */
+    std::vector<CellPtr> mUnscheduledCells;
+
+    /** The sequence number to give the next entry. */
+    unsigned mNextSequenceNumber;
+
+    /** The number of cells in the schedule. */
+    unsigned mNumCells;
+
+public:
+
+    /**
+     * Constructor.
+     */
+    CellDivisionSchedule();
+
+    /**
+     * Clear the schedule and schedule every cell in a population.
+     *
+     * @param rCellPopulation the cell population
+     */
+    void Rebuild(AbstractCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Add a cell to the schedule, or update its division time if it is already scheduled.
+     *
+     * @param pCell the cell
+     */
+    void Schedule(CellPtr pCell);
+
+    /**
+     * Remove and return every scheduled cell whose division time is no later than a given time, together with
+     * every cell whose division time cannot be predicted. Dead cells and superseded entries are discarded.
+     *
+     * @param time the current time
+     * @param rDueCells vector to which the cells are appended
+     */
+    void PopDueCells(double time, std::vector<CellPtr>& rDueCells);
+
+    /**
+     * @return the number of cells in the schedule.
+     */
+    unsigned GetNumCells() const;
+
+    /**
+     * @return the number of entries in the queue, including superseded ones.
+     */
+    unsigned GetQueueSize() const;
+};
+
+#endif /*CELLDIVISIONSCHEDULE_HPP_*/
@@ -0,0 +1,156 @@
+
+#include "CellMemoryReport.hpp"
+#include "PreCompactionCellCycleModel.hpp"
+#include "CellPolaritySrnModel.hpp"
+#include "CellPolarityVectorSrnModel.hpp"
+#include "CellPolarityOdeSystem.hpp"
+#include "NodeAttributes.hpp"
+
+template<unsigned DIM>
+CellMemoryReport<DIM>::CellMemoryReport()
+    : mNumCells(0)
+{
+    for (unsigned component=0; component<NUM_COMPONENTS; component++)
+    {
+        mBytes[component] = 0;
+    }
+}
+
+template<unsigned DIM>
+std::size_t CellMemoryReport<DIM>::GetTreeNodeBytes(std::size_t valueSize)
+{
+    // Red-black tree nodes hold three pointers and a colour alongside the value
+    return 4*sizeof(void*) + valueSize;
+}
+
+template<unsigned DIM>
+void CellMemoryReport<DIM>::Compute(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    for (unsigned component=0; component<NUM_COMPONENTS; component++)
+    {
+        mBytes[component] = 0;
+    }
+    mNumCells = 0;
+
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        mNumCells++;
+        mBytes[CELL] += sizeof(Cell);
+
+        // CellData is stored in the property collection but belongs to this cell alone
+        CellPropertyCollection& r_properties = cell_iter->rGetCellPropertyCollection();
+        mBytes[CELL_PROPERTIES] += r_properties.GetSize()*GetTreeNodeBytes(sizeof(boost::shared_ptr<AbstractCellProperty>));
+        if (r_properties.HasProperty<CellData>())
+        {
+            mBytes[CELL_DATA] += sizeof(CellData);
+            std::vector<std::string> keys = cell_iter->GetCellData()->GetKeys();
+            for (unsigned i=0; i<keys.size(); i++)
+            {
+                mBytes[CELL_DATA] += GetTreeNodeBytes(sizeof(std::pair<const std::string, double>));
+                if (keys[i].size() >= sizeof(std::string))
+                {
+                    // Longer keys do not fit in the string object itself
+                    mBytes[CELL_DATA] += keys[i].size() + 1;
+                }
+            }
+        }
+
+        AbstractCellCycleModel* p_cell_cycle_model = cell_iter->GetCellCycleModel();
+        if (dynamic_cast<PreCompactionCellCycleModel*>(p_cell_cycle_model) != nullptr)
+        {
+            mBytes[CELL_CYCLE_MODEL] += sizeof(PreCompactionCellCycleModel);
+        }
+        else
+        {
+            mBytes[CELL_CYCLE_MODEL] += sizeof(AbstractCellCycleModel);
+        }
+
+        AbstractSrnModel* p_srn_model = cell_iter->GetSrnModel();
+        DHALLAbstractOdeSrnModel* p_ode_srn_model = dynamic_cast<DHALLAbstractOdeSrnModel*>(p_srn_model);
+        if (p_ode_srn_model != nullptr)
+        {
+            bool is_vector_model = (dynamic_cast<CellPolarityVectorSrnModel*>(p_srn_model) != nullptr);
+            mBytes[SRN_MODEL] += is_vector_model ? sizeof(CellPolarityVectorSrnModel) : sizeof(CellPolaritySrnModel);
+
+            const AbstractOdeSystem* p_ode_system = p_ode_srn_model->GetOdeSystem();
+            if (p_ode_system != nullptr)
+            {
+                // The SRN model keeps its own copy of the initial conditions
+                mBytes[SRN_MODEL] += p_ode_system->GetNumberOfStateVariables()*sizeof(double);
+
+                mBytes[ODE_SYSTEM] += (is_vector_model ? sizeof(CellPolarityVectorOdeSystem) : sizeof(CellPolarityOdeSystem))
+                                      + p_ode_system->rGetConstStateVariables().capacity()*sizeof(double)
+                                      + p_ode_system->GetNumberOfParameters()*sizeof(double);
+            }
+        }
+        else
+        {
+            mBytes[SRN_MODEL] += sizeof(AbstractSrnModel);
+        }
+
+        mBytes[NODE] += sizeof(Node<DIM>) + sizeof(NodeAttributes<DIM>);
+    }
+}
+
+template<unsigned DIM>
+std::string CellMemoryReport<DIM>::GetComponentName(unsigned component)
+{
+    assert(component < NUM_COMPONENTS);
+    static const char* names[NUM_COMPONENTS] = {"cell", "cell_data", "cell_properties", "cell_cycle_model",
+                                                "srn_model", "ode_system", "node"};
+    return names[component];
+}
+
+template<unsigned DIM>
+unsigned CellMemoryReport<DIM>::GetNumCells() const
+{
+    return mNumCells;
+}
+
+template<unsigned DIM>
+std::size_t CellMemoryReport<DIM>::GetBytes(unsigned component) const
+{
+    assert(component < NUM_COMPONENTS);
+    return mBytes[component];
+}
+
+template<unsigned DIM>
+std::size_t CellMemoryReport<DIM>::GetTotalBytes() const
+{
+    std::size_t total = 0;
+    for (unsigned component=0; component<NUM_COMPONENTS; component++)
+    {
+        total += mBytes[component];
+    }
+    return total;
+}
+
+template<unsigned DIM>
+double CellMemoryReport<DIM>::GetBytesPerCell(unsigned component) const
+{
+    return (mNumCells == 0) ? 0.0 : static_cast<double>(GetBytes(component))/mNumCells;
+}
+
+template<unsigned DIM>
+double CellMemoryReport<DIM>::GetTotalBytesPerCell() const
+{
+    return (mNumCells == 0) ? 0.0 : static_cast<double>(GetTotalBytes())/mNumCells;
+}
+
+template<unsigned DIM>
+void CellMemoryReport<DIM>::WriteSummary(std::ostream& rStream) const
+{
+    rStream << "Estimated memory for " << mNumCells << " cells: " << GetTotalBytes() << " bytes ("
+            << GetTotalBytesPerCell() << " per cell)\n";
+    for (unsigned component=0; component<NUM_COMPONENTS; component++)
+    {
+        rStream << "\t" << GetComponentName(component) << ": " << GetBytesPerCell(component) << " bytes per cell\n";
+    }
+}
+
+// Explicit instantiation
+template class CellMemoryReport<1>;
+template class CellMemoryReport<2>;
+template class CellMemoryReport<3>;
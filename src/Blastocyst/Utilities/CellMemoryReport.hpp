@@ -0,0 +1,112 @@
+
+#ifndef CELLMEMORYREPORT_HPP_
+#define CELLMEMORYREPORT_HPP_
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include "AbstractCellPopulation.hpp"
+
+/**
+ * An estimate of the memory used by each cell of a population, broken down by component.
+ *
+ * Each component is estimated from the size of its object, using the actual class where it is one of the
+ * Dhall models, plus the storage held in its containers (CellData items, property collection entries, ODE
+ * state and parameters). Memory shared between cells, such as the ODE system information, ODE solver and
+ * cell properties registered with a CellPropertyRegistry, is not attributed to any cell. The figures are
+ * therefore estimates rather than exact heap usage, but are consistent over time and between runs.
+ *
+ * The report may be computed at any time by calling Compute().
+ */
+template<unsigned DIM>
+class CellMemoryReport
+{
+public:
+
+    /** The components of a cell whose memory is estimated. */
+    enum Component
+    {
+        CELL = 0,           /**< The Cell object. */
+        CELL_DATA,          /**< The CellData object and its items. */
+        CELL_PROPERTIES,    /**< The entries of the cell property collection. */
+        CELL_CYCLE_MODEL,   /**< The cell-cycle model. */
+        SRN_MODEL,          /**< The SRN model. */
+        ODE_SYSTEM,         /**< The SRN model's ODE system, with its state and parameters. */
+        NODE,               /**< The cell's node and its attributes. */
+        NUM_COMPONENTS      /**< The number of components. */
+    };
+
+private:
+
+    /** The total number of bytes estimated for each component. */
+    std::size_t mBytes[NUM_COMPONENTS];
+
+    /** The number of cells when the report was computed. */
+    unsigned mNumCells;
+
+    /**
+     * @return the estimated number of bytes used by a std::map or std::set entry holding a value of a given size.
+     *
+     * @param valueSize the size of the value
+     */
+    static std::size_t GetTreeNodeBytes(std::size_t valueSize);
+
+public:
+
+    /**
+     * Constructor. The report is empty until Compute() is called.
+     */
+    CellMemoryReport();
+
+    /**
+     * Compute the report for a population.
+     *
+     * @param rCellPopulation the cell population
+     */
+    void Compute(AbstractCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * @return the name of a component, as used in column headers.
+     *
+     * @param component the component
+     */
+    static std::string GetComponentName(unsigned component);
+
+    /**
+     * @return the number of cells when the report was computed.
+     */
+    unsigned GetNumCells() const;
+
+    /**
+     * @return the total number of bytes estimated for a component.
+     *
+     * @param component the component
+     */
+    std::size_t GetBytes(unsigned component) const;
+
+    /**
+     * @return the total number of bytes estimated for all components.
+     */
+    std::size_t GetTotalBytes() const;
+
+    /**
+     * @return the mean number of bytes per cell for a component, or 0 if there are no cells.
+     *
+     * @param component the component
+     */
+    double GetBytesPerCell(unsigned component) const;
+
+    /**
+     * @return the mean number of bytes per cell for all components, or 0 if there are no cells.
+     */
+    double GetTotalBytesPerCell() const;
+
+    /**
+     * Write a readable summary of the report.
+     *
+     * @param rStream the stream to write to
+     */
+    void WriteSummary(std::ostream& rStream) const;
+};
+
+#endif /*CELLMEMORYREPORT_HPP_*/
@@ -0,0 +1,146 @@
+
+#ifndef CELLPOLARITYVECTORS_HPP_
+#define CELLPOLARITYVECTORS_HPP_
+
+#include <cmath>
+#include "UblasVectorInclude.hpp"
+#include "Cell.hpp"
+#include "CellPolaritySrnModel.hpp"
+#include "CellPolarityVectorSrnModel.hpp"
+
+/**
+ * Helper functions giving the polarity of a cell, and the geometry of its foci, as vectors in any
+ * number of dimensions, whichever polarity SRN model the cell carries.
+ *
+ * A cell with a CellPolarityVectorSrnModel has polarity given by the first DIM components of its vector;
+ * a cell with a CellPolaritySrnModel has polarity (cos(alpha), sin(alpha)) in 2D. A trophectoderm cell
+ * is pictured as a disc (a flattened cell in 3D) normal to its polarity, with its foci on the rim of
+ * the disc, half a cell diameter from the centre. In 2D the rim is the two points either side of the
+ * centre along the perpendicular to the polarity. In 3D it is a ring, and the two foci used for a pair of
+ * cells are the points of the ring nearest to and furthest from the other cell, which reduce to the 2D
+ * foci when the cells lie in a plane.
+ */
+class CellPolarityVectors
+{
+public:
+
+    /**
+     * @return the unit polarity vector of a cell, or zero if the cell has no polarity SRN model.
+     *
+     * @param pCell the cell
+     */
+    template<unsigned DIM>
+    static c_vector<double, DIM> GetPolarityVector(CellPtr pCell)
+    {
+        c_vector<double, DIM> polarity = zero_vector<double>(DIM);
+
+        AbstractSrnModel* p_srn_model = pCell->GetSrnModel();
+        if (CellPolarityVectorSrnModel* p_vector_model = dynamic_cast<CellPolarityVectorSrnModel*>(p_srn_model))
+        {
+            const std::vector<double>& r_polarity = p_vector_model->rGetPolarityVector();
+            for (unsigned i=0; i<DIM && i<3; i++)
+            {
+                polarity(i) = r_polarity[i];
+            }
+        }
+        else if (CellPolaritySrnModel* p_angle_model = dynamic_cast<CellPolaritySrnModel*>(p_srn_model))
+        {
+            if (DIM > 1)
+            {
+                double angle = p_angle_model->GetPolarityAngle();
+                polarity(0) = cos(angle);
+                polarity(1) = sin(angle);
+            }
+        }
+        return polarity;
+    }
+
+    /**
+     * Point the polarity of a cell along a given direction.
+     *
+     * @param pCell the cell, which is left unchanged if it has no polarity SRN model
+     * @param rDirection the direction, which must be non-zero
+     */
+    template<unsigned DIM>
+    static void SetPolarityVector(CellPtr pCell, const c_vector<double, DIM>& rDirection)
+    {
+        AbstractSrnModel* p_srn_model = pCell->GetSrnModel();
+        if (CellPolarityVectorSrnModel* p_vector_model = dynamic_cast<CellPolarityVectorSrnModel*>(p_srn_model))
+        {
+            p_vector_model->SetPolarityVector(rDirection(0),
+                                              (DIM > 1) ? rDirection(1) : 0.0,
+                                              (DIM > 2) ? rDirection(2) : 0.0);
+        }
+        else if (CellPolaritySrnModel* p_angle_model = dynamic_cast<CellPolaritySrnModel*>(p_srn_model))
+        {
+            if (DIM == 2)
+            {
+                p_angle_model->SetPolarityAngle(atan2(rDirection(1), rDirection(0)));
+            }
+        }
+    }
+
+    /**
+     * @return a unit vector perpendicular to a unit polarity vector: (-e_y, e_x) in 2D, and in 3D the cross
+     * product of e with the coordinate axis least aligned with it. Zero in 1D.
+     *
+     * @param rPolarity the unit polarity vector
+     */
+    template<unsigned DIM>
+    static c_vector<double, DIM> GetPerpendicularVector(const c_vector<double, DIM>& rPolarity)
+    {
+        c_vector<double, DIM> perpendicular = zero_vector<double>(DIM);
+        if (DIM == 2)
+        {
+            perpendicular(0) = -rPolarity(1);
+            perpendicular(1) = rPolarity(0);
+        }
+        else if (DIM == 3)
+        {
+            unsigned axis = 0;
+            for (unsigned i=1; i<DIM; i++)
+            {
+                if (fabs(rPolarity(i)) < fabs(rPolarity(axis)))
+                {
+                    axis = i;
+                }
+            }
+
+            // e x a, for the unit vector a along the chosen axis
+            unsigned j = (axis + 1)%3;
+            unsigned k = (axis + 2)%3;
+            perpendicular(j) = rPolarity(k);
+            perpendicular(k) = -rPolarity(j);
+            double length = norm_2(perpendicular);
+            if (length > 0.0)
+            {
+                perpendicular /= length;
+            }
+        }
+        return perpendicular;
+    }
+
+    /**
+     * @return the unit vector from the centre of a cell to the point of its focal rim nearest a given
+     * direction: the part of rTowards perpendicular to the polarity, normalised, or GetPerpendicularVector()
+     * if rTowards is parallel to the polarity. In 2D this is whichever of the two foci lies on the side
+     * of rTowards.
+     *
+     * @param rPolarity the unit polarity vector of the cell
+     * @param rTowards the direction in which to look, for example towards another cell
+     */
+    template<unsigned DIM>
+    static c_vector<double, DIM> GetFocusDirection(const c_vector<double, DIM>& rPolarity,
+                                                   const c_vector<double, DIM>& rTowards)
+    {
+        c_vector<double, DIM> in_plane = rTowards - inner_prod(rTowards, rPolarity)*rPolarity;
+        double length = norm_2(in_plane);
+        if (length > 1e-12*norm_2(rTowards))
+        {
+            return in_plane/length;
+        }
+        return GetPerpendicularVector<DIM>(rPolarity);
+    }
+};
+
+#endif /*CELLPOLARITYVECTORS_HPP_*/
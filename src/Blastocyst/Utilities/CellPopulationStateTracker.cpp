@@ -0,0 +1,151 @@
+
+#include "CellPopulationStateTracker.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "PetscTools.hpp"
+
+#include <algorithm>
+
+template<unsigned DIM>
+CellPopulationStateTracker<DIM>* CellPopulationStateTracker<DIM>::mpInstance = nullptr;
+
+template<unsigned DIM>
+CellPopulationStateTracker<DIM>::CellPopulationStateTracker()
+    : mpCellPopulation(nullptr),
+      mNumNodes(0),
+      mNumUpdatesPerformed(0),
+      mNumUpdatesSkipped(0)
+{
+}
+
+template<unsigned DIM>
+CellPopulationStateTracker<DIM>* CellPopulationStateTracker<DIM>::Instance()
+{
+    if (mpInstance == nullptr)
+    {
+        mpInstance = new CellPopulationStateTracker<DIM>;
+    }
+    return mpInstance;
+}
+
+template<unsigned DIM>
+void CellPopulationStateTracker<DIM>::Destroy()
+{
+    if (mpInstance)
+    {
+        delete mpInstance;
+        mpInstance = nullptr;
+    }
+}
+
+template<unsigned DIM>
+void CellPopulationStateTracker<DIM>::EnsureState(AbstractCellPopulation<DIM,DIM>& rCellPopulation, unsigned requiredState, double pairRadius)
+{
+    // Node locations are always current, so only node pairs can need an update
+    if (!(requiredState & NODE_PAIRS))
+    {
+        return;
+    }
+
+    bool needs_update = NeedsUpdate(rCellPopulation, pairRadius);
+
+    // Update() exchanges halo nodes in a distributed run, so every process must make the same choice
+    if (PetscTools::IsParallel())
+    {
+        needs_update = PetscTools::ReplicateBool(needs_update);
+    }
+
+    if (needs_update)
+    {
+        UpdateAndRecord(rCellPopulation);
+    }
+    else
+    {
+        mNumUpdatesSkipped++;
+    }
+}
+
+template<unsigned DIM>
+bool CellPopulationStateTracker<DIM>::NeedsUpdate(AbstractCellPopulation<DIM,DIM>& rCellPopulation, double pairRadius)
+{
+    NodeBasedCellPopulation<DIM>* p_node_based_population = dynamic_cast<NodeBasedCellPopulation<DIM>*>(&rCellPopulation);
+    if (p_node_based_population == nullptr
+        || mpCellPopulation != &rCellPopulation
+        || rCellPopulation.GetNumNodes() != mNumNodes)
+    {
+        return true;
+    }
+
+    double skin = p_node_based_population->rGetMesh().GetMaximumInteractionDistance() - pairRadius;
+    if (skin <= 0.0)
+    {
+        return true;
+    }
+
+    double max_displacement_squared = 0.25*skin*skin;
+    for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = p_node_based_population->rGetMesh().GetNodeIteratorBegin();
+         node_iter != p_node_based_population->rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        unsigned index = node_iter->GetIndex();
+        if (index >= mReferenceLocations.size())
+        {
+            return true;
+        }
+
+        c_vector<double, DIM> displacement = node_iter->rGetLocation() - mReferenceLocations[index];
+        if (inner_prod(displacement, displacement) > max_displacement_squared)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+template<unsigned DIM>
+void CellPopulationStateTracker<DIM>::UpdateAndRecord(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    rCellPopulation.Update();
+    mNumUpdatesPerformed++;
+    RecordUpdate(rCellPopulation);
+}
+
+template<unsigned DIM>
+void CellPopulationStateTracker<DIM>::RecordUpdate(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    mpCellPopulation = &rCellPopulation;
+    mNumNodes = rCellPopulation.GetNumNodes();
+
+    unsigned max_index = 0;
+    for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = rCellPopulation.rGetMesh().GetNodeIteratorBegin();
+         node_iter != rCellPopulation.rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        max_index = std::max(max_index, node_iter->GetIndex());
+    }
+
+    mReferenceLocations.resize(max_index + 1);
+    for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = rCellPopulation.rGetMesh().GetNodeIteratorBegin();
+         node_iter != rCellPopulation.rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        mReferenceLocations[node_iter->GetIndex()] = node_iter->rGetLocation();
+    }
+}
+
+template<unsigned DIM>
+unsigned CellPopulationStateTracker<DIM>::GetNumUpdatesPerformed() const
+{
+    return mNumUpdatesPerformed;
+}
+
+template<unsigned DIM>
+unsigned CellPopulationStateTracker<DIM>::GetNumUpdatesSkipped() const
+{
+    return mNumUpdatesSkipped;
+}
+
+// Explicit instantiation
+template class CellPopulationStateTracker<1>;
+template class CellPopulationStateTracker<2>;
+template class CellPopulationStateTracker<3>;
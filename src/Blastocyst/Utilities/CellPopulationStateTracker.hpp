@@ -0,0 +1,115 @@
+
+#ifndef CELLPOPULATIONSTATETRACKER_HPP_
+#define CELLPOPULATIONSTATETRACKER_HPP_
+
+#include <vector>
+#include "UblasVectorInclude.hpp"
+#include "AbstractCellPopulation.hpp"
+
+/**
+ * Keeps track of how far a cell population has changed since its last call to Update(), so that
+ * modifiers can ask for the state they need instead of calling Update() unconditionally.
+ *
+ * A modifier declares the state it needs with EnsureState(). If it only needs current node
+ * locations then nothing is done, since these are always current. If it also needs the node pairs
+ * of a NodeBasedCellPopulation to include every pair closer than some radius, Update() is only
+ * called if nodes have been added or removed, or if some node has moved far enough since the
+ * tracker's last Update() that such a pair might be missing: the node pairs cover the mesh's
+ * maximum interaction distance, so they remain valid for the radius while no node has moved more
+ * than half the difference. For other populations, Update() is called whenever node pairs are
+ * required. In a distributed run Update() is called on every process if any process needs it, since
+ * it exchanges halo nodes.
+ */
+template<unsigned DIM>
+class CellPopulationStateTracker
+{
+public:
+
+    /** The population state that a caller of EnsureState() may require. */
+    enum RequiredState
+    {
+        NODE_LOCATIONS = 0x1,  /**< Current node locations. */
+        NODE_PAIRS = 0x2       /**< Node pairs including every pair closer than a given radius. */
+    };
+
+private:
+
+    /** Pointer to the single instance for this dimension. */
+    static CellPopulationStateTracker* mpInstance;
+
+    /** The population the tracker last called Update() on. */
+    const AbstractCellPopulation<DIM,DIM>* mpCellPopulation;
+
+    /** The number of nodes at the last Update(). */
+    unsigned mNumNodes;
+
+    /** Node locations at the last Update(), indexed by node global index. */
+    std::vector<c_vector<double, DIM> > mReferenceLocations;
+
+    /** The number of calls to Update() made by the tracker. */
+    unsigned mNumUpdatesPerformed;
+
+    /** The number of calls to Update() the tracker found to be unnecessary. */
+    unsigned mNumUpdatesSkipped;
+
+    /**
+     * Default constructor. Private, as this is a singleton.
+     */
+    CellPopulationStateTracker();
+
+    /**
+     * @return whether this process needs the population to be updated for its node pairs to include every
+     * pair closer than a given radius.
+     *
+     * @param rCellPopulation the cell population
+     * @param pairRadius the radius within which node pairs are needed
+     */
+    bool NeedsUpdate(AbstractCellPopulation<DIM,DIM>& rCellPopulation, double pairRadius);
+
+    /**
+     * Call Update() on a population and record its state.
+     *
+     * @param rCellPopulation the cell population
+     */
+    void UpdateAndRecord(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * @return the single instance of the tracker for this dimension, creating it if necessary.
+     */
+    static CellPopulationStateTracker* Instance();
+
+    /**
+     * Destroy the single instance of the tracker for this dimension.
+     */
+    static void Destroy();
+
+    /**
+     * Make sure the population is in the required state, calling Update() only if necessary.
+     *
+     * @param rCellPopulation the cell population
+     * @param requiredState a combination of RequiredState flags
+     * @param pairRadius the radius within which node pairs are needed, if NODE_PAIRS is required
+     */
+    void EnsureState(AbstractCellPopulation<DIM,DIM>& rCellPopulation, unsigned requiredState, double pairRadius=0.0);
+
+    /**
+     * Record that the population has been updated outside the tracker, for example by the simulation.
+     *
+     * @param rCellPopulation the cell population
+     */
+    void RecordUpdate(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * @return the number of calls to Update() made by the tracker.
+     */
+    unsigned GetNumUpdatesPerformed() const;
+
+    /**
+     * @return the number of calls to Update() the tracker found to be unnecessary.
+     */
+    unsigned GetNumUpdatesSkipped() const;
+};
+
+#endif /*CELLPOPULATIONSTATETRACKER_HPP_*/
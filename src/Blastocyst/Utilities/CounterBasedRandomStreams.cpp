@@ -0,0 +1,162 @@
+
+#include "CounterBasedRandomStreams.hpp"
+#include "BatchedNormalDeviateGenerator.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "SimulationTime.hpp"
+
+#include <climits>
+#include <cmath>
+
+CounterBasedRandomStreams* CounterBasedRandomStreams::mpInstance = nullptr;
+
+CounterBasedRandomStreams::CounterBasedRandomStreams()
+    : mIsEnabled(false),
+      mSeed(0)
+{
+}
+
+CounterBasedRandomStreams* CounterBasedRandomStreams::Instance()
+{
+    if (mpInstance == nullptr)
+    {
+        mpInstance = new CounterBasedRandomStreams;
+    }
+    return mpInstance;
+}
+
+void CounterBasedRandomStreams::Destroy()
+{
+    if (mpInstance)
+    {
+        delete mpInstance;
+        mpInstance = nullptr;
+    }
+}
+
+void CounterBasedRandomStreams::Philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4])
+{
+    uint32_t c0 = counter[0];
+    uint32_t c1 = counter[1];
+    uint32_t c2 = counter[2];
+    uint32_t c3 = counter[3];
+    uint32_t k0 = key[0];
+    uint32_t k1 = key[1];
+
+    for (unsigned round=0; round<10; round++)
+    {
+        uint64_t product0 = (uint64_t)0xD2511F53 * c0;
+        uint64_t product1 = (uint64_t)0xCD9E8D57 * c2;
+        uint32_t new_c0 = (uint32_t)(product1 >> 32) ^ c1 ^ k0;
+        uint32_t new_c2 = (uint32_t)(product0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t)product1;
+        c3 = (uint32_t)product0;
+        c0 = new_c0;
+        c2 = new_c2;
+
+        // Bump the key with the Weyl sequence constants
+        k0 += 0x9E3779B9;
+        k1 += 0xBB67AE85;
+    }
+
+    result[0] = c0;
+    result[1] = c1;
+    result[2] = c2;
+    result[3] = c3;
+}
+
+unsigned CounterBasedRandomStreams::GetAbsoluteTimeStep()
+{
+    // SimulationTime counts the steps from the start of each Solve(), so count them from time zero instead
+    SimulationTime* p_time = SimulationTime::Instance();
+    return (unsigned)floor(p_time->GetTime()/p_time->GetTimeStep() + 0.5);
+}
+
+void CounterBasedRandomStreams::GenerateBlock(unsigned cellId, Purpose purpose, unsigned blockIndex, uint32_t result[4]) const
+{
+    uint32_t counter[4] = {cellId, GetAbsoluteTimeStep(), blockIndex, 0};
+    uint32_t key[2] = {mSeed, (uint32_t)purpose};
+    Philox4x32(counter, key, result);
+}
+
+bool CounterBasedRandomStreams::IsEnabled() const
+{
+    return mIsEnabled;
+}
+
+void CounterBasedRandomStreams::SetEnabled(bool isEnabled)
+{
+    mIsEnabled = isEnabled;
+}
+
+unsigned CounterBasedRandomStreams::GetSeed() const
+{
+    return mSeed;
+}
+
+void CounterBasedRandomStreams::SetSeed(unsigned seed)
+{
+    mSeed = seed;
+}
+
+double CounterBasedRandomStreams::ranf(unsigned cellId, Purpose purpose, unsigned index)
+{
+    if (!mIsEnabled)
+    {
+        return RandomNumberGenerator::Instance()->ranf();
+    }
+
+    // Each block gives two deviates, each from the top 53 bits of two words
+    uint32_t block[4];
+    GenerateBlock(cellId, purpose, index/2, block);
+    unsigned offset = 2*(index%2);
+    uint64_t bits = ((uint64_t)block[offset] << 32) | block[offset + 1];
+    return (bits >> 11)*(1.0/9007199254740992.0);
+}
+
+double CounterBasedRandomStreams::NormalRandomDeviate(double mean, double sd, unsigned cellId, Purpose purpose, unsigned index)
+{
+    if (!mIsEnabled)
+    {
+        return BatchedNormalDeviateGenerator::Instance()->NormalRandomDeviate(mean, sd);
+    }
+
+    // Each block gives a Box-Muller pair, with uniform deviates in (0,1] so that the logarithm is finite
+    uint32_t block[4];
+    GenerateBlock(cellId, purpose, index/2, block);
+    uint64_t first_bits = ((uint64_t)block[0] << 32) | block[1];
+    uint64_t second_bits = ((uint64_t)block[2] << 32) | block[3];
+    double radius = sqrt(-2.0*log(((first_bits >> 11) + 1.0)*(1.0/9007199254740992.0)));
+    double angle = 2.0*M_PI*(second_bits >> 11)*(1.0/9007199254740992.0);
+    double deviate = (index%2 == 0) ? radius*cos(angle) : radius*sin(angle);
+    return mean + sd*deviate;
+}
+
+CounterBasedRandomStream::CounterBasedRandomStream(CounterBasedRandomStreams::Purpose purpose)
+    : mCellId(UINT_MAX),
+      mPurpose(purpose),
+      mTimeStep(UINT_MAX),
+      mNumDraws(0)
+{
+}
+
+void CounterBasedRandomStream::SetCellId(unsigned cellId)
+{
+    mCellId = cellId;
+}
+
+double CounterBasedRandomStream::NormalRandomDeviate(double mean, double sd)
+{
+    CounterBasedRandomStreams* p_streams = CounterBasedRandomStreams::Instance();
+    if (!p_streams->IsEnabled())
+    {
+        return p_streams->NormalRandomDeviate(mean, sd, mCellId, mPurpose, 0);
+    }
+
+    unsigned time_step = CounterBasedRandomStreams::GetAbsoluteTimeStep();
+    if (time_step != mTimeStep)
+    {
+        mTimeStep = time_step;
+        mNumDraws = 0;
+    }
+    return p_streams->NormalRandomDeviate(mean, sd, mCellId, mPurpose, mNumDraws++);
+}
@@ -0,0 +1,177 @@
+
+#ifndef COUNTERBASEDRANDOMSTREAMS_HPP_
+#define COUNTERBASEDRANDOMSTREAMS_HPP_
+
+#include <stdint.h>
+
+/**
+ * Counter-based random numbers for the stochastic parts of the Dhall models, so that each random number is
+ * a pure function of the cell it is for, the time step and what it is used for, rather than of its position
+ * in one sequential stream.
+ *
+ * Each random number comes from the Philox4x32-10 generator of Salmon et al. (SC11), keyed by the seed and
+ * the purpose and with a counter of the cell ID, the number of time steps since time zero and the index of the draw
+ * for that cell, step and purpose. Simulations in which the cells are visited in a different order, or are
+ * distributed differently between processes, therefore draw the same numbers for each cell, as long as the
+ * cells have the same IDs.
+ *
+ * The streams are opt-in: until SetEnabled(true) is called, ranf() and NormalRandomDeviate() draw from the
+ * RandomNumberGenerator and BatchedNormalDeviateGenerator as before, so that existing simulations reproduce
+ * their previous results. The streams are used by NissenNoiseForce, the polarity ODE systems,
+ * NissenBasedDivisionRule and PreCompactionCellCycleModel.
+ */
+class CounterBasedRandomStreams
+{
+public:
+
+    /** What a random number is used for, which keys a separate stream for each. */
+    enum Purpose
+    {
+        NOISE_FORCE = 0,         /**< The noise of NissenNoiseForce. */
+        POLARITY_NOISE,          /**< The noise of the polarity ODE systems. */
+        DIVISION_DIRECTION,      /**< The direction of division in NissenBasedDivisionRule. */
+        CELL_CYCLE_DURATION      /**< The cell-cycle duration of PreCompactionCellCycleModel. */
+    };
+
+private:
+
+    /** Pointer to the single instance. */
+    static CounterBasedRandomStreams* mpInstance;
+
+    /** Whether the counter-based streams are used. Defaults to false. */
+    bool mIsEnabled;
+
+    /** The seed, which is the first word of the key. Defaults to 0. */
+    unsigned mSeed;
+
+    /**
+     * Default constructor. Private, as this is a singleton.
+     */
+    CounterBasedRandomStreams();
+
+    /**
+     * Generate the block of four words for a cell, purpose and block index at the current time step.
+     *
+     * @param cellId the ID of the cell
+     * @param purpose what the random numbers are used for
+     * @param blockIndex the index of the block in the stream for this cell, step and purpose
+     * @param result filled with the block
+     */
+    void GenerateBlock(unsigned cellId, Purpose purpose, unsigned blockIndex, uint32_t result[4]) const;
+
+public:
+
+    /**
+     * @return the single instance, creating it if necessary.
+     */
+    static CounterBasedRandomStreams* Instance();
+
+    /**
+     * Destroy the single instance.
+     */
+    static void Destroy();
+
+    /**
+     * The Philox4x32-10 bijection.
+     *
+     * @param counter the counter
+     * @param key the key
+     * @param result filled with the random block for the counter and key
+     */
+    static void Philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4]);
+
+    /**
+     * @return the number of time steps from time zero to the current time. Unlike
+     * SimulationTime::GetTimeStepsElapsed(), this does not restart at each call to Solve(), so a
+     * simulation run in several Solve()s does not reuse the random numbers of its earlier ones.
+     */
+    static unsigned GetAbsoluteTimeStep();
+
+    /** @return mIsEnabled */
+    bool IsEnabled() const;
+
+    /**
+     * Set mIsEnabled.
+     *
+     * @param isEnabled whether to use the counter-based streams
+     */
+    void SetEnabled(bool isEnabled);
+
+    /** @return mSeed */
+    unsigned GetSeed() const;
+
+    /**
+     * Set mSeed.
+     *
+     * @param seed the seed
+     */
+    void SetSeed(unsigned seed);
+
+    /**
+     * @return a uniform random deviate in [0,1) for a cell at the current time step.
+     *
+     * @param cellId the ID of the cell
+     * @param purpose what the number is used for
+     * @param index the index of the draw for this cell, step and purpose
+     */
+    double ranf(unsigned cellId, Purpose purpose, unsigned index);
+
+    /**
+     * @return a normal random deviate for a cell at the current time step.
+     *
+     * @param mean the mean of the distribution
+     * @param sd the standard deviation of the distribution
+     * @param cellId the ID of the cell
+     * @param purpose what the number is used for
+     * @param index the index of the draw for this cell, step and purpose
+     */
+    double NormalRandomDeviate(double mean, double sd, unsigned cellId, Purpose purpose, unsigned index);
+};
+
+/**
+ * A cursor in the counter-based stream of one cell for one purpose, for a caller that draws a varying number
+ * of random numbers in each time step, such as an ODE system whose noise is drawn at each evaluation. The
+ * index of the draw restarts from zero at each time step.
+ */
+class CounterBasedRandomStream
+{
+private:
+
+    /** The ID of the cell. */
+    unsigned mCellId;
+
+    /** What the random numbers are used for. */
+    CounterBasedRandomStreams::Purpose mPurpose;
+
+    /** The time step of the last draw. */
+    unsigned mTimeStep;
+
+    /** The number of draws in that time step. */
+    unsigned mNumDraws;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param purpose what the random numbers are used for
+     */
+    CounterBasedRandomStream(CounterBasedRandomStreams::Purpose purpose);
+
+    /**
+     * Set mCellId.
+     *
+     * @param cellId the ID of the cell
+     */
+    void SetCellId(unsigned cellId);
+
+    /**
+     * @return the next normal random deviate in the stream.
+     *
+     * @param mean the mean of the distribution
+     * @param sd the standard deviation of the distribution
+     */
+    double NormalRandomDeviate(double mean, double sd);
+};
+
+#endif /*COUNTERBASEDRANDOMSTREAMS_HPP_*/
@@ -0,0 +1,228 @@
+
+#include "NissenHaloStateMirror.hpp"
+#include "CellPolarityVectors.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "TrophectodermCellProliferativeType.hpp"
+#include "EpiblastCellProliferativeType.hpp"
+#include "PrECellProliferativeType.hpp"
+#include "PetscTools.hpp"
+
+#include <cmath>
+
+/** The number of doubles in the record of one node: index, type tag, angle and three polarity components. */
+static const unsigned HALO_RECORD_SIZE = 6;
+
+/** MPI tag for the number of doubles in a message. */
+static const int HALO_SIZE_TAG = 4201;
+
+/** MPI tag for the records themselves. */
+static const int HALO_RECORD_TAG = 4202;
+
+template<unsigned DIM>
+NissenHaloStateMirror<DIM>* NissenHaloStateMirror<DIM>::mpInstance = nullptr;
+
+template<unsigned DIM>
+NissenHaloStateMirror<DIM>::NissenHaloStateMirror()
+    : mNumExchanges(0)
+{
+}
+
+template<unsigned DIM>
+NissenHaloStateMirror<DIM>* NissenHaloStateMirror<DIM>::Instance()
+{
+    if (mpInstance == nullptr)
+    {
+        mpInstance = new NissenHaloStateMirror<DIM>;
+    }
+    return mpInstance;
+}
+
+template<unsigned DIM>
+void NissenHaloStateMirror<DIM>::Destroy()
+{
+    if (mpInstance)
+    {
+        delete mpInstance;
+        mpInstance = nullptr;
+    }
+}
+
+template<unsigned DIM>
+typename NissenHaloStateMirror<DIM>::CellTypeTag NissenHaloStateMirror<DIM>::GetCellTypeTag(CellPtr pCell)
+{
+    boost::shared_ptr<AbstractCellProperty> p_type = pCell->GetCellProliferativeType();
+    if (p_type->template IsType<TrophectodermCellProliferativeType>())
+    {
+        return TROPHECTODERM_TYPE;
+    }
+    else if (p_type->template IsType<EpiblastCellProliferativeType>())
+    {
+        return EPIBLAST_TYPE;
+    }
+    else if (p_type->template IsType<PrECellProliferativeType>())
+    {
+        return PRE_TYPE;
+    }
+    else if (p_type->template IsType<TransitCellProliferativeType>())
+    {
+        return TRANSIT_TYPE;
+    }
+    return OTHER_TYPE;
+}
+
+template<unsigned DIM>
+void NissenHaloStateMirror<DIM>::PackNodeState(NodeBasedCellPopulation<DIM>& rCellPopulation,
+                                               unsigned nodeIndex,
+                                               std::vector<double>& rBuffer)
+{
+    CellPtr p_cell = rCellPopulation.GetCellUsingLocationIndex(nodeIndex);
+
+    double polarity[3] = {0.0, 0.0, 0.0};
+    double angle = 0.0;
+    if (CellPolaritySrnModel* p_angle_model = dynamic_cast<CellPolaritySrnModel*>(p_cell->GetSrnModel()))
+    {
+        // Send the angle itself, so that the angle-based forces see exactly the value held by the owner
+        angle = p_angle_model->GetPolarityAngle();
+        polarity[0] = cos(angle);
+        polarity[1] = sin(angle);
+    }
+    else
+    {
+        c_vector<double, DIM> vector = CellPolarityVectors::GetPolarityVector<DIM>(p_cell);
+        for (unsigned i=0; i<DIM; i++)
+        {
+            polarity[i] = vector(i);
+        }
+        angle = atan2(polarity[1], polarity[0]);
+    }
+
+    rBuffer.push_back(nodeIndex);
+    rBuffer.push_back(GetCellTypeTag(p_cell));
+    rBuffer.push_back(angle);
+    rBuffer.insert(rBuffer.end(), polarity, polarity + 3);
+}
+
+template<unsigned DIM>
+void NissenHaloStateMirror<DIM>::ExchangeWithNeighbour(NodeBasedCellPopulation<DIM>& rCellPopulation,
+                                                       const std::vector<unsigned>& rNodesToSend,
+                                                       unsigned neighbourRank)
+{
+    std::vector<double> send_buffer;
+    send_buffer.reserve(HALO_RECORD_SIZE*rNodesToSend.size());
+    for (unsigned i=0; i<rNodesToSend.size(); i++)
+    {
+        PackNodeState(rCellPopulation, rNodesToSend[i], send_buffer);
+    }
+
+    MPI_Status status;
+    unsigned send_size = send_buffer.size();
+    unsigned receive_size = 0;
+    MPI_Sendrecv(&send_size, 1, MPI_UNSIGNED, neighbourRank, HALO_SIZE_TAG,
+                 &receive_size, 1, MPI_UNSIGNED, neighbourRank, HALO_SIZE_TAG,
+                 PETSC_COMM_WORLD, &status);
+
+    std::vector<double> receive_buffer(receive_size);
+    MPI_Sendrecv(send_buffer.data(), send_size, MPI_DOUBLE, neighbourRank, HALO_RECORD_TAG,
+                 receive_buffer.data(), receive_size, MPI_DOUBLE, neighbourRank, HALO_RECORD_TAG,
+                 PETSC_COMM_WORLD, &status);
+
+    assert(receive_size % HALO_RECORD_SIZE == 0);
+    for (unsigned k=0; k<receive_size; k += HALO_RECORD_SIZE)
+    {
+        HaloNodeState& r_state = mHaloNodeStates[static_cast<unsigned>(receive_buffer[k])];
+        r_state.mTypeTag = static_cast<CellTypeTag>(static_cast<unsigned>(receive_buffer[k+1]));
+        r_state.mPolarityAngle = receive_buffer[k+2];
+        for (unsigned i=0; i<DIM; i++)
+        {
+            r_state.mPolarity(i) = receive_buffer[k+3+i];
+        }
+    }
+}
+
+template<unsigned DIM>
+void NissenHaloStateMirror<DIM>::Refresh(NodeBasedCellPopulation<DIM>& rCellPopulation)
+{
+    mHaloNodeStates.clear();
+    if (PetscTools::IsSequential())
+    {
+        return;
+    }
+
+    /*
+     * The mesh is split into slabs along its last axis, so each process only shares halo nodes with
+     * the processes either side. Exchanging to the right first cannot deadlock: the topmost process
+     * only exchanges to the left, which releases the process below it, and so on down.
+     */
+    NodesOnlyMesh<DIM>& r_mesh = rCellPopulation.rGetMesh();
+    unsigned my_rank = PetscTools::GetMyRank();
+    if (!PetscTools::AmTopMost())
+    {
+        ExchangeWithNeighbour(rCellPopulation, r_mesh.rGetHaloNodesToSendRight(), my_rank + 1);
+    }
+    if (!PetscTools::AmMaster())
+    {
+        ExchangeWithNeighbour(rCellPopulation, r_mesh.rGetHaloNodesToSendLeft(), my_rank - 1);
+    }
+    mNumExchanges++;
+}
+
+template<unsigned DIM>
+bool NissenHaloStateMirror<DIM>::IsHaloNode(unsigned nodeIndex) const
+{
+    return !mHaloNodeStates.empty() && mHaloNodeStates.find(nodeIndex) != mHaloNodeStates.end();
+}
+
+template<unsigned DIM>
+const typename NissenHaloStateMirror<DIM>::HaloNodeState& NissenHaloStateMirror<DIM>::rGetHaloNodeState(unsigned nodeIndex) const
+{
+    typename std::map<unsigned, HaloNodeState>::const_iterator iter = mHaloNodeStates.find(nodeIndex);
+    assert(iter != mHaloNodeStates.end());
+    return iter->second;
+}
+
+template<unsigned DIM>
+std::vector<unsigned> NissenHaloStateMirror<DIM>::GetHaloNodeIndices(CellTypeTag typeTag) const
+{
+    std::vector<unsigned> indices;
+    for (typename std::map<unsigned, HaloNodeState>::const_iterator iter = mHaloNodeStates.begin();
+         iter != mHaloNodeStates.end();
+         ++iter)
+    {
+        if (iter->second.mTypeTag == typeTag)
+        {
+            indices.push_back(iter->first);
+        }
+    }
+    return indices;
+}
+
+template<unsigned DIM>
+c_vector<double, DIM> NissenHaloStateMirror<DIM>::GetPolarityVector(CellPtr pCell, unsigned nodeIndex) const
+{
+    if (IsHaloNode(nodeIndex))
+    {
+        return rGetHaloNodeState(nodeIndex).mPolarity;
+    }
+    return CellPolarityVectors::GetPolarityVector<DIM>(pCell);
+}
+
+template<unsigned DIM>
+double NissenHaloStateMirror<DIM>::GetPolarityAngle(CellPtr pCell, unsigned nodeIndex) const
+{
+    if (IsHaloNode(nodeIndex))
+    {
+        return rGetHaloNodeState(nodeIndex).mPolarityAngle;
+    }
+    return static_cast<CellPolaritySrnModel*>(pCell->GetSrnModel())->GetPolarityAngle();
+}
+
+template<unsigned DIM>
+unsigned NissenHaloStateMirror<DIM>::GetNumExchanges() const
+{
+    return mNumExchanges;
+}
+
+// Explicit instantiation
+template class NissenHaloStateMirror<1>;
+template class NissenHaloStateMirror<2>;
+template class NissenHaloStateMirror<3>;
@@ -0,0 +1,164 @@
+
+#ifndef NISSENHALOSTATEMIRROR_HPP_
+#define NISSENHALOSTATEMIRROR_HPP_
+
+#include <map>
+#include <vector>
+#include "UblasVectorInclude.hpp"
+#include "NodeBasedCellPopulation.hpp"
+
+/**
+ * A mirror of the polarity and proliferative type of the halo nodes of a distributed
+ * NodeBasedCellPopulation, shared by the Dhall forces and polarity modifiers.
+ *
+ * When a population is split across processes, the nodes within the interaction distance of a
+ * process boundary are copied to the neighbouring process as halo nodes, but the polarity of the
+ * cells they belong to is held by SRN models that live only on the owning process. Refresh() sends
+ * a small record for each node in the mesh's lists of halo nodes to send left and right (its type
+ * tag, its polarity vector and, for a CellPolaritySrnModel, its polarity angle) to the neighbouring
+ * process, and stores the records it receives by global node index. The forces and modifiers then
+ * read the polarity of halo nodes from here through GetPolarityVector() and GetPolarityAngle(),
+ * and that of owned nodes from their cells as before.
+ *
+ * Refresh() must be called on every process at the same point, since it communicates. In a
+ * sequential run it does nothing and no node is a halo node, so serial results are unchanged.
+ */
+template<unsigned DIM>
+class NissenHaloStateMirror
+{
+public:
+
+    /** The proliferative types a halo node may have, as sent between processes. */
+    enum CellTypeTag
+    {
+        OTHER_TYPE = 0,          /**< Any type not listed below. */
+        TRANSIT_TYPE = 1,        /**< TransitCellProliferativeType (undetermined ICM). */
+        TROPHECTODERM_TYPE = 2,  /**< TrophectodermCellProliferativeType. */
+        EPIBLAST_TYPE = 3,       /**< EpiblastCellProliferativeType. */
+        PRE_TYPE = 4             /**< PrECellProliferativeType. */
+    };
+
+    /**
+     * The state of a halo node's cell.
+     */
+    struct HaloNodeState
+    {
+        /** The cell's proliferative type. */
+        CellTypeTag mTypeTag;
+
+        /** The cell's unit polarity vector, or zero if it has no polarity SRN model. */
+        c_vector<double, DIM> mPolarity;
+
+        /** The cell's polarity angle if it has a CellPolaritySrnModel, otherwise the angle of mPolarity in the xy plane. */
+        double mPolarityAngle;
+    };
+
+private:
+
+    /** Pointer to the single instance for this dimension. */
+    static NissenHaloStateMirror* mpInstance;
+
+    /** The state of each halo node received in the last call to Refresh(), by global node index. */
+    std::map<unsigned, HaloNodeState> mHaloNodeStates;
+
+    /** The number of calls to Refresh() that communicated. */
+    unsigned mNumExchanges;
+
+    /**
+     * Default constructor. Private, as this is a singleton.
+     */
+    NissenHaloStateMirror();
+
+    /**
+     * Append the record of an owned node to a send buffer: its global index, type tag, polarity
+     * angle and the three components of its polarity vector.
+     *
+     * @param rCellPopulation the cell population
+     * @param nodeIndex the global index of the node
+     * @param rBuffer the buffer
+     */
+    void PackNodeState(NodeBasedCellPopulation<DIM>& rCellPopulation, unsigned nodeIndex, std::vector<double>& rBuffer);
+
+    /**
+     * Send the records of some owned nodes to a neighbouring process and store the records it sends back.
+     *
+     * @param rCellPopulation the cell population
+     * @param rNodesToSend the global indices of the nodes to send
+     * @param neighbourRank the rank of the neighbouring process
+     */
+    void ExchangeWithNeighbour(NodeBasedCellPopulation<DIM>& rCellPopulation,
+                               const std::vector<unsigned>& rNodesToSend,
+                               unsigned neighbourRank);
+
+public:
+
+    /**
+     * @return the single instance of the mirror for this dimension, creating it if necessary.
+     */
+    static NissenHaloStateMirror* Instance();
+
+    /**
+     * Destroy the single instance of the mirror for this dimension.
+     */
+    static void Destroy();
+
+    /**
+     * @return the type tag of a cell.
+     *
+     * @param pCell the cell
+     */
+    static CellTypeTag GetCellTypeTag(CellPtr pCell);
+
+    /**
+     * Exchange the state of the halo nodes with the neighbouring processes. Does nothing in a sequential run.
+     *
+     * @param rCellPopulation the cell population, whose halo nodes must be current
+     */
+    void Refresh(NodeBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * @return whether a node is a halo node whose state was received in the last call to Refresh().
+     *
+     * @param nodeIndex the global index of the node
+     */
+    bool IsHaloNode(unsigned nodeIndex) const;
+
+    /**
+     * @return the state of a halo node.
+     *
+     * @param nodeIndex the global index of the node, which must be a halo node
+     */
+    const HaloNodeState& rGetHaloNodeState(unsigned nodeIndex) const;
+
+    /**
+     * @return the global indices of the halo nodes with a given type tag.
+     *
+     * @param typeTag the type tag
+     */
+    std::vector<unsigned> GetHaloNodeIndices(CellTypeTag typeTag) const;
+
+    /**
+     * @return the unit polarity vector of the cell at a node: from the mirror for a halo node, and from
+     * the cell, as given by CellPolarityVectors::GetPolarityVector(), otherwise.
+     *
+     * @param pCell the cell at the node
+     * @param nodeIndex the global index of the node
+     */
+    c_vector<double, DIM> GetPolarityVector(CellPtr pCell, unsigned nodeIndex) const;
+
+    /**
+     * @return the polarity angle of the cell at a node, which must have a CellPolaritySrnModel: from the
+     * mirror for a halo node, and from the cell's SRN model otherwise.
+     *
+     * @param pCell the cell at the node
+     * @param nodeIndex the global index of the node
+     */
+    double GetPolarityAngle(CellPtr pCell, unsigned nodeIndex) const;
+
+    /**
+     * @return the number of calls to Refresh() that communicated.
+     */
+    unsigned GetNumExchanges() const;
+};
+
+#endif /*NISSENHALOSTATEMIRROR_HPP_*/
@@ -0,0 +1,406 @@
+
+#include "NissenPairGeometryCache.hpp"
+#include "PetscTools.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+template<unsigned DIM>
+NissenPairGeometryCache<DIM>* NissenPairGeometryCache<DIM>::mpInstance = nullptr;
+
+template<unsigned DIM>
+NissenPairGeometryCache<DIM>::NissenPairGeometryCache()
+    : mpCellPopulation(nullptr),
+      mNumNodes(0),
+      mNumNodePairs(0),
+      mLocationChecksum(0.0),
+      mNumRebuilds(0),
+      mNumQueries(0),
+      mReorderInterval(0),
+      mLocalityThreshold(2.0),
+      mLocalityMetric(0.0),
+      mLocalityMetricAfterReordering(0.0),
+      mNumRebuildsSinceReordering(0),
+      mNumReorderings(0)
+{
+}
+
+template<unsigned DIM>
+NissenPairGeometryCache<DIM>* NissenPairGeometryCache<DIM>::Instance()
+{
+    if (mpInstance == nullptr)
+    {
+        mpInstance = new NissenPairGeometryCache<DIM>;
+    }
+    return mpInstance;
+}
+
+template<unsigned DIM>
+void NissenPairGeometryCache<DIM>::Destroy()
+{
+    if (mpInstance)
+    {
+        delete mpInstance;
+        mpInstance = nullptr;
+    }
+}
+
+template<unsigned DIM>
+double NissenPairGeometryCache<DIM>::ComputeLocationChecksum(NodeBasedCellPopulation<DIM>& rCellPopulation)
+{
+    // Weight each coordinate by its node index so that exchanging two nodes also changes the checksum
+    double checksum = 0.0;
+    for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = rCellPopulation.rGetMesh().GetNodeIteratorBegin();
+         node_iter != rCellPopulation.rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        const c_vector<double, DIM>& r_location = node_iter->rGetLocation();
+        double weight = node_iter->GetIndex() + 1.0;
+        for (unsigned j=0; j<DIM; j++)
+        {
+            checksum += weight*(j + 1.0)*r_location[j];
+        }
+    }
+    return checksum;
+}
+
+template<unsigned DIM>
+const std::vector<typename NissenPairGeometryCache<DIM>::PairGeometry>& NissenPairGeometryCache<DIM>::rGetPairs(NodeBasedCellPopulation<DIM>& rCellPopulation)
+{
+    mNumQueries++;
+
+    std::vector<std::pair<Node<DIM>*, Node<DIM>*> >& r_node_pairs = rCellPopulation.rGetNodePairs();
+    unsigned num_nodes = rCellPopulation.GetNumNodes();
+    double checksum = ComputeLocationChecksum(rCellPopulation);
+
+    // Halo nodes are received afresh at each Update() and are not covered by the checksum, so a distributed cache is always rebuilt
+    if (PetscTools::IsSequential()
+        && mpCellPopulation == &rCellPopulation
+        && mNumNodes == num_nodes
+        && mNumNodePairs == r_node_pairs.size()
+        && mLocationChecksum == checksum)
+    {
+        return mPairs;
+    }
+
+    UpdateNodeOrdering(rCellPopulation);
+
+    // Sort the pairs by the position of their earlier node in the ordering (a stable counting sort)
+    std::vector<unsigned> bucket_starts(mNodeOrdering.size() + 1, 0);
+    for (unsigned i=0; i<r_node_pairs.size(); i++)
+    {
+        unsigned position = std::min(GetOrderingIndex(r_node_pairs[i].first->GetIndex()),
+                                     GetOrderingIndex(r_node_pairs[i].second->GetIndex()));
+        bucket_starts[position + 1]++;
+    }
+    for (unsigned k=0; k<mNodeOrdering.size(); k++)
+    {
+        bucket_starts[k+1] += bucket_starts[k];
+    }
+
+    mPairs.resize(r_node_pairs.size());
+    for (unsigned i=0; i<r_node_pairs.size(); i++)
+    {
+        unsigned position = std::min(GetOrderingIndex(r_node_pairs[i].first->GetIndex()),
+                                     GetOrderingIndex(r_node_pairs[i].second->GetIndex()));
+        PairGeometry& r_pair = mPairs[bucket_starts[position]++];
+        r_pair.mNodeAIndex = r_node_pairs[i].first->GetIndex();
+        r_pair.mNodeBIndex = r_node_pairs[i].second->GetIndex();
+        r_pair.mVectorFromAtoB = rCellPopulation.rGetMesh().GetVectorFromAtoB(r_node_pairs[i].first->rGetLocation(),
+                                                                               r_node_pairs[i].second->rGetLocation());
+        r_pair.mDistance = norm_2(r_pair.mVectorFromAtoB);
+    }
+
+    mpCellPopulation = &rCellPopulation;
+    mNumNodes = num_nodes;
+    mNumNodePairs = r_node_pairs.size();
+    mLocationChecksum = checksum;
+    mNumRebuilds++;
+
+    return mPairs;
+}
+
+template<unsigned DIM>
+void NissenPairGeometryCache<DIM>::UpdateNodeOrdering(NodeBasedCellPopulation<DIM>& rCellPopulation)
+{
+    unsigned max_index = 0;
+    for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = rCellPopulation.rGetMesh().GetNodeIteratorBegin();
+         node_iter != rCellPopulation.rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        max_index = std::max(max_index, node_iter->GetIndex());
+    }
+
+    std::vector<bool> is_present(max_index + 1, false);
+    for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = rCellPopulation.rGetMesh().GetNodeIteratorBegin();
+         node_iter != rCellPopulation.rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        is_present[node_iter->GetIndex()] = true;
+    }
+
+    // Keep the surviving nodes in their current order
+    bool is_first_ordering = (mNodeOrdering.empty() || mpCellPopulation != &rCellPopulation);
+    std::vector<unsigned> ordering;
+    ordering.reserve(rCellPopulation.GetNumNodes());
+    std::vector<bool> is_ordered(max_index + 1, false);
+    if (!is_first_ordering)
+    {
+        for (unsigned k=0; k<mNodeOrdering.size(); k++)
+        {
+            unsigned index = mNodeOrdering[k];
+            if (index <= max_index && is_present[index])
+            {
+                ordering.push_back(index);
+                is_ordered[index] = true;
+            }
+        }
+    }
+
+    // Insert each new node (typically a daughter cell) just after a neighbour that is already ordered
+    std::vector<unsigned> positions(max_index + 1, UINT_MAX);
+    for (unsigned k=0; k<ordering.size(); k++)
+    {
+        positions[ordering[k]] = k;
+    }
+
+    std::vector<unsigned> anchors(max_index + 1, UINT_MAX);
+    std::vector<std::pair<Node<DIM>*, Node<DIM>*> >& r_node_pairs = rCellPopulation.rGetNodePairs();
+    for (unsigned i=0; i<r_node_pairs.size(); i++)
+    {
+        unsigned index_a = r_node_pairs[i].first->GetIndex();
+        unsigned index_b = r_node_pairs[i].second->GetIndex();
+
+        // Halo nodes of a distributed population are not ordered, and may lie outside the range of owned indices
+        if (index_a > max_index || index_b > max_index)
+        {
+            continue;
+        }
+        if (!is_ordered[index_a] && is_ordered[index_b] && anchors[index_a] == UINT_MAX)
+        {
+            anchors[index_a] = positions[index_b];
+        }
+        if (!is_ordered[index_b] && is_ordered[index_a] && anchors[index_b] == UINT_MAX)
+        {
+            anchors[index_b] = positions[index_a];
+        }
+    }
+
+    std::vector<std::vector<unsigned> > inserted_after(ordering.size());
+    std::vector<unsigned> unanchored;
+    for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = rCellPopulation.rGetMesh().GetNodeIteratorBegin();
+         node_iter != rCellPopulation.rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        unsigned index = node_iter->GetIndex();
+        if (!is_ordered[index])
+        {
+            if (anchors[index] != UINT_MAX)
+            {
+                inserted_after[anchors[index]].push_back(index);
+            }
+            else
+            {
+                unanchored.push_back(index);
+            }
+        }
+    }
+
+    mNodeOrdering.clear();
+    mNodeOrdering.reserve(rCellPopulation.GetNumNodes());
+    for (unsigned k=0; k<ordering.size(); k++)
+    {
+        mNodeOrdering.push_back(ordering[k]);
+        mNodeOrdering.insert(mNodeOrdering.end(), inserted_after[k].begin(), inserted_after[k].end());
+    }
+    mNodeOrdering.insert(mNodeOrdering.end(), unanchored.begin(), unanchored.end());
+    ComputeOrderingIndices();
+
+    mLocalityMetric = ComputeLocalityMetric(rCellPopulation);
+    mNumRebuildsSinceReordering++;
+
+    if (is_first_ordering
+        || (mReorderInterval > 0 && mNumRebuildsSinceReordering >= mReorderInterval)
+        || mLocalityMetric > mLocalityThreshold*std::max(mLocalityMetricAfterReordering, 1.0))
+    {
+        ComputeMortonOrdering(rCellPopulation);
+        ComputeOrderingIndices();
+
+        mLocalityMetric = ComputeLocalityMetric(rCellPopulation);
+        mLocalityMetricAfterReordering = mLocalityMetric;
+        mNumRebuildsSinceReordering = 0;
+        mNumReorderings++;
+    }
+}
+
+template<unsigned DIM>
+void NissenPairGeometryCache<DIM>::ComputeMortonOrdering(NodeBasedCellPopulation<DIM>& rCellPopulation)
+{
+    if (mNodeOrdering.empty())
+    {
+        return;
+    }
+
+    c_vector<double, DIM> min_corner = rCellPopulation.GetNode(mNodeOrdering[0])->rGetLocation();
+    c_vector<double, DIM> max_corner = min_corner;
+    for (unsigned k=1; k<mNodeOrdering.size(); k++)
+    {
+        const c_vector<double, DIM>& r_location = rCellPopulation.GetNode(mNodeOrdering[k])->rGetLocation();
+        for (unsigned j=0; j<DIM; j++)
+        {
+            min_corner[j] = std::min(min_corner[j], r_location[j]);
+            max_corner[j] = std::max(max_corner[j], r_location[j]);
+        }
+    }
+
+    // Quantise each coordinate to the same number of bits, then interleave the bits
+    const unsigned bits_per_coordinate = 63/DIM;
+    const double max_cell = static_cast<double>((uint64_t(1) << bits_per_coordinate) - 1);
+
+    std::vector<std::pair<uint64_t, unsigned> > codes(mNodeOrdering.size());
+    for (unsigned k=0; k<mNodeOrdering.size(); k++)
+    {
+        const c_vector<double, DIM>& r_location = rCellPopulation.GetNode(mNodeOrdering[k])->rGetLocation();
+
+        uint64_t cells[DIM];
+        for (unsigned j=0; j<DIM; j++)
+        {
+            double extent = max_corner[j] - min_corner[j];
+            double scaled = (extent > 0.0) ? (r_location[j] - min_corner[j])/extent : 0.0;
+            cells[j] = static_cast<uint64_t>(std::floor(scaled*max_cell));
+        }
+
+        uint64_t code = 0;
+        for (unsigned bit=bits_per_coordinate; bit-- > 0; )
+        {
+            for (unsigned j=0; j<DIM; j++)
+            {
+                code = (code << 1) | ((cells[j] >> bit) & 1);
+            }
+        }
+        codes[k] = std::make_pair(code, mNodeOrdering[k]);
+    }
+
+    std::sort(codes.begin(), codes.end());
+    for (unsigned k=0; k<codes.size(); k++)
+    {
+        mNodeOrdering[k] = codes[k].second;
+    }
+}
+
+template<unsigned DIM>
+void NissenPairGeometryCache<DIM>::ComputeOrderingIndices()
+{
+    unsigned max_index = 0;
+    for (unsigned k=0; k<mNodeOrdering.size(); k++)
+    {
+        max_index = std::max(max_index, mNodeOrdering[k]);
+    }
+
+    mOrderingIndices.assign(max_index + 1, UINT_MAX);
+    for (unsigned k=0; k<mNodeOrdering.size(); k++)
+    {
+        mOrderingIndices[mNodeOrdering[k]] = k;
+    }
+}
+
+template<unsigned DIM>
+unsigned NissenPairGeometryCache<DIM>::GetOrderingIndex(unsigned nodeIndex) const
+{
+    return (nodeIndex < mOrderingIndices.size()) ? mOrderingIndices[nodeIndex] : UINT_MAX;
+}
+
+template<unsigned DIM>
+double NissenPairGeometryCache<DIM>::ComputeLocalityMetric(NodeBasedCellPopulation<DIM>& rCellPopulation)
+{
+    std::vector<std::pair<Node<DIM>*, Node<DIM>*> >& r_node_pairs = rCellPopulation.rGetNodePairs();
+    if (r_node_pairs.empty())
+    {
+        return 0.0;
+    }
+
+    double total_gap = 0.0;
+    unsigned num_owned_pairs = 0;
+    for (unsigned i=0; i<r_node_pairs.size(); i++)
+    {
+        unsigned position_a = GetOrderingIndex(r_node_pairs[i].first->GetIndex());
+        unsigned position_b = GetOrderingIndex(r_node_pairs[i].second->GetIndex());
+
+        // Skip pairs with a halo node
+        if (position_a == UINT_MAX || position_b == UINT_MAX)
+        {
+            continue;
+        }
+        total_gap += (position_a > position_b) ? position_a - position_b : position_b - position_a;
+        num_owned_pairs++;
+    }
+    return (num_owned_pairs > 0) ? total_gap/num_owned_pairs : 0.0;
+}
+
+template<unsigned DIM>
+const std::vector<unsigned>& NissenPairGeometryCache<DIM>::rGetNodeOrdering(NodeBasedCellPopulation<DIM>& rCellPopulation)
+{
+    rGetPairs(rCellPopulation);
+    return mNodeOrdering;
+}
+
+template<unsigned DIM>
+void NissenPairGeometryCache<DIM>::Invalidate()
+{
+    mpCellPopulation = nullptr;
+}
+
+template<unsigned DIM>
+unsigned NissenPairGeometryCache<DIM>::GetReorderInterval() const
+{
+    return mReorderInterval;
+}
+
+template<unsigned DIM>
+void NissenPairGeometryCache<DIM>::SetReorderInterval(unsigned reorderInterval)
+{
+    mReorderInterval = reorderInterval;
+}
+
+template<unsigned DIM>
+double NissenPairGeometryCache<DIM>::GetLocalityThreshold() const
+{
+    return mLocalityThreshold;
+}
+
+template<unsigned DIM>
+void NissenPairGeometryCache<DIM>::SetLocalityThreshold(double localityThreshold)
+{
+    assert(localityThreshold >= 1.0);
+    mLocalityThreshold = localityThreshold;
+}
+
+template<unsigned DIM>
+double NissenPairGeometryCache<DIM>::GetLocalityMetric() const
+{
+    return mLocalityMetric;
+}
+
+template<unsigned DIM>
+unsigned NissenPairGeometryCache<DIM>::GetNumReorderings() const
+{
+    return mNumReorderings;
+}
+
+template<unsigned DIM>
+unsigned NissenPairGeometryCache<DIM>::GetNumRebuilds() const
+{
+    return mNumRebuilds;
+}
+
+template<unsigned DIM>
+unsigned NissenPairGeometryCache<DIM>::GetNumQueries() const
+{
+    return mNumQueries;
+}
+
+// Explicit instantiation
+template class NissenPairGeometryCache<1>;
+template class NissenPairGeometryCache<2>;
+template class NissenPairGeometryCache<3>;
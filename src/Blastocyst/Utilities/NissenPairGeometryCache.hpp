@@ -0,0 +1,229 @@
+
+#ifndef NISSENPAIRGEOMETRYCACHE_HPP_
+#define NISSENPAIRGEOMETRYCACHE_HPP_
+
+#include <vector>
+#include <stdint.h>
+#include "UblasVectorInclude.hpp"
+#include "NodeBasedCellPopulation.hpp"
+
+/**
+ * A cache of the geometry of each pair of nearby nodes in a NodeBasedCellPopulation, shared by the
+ * Dhall forces and modifiers so that each displacement vector and distance is computed once per
+ * time step rather than once by each force and again by CellPolarityTrackingModifier.
+ *
+ * The pairs are those returned by NodeBasedCellPopulation::rGetNodePairs(), with the same
+ * orientation. The cache is rebuilt lazily whenever rGetPairs() is called after the population,
+ * its number of nodes or pairs, or any node location has changed.
+ *
+ * Node indices are assigned in birth order, so as the embryo grows spatial neighbours end up far
+ * apart in the mesh's node storage. The cache therefore keeps its own ordering of the nodes along
+ * a Morton (Z-order) curve and stores the pairs sorted by the position of their earlier node in
+ * this ordering, so that loops over the pairs visit nearby nodes together. Each new node is inserted
+ * into the ordering just after a neighbour (for a daughter cell, usually its parent), and the whole
+ * ordering is only recomputed every mReorderInterval rebuilds or when the locality metric
+ * (the mean distance in the ordering between the two nodes of a pair) grows to mLocalityThreshold
+ * times its value just after the last reordering. Callers such as CellPolarityTrackingModifier use
+ * rGetNodeOrdering() to lay out their own per-cell arrays in the same order.
+ *
+ * For a population distributed across processes, only the owned nodes are ordered; a pair with a halo
+ * node is placed by its owned node. Since halo nodes are not covered by the location checksum, the cache
+ * is then rebuilt on every call.
+ */
+template<unsigned DIM>
+class NissenPairGeometryCache
+{
+public:
+
+    /**
+     * The geometry of a pair of nodes.
+     */
+    struct PairGeometry
+    {
+        /** Global index of the first node in the pair. */
+        unsigned mNodeAIndex;
+
+        /** Global index of the second node in the pair. */
+        unsigned mNodeBIndex;
+
+        /** The vector from node A to node B, as given by the mesh method GetVectorFromAtoB(). */
+        c_vector<double, DIM> mVectorFromAtoB;
+
+        /** The distance between the two nodes. */
+        double mDistance;
+    };
+
+private:
+
+    /** Pointer to the single instance for this dimension. */
+    static NissenPairGeometryCache* mpInstance;
+
+    /** The cached pair geometry. */
+    std::vector<PairGeometry> mPairs;
+
+    /** The population the cache was last built for. */
+    const NodeBasedCellPopulation<DIM>* mpCellPopulation;
+
+    /** The number of nodes when the cache was last built. */
+    unsigned mNumNodes;
+
+    /** The number of node pairs when the cache was last built. */
+    unsigned mNumNodePairs;
+
+    /** A checksum of the node locations when the cache was last built. */
+    double mLocationChecksum;
+
+    /** The number of times the cache has been rebuilt. */
+    unsigned mNumRebuilds;
+
+    /** The number of calls to rGetPairs(). */
+    unsigned mNumQueries;
+
+    /** Global indices of the nodes, in the cache's ordering. */
+    std::vector<unsigned> mNodeOrdering;
+
+    /** Position of each node in mNodeOrdering, indexed by global index (UINT_MAX for unused indices). */
+    std::vector<unsigned> mOrderingIndices;
+
+    /** The number of rebuilds between recomputations of the ordering (0 means only use the locality metric). */
+    unsigned mReorderInterval;
+
+    /** The ratio by which the locality metric may grow after a reordering before the ordering is recomputed. */
+    double mLocalityThreshold;
+
+    /** The locality metric when the cache was last built. */
+    double mLocalityMetric;
+
+    /** The locality metric just after the ordering was last recomputed. */
+    double mLocalityMetricAfterReordering;
+
+    /** The number of rebuilds since the ordering was last recomputed. */
+    unsigned mNumRebuildsSinceReordering;
+
+    /** The number of times the ordering has been recomputed. */
+    unsigned mNumReorderings;
+
+    /**
+     * Default constructor. Private, as this is a singleton.
+     */
+    NissenPairGeometryCache();
+
+    /**
+     * Compute a checksum of the node locations of a population.
+     *
+     * @param rCellPopulation the cell population
+     * @return the checksum
+     */
+    double ComputeLocationChecksum(NodeBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Bring mNodeOrdering up to date with the nodes of a population, dropping removed nodes,
+     * inserting new ones beside their neighbours and recomputing the whole ordering if locality has degraded.
+     *
+     * @param rCellPopulation the cell population
+     */
+    void UpdateNodeOrdering(NodeBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Sort mNodeOrdering by the Morton code of each node's location within the bounding box of the population.
+     *
+     * @param rCellPopulation the cell population
+     */
+    void ComputeMortonOrdering(NodeBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Fill mOrderingIndices from mNodeOrdering.
+     */
+    void ComputeOrderingIndices();
+
+    /**
+     * @return the position of a node in mNodeOrdering, or UINT_MAX if it is not ordered (for example, a halo node).
+     *
+     * @param nodeIndex the global index of the node
+     */
+    unsigned GetOrderingIndex(unsigned nodeIndex) const;
+
+    /**
+     * @return the locality metric of the node pairs of a population under the current ordering.
+     *
+     * @param rCellPopulation the cell population
+     */
+    double ComputeLocalityMetric(NodeBasedCellPopulation<DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * @return the single instance of the cache for this dimension, creating it if necessary.
+     */
+    static NissenPairGeometryCache* Instance();
+
+    /**
+     * Destroy the single instance of the cache for this dimension.
+     */
+    static void Destroy();
+
+    /**
+     * @return the geometry of each node pair in the population, rebuilding the cache if anything has changed.
+     *
+     * @param rCellPopulation the cell population
+     */
+    const std::vector<PairGeometry>& rGetPairs(NodeBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * @return the global indices of the nodes in the cache's spatial ordering, rebuilding the cache if anything has changed.
+     *
+     * @param rCellPopulation the cell population
+     */
+    const std::vector<unsigned>& rGetNodeOrdering(NodeBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Force the cache to be rebuilt on the next call to rGetPairs().
+     */
+    void Invalidate();
+
+    /**
+     * @return mReorderInterval
+     */
+    unsigned GetReorderInterval() const;
+
+    /**
+     * Set mReorderInterval.
+     *
+     * @param reorderInterval the number of rebuilds between recomputations of the ordering (0 to only use the locality metric)
+     */
+    void SetReorderInterval(unsigned reorderInterval);
+
+    /**
+     * @return mLocalityThreshold
+     */
+    double GetLocalityThreshold() const;
+
+    /**
+     * Set mLocalityThreshold.
+     *
+     * @param localityThreshold the ratio by which the locality metric may grow before the ordering is recomputed
+     */
+    void SetLocalityThreshold(double localityThreshold);
+
+    /**
+     * @return the locality metric when the cache was last built.
+     */
+    double GetLocalityMetric() const;
+
+    /**
+     * @return the number of times the ordering has been recomputed.
+     */
+    unsigned GetNumReorderings() const;
+
+    /**
+     * @return the number of times the cache has been rebuilt.
+     */
+    unsigned GetNumRebuilds() const;
+
+    /**
+     * @return the number of calls to rGetPairs().
+     */
+    unsigned GetNumQueries() const;
+};
+
+#endif /*NISSENPAIRGEOMETRYCACHE_HPP_*/
@@ -0,0 +1,168 @@
+
+#ifndef OBJECTPOOL_HPP_
+#define OBJECTPOOL_HPP_
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/**
+ * A pool allocator for objects of a single class, used by class-specific operator new and
+ * operator delete so that the objects created at each cell division (cell-cycle models, SRN
+ * models and their ODE systems) are taken from contiguous chunks rather than individually
+ * from the heap.
+ *
+ * Memory is obtained in chunks of OBJECTS_PER_CHUNK slots and freed slots are kept on a free
+ * list for reuse; chunks are never returned to the heap. Requests for any size other than
+ * sizeof(T), such as from a subclass of T that does not provide its own operators, are passed
+ * to the global operators. Since boost serialization allocates through class-specific operators
+ * when they exist, objects loaded from an archive also come from the pool.
+ *
+ * The single instance for each class is deliberately never destroyed, so that objects may
+ * still be deleted safely during static destruction at program exit.
+ */
+template<class T, unsigned OBJECTS_PER_CHUNK=256>
+class ObjectPool
+{
+private:
+
+    /** The size of each slot, rounded up so that every slot is suitably aligned. */
+    static const std::size_t SLOT_SIZE = ((sizeof(T) + 2*sizeof(double) - 1)/(2*sizeof(double)))*(2*sizeof(double));
+
+    /** The chunks of memory obtained so far. */
+    std::vector<char*> mChunks;
+
+    /** The first free slot, each free slot holding a pointer to the next. */
+    void* mpFreeList;
+
+    /** The number of slots currently in use. */
+    unsigned mNumAllocated;
+
+    /**
+     * Default constructor. Private, as this is a singleton.
+     */
+    ObjectPool()
+        : mpFreeList(nullptr),
+          mNumAllocated(0)
+    {
+    }
+
+    /**
+     * Obtain a new chunk and add its slots to the free list.
+     */
+    void AddChunk()
+    {
+        char* p_chunk = static_cast<char*>(::operator new(SLOT_SIZE*OBJECTS_PER_CHUNK));
+        mChunks.push_back(p_chunk);
+
+        // Thread the slots onto the free list so that they are handed out in address order
+        for (unsigned i=OBJECTS_PER_CHUNK; i-- > 0; )
+        {
+            void* p_slot = p_chunk + i*SLOT_SIZE;
+            *static_cast<void**>(p_slot) = mpFreeList;
+            mpFreeList = p_slot;
+        }
+    }
+
+    /**
+     * @return whether some memory lies in one of the pool's chunks.
+     *
+     * @param pObject the memory
+     */
+    bool Owns(void* pObject) const
+    {
+        const char* p_object = static_cast<const char*>(pObject);
+        for (unsigned i=0; i<mChunks.size(); i++)
+        {
+            if (p_object >= mChunks[i] && p_object < mChunks[i] + SLOT_SIZE*OBJECTS_PER_CHUNK)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+
+    /**
+     * @return the single instance of the pool for this class, creating it if necessary.
+     */
+    static ObjectPool* Instance()
+    {
+        static ObjectPool* p_instance = new ObjectPool;
+        return p_instance;
+    }
+
+    /**
+     * Allocate memory for an object.
+     *
+     * @param size the number of bytes required
+     * @return the allocated memory
+     */
+    void* Allocate(std::size_t size)
+    {
+        if (size != sizeof(T))
+        {
+            return ::operator new(size);
+        }
+
+        if (mpFreeList == nullptr)
+        {
+            AddChunk();
+        }
+
+        void* p_slot = mpFreeList;
+        mpFreeList = *static_cast<void**>(p_slot);
+        mNumAllocated++;
+        return p_slot;
+    }
+
+    /**
+     * Release memory allocated by Allocate().
+     *
+     * @param pObject the memory to release
+     */
+    void Deallocate(void* pObject)
+    {
+        if (pObject == nullptr)
+        {
+            return;
+        }
+
+        if (!Owns(pObject))
+        {
+            ::operator delete(pObject);
+            return;
+        }
+
+        *static_cast<void**>(pObject) = mpFreeList;
+        mpFreeList = pObject;
+        mNumAllocated--;
+    }
+
+    /**
+     * @return the number of objects currently allocated from the pool.
+     */
+    unsigned GetNumAllocated() const
+    {
+        return mNumAllocated;
+    }
+
+    /**
+     * @return the number of objects the pool can hold without obtaining another chunk.
+     */
+    unsigned GetCapacity() const
+    {
+        return mChunks.size()*OBJECTS_PER_CHUNK;
+    }
+
+    /**
+     * @return the number of bytes obtained from the heap by the pool.
+     */
+    std::size_t GetNumBytesReserved() const
+    {
+        return mChunks.size()*OBJECTS_PER_CHUNK*SLOT_SIZE;
+    }
+};
+
+#endif /*OBJECTPOOL_HPP_*/
@@ -0,0 +1,144 @@
+
+#include "SparseSymmetricMatrix.hpp"
+
+#include <cassert>
+#include <cmath>
+
+SparseSymmetricMatrix::SparseSymmetricMatrix()
+{
+    Clear();
+}
+
+void SparseSymmetricMatrix::Clear(unsigned expectedNumRows)
+{
+    mRowStarts.clear();
+    mColumnIndices.clear();
+    mValues.clear();
+    mDiagonal.clear();
+
+    mRowStarts.reserve(expectedNumRows + 1);
+    mDiagonal.reserve(expectedNumRows);
+
+    mRowStarts.push_back(0);
+    mDiagonal.push_back(0.0);
+}
+
+void SparseSymmetricMatrix::AddEntry(unsigned column, double value)
+{
+    mColumnIndices.push_back(column);
+    mValues.push_back(value);
+
+    if (column == mRowStarts.size() - 1)
+    {
+        mDiagonal.back() += value;
+    }
+}
+
+void SparseSymmetricMatrix::FinishRow()
+{
+    mRowStarts.push_back(mValues.size());
+    mDiagonal.push_back(0.0);
+}
+
+unsigned SparseSymmetricMatrix::GetNumRows() const
+{
+    return mRowStarts.size() - 1;
+}
+
+void SparseSymmetricMatrix::Multiply(const std::vector<double>& rX, std::vector<double>& rResult) const
+{
+    unsigned num_rows = GetNumRows();
+    assert(rX.size() == num_rows);
+    rResult.resize(num_rows);
+
+    for (unsigned row=0; row<num_rows; row++)
+    {
+        double sum = 0.0;
+        for (unsigned k=mRowStarts[row]; k<mRowStarts[row+1]; k++)
+        {
+            sum += mValues[k]*rX[mColumnIndices[k]];
+        }
+        rResult[row] = sum;
+    }
+}
+
+unsigned SparseSymmetricMatrix::SolveWithConjugateGradient(const std::vector<double>& rRhs,
+                                                           std::vector<double>& rSolution,
+                                                           double relativeTolerance,
+                                                           unsigned maxIterations) const
+{
+    unsigned num_rows = GetNumRows();
+    assert(rRhs.size() == num_rows);
+    rSolution.resize(num_rows, 0.0);
+
+    if (num_rows == 0)
+    {
+        return 0;
+    }
+
+    // r = b - A*x
+    std::vector<double> residual(num_rows);
+    Multiply(rSolution, residual);
+    double rhs_norm_squared = 0.0;
+    for (unsigned i=0; i<num_rows; i++)
+    {
+        residual[i] = rRhs[i] - residual[i];
+        rhs_norm_squared += rRhs[i]*rRhs[i];
+    }
+
+    double tolerance_squared = relativeTolerance*relativeTolerance*rhs_norm_squared;
+
+    std::vector<double> preconditioned(num_rows);
+    std::vector<double> direction(num_rows);
+    std::vector<double> a_times_direction(num_rows);
+
+    double rz = 0.0;
+    double residual_norm_squared = 0.0;
+    for (unsigned i=0; i<num_rows; i++)
+    {
+        assert(mDiagonal[i] > 0.0);
+        preconditioned[i] = residual[i]/mDiagonal[i];
+        direction[i] = preconditioned[i];
+        rz += residual[i]*preconditioned[i];
+        residual_norm_squared += residual[i]*residual[i];
+    }
+
+    unsigned iteration = 0;
+    while (residual_norm_squared > tolerance_squared && iteration < maxIterations)
+    {
+        Multiply(direction, a_times_direction);
+
+        double p_a_p = 0.0;
+        for (unsigned i=0; i<num_rows; i++)
+        {
+            p_a_p += direction[i]*a_times_direction[i];
+        }
+        if (p_a_p <= 0.0)
+        {
+            // The matrix is not positive definite along this direction, so we can go no further
+            break;
+        }
+
+        double step = rz/p_a_p;
+        double new_rz = 0.0;
+        residual_norm_squared = 0.0;
+        for (unsigned i=0; i<num_rows; i++)
+        {
+            rSolution[i] += step*direction[i];
+            residual[i] -= step*a_times_direction[i];
+            preconditioned[i] = residual[i]/mDiagonal[i];
+            new_rz += residual[i]*preconditioned[i];
+            residual_norm_squared += residual[i]*residual[i];
+        }
+
+        double beta = new_rz/rz;
+        rz = new_rz;
+        for (unsigned i=0; i<num_rows; i++)
+        {
+            direction[i] = preconditioned[i] + beta*direction[i];
+        }
+        iteration++;
+    }
+
+    return iteration;
+}
@@ -0,0 +1,89 @@
+
+#ifndef SPARSESYMMETRICMATRIX_HPP_
+#define SPARSESYMMETRICMATRIX_HPP_
+
+#include <vector>
+
+/**
+ * A small compressed sparse row (CSR) matrix, intended for the symmetric positive
+ * definite systems that arise when cell-level quantities on the neighbour graph are
+ * advanced implicitly (for example the coupled trophectoderm polarity angles).
+ *
+ * Rows are assembled in order with AddEntry() and closed with FinishRow(). Only the
+ * sequential Jacobi-preconditioned conjugate gradient solve is provided; the systems
+ * are local to one process and small, so PETSc is not used.
+ */
+class SparseSymmetricMatrix
+{
+private:
+
+    /** Start of each row in mColumnIndices and mValues, with one extra entry at the end. */
+    std::vector<unsigned> mRowStarts;
+
+    /** Column index of each stored entry. */
+    std::vector<unsigned> mColumnIndices;
+
+    /** Value of each stored entry. */
+    std::vector<double> mValues;
+
+    /** Diagonal entry of each row, accumulated during assembly for the preconditioner. */
+    std::vector<double> mDiagonal;
+
+public:
+
+    /**
+     * Default constructor. Creates an empty matrix.
+     */
+    SparseSymmetricMatrix();
+
+    /**
+     * Remove all rows, keeping allocated storage for reuse.
+     *
+     * @param expectedNumRows the number of rows that will be assembled
+     */
+    void Clear(unsigned expectedNumRows=0);
+
+    /**
+     * Add an entry to the row currently being assembled. Entries on the same
+     * column may be added more than once and are summed in products.
+     *
+     * @param column the column index
+     * @param value the value
+     */
+    void AddEntry(unsigned column, double value);
+
+    /**
+     * Close the row currently being assembled and start the next one.
+     */
+    void FinishRow();
+
+    /**
+     * @return the number of rows that have been assembled.
+     */
+    unsigned GetNumRows() const;
+
+    /**
+     * Compute rResult = A*rX.
+     *
+     * @param rX the vector to multiply
+     * @param rResult filled in with the product
+     */
+    void Multiply(const std::vector<double>& rX, std::vector<double>& rResult) const;
+
+    /**
+     * Solve A*rSolution = rRhs by the conjugate gradient method with a Jacobi preconditioner.
+     * The matrix must be symmetric positive definite. rSolution is used as the initial guess.
+     *
+     * @param rRhs the right-hand side
+     * @param rSolution the initial guess, filled in with the solution
+     * @param relativeTolerance the required reduction in the residual norm
+     * @param maxIterations the maximum number of iterations
+     * @return the number of iterations performed
+     */
+    unsigned SolveWithConjugateGradient(const std::vector<double>& rRhs,
+                                        std::vector<double>& rSolution,
+                                        double relativeTolerance=1e-10,
+                                        unsigned maxIterations=1000) const;
+};
+
+#endif /*SPARSESYMMETRICMATRIX_HPP_*/
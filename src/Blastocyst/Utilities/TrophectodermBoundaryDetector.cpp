@@ -0,0 +1,322 @@
+
+#include "TrophectodermBoundaryDetector.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "NissenPairGeometryCache.hpp"
+#include "PetscTools.hpp"
+#include "Warnings.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+/** The number of directions sampled on the sphere in 3D. */
+static const unsigned NUM_SPHERE_SAMPLE_DIRECTIONS = 128;
+
+/** The smallest free arc, in radians, that puts a node on the boundary in 2D, so that rounding does not. */
+static const double MINIMUM_FREE_ARC = 1e-6;
+
+template<unsigned DIM>
+TrophectodermBoundaryDetector<DIM>::TrophectodermBoundaryDetector(double alpha)
+    : mAlpha(alpha),
+      mNumBoundaryNodes(0)
+{
+    assert(alpha > 0.0);
+
+    if (DIM == 1)
+    {
+        c_vector<double, DIM> direction;
+        direction(0) = 1.0;
+        mSampleDirections.push_back(direction);
+        mSampleDirections.push_back(-direction);
+    }
+    else if (DIM == 3)
+    {
+        // Points spread evenly over the sphere along a spiral with golden angle spacing
+        double golden_angle = M_PI*(3.0 - sqrt(5.0));
+        for (unsigned i=0; i<NUM_SPHERE_SAMPLE_DIRECTIONS; i++)
+        {
+            double z = 1.0 - (2.0*i + 1.0)/NUM_SPHERE_SAMPLE_DIRECTIONS;
+            double r = sqrt(1.0 - z*z);
+
+            c_vector<double, DIM> direction;
+            direction(0) = r*cos(golden_angle*i);
+            direction(1) = r*sin(golden_angle*i);
+            direction(2) = z;
+            mSampleDirections.push_back(direction);
+        }
+    }
+}
+
+template<unsigned DIM>
+void TrophectodermBoundaryDetector<DIM>::Compute(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    unsigned max_index = 0;
+    for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = rCellPopulation.rGetMesh().GetNodeIteratorBegin();
+         node_iter != rCellPopulation.rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        max_index = std::max(max_index, node_iter->GetIndex());
+    }
+
+    mIsOnBoundary.assign(max_index + 1, false);
+    mOutwardNormals.resize(max_index + 1);
+    mNeighbourVectors.resize(max_index + 1);
+    for (unsigned i=0; i<mNeighbourVectors.size(); i++)
+    {
+        mNeighbourVectors[i].clear();
+    }
+    mNumBoundaryNodes = 0;
+
+    // Gather the vectors from each node to its neighbours within 2*alpha
+    double diameter = 2.0*mAlpha;
+    NodeBasedCellPopulation<DIM>* p_node_based_population = dynamic_cast<NodeBasedCellPopulation<DIM>*>(&rCellPopulation);
+    if (p_node_based_population)
+    {
+        if (diameter > p_node_based_population->rGetMesh().GetMaximumInteractionDistance())
+        {
+            WARN_ONCE_ONLY("The node pairs do not cover twice the alpha of TrophectodermBoundaryDetector, so too many cells may be found on the boundary.");
+        }
+
+        const std::vector<typename NissenPairGeometryCache<DIM>::PairGeometry>& r_pairs =
+            NissenPairGeometryCache<DIM>::Instance()->rGetPairs(*p_node_based_population);
+        for (unsigned i=0; i<r_pairs.size(); i++)
+        {
+            if (r_pairs[i].mDistance < diameter)
+            {
+                // In a distributed run one node may be a halo node, which is classified by its owner
+                if (r_pairs[i].mNodeAIndex <= max_index)
+                {
+                    mNeighbourVectors[r_pairs[i].mNodeAIndex].push_back(r_pairs[i].mVectorFromAtoB);
+                }
+                if (r_pairs[i].mNodeBIndex <= max_index)
+                {
+                    mNeighbourVectors[r_pairs[i].mNodeBIndex].push_back(-r_pairs[i].mVectorFromAtoB);
+                }
+            }
+        }
+    }
+    else
+    {
+        for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = rCellPopulation.rGetMesh().GetNodeIteratorBegin();
+             node_iter != rCellPopulation.rGetMesh().GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            unsigned index = node_iter->GetIndex();
+            std::set<unsigned> neighbour_indices = rCellPopulation.GetNeighbouringNodeIndices(index);
+            for (std::set<unsigned>::iterator iter = neighbour_indices.begin(); iter != neighbour_indices.end(); ++iter)
+            {
+                c_vector<double, DIM> vector = rCellPopulation.rGetMesh().GetVectorFromAtoB(node_iter->rGetLocation(),
+                                                                                           rCellPopulation.GetNode(*iter)->rGetLocation());
+                if (norm_2(vector) < diameter)
+                {
+                    mNeighbourVectors[index].push_back(vector);
+                }
+            }
+        }
+    }
+
+    c_vector<double, DIM> centroid = GetCentroid(rCellPopulation);
+    for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = rCellPopulation.rGetMesh().GetNodeIteratorBegin();
+         node_iter != rCellPopulation.rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        c_vector<double, DIM> away_from_centroid = node_iter->rGetLocation() - centroid;
+        double distance = norm_2(away_from_centroid);
+        if (distance > 0.0)
+        {
+            away_from_centroid /= distance;
+        }
+        else
+        {
+            away_from_centroid = zero_vector<double>(DIM);
+            away_from_centroid(0) = 1.0;
+        }
+
+        ClassifyNode(node_iter->GetIndex(), mNeighbourVectors[node_iter->GetIndex()], away_from_centroid);
+    }
+}
+
+template<unsigned DIM>
+c_vector<double, DIM> TrophectodermBoundaryDetector<DIM>::GetCentroid(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    if (PetscTools::IsSequential())
+    {
+        return rCellPopulation.GetCentroidOfCellPopulation();
+    }
+
+    // Each process only holds its own nodes, so sum their locations over all processes
+    double local_sums[DIM+1];
+    for (unsigned j=0; j<=DIM; j++)
+    {
+        local_sums[j] = 0.0;
+    }
+    for (typename AbstractMesh<DIM,DIM>::NodeIterator node_iter = rCellPopulation.rGetMesh().GetNodeIteratorBegin();
+         node_iter != rCellPopulation.rGetMesh().GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        for (unsigned j=0; j<DIM; j++)
+        {
+            local_sums[j] += node_iter->rGetLocation()[j];
+        }
+        local_sums[DIM] += 1.0;
+    }
+
+    double global_sums[DIM+1];
+    MPI_Allreduce(local_sums, global_sums, DIM+1, MPI_DOUBLE, MPI_SUM, PETSC_COMM_WORLD);
+
+    c_vector<double, DIM> centroid = zero_vector<double>(DIM);
+    if (global_sums[DIM] > 0.0)
+    {
+        for (unsigned j=0; j<DIM; j++)
+        {
+            centroid[j] = global_sums[j]/global_sums[DIM];
+        }
+    }
+    return centroid;
+}
+
+template<unsigned DIM>
+void TrophectodermBoundaryDetector<DIM>::ClassifyNode(unsigned nodeIndex,
+                                                      const std::vector<c_vector<double, DIM> >& rNeighbourVectors,
+                                                      const c_vector<double, DIM>& rAwayFromCentroid)
+{
+    if (rNeighbourVectors.empty())
+    {
+        mIsOnBoundary[nodeIndex] = true;
+        mOutwardNormals[nodeIndex] = rAwayFromCentroid;
+        mNumBoundaryNodes++;
+        return;
+    }
+
+    if (DIM == 2)
+    {
+        // Each neighbour blocks the arc of disc-centre directions within acos(|d|/(2*alpha)) of its own direction
+        std::vector<std::pair<double, double> > blocked_arcs;
+        blocked_arcs.reserve(rNeighbourVectors.size());
+        for (unsigned i=0; i<rNeighbourVectors.size(); i++)
+        {
+            double distance = norm_2(rNeighbourVectors[i]);
+            if (distance == 0.0)
+            {
+                continue;
+            }
+
+            double half_width = acos(std::min(1.0, distance/(2.0*mAlpha)));
+            double start = atan2(rNeighbourVectors[i](1), rNeighbourVectors[i](0)) - half_width;
+            if (start < 0.0)
+            {
+                start += 2.0*M_PI;
+            }
+            blocked_arcs.push_back(std::make_pair(start, start + 2.0*half_width));
+        }
+        if (blocked_arcs.empty())
+        {
+            mIsOnBoundary[nodeIndex] = true;
+            mOutwardNormals[nodeIndex] = rAwayFromCentroid;
+            mNumBoundaryNodes++;
+            return;
+        }
+        std::sort(blocked_arcs.begin(), blocked_arcs.end());
+
+        // Sweep round the circle to find the largest free arc, starting from any coverage that wraps past 2*pi
+        double max_end = 0.0;
+        for (unsigned i=0; i<blocked_arcs.size(); i++)
+        {
+            max_end = std::max(max_end, blocked_arcs[i].second);
+        }
+
+        double largest_gap = 0.0;
+        double largest_gap_start = 0.0;
+        double reach = std::max(blocked_arcs[0].second, max_end - 2.0*M_PI);
+        for (unsigned i=1; i<blocked_arcs.size(); i++)
+        {
+            if (blocked_arcs[i].first - reach > largest_gap)
+            {
+                largest_gap = blocked_arcs[i].first - reach;
+                largest_gap_start = reach;
+            }
+            reach = std::max(reach, blocked_arcs[i].second);
+        }
+        if (blocked_arcs[0].first + 2.0*M_PI - reach > largest_gap)
+        {
+            largest_gap = blocked_arcs[0].first + 2.0*M_PI - reach;
+            largest_gap_start = reach;
+        }
+
+        if (largest_gap > MINIMUM_FREE_ARC)
+        {
+            double normal_angle = largest_gap_start + 0.5*largest_gap;
+            c_vector<double, DIM> normal;
+            normal(0) = cos(normal_angle);
+            normal(1) = sin(normal_angle);
+
+            mIsOnBoundary[nodeIndex] = true;
+            mOutwardNormals[nodeIndex] = normal;
+            mNumBoundaryNodes++;
+        }
+    }
+    else
+    {
+        // Otherwise sample the directions, averaging those left free
+        c_vector<double, DIM> free_direction_sum = zero_vector<double>(DIM);
+        bool has_free_direction = false;
+        for (unsigned j=0; j<mSampleDirections.size(); j++)
+        {
+            bool is_blocked = false;
+            for (unsigned i=0; i<rNeighbourVectors.size() && !is_blocked; i++)
+            {
+                double distance_squared = inner_prod(rNeighbourVectors[i], rNeighbourVectors[i]);
+                is_blocked = (inner_prod(mSampleDirections[j], rNeighbourVectors[i]) > distance_squared/(2.0*mAlpha));
+            }
+            if (!is_blocked)
+            {
+                free_direction_sum += mSampleDirections[j];
+                has_free_direction = true;
+            }
+        }
+
+        if (has_free_direction)
+        {
+            double length = norm_2(free_direction_sum);
+            mIsOnBoundary[nodeIndex] = true;
+            mOutwardNormals[nodeIndex] = (length > 0.0) ? c_vector<double, DIM>(free_direction_sum/length) : rAwayFromCentroid;
+            mNumBoundaryNodes++;
+        }
+    }
+}
+
+template<unsigned DIM>
+bool TrophectodermBoundaryDetector<DIM>::IsOnBoundary(unsigned nodeIndex) const
+{
+    return nodeIndex < mIsOnBoundary.size() && mIsOnBoundary[nodeIndex];
+}
+
+template<unsigned DIM>
+const c_vector<double, DIM>& TrophectodermBoundaryDetector<DIM>::rGetOutwardNormal(unsigned nodeIndex) const
+{
+    assert(IsOnBoundary(nodeIndex));
+    return mOutwardNormals[nodeIndex];
+}
+
+template<unsigned DIM>
+unsigned TrophectodermBoundaryDetector<DIM>::GetNumBoundaryNodes() const
+{
+    return mNumBoundaryNodes;
+}
+
+template<unsigned DIM>
+double TrophectodermBoundaryDetector<DIM>::GetAlpha() const
+{
+    return mAlpha;
+}
+
+template<unsigned DIM>
+void TrophectodermBoundaryDetector<DIM>::SetAlpha(double alpha)
+{
+    assert(alpha > 0.0);
+    mAlpha = alpha;
+}
+
+// Explicit instantiation
+template class TrophectodermBoundaryDetector<1>;
+template class TrophectodermBoundaryDetector<2>;
+template class TrophectodermBoundaryDetector<3>;
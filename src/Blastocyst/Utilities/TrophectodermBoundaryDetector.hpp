@@ -0,0 +1,117 @@
+
+#ifndef TROPHECTODERMBOUNDARYDETECTOR_HPP_
+#define TROPHECTODERMBOUNDARYDETECTOR_HPP_
+
+#include <vector>
+#include "UblasVectorInclude.hpp"
+#include "AbstractCellPopulation.hpp"
+
+/**
+ * Finds the cells on the outer boundary of a population, and the outward normal at each, in a single
+ * geometric pass over the node pairs.
+ *
+ * A node lies on the boundary of the population's alpha shape if some disc (sphere in 3D) of radius
+ * alpha touches it and contains no other node. A neighbour at displacement d from the node lies inside
+ * the disc centred at (node + alpha*u) exactly when u.d > |d|^2/(2*alpha), so each neighbour closer than
+ * 2*alpha blocks a cone of directions u, and the node is on the boundary if these cones leave some
+ * direction free. The outward normal is the middle of the largest free arc in 2D, and the mean free
+ * direction otherwise, where directions are sampled. Nodes with no neighbours within 2*alpha take the
+ * direction away from the population's centroid.
+ *
+ * For a NodeBasedCellPopulation the neighbours are taken from the shared NissenPairGeometryCache, so the
+ * cost is that of sorting each node's neighbours, O(N k log k) for N nodes with k neighbours each; the
+ * node pairs must cover 2*alpha. For other populations the population's own neighbours are used.
+ */
+template<unsigned DIM>
+class TrophectodermBoundaryDetector
+{
+private:
+
+    /**
+     * The radius of the probe disc. Defaults to 0.8, a little under a cell diameter, so that cells in
+     * shallow notches of the surface count as outer while close-packed cells up to about 1.39 apart do not.
+     */
+    double mAlpha;
+
+    /** Whether each node was on the boundary at the last call to Compute(), indexed by node global index. */
+    std::vector<bool> mIsOnBoundary;
+
+    /** The outward unit normal of each boundary node at the last call to Compute(), indexed by node global index. */
+    std::vector<c_vector<double, DIM> > mOutwardNormals;
+
+    /** The number of boundary nodes found by the last call to Compute(). */
+    unsigned mNumBoundaryNodes;
+
+    /** The directions sampled when DIM is not 2: both directions in 1D, a Fibonacci lattice on the sphere in 3D. */
+    std::vector<c_vector<double, DIM> > mSampleDirections;
+
+    /** Work space: the vectors from each node to its neighbours within 2*alpha, indexed by node global index. */
+    std::vector<std::vector<c_vector<double, DIM> > > mNeighbourVectors;
+
+    /**
+     * @return the centroid of the population, over all processes in a distributed run.
+     *
+     * @param rCellPopulation the cell population
+     */
+    c_vector<double, DIM> GetCentroid(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Decide whether a node is on the boundary and, if so, store its outward normal.
+     *
+     * @param nodeIndex the global index of the node
+     * @param rNeighbourVectors the vectors from the node to its neighbours within 2*alpha
+     * @param rAwayFromCentroid the unit vector from the population's centroid to the node
+     */
+    void ClassifyNode(unsigned nodeIndex,
+                      const std::vector<c_vector<double, DIM> >& rNeighbourVectors,
+                      const c_vector<double, DIM>& rAwayFromCentroid);
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param alpha the radius of the probe disc (defaults to 0.8)
+     */
+    TrophectodermBoundaryDetector(double alpha=0.8);
+
+    /**
+     * Find the boundary nodes of a population and their outward normals.
+     *
+     * @param rCellPopulation the cell population
+     */
+    void Compute(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * @return whether a node was on the boundary at the last call to Compute().
+     *
+     * @param nodeIndex the global index of the node
+     */
+    bool IsOnBoundary(unsigned nodeIndex) const;
+
+    /**
+     * @return the outward unit normal of a boundary node at the last call to Compute().
+     *
+     * @param nodeIndex the global index of the node, which must be on the boundary
+     */
+    const c_vector<double, DIM>& rGetOutwardNormal(unsigned nodeIndex) const;
+
+    /**
+     * @return the number of boundary nodes found by the last call to Compute().
+     */
+    unsigned GetNumBoundaryNodes() const;
+
+    /**
+     * @return mAlpha
+     */
+    double GetAlpha() const;
+
+    /**
+     * Set mAlpha.
+     *
+     * @param alpha the radius of the probe disc, which must be positive
+     */
+    void SetAlpha(double alpha);
+};
+
+#endif /*TROPHECTODERMBOUNDARYDETECTOR_HPP_*/
@@ -1,12 +1,14 @@
 
 #include "CellPolarityOdeSystem.hpp"
-#include "CellwiseOdeSystemInformation.hpp"
-#include "RandomNumberGenerator.hpp"
+#include "OdeSystemInformation.hpp"
+#include "ObjectPool.hpp"
 
-CellPolarityOdeSystem::CellPolarityOdeSystem(std::vector<double> stateVariables)
-    : AbstractOdeSystem(1)
+CellPolarityOdeSystem::CellPolarityOdeSystem(const std::vector<double>& stateVariables)
+    : AbstractOdeSystem(1),
+      mNoiseStream(CounterBasedRandomStreams::POLARITY_NOISE)
 {
-    mpSystemInfo.reset(new CellwiseOdeSystemInformation<CellPolarityOdeSystem>);
+    // The names, units and initial conditions are identical for every cell, so share a single copy
+    mpSystemInfo = OdeSystemInformation<CellPolarityOdeSystem>::Instance();
 
     /**
      * The state variables are as follows:
@@ -17,11 +19,9 @@ CellPolarityOdeSystem::CellPolarityOdeSystem(std::vector<double> stateVariables)
      * to file at each time step alongside the others, and visualized.
      */
 
-    SetDefaultInitialCondition(0, 0.0); // soon overwritten
-
     this->mParameters.push_back(0.0);
 
-    if (stateVariables != std::vector<double>())
+    if (!stateVariables.empty())
     {
         SetStateVariables(stateVariables);
     }
@@ -31,22 +31,41 @@ CellPolarityOdeSystem::~CellPolarityOdeSystem()
 {
 }
 
+void* CellPolarityOdeSystem::operator new(size_t size)
+{
+    return ObjectPool<CellPolarityOdeSystem>::Instance()->Allocate(size);
+}
+
+void CellPolarityOdeSystem::operator delete(void* pObject)
+{
+    ObjectPool<CellPolarityOdeSystem>::Instance()->Deallocate(pObject);
+}
+
 void CellPolarityOdeSystem::EvaluateYDerivatives(double time, const std::vector<double>& rY, std::vector<double>& rDY)
 {
-    std::vector<double> Alpha = rY;
     double dVpdAlpha = this->mParameters[0]; // Shorthand for "this->mParameter("dVpdAlpha");"
     
-    double x = RandomNumberGenerator::Instance()->NormalRandomDeviate(0.0, 3.1415926535*1.0e-3);
+    double x = mNoiseStream.NormalRandomDeviate(0.0, 3.1415926535*1.0e-3);
     // The next line define the ODE system by Nissen et al.
-    rDY[0] = -0.1*dVpdAlpha + x;  // d[V_i]/dAlpha_i
+    rDY[0] = -GetCouplingStrength()*dVpdAlpha + x;  // d[V_i]/dAlpha_i
+}
+
+double CellPolarityOdeSystem::GetCouplingStrength()
+{
+    return 0.1;
+}
+
+void CellPolarityOdeSystem::SetNoiseCellId(unsigned cellId)
+{
+    mNoiseStream.SetCellId(cellId);
 }
 
 template<>
-void CellwiseOdeSystemInformation<CellPolarityOdeSystem>::Initialise()
+void OdeSystemInformation<CellPolarityOdeSystem>::Initialise()
 {
     this->mVariableNames.push_back("Polarity Angle");
     this->mVariableUnits.push_back("non-dim");
-    this->mInitialConditions.push_back(0.0); // will be filled in later
+    this->mInitialConditions.push_back(0.0); // soon overwritten
 
     // If this is ever not the first parameter change the line
     // double mean_delta = this->mParameters[0]; in EvaluateYDerivatives().
@@ -9,6 +9,7 @@
 #include <iostream>
 
 #include "AbstractOdeSystem.hpp"
+#include "CounterBasedRandomStreams.hpp"
 
 /**
  * Represents the Delta-Notch ODE system described by Collier et al,
@@ -35,6 +36,9 @@ private:
 
     ///\todo extract model parameters as member variables
 
+    /** The stream from which the noise is drawn if counter-based random streams are enabled. */
+    CounterBasedRandomStream mNoiseStream;
+
 public:
 
     /**
@@ -42,7 +46,23 @@ public:
      *
      * @param stateVariables optional initial conditions for state variables (only used in archiving)
      */
-    CellPolarityOdeSystem(std::vector<double> stateVariables=std::vector<double>());
+    CellPolarityOdeSystem(const std::vector<double>& stateVariables=std::vector<double>());
+
+    /**
+     * Class-specific allocation from an ObjectPool, so that the ODE systems created at each
+     * division sit together in memory and do not each require a heap allocation.
+     *
+     * @param size the number of bytes required
+     * @return the allocated memory
+     */
+    static void* operator new(size_t size);
+
+    /**
+     * Return memory allocated by operator new() to the ObjectPool.
+     *
+     * @param pObject the memory to release
+     */
+    static void operator delete(void* pObject);
 
     /**
      * Destructor.
@@ -60,6 +80,19 @@ public:
      * @param rDY filled in with the resulting derivatives (using  Collier et al. system of equations).
      */
     void EvaluateYDerivatives(double time, const std::vector<double>& rY, std::vector<double>& rDY);
+
+    /**
+     * @return the coupling strength multiplying dVpdAlpha on the RHS of the polarity ODE.
+     * Used by CellPolarityTrackingModifier when integrating the coupled polarity network implicitly.
+     */
+    static double GetCouplingStrength();
+
+    /**
+     * Set the ID of the cell whose stream the noise is drawn from, if counter-based random streams are enabled.
+     *
+     * @param cellId the ID of the cell
+     */
+    void SetNoiseCellId(unsigned cellId);
 };
 
 // Declare identifier for the serializer
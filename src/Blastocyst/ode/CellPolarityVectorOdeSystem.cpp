@@ -0,0 +1,122 @@
+
+#include "CellPolarityVectorOdeSystem.hpp"
+#include "CellPolarityOdeSystem.hpp"
+#include "OdeSystemInformation.hpp"
+#include "ObjectPool.hpp"
+
+#include <cassert>
+
+CellPolarityVectorOdeSystem::CellPolarityVectorOdeSystem(const std::vector<double>& stateVariables)
+    : AbstractOdeSystem(3),
+      mNumDimensions(3),
+      mNoiseStream(CounterBasedRandomStreams::POLARITY_NOISE)
+{
+    // The names, units and initial conditions are identical for every cell, so share a single copy
+    mpSystemInfo = OdeSystemInformation<CellPolarityVectorOdeSystem>::Instance();
+
+    /**
+     * The state variables are as follows:
+     *
+     * 0 - Polarity X for this cell
+     * 1 - Polarity Y for this cell
+     * 2 - Polarity Z for this cell
+     *
+     * and the parameters are the components of the sum of the neighbouring polarities.
+     */
+    this->mParameters.push_back(0.0);
+    this->mParameters.push_back(0.0);
+    this->mParameters.push_back(0.0);
+
+    if (!stateVariables.empty())
+    {
+        SetStateVariables(stateVariables);
+    }
+}
+
+CellPolarityVectorOdeSystem::~CellPolarityVectorOdeSystem()
+{
+}
+
+void* CellPolarityVectorOdeSystem::operator new(size_t size)
+{
+    return ObjectPool<CellPolarityVectorOdeSystem>::Instance()->Allocate(size);
+}
+
+void CellPolarityVectorOdeSystem::operator delete(void* pObject)
+{
+    ObjectPool<CellPolarityVectorOdeSystem>::Instance()->Deallocate(pObject);
+}
+
+void CellPolarityVectorOdeSystem::EvaluateYDerivatives(double time, const std::vector<double>& rY, std::vector<double>& rDY)
+{
+    double coupling = CellPolarityOdeSystem::GetCouplingStrength();
+
+    // The noise has the standard deviation of the angle model in each direction, before projection
+    double noise[3] = {0.0, 0.0, 0.0};
+    for (unsigned i=0; i<mNumDimensions; i++)
+    {
+        noise[i] = mNoiseStream.NormalRandomDeviate(0.0, 3.1415926535*1.0e-3);
+    }
+
+    double e_dot_e = rY[0]*rY[0] + rY[1]*rY[1] + rY[2]*rY[2];
+    double e_dot_forcing = 0.0;
+    double forcing[3];
+    for (unsigned i=0; i<3; i++)
+    {
+        forcing[i] = coupling*this->mParameters[i] + noise[i];
+        e_dot_forcing += rY[i]*forcing[i];
+    }
+
+    // Project onto the plane tangent to e, so that only the direction of e changes
+    double projection = (e_dot_e > 0.0) ? e_dot_forcing/e_dot_e : 0.0;
+    for (unsigned i=0; i<3; i++)
+    {
+        rDY[i] = forcing[i] - projection*rY[i];
+    }
+}
+
+unsigned CellPolarityVectorOdeSystem::GetNumDimensions() const
+{
+    return mNumDimensions;
+}
+
+void CellPolarityVectorOdeSystem::SetNumDimensions(unsigned numDimensions)
+{
+    assert(numDimensions > 0 && numDimensions <= 3);
+    mNumDimensions = numDimensions;
+}
+
+void CellPolarityVectorOdeSystem::SetNoiseCellId(unsigned cellId)
+{
+    mNoiseStream.SetCellId(cellId);
+}
+
+template<>
+void OdeSystemInformation<CellPolarityVectorOdeSystem>::Initialise()
+{
+    this->mVariableNames.push_back("Polarity X");
+    this->mVariableUnits.push_back("non-dim");
+    this->mInitialConditions.push_back(1.0); // soon overwritten
+
+    this->mVariableNames.push_back("Polarity Y");
+    this->mVariableUnits.push_back("non-dim");
+    this->mInitialConditions.push_back(0.0);
+
+    this->mVariableNames.push_back("Polarity Z");
+    this->mVariableUnits.push_back("non-dim");
+    this->mInitialConditions.push_back(0.0);
+
+    // If these are ever not the first parameters change EvaluateYDerivatives()
+    this->mParameterNames.push_back("Drive X");
+    this->mParameterUnits.push_back("non-dim");
+    this->mParameterNames.push_back("Drive Y");
+    this->mParameterUnits.push_back("non-dim");
+    this->mParameterNames.push_back("Drive Z");
+    this->mParameterUnits.push_back("non-dim");
+
+    this->mInitialised = true;
+}
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+CHASTE_CLASS_EXPORT(CellPolarityVectorOdeSystem)
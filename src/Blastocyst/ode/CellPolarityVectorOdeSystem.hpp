@@ -0,0 +1,147 @@
+
+#ifndef CELLPOLARITYVECTORODESYSTEM_HPP_
+#define CELLPOLARITYVECTORODESYSTEM_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include <cmath>
+#include <iostream>
+
+#include "AbstractOdeSystem.hpp"
+#include "CounterBasedRandomStreams.hpp"
+
+/**
+ * The Nissen et al. polarity ODE written for a unit polarity vector e rather than an angle, so that it
+ * applies in any number of dimensions:
+ *
+ *     de/dt = c*(I - e e^T)*sum_b e_b + noise,
+ *
+ * where the sum runs over the coupled neighbours, c is CellPolarityOdeSystem::GetCouplingStrength() and
+ * the noise is Gaussian, with the same standard deviation as that of the angle model, projected onto the
+ * plane tangent to e. In 2D, with e = (cos(alpha), sin(alpha)), this is exactly the angle equation
+ * d(alpha)/dt = -c*sum_b sin(alpha - alpha_b) + noise. The sum of neighbour polarities is held in the
+ * parameters "Drive X", "Drive Y" and "Drive Z", and is set by CellPolarityVectorTrackingModifier.
+ *
+ * There are always three state variables. Only the first mNumDimensions components receive noise, so a
+ * polarity that starts in the plane of a 2D simulation stays there. The ODE does not itself keep |e| = 1;
+ * CellPolarityVectorSrnModel renormalises e after each solve.
+ */
+class CellPolarityVectorOdeSystem : public AbstractOdeSystem
+{
+private:
+
+    friend class boost::serialization::access;
+    /**
+     * Serialize the object and its member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractOdeSystem>(*this);
+        archive & mNumDimensions;
+    }
+
+    /** The number of polarity components that receive noise. Defaults to 3. */
+    unsigned mNumDimensions;
+
+    /** The stream from which the noise is drawn if counter-based random streams are enabled. */
+    CounterBasedRandomStream mNoiseStream;
+
+public:
+
+    /**
+     * Default constructor.
+     *
+     * @param stateVariables optional initial conditions for state variables (only used in archiving)
+     */
+    CellPolarityVectorOdeSystem(const std::vector<double>& stateVariables=std::vector<double>());
+
+    /**
+     * Class-specific allocation from an ObjectPool, as for CellPolarityOdeSystem.
+     *
+     * @param size the number of bytes required
+     * @return the allocated memory
+     */
+    static void* operator new(size_t size);
+
+    /**
+     * Return memory allocated by operator new() to the ObjectPool.
+     *
+     * @param pObject the memory to release
+     */
+    static void operator delete(void* pObject);
+
+    /**
+     * Destructor.
+     */
+    ~CellPolarityVectorOdeSystem();
+
+    /**
+     * Compute the RHS of the vector form of the Nissen et al. polarity ODE system.
+     *
+     * @param time used to evaluate the RHS.
+     * @param rY value of the solution vector used to evaluate the RHS.
+     * @param rDY filled in with the resulting derivatives.
+     */
+    void EvaluateYDerivatives(double time, const std::vector<double>& rY, std::vector<double>& rDY);
+
+    /**
+     * @return mNumDimensions
+     */
+    unsigned GetNumDimensions() const;
+
+    /**
+     * Set mNumDimensions.
+     *
+     * @param numDimensions the number of polarity components that receive noise, between 1 and 3
+     */
+    void SetNumDimensions(unsigned numDimensions);
+
+    /**
+     * Set the ID of the cell whose stream the noise is drawn from, if counter-based random streams are enabled.
+     *
+     * @param cellId the ID of the cell
+     */
+    void SetNoiseCellId(unsigned cellId);
+};
+
+// Declare identifier for the serializer
+#include "SerializationExportWrapper.hpp"
+CHASTE_CLASS_EXPORT(CellPolarityVectorOdeSystem)
+
+namespace boost
+{
+namespace serialization
+{
+/**
+ * Serialize information required to construct a CellPolarityVectorOdeSystem.
+ */
+template<class Archive>
+inline void save_construct_data(
+    Archive & ar, const CellPolarityVectorOdeSystem * t, const unsigned int file_version)
+{
+    const std::vector<double> state_variables = t->rGetConstStateVariables();
+    ar & state_variables;
+}
+
+/**
+ * De-serialize constructor parameters and initialise a CellPolarityVectorOdeSystem.
+ */
+template<class Archive>
+inline void load_construct_data(
+    Archive & ar, CellPolarityVectorOdeSystem * t, const unsigned int file_version)
+{
+    std::vector<double> state_variables;
+    ar & state_variables;
+
+    // Invoke inplace constructor to initialise instance
+    ::new(t)CellPolarityVectorOdeSystem(state_variables);
+}
+}
+} // namespace ...
+
+#endif /*CELLPOLARITYVECTORODESYSTEM_HPP_*/
@@ -1,11 +1,17 @@
 
 #include "CellPolaritySrnModel.hpp"
+#include "ObjectPool.hpp"
 #include "Debug.hpp"
 
 #include <cassert>
+#include <climits>
 
 CellPolaritySrnModel::CellPolaritySrnModel(boost::shared_ptr<AbstractCellCycleModelOdeSolver> pOdeSolver)
-    : DHALLAbstractOdeSrnModel(1, pOdeSolver)
+    : DHALLAbstractOdeSrnModel(1, pOdeSolver),
+      mNextUpdateTime(0.0),
+      mUpdateInterval(1),
+      mPolarityAngleSlot(UINT_MAX),
+      mdVpdAlphaSlot(UINT_MAX)
 {
 //    TRACE("Now attempting to initialise the Srn Model");
     if (mpOdeSolver == boost::shared_ptr<AbstractCellCycleModelOdeSolver>())
@@ -24,7 +30,11 @@ CellPolaritySrnModel::CellPolaritySrnModel(boost::shared_ptr<AbstractCellCycleMo
 }
 
 CellPolaritySrnModel::CellPolaritySrnModel(const CellPolaritySrnModel& rModel)
-    : DHALLAbstractOdeSrnModel(rModel)
+    : DHALLAbstractOdeSrnModel(rModel),
+      mNextUpdateTime(rModel.mNextUpdateTime),
+      mUpdateInterval(rModel.mUpdateInterval),
+      mPolarityAngleSlot(rModel.mPolarityAngleSlot),
+      mdVpdAlphaSlot(rModel.mdVpdAlphaSlot)
 {
     /*
      * Set each member variable of the new SRN model that inherits
@@ -44,6 +54,19 @@ CellPolaritySrnModel::CellPolaritySrnModel(const CellPolaritySrnModel& rModel)
 //    	PRINT_VECTOR(rModel.GetOdeSystem()->rGetStateVariables());
     	assert(rModel.GetOdeSystem());
     	SetOdeSystem(new CellPolarityOdeSystem(rModel.GetOdeSystem()->rGetStateVariables()));
+
+    	// The daughter inherits the parent's current neighbour drive until the modifier next updates it
+    	mpOdeSystem->SetParameter(0, rModel.GetOdeSystem()->GetParameter(0));
+}
+
+void* CellPolaritySrnModel::operator new(size_t size)
+{
+    return ObjectPool<CellPolaritySrnModel>::Instance()->Allocate(size);
+}
+
+void CellPolaritySrnModel::operator delete(void* pObject)
+{
+    ObjectPool<CellPolaritySrnModel>::Instance()->Deallocate(pObject);
 }
 
 AbstractSrnModel* CellPolaritySrnModel::CreateSrnModel()
@@ -55,18 +78,67 @@ void CellPolaritySrnModel::SimulateToCurrentTime()
 {
 //    TRACE("Now attempting SimulateToCurrentTime within CellPolaritySrnModel");
 
-	// Custom behaviour
-    UpdatedVpdAlpha();
+    // Gate on the simulation time, as the count of time steps elapsed restarts at each Solve()
+    double time = SimulationTime::Instance()->GetTime();
+    double dt = SimulationTime::Instance()->GetTimeStep();
+    if (time < mNextUpdateTime - 0.5*dt)
+    {
+        return;
+    }
 
     // Run the ODE simulation as needed
+    SolveOdeSystemToCurrentTime();
+    mNextUpdateTime = time + mUpdateInterval*dt;
+}
+
+void CellPolaritySrnModel::SolveOdeSystemToCurrentTime()
+{
+    if (mpCell != NULL)
+    {
+        static_cast<CellPolarityOdeSystem*>(mpOdeSystem)->SetNoiseCellId(mpCell->GetCellId());
+    }
     DHALLAbstractOdeSrnModel::SimulateToCurrentTime();
 }
 
+void CellPolaritySrnModel::SynchroniseToCurrentTime()
+{
+    SolveOdeSystemToCurrentTime();
+    mNextUpdateTime = SimulationTime::Instance()->GetTime();
+}
+
+void CellPolaritySrnModel::ResetForDivision()
+{
+    // Any remaining part of the current update interval is solved when the next update is due
+    SolveOdeSystemToCurrentTime();
+    DHALLAbstractOdeSrnModel::ResetForDivision();
+}
+
+unsigned CellPolaritySrnModel::GetUpdateInterval()
+{
+    return mUpdateInterval;
+}
+
+void CellPolaritySrnModel::SetUpdateInterval(unsigned updateInterval)
+{
+    assert(updateInterval > 0);
+    mUpdateInterval = updateInterval;
+}
+
 void CellPolaritySrnModel::Initialise()
 {
 //    TRACE("Now attempting CellPolaritySrnModel::initialise within CellPolaritySrnModel");
 	
 	DHALLAbstractOdeSrnModel::Initialise(new CellPolarityOdeSystem);
+	ResolveDataSlots();
+}
+
+void CellPolaritySrnModel::ResolveDataSlots()
+{
+    if (mPolarityAngleSlot == UINT_MAX)
+    {
+        mPolarityAngleSlot = RegisterDataSlot("Polarity Angle");
+        mdVpdAlphaSlot = RegisterDataSlot("dVpdAlpha");
+    }
 }
 
 void CellPolaritySrnModel::UpdatedVpdAlpha()
@@ -76,8 +148,8 @@ void CellPolaritySrnModel::UpdatedVpdAlpha()
     assert(mpCell != NULL);
 
     double dVpdAlpha = mpCell->GetCellData()->GetItem("dVpdAlpha");
-    
-    mpOdeSystem->SetParameter("dVpdAlpha", dVpdAlpha);
+
+    SetdVpdAlpha(dVpdAlpha);
 }
 
 double CellPolaritySrnModel::GetPolarityAngle()
@@ -85,7 +157,8 @@ double CellPolaritySrnModel::GetPolarityAngle()
 //    TRACE("Now attempting GetPolarityAngle within CellPolaritySrnModel");
 	assert(mpOdeSystem != NULL);
 //	TRACE("OdeSystem Exists");
-    double polarity_angle = mpOdeSystem->rGetStateVariables()[0];
+    ResolveDataSlots();
+    double polarity_angle = GetDataSlotValue(mPolarityAngleSlot);
 //    PRINT_VARIABLE(polarity_angle);
     return polarity_angle;
 }
@@ -93,17 +166,26 @@ double CellPolaritySrnModel::GetPolarityAngle()
 void CellPolaritySrnModel::SetPolarityAngle(double polarityAngle)
 {
     assert(mpOdeSystem != NULL);
-    mpOdeSystem->rGetStateVariables()[0] = polarityAngle;
+    ResolveDataSlots();
+    SetDataSlotValue(mPolarityAngleSlot, polarityAngle);
 }
 
 double CellPolaritySrnModel::GetdVpdAlpha()
 {
 //    TRACE("Now attempting GetdVdAlpha within CellPolaritySrnModel");
 	assert(mpOdeSystem != NULL);
-    double dVpdAlpha = mpOdeSystem->GetParameter("dVpdAlpha");
+    ResolveDataSlots();
+    double dVpdAlpha = GetDataSlotValue(mdVpdAlphaSlot);
     return dVpdAlpha;
 }
 
+void CellPolaritySrnModel::SetdVpdAlpha(double dVpdAlpha)
+{
+    assert(mpOdeSystem != NULL);
+    ResolveDataSlots();
+    SetDataSlotValue(mdVpdAlphaSlot, dVpdAlpha);
+}
+
 void CellPolaritySrnModel::OutputSrnModelParameters(out_stream& rParamsFile)
 {
     // No new parameters to output, so just call method on direct parent class
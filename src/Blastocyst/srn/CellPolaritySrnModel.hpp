@@ -29,8 +29,43 @@ private:
     void serialize(Archive & archive, const unsigned int version)
     {
         archive & boost::serialization::base_object<DHALLAbstractOdeSrnModel>(*this);
+        archive & mNextUpdateTime;
+        archive & mUpdateInterval;
     }
 
+    /**
+     * The ODE system is only solved once the simulation time reaches this value. Defaults to 0.
+     */
+    double mNextUpdateTime;
+
+    /**
+     * The number of simulation time steps between solves of the ODE system, so that the
+     * polarity can be advanced with a larger step than the mechanics. Defaults to 1.
+     */
+    unsigned mUpdateInterval;
+
+    /**
+     * Slot of the polarity angle state variable, resolved once by ResolveDataSlots().
+     * Not archived: it is resolved again on first use after loading.
+     */
+    unsigned mPolarityAngleSlot;
+
+    /** Slot of the dVpdAlpha parameter, resolved once by ResolveDataSlots(). */
+    unsigned mdVpdAlphaSlot;
+
+    /**
+     * Resolve the names "Polarity Angle" and "dVpdAlpha" to slots in the ODE system,
+     * if this has not already been done, so that the accessors below never perform
+     * a string lookup inside the time loop.
+     */
+    void ResolveDataSlots();
+
+    /**
+     * Solve the ODE system up to the current time, with its noise drawn from the stream of this cell
+     * if counter-based random streams are enabled.
+     */
+    void SolveOdeSystemToCurrentTime();
+
 protected:
     /**
      * Protected copy-constructor for use by CreateSrnModel.  The only way for external code to create a copy of a SRN model
@@ -55,6 +90,22 @@ public:
      */
     CellPolaritySrnModel(boost::shared_ptr<AbstractCellCycleModelOdeSolver> pOdeSolver = boost::shared_ptr<AbstractCellCycleModelOdeSolver>());
 
+    /**
+     * Class-specific allocation from an ObjectPool, so that the SRN models created at each
+     * division sit together in memory and do not each require a heap allocation.
+     *
+     * @param size the number of bytes required
+     * @return the allocated memory
+     */
+    static void* operator new(size_t size);
+
+    /**
+     * Return memory allocated by operator new() to the ObjectPool.
+     *
+     * @param pObject the memory to release
+     */
+    static void operator delete(void* pObject);
+
     /**
      * Overridden builder method to create new copies of
      * this SRN model.
@@ -73,12 +124,44 @@ public:
     /**
      * Overridden SimulateToTime() method for custom behaviour.
      *
-     * \todo #2752 say what it does in this class
+     * The dVpdAlpha parameter is expected to have been set directly through
+     * SetdVpdAlpha() (by CellPolarityTrackingModifier) before this is called.
+     * The ODE system is only solved every mUpdateInterval time steps; at other
+     * time steps this method does nothing.
      */
     void SimulateToCurrentTime();
 
     /**
-     * Update the current levels of Delta and Notch in the cell.
+     * Solve the ODE system up to the current time, even if this is not a time step
+     * at which it would otherwise be solved.
+     */
+    void SynchroniseToCurrentTime();
+
+    /**
+     * Overridden ResetForDivision() method.
+     *
+     * Brings the ODE system up to the current time before division, since a
+     * daughter must start from the parent's current polarity.
+     */
+    void ResetForDivision();
+
+    /**
+     * @return mUpdateInterval
+     */
+    unsigned GetUpdateInterval();
+
+    /**
+     * Set mUpdateInterval. Takes effect after the next solve of the ODE system.
+     *
+     * @param updateInterval the number of time steps between solves of the ODE system
+     */
+    void SetUpdateInterval(unsigned updateInterval);
+
+    /**
+     * Copy the value of "dVpdAlpha" stored in the cell's CellData into the ODE system.
+     *
+     * Kept for backwards compatibility with code that stores dVpdAlpha in CellData;
+     * this is no longer called every time step.
      */
     void UpdatedVpdAlpha();
 
@@ -99,6 +182,13 @@ public:
      */
     double GetdVpdAlpha();
 
+    /**
+     * Set the sum of the sine of the polarity angle differences with neighbouring cells.
+     *
+     * @param dVpdAlpha the new value of dVpdAlpha
+     */
+    void SetdVpdAlpha(double dVpdAlpha);
+
     /**
      * Output cell-cycle model parameters to file.
      *
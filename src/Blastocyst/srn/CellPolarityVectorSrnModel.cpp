@@ -0,0 +1,175 @@
+
+#include "CellPolarityVectorSrnModel.hpp"
+#include "ObjectPool.hpp"
+
+#include <cassert>
+#include <cmath>
+
+CellPolarityVectorSrnModel::CellPolarityVectorSrnModel(boost::shared_ptr<AbstractCellCycleModelOdeSolver> pOdeSolver)
+    : DHALLAbstractOdeSrnModel(3, pOdeSolver),
+      mNextUpdateTime(0.0),
+      mUpdateInterval(1)
+{
+    if (mpOdeSolver == boost::shared_ptr<AbstractCellCycleModelOdeSolver>())
+    {
+#ifdef CHASTE_CVODE
+        mpOdeSolver = CellCycleModelOdeSolver<CellPolarityVectorSrnModel, CvodeAdaptor>::Instance();
+        mpOdeSolver->Initialise();
+        mpOdeSolver->SetMaxSteps(10000);
+#else
+        mpOdeSolver = CellCycleModelOdeSolver<CellPolarityVectorSrnModel, RungeKutta4IvpOdeSolver>::Instance();
+        mpOdeSolver->Initialise();
+        SetDt(0.001);
+#endif //CHASTE_CVODE
+    }
+    assert(mpOdeSolver->IsSetUp());
+}
+
+CellPolarityVectorSrnModel::CellPolarityVectorSrnModel(const CellPolarityVectorSrnModel& rModel)
+    : DHALLAbstractOdeSrnModel(rModel),
+      mNextUpdateTime(rModel.mNextUpdateTime),
+      mUpdateInterval(rModel.mUpdateInterval)
+{
+    assert(rModel.GetOdeSystem());
+    CellPolarityVectorOdeSystem* p_ode_system = new CellPolarityVectorOdeSystem(rModel.GetOdeSystem()->rGetStateVariables());
+    p_ode_system->SetNumDimensions(static_cast<CellPolarityVectorOdeSystem*>(rModel.GetOdeSystem())->GetNumDimensions());
+    SetOdeSystem(p_ode_system);
+
+    // The daughter inherits the parent's current neighbour drive until the modifier next updates it
+    for (unsigned i=0; i<3; i++)
+    {
+        mpOdeSystem->SetParameter(i, rModel.GetOdeSystem()->GetParameter(i));
+    }
+}
+
+void* CellPolarityVectorSrnModel::operator new(size_t size)
+{
+    return ObjectPool<CellPolarityVectorSrnModel>::Instance()->Allocate(size);
+}
+
+void CellPolarityVectorSrnModel::operator delete(void* pObject)
+{
+    ObjectPool<CellPolarityVectorSrnModel>::Instance()->Deallocate(pObject);
+}
+
+AbstractSrnModel* CellPolarityVectorSrnModel::CreateSrnModel()
+{
+    return new CellPolarityVectorSrnModel(*this);
+}
+
+void CellPolarityVectorSrnModel::Initialise()
+{
+    DHALLAbstractOdeSrnModel::Initialise(new CellPolarityVectorOdeSystem);
+    NormalisePolarity();
+}
+
+void CellPolarityVectorSrnModel::SimulateToCurrentTime()
+{
+    // Gate on the simulation time, as the count of time steps elapsed restarts at each Solve()
+    double time = SimulationTime::Instance()->GetTime();
+    double dt = SimulationTime::Instance()->GetTimeStep();
+    if (time < mNextUpdateTime - 0.5*dt)
+    {
+        return;
+    }
+
+    SolveOdeSystemToCurrentTime();
+    NormalisePolarity();
+    mNextUpdateTime = time + mUpdateInterval*dt;
+}
+
+void CellPolarityVectorSrnModel::SolveOdeSystemToCurrentTime()
+{
+    if (mpCell != NULL)
+    {
+        static_cast<CellPolarityVectorOdeSystem*>(mpOdeSystem)->SetNoiseCellId(mpCell->GetCellId());
+    }
+    DHALLAbstractOdeSrnModel::SimulateToCurrentTime();
+}
+
+void CellPolarityVectorSrnModel::SynchroniseToCurrentTime()
+{
+    SolveOdeSystemToCurrentTime();
+    NormalisePolarity();
+    mNextUpdateTime = SimulationTime::Instance()->GetTime();
+}
+
+void CellPolarityVectorSrnModel::ResetForDivision()
+{
+    SolveOdeSystemToCurrentTime();
+    NormalisePolarity();
+    DHALLAbstractOdeSrnModel::ResetForDivision();
+}
+
+void CellPolarityVectorSrnModel::NormalisePolarity()
+{
+    std::vector<double>& r_polarity = mpOdeSystem->rGetStateVariables();
+    double length = sqrt(r_polarity[0]*r_polarity[0] + r_polarity[1]*r_polarity[1] + r_polarity[2]*r_polarity[2]);
+    if (length > 0.0)
+    {
+        r_polarity[0] /= length;
+        r_polarity[1] /= length;
+        r_polarity[2] /= length;
+    }
+}
+
+unsigned CellPolarityVectorSrnModel::GetUpdateInterval()
+{
+    return mUpdateInterval;
+}
+
+void CellPolarityVectorSrnModel::SetUpdateInterval(unsigned updateInterval)
+{
+    assert(updateInterval > 0);
+    mUpdateInterval = updateInterval;
+}
+
+const std::vector<double>& CellPolarityVectorSrnModel::rGetPolarityVector()
+{
+    assert(mpOdeSystem != NULL);
+    return mpOdeSystem->rGetStateVariables();
+}
+
+void CellPolarityVectorSrnModel::SetPolarityVector(double x, double y, double z)
+{
+    assert(mpOdeSystem != NULL);
+    assert(x != 0.0 || y != 0.0 || z != 0.0);
+
+    std::vector<double>& r_polarity = mpOdeSystem->rGetStateVariables();
+    r_polarity[0] = x;
+    r_polarity[1] = y;
+    r_polarity[2] = z;
+    NormalisePolarity();
+}
+
+void CellPolarityVectorSrnModel::SetPolarityDrive(double x, double y, double z)
+{
+    assert(mpOdeSystem != NULL);
+    mpOdeSystem->SetParameter(0, x);
+    mpOdeSystem->SetParameter(1, y);
+    mpOdeSystem->SetParameter(2, z);
+}
+
+unsigned CellPolarityVectorSrnModel::GetNumDimensions()
+{
+    assert(mpOdeSystem != NULL);
+    return static_cast<CellPolarityVectorOdeSystem*>(mpOdeSystem)->GetNumDimensions();
+}
+
+void CellPolarityVectorSrnModel::SetNumDimensions(unsigned numDimensions)
+{
+    assert(mpOdeSystem != NULL);
+    static_cast<CellPolarityVectorOdeSystem*>(mpOdeSystem)->SetNumDimensions(numDimensions);
+}
+
+void CellPolarityVectorSrnModel::OutputSrnModelParameters(out_stream& rParamsFile)
+{
+    // No new parameters to output, so just call method on direct parent class
+    DHALLAbstractOdeSrnModel::OutputSrnModelParameters(rParamsFile);
+}
+
+// Declare identifier for the serializer
+#include "SerializationExportWrapperForCpp.hpp"
+CHASTE_CLASS_EXPORT(CellPolarityVectorSrnModel)
+#include "CellCycleModelOdeSolverExportWrapper.hpp"
+EXPORT_CELL_CYCLE_MODEL_ODE_SOLVER(CellPolarityVectorSrnModel)
@@ -0,0 +1,194 @@
+
+#ifndef CELLPOLARITYVECTORSRNMODEL_HPP_
+#define CELLPOLARITYVECTORSRNMODEL_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "CellPolarityVectorOdeSystem.hpp"
+#include "DHALLAbstractOdeSrnModel.hpp"
+
+/**
+ * A subclass of DHALLAbstractOdeSrnModel that holds the cell's polarity as a unit vector, evolved by a
+ * CellPolarityVectorOdeSystem, for use in 3D (or, equivalently to CellPolaritySrnModel, in 2D).
+ *
+ * The polarity always has three components; in a 2D simulation the third stays zero. The components
+ * and the neighbour drive are read and written directly through the ODE system's arrays, so no
+ * string lookup or trigonometry is needed inside the time loop. As with CellPolaritySrnModel, the
+ * ODE system is only solved every mUpdateInterval time steps, and the polarity is renormalised to
+ * unit length after each solve.
+ */
+class CellPolarityVectorSrnModel : public DHALLAbstractOdeSrnModel
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the SRN model and member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<DHALLAbstractOdeSrnModel>(*this);
+        archive & mNextUpdateTime;
+        archive & mUpdateInterval;
+    }
+
+    /**
+     * The ODE system is only solved once the simulation time reaches this value. Defaults to 0.
+     */
+    double mNextUpdateTime;
+
+    /**
+     * The number of simulation time steps between solves of the ODE system. Defaults to 1.
+     */
+    unsigned mUpdateInterval;
+
+    /**
+     * Rescale the polarity to unit length, undoing the drift in |e| left by the ODE solver.
+     */
+    void NormalisePolarity();
+
+    /**
+     * Solve the ODE system up to the current time, with its noise drawn from the stream of this cell
+     * if counter-based random streams are enabled.
+     */
+    void SolveOdeSystemToCurrentTime();
+
+protected:
+
+    /**
+     * Protected copy-constructor for use by CreateSrnModel().
+     *
+     * The daughter starts with the parent's polarity and neighbour drive.
+     *
+     * @param rModel  the SRN model to copy.
+     */
+    CellPolarityVectorSrnModel(const CellPolarityVectorSrnModel& rModel);
+
+public:
+
+    /**
+     * Default constructor calls base class.
+     *
+     * @param pOdeSolver An optional pointer to a cell-cycle model ODE solver object (allows the use of different ODE solvers)
+     */
+    CellPolarityVectorSrnModel(boost::shared_ptr<AbstractCellCycleModelOdeSolver> pOdeSolver = boost::shared_ptr<AbstractCellCycleModelOdeSolver>());
+
+    /**
+     * Class-specific allocation from an ObjectPool, as for CellPolaritySrnModel.
+     *
+     * @param size the number of bytes required
+     * @return the allocated memory
+     */
+    static void* operator new(size_t size);
+
+    /**
+     * Return memory allocated by operator new() to the ObjectPool.
+     *
+     * @param pObject the memory to release
+     */
+    static void operator delete(void* pObject);
+
+    /**
+     * Overridden builder method to create new copies of this SRN model.
+     *
+     * @return a copy of the current SRN model.
+     */
+    AbstractSrnModel* CreateSrnModel();
+
+    /**
+     * Initialise the SRN model at the start of a simulation.
+     *
+     * This overridden method sets up a new CellPolarityVectorOdeSystem.
+     */
+    void Initialise(); // override
+
+    /**
+     * Overridden SimulateToCurrentTime() method.
+     *
+     * The drive is expected to have been set through SetPolarityDrive() (by
+     * CellPolarityVectorTrackingModifier) before this is called. The ODE system is only
+     * solved every mUpdateInterval time steps; at other time steps this method does nothing.
+     */
+    void SimulateToCurrentTime();
+
+    /**
+     * Solve the ODE system up to the current time, even if this is not a time step
+     * at which it would otherwise be solved.
+     */
+    void SynchroniseToCurrentTime();
+
+    /**
+     * Overridden ResetForDivision() method.
+     *
+     * Brings the ODE system up to the current time before division.
+     */
+    void ResetForDivision();
+
+    /**
+     * @return mUpdateInterval
+     */
+    unsigned GetUpdateInterval();
+
+    /**
+     * Set mUpdateInterval. Takes effect after the next solve of the ODE system.
+     *
+     * @param updateInterval the number of time steps between solves of the ODE system
+     */
+    void SetUpdateInterval(unsigned updateInterval);
+
+    /**
+     * @return the three components of the unit polarity vector.
+     */
+    const std::vector<double>& rGetPolarityVector();
+
+    /**
+     * Set the polarity vector. The vector is normalised, so it need not have unit length,
+     * but it must be non-zero.
+     *
+     * @param x the first component
+     * @param y the second component
+     * @param z the third component
+     */
+    void SetPolarityVector(double x, double y, double z=0.0);
+
+    /**
+     * Set the sum of the polarity vectors of the coupled neighbours, used on the RHS of the polarity ODE.
+     *
+     * @param x the first component
+     * @param y the second component
+     * @param z the third component
+     */
+    void SetPolarityDrive(double x, double y, double z);
+
+    /**
+     * @return the number of polarity components that receive noise.
+     */
+    unsigned GetNumDimensions();
+
+    /**
+     * Set the number of polarity components that receive noise, which should be the space dimension.
+     *
+     * @param numDimensions the number of components, between 1 and 3
+     */
+    void SetNumDimensions(unsigned numDimensions);
+
+    /**
+     * Output SRN model parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSrnModelParameters(out_stream& rParamsFile);
+};
+
+// Declare identifier for the serializer
+#include "SerializationExportWrapper.hpp"
+CHASTE_CLASS_EXPORT(CellPolarityVectorSrnModel)
+#include "CellCycleModelOdeSolverExportWrapper.hpp"
+
+#endif /*CELLPOLARITYVECTORSRNMODEL_HPP_*/
@@ -1,6 +1,7 @@
 
 #include "DHALLAbstractOdeSrnModel.hpp"
 #include "Debug.hpp"
+#include "Exception.hpp"
 
 DHALLAbstractOdeSrnModel::DHALLAbstractOdeSrnModel(unsigned stateSize, boost::shared_ptr<AbstractCellCycleModelOdeSolver> pOdeSolver)
     : AbstractSrnModel(),
@@ -97,6 +98,46 @@ void DHALLAbstractOdeSrnModel::SetInitialConditions(std::vector<double> initialC
     mInitialConditions = initialConditions;
 }
 
+unsigned DHALLAbstractOdeSrnModel::RegisterDataSlot(const std::string& rName)
+{
+    assert(mpOdeSystem != nullptr);
+
+    if (mpOdeSystem->HasStateVariable(rName))
+    {
+        return mpOdeSystem->GetStateVariableIndex(rName);
+    }
+    if (mpOdeSystem->HasParameter(rName))
+    {
+        return mStateSize + mpOdeSystem->GetParameterIndex(rName);
+    }
+    EXCEPTION("No state variable or parameter named '" << rName << "' in this SRN model's ODE system.");
+}
+
+double DHALLAbstractOdeSrnModel::GetDataSlotValue(unsigned slot)
+{
+    assert(mpOdeSystem != nullptr);
+
+    if (slot < mStateSize)
+    {
+        return mpOdeSystem->rGetStateVariables()[slot];
+    }
+    return mpOdeSystem->GetParameter(slot - mStateSize);
+}
+
+void DHALLAbstractOdeSrnModel::SetDataSlotValue(unsigned slot, double value)
+{
+    assert(mpOdeSystem != nullptr);
+
+    if (slot < mStateSize)
+    {
+        mpOdeSystem->rGetStateVariables()[slot] = value;
+    }
+    else
+    {
+        mpOdeSystem->SetParameter(slot - mStateSize, value);
+    }
+}
+
 void DHALLAbstractOdeSrnModel::OutputSrnModelParameters(out_stream& rParamsFile)
 {
     // No new parameters to output, so just call method on direct parent class
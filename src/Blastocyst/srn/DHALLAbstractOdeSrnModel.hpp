@@ -109,6 +109,34 @@ public:
      */
     void SetInitialConditions(std::vector<double> initialConditions);
 
+    /**
+     * Resolve the name of an ODE state variable or parameter to an integer slot.
+     *
+     * This performs the string lookup once, so that callers can then use
+     * GetDataSlotValue() and SetDataSlotValue() inside the time loop. State
+     * variables occupy slots [0, mStateSize) and parameters follow on from these.
+     * The ODE system must have been set up before this method is called.
+     *
+     * @param rName the name of a state variable or parameter of the ODE system
+     * @return the slot associated with rName
+     */
+    unsigned RegisterDataSlot(const std::string& rName);
+
+    /**
+     * @return the current value stored in a slot obtained from RegisterDataSlot().
+     *
+     * @param slot the slot
+     */
+    double GetDataSlotValue(unsigned slot);
+
+    /**
+     * Set the value stored in a slot obtained from RegisterDataSlot().
+     *
+     * @param slot the slot
+     * @param value the new value
+     */
+    void SetDataSlotValue(unsigned slot, double value);
+
     /**
      * Outputs SRN model parameters to file. Virtual void so needs to be specified in child classes.
      *
@@ -0,0 +1,73 @@
+#ifndef BLASTOCYSTTESTCELLSGENERATOR_HPP_
+#define BLASTOCYSTTESTCELLSGENERATOR_HPP_
+
+#include <vector>
+
+#include "Cell.hpp"
+#include "CellPropertyRegistry.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "NoCellCycleModel.hpp"
+#include "CellPolaritySrnModel.hpp"
+
+/**
+ * Makes the cells used by the Blastocyst test suites. Each cell is wild type, is born at time zero,
+ * has a target area of 1 and, optionally, a CellPolaritySrnModel with the given polarity angle.
+ */
+class BlastocystTestCellsGenerator
+{
+public:
+
+    /**
+     * @return a new cell
+     *
+     * @param pProliferativeType the proliferative type of the cell
+     * @param pCellCycleModel the cell-cycle model of the cell, which the cell takes ownership of
+     * @param hasPolaritySrnModel whether to give the cell a CellPolaritySrnModel
+     * @param polarityAngle the initial polarity angle, if the cell has a CellPolaritySrnModel (defaults to 0)
+     */
+    static CellPtr CreateCell(boost::shared_ptr<AbstractCellProperty> pProliferativeType,
+                              AbstractCellCycleModel* pCellCycleModel,
+                              bool hasPolaritySrnModel,
+                              double polarityAngle=0.0)
+    {
+        boost::shared_ptr<AbstractCellProperty> p_state(CellPropertyRegistry::Instance()->Get<WildTypeCellMutationState>());
+
+        CellPolaritySrnModel* p_srn_model = nullptr;
+        if (hasPolaritySrnModel)
+        {
+            p_srn_model = new CellPolaritySrnModel();
+            std::vector<double> initial_conditions;
+            initial_conditions.push_back(polarityAngle);
+            p_srn_model->SetInitialConditions(initial_conditions);
+        }
+
+        // Cell gives a cell without an SRN model a NullSrnModel
+        CellPtr p_cell(new Cell(p_state, pCellCycleModel, p_srn_model));
+        p_cell->SetCellProliferativeType(pProliferativeType);
+        p_cell->SetBirthTime(0.0);
+        p_cell->GetCellData()->SetItem("target area", 1.0);
+        return p_cell;
+    }
+
+    /**
+     * Append cells with NoCellCycleModels, for a 2D population, to a vector.
+     *
+     * @param numCells the number of cells to make
+     * @param rCells the vector the cells are appended to
+     * @param hasPolaritySrnModel whether to give the cells CellPolaritySrnModels, with polarity angles of 0
+     */
+    template<class PROLIFERATIVE_TYPE>
+    static void GenerateCells(unsigned numCells, std::vector<CellPtr>& rCells, bool hasPolaritySrnModel)
+    {
+        boost::shared_ptr<AbstractCellProperty> p_prolif_type(CellPropertyRegistry::Instance()->Get<PROLIFERATIVE_TYPE>());
+
+        for (unsigned i=0; i<numCells; i++)
+        {
+            NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+            p_cc_model->SetDimension(2);
+            rCells.push_back(CreateCell(p_prolif_type, p_cc_model, hasPolaritySrnModel));
+        }
+    }
+};
+
+#endif /*BLASTOCYSTTESTCELLSGENERATOR_HPP_*/
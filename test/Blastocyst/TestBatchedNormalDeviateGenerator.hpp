@@ -0,0 +1,131 @@
+#ifndef TESTBATCHEDNORMALDEVIATEGENERATOR_HPP_
+#define TESTBATCHEDNORMALDEVIATEGENERATOR_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "BatchedNormalDeviateGenerator.hpp"
+#include "RandomNumberGenerator.hpp"
+
+/**
+ * Tests of BatchedNormalDeviateGenerator, which supplies the noise of the Dhall forces and polarity ODE systems.
+ */
+class TestBatchedNormalDeviateGenerator : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestDeviatesAreStandardNormal() throw (Exception)
+    {
+        RandomNumberGenerator::Instance()->Reseed(0);
+        BatchedNormalDeviateGenerator::Destroy();
+
+        unsigned num_deviates = 100000;
+        std::vector<double> deviates(num_deviates);
+        BatchedNormalDeviateGenerator::Instance()->Fill(&deviates[0], num_deviates, 0.0, 1.0);
+        TS_ASSERT_EQUALS(BatchedNormalDeviateGenerator::Instance()->GetNumBatches(), 1u);
+
+        double mean = 0.0;
+        for (unsigned i=0; i<num_deviates; i++)
+        {
+            mean += deviates[i];
+        }
+        mean /= num_deviates;
+
+        double variance = 0.0;
+        double third_moment = 0.0;
+        double fourth_moment = 0.0;
+        double lag_one_covariance = 0.0;
+        unsigned num_within_one_sd = 0;
+        for (unsigned i=0; i<num_deviates; i++)
+        {
+            double deviation = deviates[i] - mean;
+            variance += deviation*deviation;
+            third_moment += deviation*deviation*deviation;
+            fourth_moment += deviation*deviation*deviation*deviation;
+            if (i > 0)
+            {
+                lag_one_covariance += deviation*(deviates[i-1] - mean);
+            }
+            if (fabs(deviates[i]) < 1.0)
+            {
+                num_within_one_sd++;
+            }
+        }
+        variance /= num_deviates;
+        double skewness = third_moment/(num_deviates*pow(variance, 1.5));
+        double kurtosis = fourth_moment/(num_deviates*variance*variance);
+        double lag_one_correlation = lag_one_covariance/((num_deviates - 1)*variance);
+
+        // Each to within about five standard errors
+        TS_ASSERT_DELTA(mean, 0.0, 0.016);
+        TS_ASSERT_DELTA(variance, 1.0, 0.025);
+        TS_ASSERT_DELTA(skewness, 0.0, 0.04);
+        TS_ASSERT_DELTA(kurtosis, 3.0, 0.08);
+        TS_ASSERT_DELTA(lag_one_correlation, 0.0, 0.016);
+        TS_ASSERT_DELTA(num_within_one_sd/(double)num_deviates, 0.6827, 0.0075);
+
+        // Kolmogorov-Smirnov test against the standard normal distribution, at the 0.1% level
+        std::sort(deviates.begin(), deviates.end());
+        double largest_difference = 0.0;
+        for (unsigned i=0; i<num_deviates; i++)
+        {
+            double cdf = 0.5*erfc(-deviates[i]/sqrt(2.0));
+            largest_difference = std::max(largest_difference, std::max(fabs(cdf - i/(double)num_deviates),
+                                                                       fabs((i + 1.0)/num_deviates - cdf)));
+        }
+        TS_ASSERT_LESS_THAN(largest_difference, 1.95/sqrt((double)num_deviates));
+
+        BatchedNormalDeviateGenerator::Destroy();
+    }
+
+    void TestDeviatesAreReproducibleFromSeed() throw (Exception)
+    {
+        // An odd number, so that the last deviate is the first of an unfinished pair
+        unsigned num_deviates = 1001;
+        double mean = 0.5;
+        double sd = 1.0e-3;
+
+        RandomNumberGenerator::Instance()->Reseed(7);
+        BatchedNormalDeviateGenerator::Destroy();
+        std::vector<double> first(num_deviates);
+        BatchedNormalDeviateGenerator::Instance()->Fill(&first[0], num_deviates, mean, sd);
+
+        RandomNumberGenerator::Instance()->Reseed(7);
+        std::vector<double> second(num_deviates);
+        BatchedNormalDeviateGenerator::Instance()->Fill(&second[0], num_deviates, mean, sd);
+
+        for (unsigned i=0; i<num_deviates; i++)
+        {
+            TS_ASSERT_EQUALS(first[i], second[i]);
+            TS_ASSERT_DELTA(first[i], mean, 10*sd);
+        }
+
+        // A buffer of the same size is filled with the same deviates, which are returned in order
+        RandomNumberGenerator::Instance()->Reseed(7);
+        BatchedNormalDeviateGenerator::Instance()->SetBufferSize(num_deviates);
+        for (unsigned i=0; i<num_deviates; i++)
+        {
+            TS_ASSERT_EQUALS(BatchedNormalDeviateGenerator::Instance()->NormalRandomDeviate(mean, sd), first[i]);
+        }
+        TS_ASSERT_EQUALS(BatchedNormalDeviateGenerator::Instance()->GetNumBatches(), 3u);
+
+        // The next deviate starts a new batch, from the next seed
+        BatchedNormalDeviateGenerator::Instance()->NormalRandomDeviate(mean, sd);
+        TS_ASSERT_EQUALS(BatchedNormalDeviateGenerator::Instance()->GetNumBatches(), 4u);
+
+        // A different seed gives different deviates
+        RandomNumberGenerator::Instance()->Reseed(8);
+        BatchedNormalDeviateGenerator::Instance()->Reset();
+        TS_ASSERT_DIFFERS(BatchedNormalDeviateGenerator::Instance()->NormalRandomDeviate(mean, sd), first[0]);
+
+        BatchedNormalDeviateGenerator::Destroy();
+    }
+};
+
+#endif /*TESTBATCHEDNORMALDEVIATEGENERATOR_HPP_*/
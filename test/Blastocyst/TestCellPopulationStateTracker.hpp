@@ -0,0 +1,149 @@
+#ifndef TESTCELLPOPULATIONSTATETRACKER_HPP_
+#define TESTCELLPOPULATIONSTATETRACKER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+
+#include "TransitCellProliferativeType.hpp"
+
+#include "HoneycombMeshGenerator.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+
+#include "NissenOffLatticeSimulation.hpp"
+#include "CellPolarityTrackingModifier.hpp"
+#include "NissenForce.hpp"
+#include "NissenPairGeometryCache.hpp"
+#include "NissenHaloStateMirror.hpp"
+#include "CellPopulationStateTracker.hpp"
+
+#include "BlastocystTestCellsGenerator.hpp"
+#include "SmartPointers.hpp"
+
+/**
+ * Tests of CellPopulationStateTracker, which lets modifiers reuse node pairs that are still current.
+ */
+class TestCellPopulationStateTracker : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestNodePairsAreOnlyUpdatedWhenStale() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // Nodes are moved by index
+
+        HoneycombMeshGenerator generator(4, 4, 0);
+        MutableMesh<2,2>* p_generating_mesh = generator.GetMesh();
+
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(*p_generating_mesh, 1.5);
+
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TransitCellProliferativeType>(mesh.GetNumNodes(), cells, true);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+
+        CellPopulationStateTracker<2>* p_tracker = CellPopulationStateTracker<2>::Instance();
+
+        // Node locations are always current
+        p_tracker->EnsureState(cell_population, CellPopulationStateTracker<2>::NODE_LOCATIONS);
+        TS_ASSERT_EQUALS(p_tracker->GetNumUpdatesPerformed(), 0u);
+        TS_ASSERT_EQUALS(p_tracker->GetNumUpdatesSkipped(), 0u);
+
+        // The population has not been seen before, so the first request for node pairs updates it
+        p_tracker->EnsureState(cell_population, CellPopulationStateTracker<2>::NODE_PAIRS, 1.0);
+        TS_ASSERT_EQUALS(p_tracker->GetNumUpdatesPerformed(), 1u);
+        p_tracker->EnsureState(cell_population, CellPopulationStateTracker<2>::NODE_PAIRS, 1.0);
+        TS_ASSERT_EQUALS(p_tracker->GetNumUpdatesPerformed(), 1u);
+        TS_ASSERT_EQUALS(p_tracker->GetNumUpdatesSkipped(), 1u);
+
+        // The skin is 0.5, so the pairs stay current until a node has moved more than 0.25
+        c_vector<double, 2> location = mesh.GetNode(5)->rGetLocation();
+        location[0] += 0.2;
+        mesh.GetNode(5)->rGetModifiableLocation() = location;
+        p_tracker->EnsureState(cell_population, CellPopulationStateTracker<2>::NODE_PAIRS, 1.0);
+        TS_ASSERT_EQUALS(p_tracker->GetNumUpdatesPerformed(), 1u);
+        TS_ASSERT_EQUALS(p_tracker->GetNumUpdatesSkipped(), 2u);
+
+        location[0] += 0.1;
+        mesh.GetNode(5)->rGetModifiableLocation() = location;
+        p_tracker->EnsureState(cell_population, CellPopulationStateTracker<2>::NODE_PAIRS, 1.0);
+        TS_ASSERT_EQUALS(p_tracker->GetNumUpdatesPerformed(), 2u);
+
+        // A wider pair radius leaves a thinner skin
+        location[0] += 0.1;
+        mesh.GetNode(5)->rGetModifiableLocation() = location;
+        p_tracker->EnsureState(cell_population, CellPopulationStateTracker<2>::NODE_PAIRS, 1.0);
+        TS_ASSERT_EQUALS(p_tracker->GetNumUpdatesPerformed(), 2u);
+        p_tracker->EnsureState(cell_population, CellPopulationStateTracker<2>::NODE_PAIRS, 1.4);
+        TS_ASSERT_EQUALS(p_tracker->GetNumUpdatesPerformed(), 3u);
+
+        // With no skin at all, every request updates the population
+        p_tracker->EnsureState(cell_population, CellPopulationStateTracker<2>::NODE_PAIRS, 1.5);
+        TS_ASSERT_EQUALS(p_tracker->GetNumUpdatesPerformed(), 4u);
+
+        // An update made elsewhere and recorded counts as current
+        location[0] += 0.4;
+        mesh.GetNode(5)->rGetModifiableLocation() = location;
+        cell_population.Update();
+        p_tracker->RecordUpdate(cell_population);
+        p_tracker->EnsureState(cell_population, CellPopulationStateTracker<2>::NODE_PAIRS, 1.0);
+        TS_ASSERT_EQUALS(p_tracker->GetNumUpdatesPerformed(), 4u);
+
+        // A new node always needs an update
+        std::vector<CellPtr> new_cells;
+        BlastocystTestCellsGenerator::GenerateCells<TransitCellProliferativeType>(1, new_cells, true);
+        cell_population.AddCell(new_cells[0], cell_population.GetCellUsingLocationIndex(0));
+        p_tracker->EnsureState(cell_population, CellPopulationStateTracker<2>::NODE_PAIRS, 1.0);
+        TS_ASSERT_EQUALS(p_tracker->GetNumUpdatesPerformed(), 5u);
+
+        CellPopulationStateTracker<2>::Destroy();
+    }
+
+    void TestSimulationSharesItsUpdatesWithTheModifier() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // The pair counts are those of the whole population
+
+        HoneycombMeshGenerator generator(3, 3, 0);
+        MutableMesh<2,2>* p_generating_mesh = generator.GetMesh();
+
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(*p_generating_mesh, 1.5);
+
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TransitCellProliferativeType>(mesh.GetNumNodes(), cells, true);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+
+        NissenOffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("CellPopulationStateTracker");
+        simulator.SetDt(1.0/200.0);
+        simulator.SetSamplingTimestepMultiple(20);
+        simulator.SetEndTime(1.0);
+
+        MAKE_PTR(NissenForce<2>, p_force);
+        p_force->SetCutOffLength(2.5);
+        simulator.AddForce(p_force);
+
+        MAKE_PTR(CellPolarityTrackingModifier<2>, p_modifier);
+        simulator.AddSimulationModifier(p_modifier);
+
+        simulator.Solve();
+
+        // The simulation records its own update each time step, so the modifier reuses it
+        CellPopulationStateTracker<2>* p_tracker = CellPopulationStateTracker<2>::Instance();
+        TS_ASSERT_LESS_THAN_EQUALS(p_tracker->GetNumUpdatesPerformed(), 1u);
+        TS_ASSERT_LESS_THAN(0u, p_tracker->GetNumUpdatesSkipped());
+
+        // The node pairs beyond the range of the force are counted and written out
+        TS_ASSERT_LESS_THAN_EQUALS(0.0, simulator.GetRejectedPairFraction());
+        TS_ASSERT_LESS_THAN(simulator.GetRejectedPairFraction(), 1.0);
+        OutputFileHandler handler("CellPopulationStateTracker", false);
+        TS_ASSERT(handler.FindFile("results_from_time_0/pairrejection.dat").Exists());
+
+        NissenPairGeometryCache<2>::Destroy();
+        NissenHaloStateMirror<2>::Destroy();
+        CellPopulationStateTracker<2>::Destroy();
+    }
+};
+
+#endif /*TESTCELLPOPULATIONSTATETRACKER_HPP_*/
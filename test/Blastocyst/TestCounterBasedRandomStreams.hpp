@@ -0,0 +1,226 @@
+#ifndef TESTCOUNTERBASEDRANDOMSTREAMS_HPP_
+#define TESTCOUNTERBASEDRANDOMSTREAMS_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+
+#include <map>
+#include <vector>
+
+#include "NoCellCycleModel.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "WildTypeCellMutationState.hpp"
+
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+
+#include "NissenNoiseForce.hpp"
+#include "CounterBasedRandomStreams.hpp"
+#include "BatchedNormalDeviateGenerator.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "SimulationTime.hpp"
+
+/**
+ * Tests of CounterBasedRandomStreams, which makes each random number a function of the cell, step and purpose.
+ */
+class TestCounterBasedRandomStreams : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestPhiloxKnownAnswers() throw (Exception)
+    {
+        // The known-answer vectors of the Random123 library
+        uint32_t result[4];
+
+        uint32_t zero_counter[4] = {0, 0, 0, 0};
+        uint32_t zero_key[2] = {0, 0};
+        CounterBasedRandomStreams::Philox4x32(zero_counter, zero_key, result);
+        TS_ASSERT_EQUALS(result[0], 0x6627e8d5u);
+        TS_ASSERT_EQUALS(result[1], 0xe169c58du);
+        TS_ASSERT_EQUALS(result[2], 0xbc57ac4cu);
+        TS_ASSERT_EQUALS(result[3], 0x9b00dbd8u);
+
+        uint32_t full_counter[4] = {0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff};
+        uint32_t full_key[2] = {0xffffffff, 0xffffffff};
+        CounterBasedRandomStreams::Philox4x32(full_counter, full_key, result);
+        TS_ASSERT_EQUALS(result[0], 0x408f276du);
+        TS_ASSERT_EQUALS(result[1], 0x41c83b0eu);
+        TS_ASSERT_EQUALS(result[2], 0xa20bc7c6u);
+        TS_ASSERT_EQUALS(result[3], 0x6d5451fdu);
+
+        uint32_t pi_counter[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+        uint32_t pi_key[2] = {0xa4093822, 0x299f31d0};
+        CounterBasedRandomStreams::Philox4x32(pi_counter, pi_key, result);
+        TS_ASSERT_EQUALS(result[0], 0xd16cfe09u);
+        TS_ASSERT_EQUALS(result[1], 0x94fdccebu);
+        TS_ASSERT_EQUALS(result[2], 0x5001e420u);
+        TS_ASSERT_EQUALS(result[3], 0x24126ea1u);
+    }
+
+    void TestDrawsDependOnlyOnCellStepAndPurpose() throw (Exception)
+    {
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 10);
+        CounterBasedRandomStreams* p_streams = CounterBasedRandomStreams::Instance();
+
+        // Until enabled, the draws come from the RandomNumberGenerator as before
+        TS_ASSERT(!p_streams->IsEnabled());
+        RandomNumberGenerator::Instance()->Reseed(3);
+        double expected = RandomNumberGenerator::Instance()->ranf();
+        RandomNumberGenerator::Instance()->Reseed(3);
+        TS_ASSERT_EQUALS(p_streams->ranf(0, CounterBasedRandomStreams::CELL_CYCLE_DURATION, 0), expected);
+
+        p_streams->SetEnabled(true);
+        p_streams->SetSeed(11);
+        TS_ASSERT_EQUALS(p_streams->GetSeed(), 11u);
+
+        // The same numbers are drawn for each cell whatever the order the cells are visited in
+        unsigned num_cells = 1000;
+        std::vector<double> uniforms(num_cells);
+        std::vector<double> normals(num_cells);
+        for (unsigned i=0; i<num_cells; i++)
+        {
+            uniforms[i] = p_streams->ranf(i, CounterBasedRandomStreams::DIVISION_DIRECTION, 1);
+            normals[i] = p_streams->NormalRandomDeviate(0.0, 1.0, i, CounterBasedRandomStreams::NOISE_FORCE, 3);
+        }
+        RandomNumberGenerator::Instance()->ranf();
+        double mean_uniform = 0.0;
+        double mean_normal = 0.0;
+        double mean_square_normal = 0.0;
+        for (unsigned i=num_cells; i-- > 0; )
+        {
+            TS_ASSERT_EQUALS(p_streams->ranf(i, CounterBasedRandomStreams::DIVISION_DIRECTION, 1), uniforms[i]);
+            TS_ASSERT_EQUALS(p_streams->NormalRandomDeviate(0.0, 1.0, i, CounterBasedRandomStreams::NOISE_FORCE, 3), normals[i]);
+            TS_ASSERT_LESS_THAN_EQUALS(0.0, uniforms[i]);
+            TS_ASSERT_LESS_THAN(uniforms[i], 1.0);
+            mean_uniform += uniforms[i]/num_cells;
+            mean_normal += normals[i]/num_cells;
+            mean_square_normal += normals[i]*normals[i]/num_cells;
+        }
+        TS_ASSERT_DELTA(mean_uniform, 0.5, 0.05);
+        TS_ASSERT_DELTA(mean_normal, 0.0, 0.16);
+        TS_ASSERT_DELTA(mean_square_normal, 1.0, 0.25);
+
+        // Another draw index, purpose, seed or time step gives another number
+        TS_ASSERT_DIFFERS(p_streams->ranf(5, CounterBasedRandomStreams::DIVISION_DIRECTION, 0), uniforms[5]);
+        TS_ASSERT_DIFFERS(p_streams->ranf(5, CounterBasedRandomStreams::CELL_CYCLE_DURATION, 1), uniforms[5]);
+        p_streams->SetSeed(12);
+        TS_ASSERT_DIFFERS(p_streams->ranf(5, CounterBasedRandomStreams::DIVISION_DIRECTION, 1), uniforms[5]);
+        p_streams->SetSeed(11);
+        SimulationTime::Instance()->IncrementTimeOneStep();
+        TS_ASSERT_DIFFERS(p_streams->ranf(5, CounterBasedRandomStreams::DIVISION_DIRECTION, 1), uniforms[5]);
+
+        // A stream cursor restarts its draws at each time step
+        CounterBasedRandomStream stream(CounterBasedRandomStreams::POLARITY_NOISE);
+        stream.SetCellId(5);
+        double first = stream.NormalRandomDeviate(0.0, 1.0);
+        double second = stream.NormalRandomDeviate(0.0, 1.0);
+        TS_ASSERT_EQUALS(first, p_streams->NormalRandomDeviate(0.0, 1.0, 5, CounterBasedRandomStreams::POLARITY_NOISE, 0));
+        TS_ASSERT_EQUALS(second, p_streams->NormalRandomDeviate(0.0, 1.0, 5, CounterBasedRandomStreams::POLARITY_NOISE, 1));
+        SimulationTime::Instance()->IncrementTimeOneStep();
+        TS_ASSERT_EQUALS(stream.NormalRandomDeviate(0.0, 1.0), p_streams->NormalRandomDeviate(0.0, 1.0, 5, CounterBasedRandomStreams::POLARITY_NOISE, 0));
+
+        CounterBasedRandomStreams::Destroy();
+        BatchedNormalDeviateGenerator::Destroy();
+    }
+
+    void TestDrawsAreNotRepeatedInALaterSolve() throw (Exception)
+    {
+        SimulationTime* p_time = SimulationTime::Instance();
+        p_time->SetEndTimeAndNumberOfTimeSteps(1.0, 10);
+        CounterBasedRandomStreams* p_streams = CounterBasedRandomStreams::Instance();
+        p_streams->SetEnabled(true);
+
+        double first_solve_uniform = p_streams->ranf(3, CounterBasedRandomStreams::NOISE_FORCE, 0);
+        CounterBasedRandomStream stream(CounterBasedRandomStreams::POLARITY_NOISE);
+        stream.SetCellId(3);
+        double first_solve_normal = stream.NormalRandomDeviate(0.0, 1.0);
+
+        while (!p_time->IsFinished())
+        {
+            p_time->IncrementTimeOneStep();
+        }
+        TS_ASSERT_EQUALS(CounterBasedRandomStreams::GetAbsoluteTimeStep(), 10u);
+        double end_uniform = p_streams->ranf(3, CounterBasedRandomStreams::NOISE_FORCE, 0);
+
+        // A second Solve() restarts the count of time steps elapsed, but not the streams
+        p_time->ResetEndTimeAndNumberOfTimeSteps(2.0, 10);
+        TS_ASSERT_EQUALS(p_time->GetTimeStepsElapsed(), 0u);
+        TS_ASSERT_EQUALS(CounterBasedRandomStreams::GetAbsoluteTimeStep(), 10u);
+        TS_ASSERT_EQUALS(p_streams->ranf(3, CounterBasedRandomStreams::NOISE_FORCE, 0), end_uniform);
+        TS_ASSERT_DIFFERS(p_streams->ranf(3, CounterBasedRandomStreams::NOISE_FORCE, 0), first_solve_uniform);
+        TS_ASSERT_DIFFERS(stream.NormalRandomDeviate(0.0, 1.0), first_solve_normal);
+
+        p_time->IncrementTimeOneStep();
+        TS_ASSERT_EQUALS(CounterBasedRandomStreams::GetAbsoluteTimeStep(), 11u);
+
+        CounterBasedRandomStreams::Destroy();
+    }
+
+    void TestNoiseForceIsIndependentOfTheGlobalStream() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // The forces are compared by node
+
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 10);
+
+        std::vector<Node<2>*> nodes;
+        for (unsigned i=0; i<5; i++)
+        {
+            nodes.push_back(new Node<2>(i, false, i, 0.0));
+        }
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 1.5);
+
+        boost::shared_ptr<AbstractCellProperty> p_state(CellPropertyRegistry::Instance()->Get<WildTypeCellMutationState>());
+        boost::shared_ptr<AbstractCellProperty> p_prolif_type(CellPropertyRegistry::Instance()->Get<TransitCellProliferativeType>());
+        std::vector<CellPtr> cells;
+        for (unsigned i=0; i<mesh.GetNumNodes(); i++)
+        {
+            NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+            p_cc_model->SetDimension(2);
+            CellPtr p_cell(new Cell(p_state, p_cc_model));
+            p_cell->SetCellProliferativeType(p_prolif_type);
+            cells.push_back(p_cell);
+        }
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+
+        CounterBasedRandomStreams::Instance()->SetEnabled(true);
+
+        NissenNoiseForce<2> force;
+        force.AddForceContribution(cell_population);
+        std::map<unsigned, c_vector<double, 2> > first_forces;
+        for (unsigned i=0; i<mesh.GetNumNodes(); i++)
+        {
+            first_forces[cell_population.GetCellUsingLocationIndex(i)->GetCellId()] = mesh.GetNode(i)->rGetAppliedForce();
+            mesh.GetNode(i)->ClearAppliedForce();
+        }
+
+        // A fresh force, after other draws from the global stream, gives each cell the same noise
+        RandomNumberGenerator::Instance()->Reseed(99);
+        RandomNumberGenerator::Instance()->ranf();
+        NissenNoiseForce<2> other_force;
+        other_force.AddForceContribution(cell_population);
+        for (unsigned i=0; i<mesh.GetNumNodes(); i++)
+        {
+            c_vector<double, 2> first_force = first_forces[cell_population.GetCellUsingLocationIndex(i)->GetCellId()];
+            TS_ASSERT_LESS_THAN(0.0, norm_2(first_force));
+            TS_ASSERT_EQUALS(mesh.GetNode(i)->rGetAppliedForce()[0], first_force[0]);
+            TS_ASSERT_EQUALS(mesh.GetNode(i)->rGetAppliedForce()[1], first_force[1]);
+            mesh.GetNode(i)->ClearAppliedForce();
+        }
+
+        // A second evaluation in the same time step, as by a method with substeps, draws fresh noise
+        other_force.AddForceContribution(cell_population);
+        TS_ASSERT_DIFFERS(mesh.GetNode(0)->rGetAppliedForce()[0],
+                          first_forces[cell_population.GetCellUsingLocationIndex(0)->GetCellId()][0]);
+
+        CounterBasedRandomStreams::Destroy();
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+    }
+};
+
+#endif /*TESTCOUNTERBASEDRANDOMSTREAMS_HPP_*/
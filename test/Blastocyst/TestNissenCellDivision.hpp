@@ -0,0 +1,250 @@
+#ifndef TESTNISSENCELLDIVISION_HPP_
+#define TESTNISSENCELLDIVISION_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+
+#include <cfloat>
+#include <fstream>
+#include <string>
+
+#include "PreCompactionCellCycleModel.hpp"
+#include "NoCellCycleModel.hpp"
+#include "TransitCellProliferativeType.hpp"
+#include "TrophectodermCellProliferativeType.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "WildTypeCellMutationState.hpp"
+
+#include "HoneycombMeshGenerator.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+
+#include "NissenOffLatticeSimulation.hpp"
+#include "NissenBasedDivisionRule.hpp"
+#include "CellDivisionSchedule.hpp"
+#include "CellPolarityTrackingModifier.hpp"
+#include "NissenForce.hpp"
+#include "NissenPairGeometryCache.hpp"
+#include "NissenHaloStateMirror.hpp"
+#include "CellPopulationStateTracker.hpp"
+
+#include "BlastocystTestCellsGenerator.hpp"
+#include "SmartPointers.hpp"
+
+/**
+ * Tests of the scheduling and batching of cell divisions in NissenOffLatticeSimulation.
+ */
+class TestNissenCellDivision : public AbstractCellBasedTestSuite
+{
+private:
+
+    void GenerateCells(unsigned numCells, double cellCycleDuration, std::vector<CellPtr>& rCells)
+    {
+        boost::shared_ptr<AbstractCellProperty> p_prolif_type(CellPropertyRegistry::Instance()->Get<TransitCellProliferativeType>());
+
+        for (unsigned i=0; i<numCells; i++)
+        {
+            // Cells other than trophectoderm take twice the drawn duration
+            PreCompactionCellCycleModel* p_cc_model = new PreCompactionCellCycleModel();
+            p_cc_model->SetDimension(2);
+            p_cc_model->SetMinCellCycleDuration(0.5*cellCycleDuration);
+            p_cc_model->SetMaxCellCycleDuration(0.6*cellCycleDuration);
+            rCells.push_back(BlastocystTestCellsGenerator::CreateCell(p_prolif_type, p_cc_model, true));
+        }
+    }
+
+public:
+
+    void TestDivisionsAreProcessedAsABatch() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // The divisions are counted over the whole population
+
+        HoneycombMeshGenerator generator(2, 2, 0);
+        MutableMesh<2,2>* p_generating_mesh = generator.GetMesh();
+
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(*p_generating_mesh, 1.5);
+
+        // Every cell divides once, between times 0.5 and 0.6, and its daughters are not due again before 1.0
+        std::vector<CellPtr> cells;
+        GenerateCells(mesh.GetNumNodes(), 0.5, cells);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+        MAKE_PTR(NissenBasedDivisionRule<2>, p_division_rule);
+        p_division_rule->SetUseOverlapAwarePlacement(true);
+        cell_population.SetCentreBasedDivisionRule(p_division_rule);
+
+        NissenOffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("NissenCellDivision");
+        simulator.SetDt(1.0/200.0);
+        simulator.SetSamplingTimestepMultiple(20);
+        simulator.SetEndTime(0.9);
+        simulator.SetOutputDivisionLocations(true);
+
+        MAKE_PTR(NissenForce<2>, p_force);
+        p_force->SetCutOffLength(2.5);
+        simulator.AddForce(p_force);
+
+        MAKE_PTR(CellPolarityTrackingModifier<2>, p_modifier);
+        simulator.AddSimulationModifier(p_modifier);
+
+        simulator.Solve();
+
+        TS_ASSERT_EQUALS(simulator.GetNumBirths(), 4u);
+        TS_ASSERT_EQUALS(cell_population.GetNumRealCells(), 8u);
+
+        // Every daughter position computed for a batch was used
+        TS_ASSERT_EQUALS(p_division_rule->GetNumBatchedDivisions(), 0u);
+
+        // Each division is recorded
+        OutputFileHandler handler("NissenCellDivision", false);
+        FileFinder division_file = handler.FindFile("results_from_time_0/divisions.dat");
+        TS_ASSERT(division_file.Exists());
+        std::ifstream division_stream(division_file.GetAbsolutePath().c_str());
+        unsigned num_divisions = 0;
+        std::string line;
+        while (std::getline(division_stream, line))
+        {
+            if (!line.empty() && line[0] != '#')
+            {
+                num_divisions++;
+            }
+        }
+        TS_ASSERT_EQUALS(num_divisions, 4u);
+
+        // The population is updated after the divisions as part of the time step, so the modifier need not update it again
+        TS_ASSERT_LESS_THAN_EQUALS(CellPopulationStateTracker<2>::Instance()->GetNumUpdatesPerformed(), 1u);
+
+        NissenPairGeometryCache<2>::Destroy();
+        NissenHaloStateMirror<2>::Destroy();
+        CellPopulationStateTracker<2>::Destroy();
+    }
+
+    void TestScheduleReturnsCellsWhenDue() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // Each node is given a cell
+
+        std::vector<Node<2>*> nodes;
+        for (unsigned i=0; i<5; i++)
+        {
+            nodes.push_back(new Node<2>(i, false, double(i), 0.0));
+        }
+
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 1.5);
+
+        // Four cells with durations between 10 and 12 hours, born at different times
+        std::vector<CellPtr> cells;
+        GenerateCells(4, 10.0, cells);
+        cells[0]->SetBirthTime(-8.0);
+        cells[1]->SetBirthTime(-2.0);
+        cells[2]->SetBirthTime(-6.0);
+        cells[3]->SetBirthTime(0.0);
+
+        // A cell whose division time cannot be predicted
+        boost::shared_ptr<AbstractCellProperty> p_state(CellPropertyRegistry::Instance()->Get<WildTypeCellMutationState>());
+        NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+        p_cc_model->SetDimension(2);
+        CellPtr p_unscheduled_cell(new Cell(p_state, p_cc_model));
+        p_unscheduled_cell->SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<TransitCellProliferativeType>());
+        cells.push_back(p_unscheduled_cell);
+
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+        cell_population.InitialiseCells();
+
+        std::vector<double> division_times(4);
+        for (unsigned i=0; i<4; i++)
+        {
+            division_times[i] = cells[i]->GetBirthTime() + cells[i]->GetCellCycleModel()->GetCellCycleDuration();
+        }
+        TS_ASSERT_LESS_THAN(division_times[0], division_times[2]);
+        TS_ASSERT_LESS_THAN(division_times[2], division_times[1]);
+        TS_ASSERT_LESS_THAN(division_times[1], division_times[3]);
+
+        CellDivisionSchedule<2> schedule;
+        schedule.Rebuild(cell_population);
+        TS_ASSERT_EQUALS(schedule.GetNumCells(), 5u);
+        TS_ASSERT_EQUALS(schedule.GetQueueSize(), 4u);
+
+        // Only the cells due by then are returned, earliest first, along with the unscheduled cell
+        std::vector<CellPtr> due_cells;
+        schedule.PopDueCells(0.5*(division_times[2] + division_times[1]), due_cells);
+        TS_ASSERT_EQUALS(due_cells.size(), 3u);
+        TS_ASSERT(due_cells[0] == cells[0]);
+        TS_ASSERT(due_cells[1] == cells[2]);
+        TS_ASSERT(due_cells[2] == p_unscheduled_cell);
+        TS_ASSERT_EQUALS(schedule.GetNumCells(), 2u);
+        TS_ASSERT_EQUALS(schedule.GetQueueSize(), 2u);
+
+        // Rescheduling a cell supersedes its earlier entry, which is then skipped
+        schedule.Schedule(cells[0]);
+        schedule.Schedule(cells[0]);
+        TS_ASSERT_EQUALS(schedule.GetNumCells(), 3u);
+        TS_ASSERT_EQUALS(schedule.GetQueueSize(), 4u);
+
+        // A dead cell is dropped, and a cell that will never divide is counted but not queued
+        cells[1]->Kill();
+        cells[3]->SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<DifferentiatedCellProliferativeType>());
+        static_cast<PreCompactionCellCycleModel*>(cells[3]->GetCellCycleModel())->RescaleCellCycleDurationForType();
+        TS_ASSERT_EQUALS(cells[3]->GetCellCycleModel()->GetCellCycleDuration(), DBL_MAX);
+        schedule.Schedule(cells[3]);
+        TS_ASSERT_EQUALS(schedule.GetNumCells(), 3u);
+        TS_ASSERT_EQUALS(schedule.GetQueueSize(), 4u);
+
+        due_cells.clear();
+        schedule.PopDueCells(1000.0, due_cells);
+        TS_ASSERT_EQUALS(due_cells.size(), 1u);
+        TS_ASSERT(due_cells[0] == cells[0]);
+        TS_ASSERT_EQUALS(schedule.GetNumCells(), 1u);
+        TS_ASSERT_EQUALS(schedule.GetQueueSize(), 0u);
+
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+    }
+
+    void TestBecomingTrophectodermHalvesTheCellCycle() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // Cells are looked up by location index
+
+        HoneycombMeshGenerator generator(2, 2, 0);
+        MutableMesh<2,2>* p_generating_mesh = generator.GetMesh();
+
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(*p_generating_mesh, 1.5);
+
+        std::vector<CellPtr> cells;
+        GenerateCells(mesh.GetNumNodes(), 10.0, cells);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+
+        // Constructing the simulation draws the cell-cycle durations
+        NissenOffLatticeSimulation<2> simulator(cell_population);
+        CellPtr p_cell = cell_population.GetCellUsingLocationIndex(0);
+        double duration = p_cell->GetCellCycleModel()->GetCellCycleDuration();
+        TS_ASSERT_LESS_THAN_EQUALS(10.0, duration);
+        TS_ASSERT_LESS_THAN_EQUALS(duration, 12.0);
+
+        // A cell specified as trophectoderm takes half as long, keeping its drawn duration
+        p_cell->SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<TrophectodermCellProliferativeType>());
+        simulator.RescheduleDivision(p_cell);
+        TS_ASSERT_DELTA(p_cell->GetCellCycleModel()->GetCellCycleDuration(), 0.5*duration, 1e-12);
+
+        // Rescheduling again without a change of type leaves the duration alone
+        simulator.RescheduleDivision(p_cell);
+        TS_ASSERT_DELTA(p_cell->GetCellCycleModel()->GetCellCycleDuration(), 0.5*duration, 1e-12);
+
+        // A differentiated cell never divides, and a new duration is drawn if it becomes proliferative again
+        p_cell->SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<DifferentiatedCellProliferativeType>());
+        simulator.RescheduleDivision(p_cell);
+        TS_ASSERT_EQUALS(p_cell->GetCellCycleModel()->GetCellCycleDuration(), DBL_MAX);
+
+        p_cell->SetCellProliferativeType(CellPropertyRegistry::Instance()->Get<TrophectodermCellProliferativeType>());
+        simulator.RescheduleDivision(p_cell);
+        TS_ASSERT_LESS_THAN_EQUALS(5.0, p_cell->GetCellCycleModel()->GetCellCycleDuration());
+        TS_ASSERT_LESS_THAN_EQUALS(p_cell->GetCellCycleModel()->GetCellCycleDuration(), 6.0);
+    }
+};
+
+#endif /*TESTNISSENCELLDIVISION_HPP_*/
@@ -0,0 +1,128 @@
+#ifndef TESTNISSENFIREMINIMISER_HPP_
+#define TESTNISSENFIREMINIMISER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+
+#include "TransitCellProliferativeType.hpp"
+
+#include "HoneycombMeshGenerator.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+
+#include "NissenFireMinimiser.hpp"
+#include "NissenForce.hpp"
+#include "NissenNoiseForce.hpp"
+#include "NissenPairGeometryCache.hpp"
+#include "NissenHaloStateMirror.hpp"
+#include "CellPopulationStateTracker.hpp"
+
+#include "BlastocystTestCellsGenerator.hpp"
+#include "SmartPointers.hpp"
+
+/**
+ * Tests of the potential energy of the Dhall forces and of NissenFireMinimiser.
+ */
+class TestNissenFireMinimiser : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestPairPotentialMatchesForce() throw (Exception)
+    {
+        std::vector<Node<2>*> nodes;
+        nodes.push_back(new Node<2>(0, false, 0.0, 0.0));
+        nodes.push_back(new Node<2>(1, false, 1.0, 0.0));
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 2.5);
+
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TransitCellProliferativeType>(mesh.GetNumNodes(), cells, false);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+
+        NissenForce<2> force;
+        force.SetCutOffLength(2.5);
+        force.SetNumPotentialQuadratureIntervals(256);
+
+        // The pair potential is zero at the range and its derivative is the force on A along the line to B
+        c_vector<double, 2> unit_vector = zero_vector<double>(2);
+        unit_vector[0] = 1.0;
+        TS_ASSERT_DELTA(force.CalculatePairPotential(0, 1, 2.5*unit_vector, 2.5, cell_population), 0.0, 1e-12);
+
+        double h = 1e-3;
+        double distances[4] = {0.4, 0.8, 1.3, 2.0};
+        for (unsigned i=0; i<4; i++)
+        {
+            double r = distances[i];
+            double derivative = (force.CalculatePairPotential(0, 1, (r+h)*unit_vector, r+h, cell_population)
+                                 - force.CalculatePairPotential(0, 1, (r-h)*unit_vector, r-h, cell_population))/(2.0*h);
+            c_vector<double, 2> pair_force = force.CalculateForceFromPairGeometry(0, 1, r*unit_vector, r, cell_population);
+            TS_ASSERT_DELTA(derivative, pair_force[0], 1e-3);
+        }
+
+        // Close cells repel, so have a positive potential, and the attraction makes it negative further out
+        TS_ASSERT_LESS_THAN(0.0, force.CalculatePairPotential(0, 1, 0.4*unit_vector, 0.4, cell_population));
+        TS_ASSERT_LESS_THAN(force.CalculatePairPotential(0, 1, 2.0*unit_vector, 2.0, cell_population), 0.0);
+
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+    }
+
+    void TestMinimiserRelaxesSquashedCluster() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // The energy is compared with a sequential calculation
+
+        HoneycombMeshGenerator generator(3, 3, 0);
+        MutableMesh<2,2>* p_generating_mesh = generator.GetMesh();
+        p_generating_mesh->Scale(0.7, 0.7);
+
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(*p_generating_mesh, 3.0);
+
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TransitCellProliferativeType>(mesh.GetNumNodes(), cells, false);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+
+        MAKE_PTR(NissenForce<2>, p_force);
+        p_force->SetCutOffLength(2.5);
+
+        // The noise is frozen, so does not stop the minimiser converging
+        MAKE_PTR(NissenNoiseForce<2>, p_noise_force);
+
+        NissenFireMinimiser<2> minimiser(cell_population);
+        minimiser.AddForce(p_force);
+        minimiser.AddForce(p_noise_force);
+
+        double initial_energy = minimiser.CalculatePotentialEnergy();
+        TS_ASSERT(minimiser.Minimise());
+        double final_energy = minimiser.CalculatePotentialEnergy();
+
+        TS_ASSERT_LESS_THAN(minimiser.GetFinalMaximumForce(), minimiser.GetForceTolerance());
+        TS_ASSERT_LESS_THAN(final_energy, initial_energy);
+
+        // Far fewer iterations than forward Euler steps of 1/200 hours over the hours the cluster takes to spread out
+        TS_ASSERT_LESS_THAN(minimiser.GetNumIterations(), 500u);
+
+        // The cluster has spread out: no two cells are as close as they were squashed
+        cell_population.Update();
+        std::vector<std::pair<Node<2>*, Node<2>*> >& r_node_pairs = cell_population.rGetNodePairs();
+        for (unsigned i=0; i<r_node_pairs.size(); i++)
+        {
+            double distance = norm_2(r_node_pairs[i].second->rGetLocation() - r_node_pairs[i].first->rGetLocation());
+            TS_ASSERT_LESS_THAN(0.75, distance);
+        }
+
+        // A second call finds the population already relaxed
+        TS_ASSERT(minimiser.Minimise());
+        TS_ASSERT_EQUALS(minimiser.GetNumIterations(), 0u);
+
+        NissenPairGeometryCache<2>::Destroy();
+        NissenHaloStateMirror<2>::Destroy();
+        CellPopulationStateTracker<2>::Destroy();
+    }
+};
+
+#endif /*TESTNISSENFIREMINIMISER_HPP_*/
@@ -0,0 +1,244 @@
+#ifndef TESTNISSENHALOEXCHANGE_HPP_
+#define TESTNISSENHALOEXCHANGE_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+#include "PetscTools.hpp"
+
+#include <sstream>
+
+#include "NoCellCycleModel.hpp"
+#include "TrophectodermCellProliferativeType.hpp"
+
+#include "HoneycombMeshGenerator.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+
+#include "OffLatticeSimulation.hpp"
+#include "CellPolaritySrnModel.hpp"
+#include "CellPolarityTrackingModifier.hpp"
+#include "NissenForceTrophectoderm.hpp"
+#include "NissenHaloStateMirror.hpp"
+#include "NissenPairGeometryCache.hpp"
+#include "CellPopulationStateTracker.hpp"
+#include "SimulationTime.hpp"
+
+#include "BlastocystTestCellsGenerator.hpp"
+#include "SmartPointers.hpp"
+
+/**
+ * Tests of the exchange of polarity with halo nodes. These run sequentially and in parallel
+ * (they are in the parallel test pack); in a sequential run there are no halo nodes.
+ */
+class TestNissenHaloExchange : public AbstractCellBasedTestSuite
+{
+private:
+
+    /** A polarity angle that any process can work out from a node's location. */
+    double AngleAtLocation(const c_vector<double, 2>& rLocation)
+    {
+        return 0.3*rLocation[0] - 0.2*rLocation[1];
+    }
+
+    void GenerateTrophectodermCells(NodesOnlyMesh<2>& rMesh, std::vector<CellPtr>& rCells, std::vector<unsigned>& rLocationIndices)
+    {
+        boost::shared_ptr<AbstractCellProperty> p_prolif_type(CellPropertyRegistry::Instance()->Get<TrophectodermCellProliferativeType>());
+
+        // Only the nodes owned by this process get cells; their global indices need not run from zero
+        for (AbstractMesh<2,2>::NodeIterator node_iter = rMesh.GetNodeIteratorBegin();
+             node_iter != rMesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+            p_cc_model->SetDimension(2);
+
+            CellPtr p_cell = BlastocystTestCellsGenerator::CreateCell(p_prolif_type, p_cc_model, true, AngleAtLocation(node_iter->rGetLocation()));
+            p_cell->GetCellData()->SetItem("initial x", node_iter->rGetLocation()[0]);
+            p_cell->GetCellData()->SetItem("initial y", node_iter->rGetLocation()[1]);
+            rCells.push_back(p_cell);
+            rLocationIndices.push_back(node_iter->GetIndex());
+        }
+    }
+
+    /**
+     * Run a trophectoderm sheet for one time unit and return, for every cell on every process, its
+     * starting location, final location and final polarity angle, five entries per cell.
+     */
+    std::vector<double> SolveTrophectodermSheet(const std::string& rOutputDirectory)
+    {
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+
+        HoneycombMeshGenerator generator(6, 8, 0);
+        MutableMesh<2,2>* p_generating_mesh = generator.GetMesh();
+
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(*p_generating_mesh, 2.5);
+
+        std::vector<CellPtr> cells;
+        std::vector<unsigned> location_indices;
+        GenerateTrophectodermCells(mesh, cells, location_indices);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells, location_indices);
+
+        OffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory(rOutputDirectory);
+        simulator.SetDt(1.0/200.0);
+        simulator.SetSamplingTimestepMultiple(200);
+        simulator.SetEndTime(1.0);
+
+        MAKE_PTR(CellPolarityTrackingModifier<2>, p_modifier);
+        simulator.AddSimulationModifier(p_modifier);
+
+        MAKE_PTR(NissenForceTrophectoderm<2>, p_force);
+        p_force->SetCutOffLength(2.5);
+        simulator.AddForce(p_force);
+
+        simulator.Solve();
+
+        std::vector<double> local_records;
+        for (AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            c_vector<double, 2> location = cell_population.GetLocationOfCellCentre(*cell_iter);
+            local_records.push_back(cell_iter->GetCellData()->GetItem("initial x"));
+            local_records.push_back(cell_iter->GetCellData()->GetItem("initial y"));
+            local_records.push_back(location[0]);
+            local_records.push_back(location[1]);
+            local_records.push_back(static_cast<CellPolaritySrnModel*>(cell_iter->GetSrnModel())->GetPolarityAngle());
+        }
+
+        // Cells move between processes, so gather them all rather than relying on their indices
+        std::vector<double> records = local_records;
+        if (PetscTools::IsParallel() && !PetscTools::IsIsolated())
+        {
+            int local_size = local_records.size();
+            std::vector<int> sizes(PetscTools::GetNumProcs());
+            MPI_Allgather(&local_size, 1, MPI_INT, &sizes[0], 1, MPI_INT, PETSC_COMM_WORLD);
+
+            std::vector<int> offsets(sizes.size(), 0);
+            for (unsigned p=1; p<sizes.size(); p++)
+            {
+                offsets[p] = offsets[p-1] + sizes[p-1];
+            }
+            records.resize(offsets.back() + sizes.back());
+            MPI_Allgatherv(local_records.data(), local_size, MPI_DOUBLE,
+                           records.data(), &sizes[0], &offsets[0], MPI_DOUBLE, PETSC_COMM_WORLD);
+        }
+
+        NissenPairGeometryCache<2>::Destroy();
+        NissenHaloStateMirror<2>::Destroy();
+        CellPopulationStateTracker<2>::Destroy();
+        return records;
+    }
+
+public:
+
+    void TestHaloNodesMirrorTheirOwnersPolarity() throw (Exception)
+    {
+        HoneycombMeshGenerator generator(6, 8, 0);
+        MutableMesh<2,2>* p_generating_mesh = generator.GetMesh();
+
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(*p_generating_mesh, 2.5);
+
+        std::vector<CellPtr> cells;
+        std::vector<unsigned> location_indices;
+        GenerateTrophectodermCells(mesh, cells, location_indices);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells, location_indices);
+        cell_population.Update();
+
+        NissenHaloStateMirror<2>* p_mirror = NissenHaloStateMirror<2>::Instance();
+        unsigned num_exchanges = p_mirror->GetNumExchanges();
+        p_mirror->Refresh(cell_population);
+
+        std::vector<unsigned> halo_indices = p_mirror->GetHaloNodeIndices(NissenHaloStateMirror<2>::TROPHECTODERM_TYPE);
+        if (PetscTools::IsSequential())
+        {
+            TS_ASSERT_EQUALS(p_mirror->GetNumExchanges(), num_exchanges);
+            TS_ASSERT(halo_indices.empty());
+        }
+        else
+        {
+            TS_ASSERT_EQUALS(p_mirror->GetNumExchanges(), num_exchanges + 1);
+        }
+
+        // Every halo node carries the angle its owner set from the node's location
+        for (unsigned h=0; h<halo_indices.size(); h++)
+        {
+            const c_vector<double, 2>& r_location = cell_population.GetNode(halo_indices[h])->rGetLocation();
+            const NissenHaloStateMirror<2>::HaloNodeState& r_state = p_mirror->rGetHaloNodeState(halo_indices[h]);
+            TS_ASSERT_DELTA(r_state.mPolarityAngle, AngleAtLocation(r_location), 1e-12);
+            TS_ASSERT_DELTA(r_state.mPolarity[0], cos(AngleAtLocation(r_location)), 1e-12);
+            TS_ASSERT_DELTA(r_state.mPolarity[1], sin(AngleAtLocation(r_location)), 1e-12);
+        }
+
+        // Owned nodes are never halo nodes, and each pair has at least one owned node
+        for (AbstractMesh<2,2>::NodeIterator node_iter = mesh.GetNodeIteratorBegin();
+             node_iter != mesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            TS_ASSERT(!p_mirror->IsHaloNode(node_iter->GetIndex()));
+        }
+        const std::vector<NissenPairGeometryCache<2>::PairGeometry>& r_pairs = NissenPairGeometryCache<2>::Instance()->rGetPairs(cell_population);
+        for (unsigned i=0; i<r_pairs.size(); i++)
+        {
+            TS_ASSERT(!(p_mirror->IsHaloNode(r_pairs[i].mNodeAIndex) && p_mirror->IsHaloNode(r_pairs[i].mNodeBIndex)));
+        }
+
+        NissenPairGeometryCache<2>::Destroy();
+        NissenHaloStateMirror<2>::Destroy();
+    }
+
+    void TestTrophectodermSheetRunsDistributed() throw (Exception)
+    {
+        std::vector<double> records = SolveTrophectodermSheet("NissenHaloExchange");
+
+        // No cell is lost as cells move between processes
+        TS_ASSERT_EQUALS(records.size(), 5u*48u);
+        for (unsigned i=0; i<records.size(); i+=5)
+        {
+            TS_ASSERT(!std::isnan(records[i+4]));
+        }
+    }
+
+    void TestDistributedSheetMatchesSerialRun() throw (Exception)
+    {
+        std::vector<double> records = SolveTrophectodermSheet("NissenHaloExchange/Distributed");
+
+        // Each process then runs the whole sheet on its own, in its own output directory
+        PetscTools::IsolateProcesses(true);
+        std::stringstream serial_directory;
+        serial_directory << "NissenHaloExchange/Serial" << PetscTools::GetMyRank();
+        std::vector<double> serial_records = SolveTrophectodermSheet(serial_directory.str());
+        PetscTools::IsolateProcesses(false);
+
+        TS_ASSERT_EQUALS(serial_records.size(), 5u*48u);
+        TS_ASSERT_EQUALS(records.size(), serial_records.size());
+
+        /*
+         * Match the cells by where they started. The forces and couplings are summed in a different
+         * order, and the polarity noise is keyed by cell ID, which depends on how the cells were shared
+         * out, so the runs agree closely rather than exactly.
+         */
+        for (unsigned i=0; i<serial_records.size(); i+=5)
+        {
+            bool is_found = false;
+            for (unsigned j=0; j<records.size(); j+=5)
+            {
+                if (fabs(records[j] - serial_records[i]) < 1e-9 && fabs(records[j+1] - serial_records[i+1]) < 1e-9)
+                {
+                    is_found = true;
+                    TS_ASSERT_DELTA(records[j+2], serial_records[i+2], 1e-3);
+                    TS_ASSERT_DELTA(records[j+3], serial_records[i+3], 1e-3);
+                    TS_ASSERT_DELTA(records[j+4], serial_records[i+4], 1e-3);
+                }
+            }
+            TS_ASSERT(is_found);
+        }
+    }
+};
+
+#endif /*TESTNISSENHALOEXCHANGE_HPP_*/
@@ -0,0 +1,513 @@
+#ifndef TESTNISSENNUMERICALMETHODS_HPP_
+#define TESTNISSENNUMERICALMETHODS_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <set>
+
+#include "TrophectodermCellProliferativeType.hpp"
+
+#include "HoneycombMeshGenerator.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+
+#include "NissenOffLatticeSimulation.hpp"
+#include "NissenAdaptiveNumericalMethod.hpp"
+#include "NissenMultipleTimeStepNumericalMethod.hpp"
+#include "NissenSemiImplicitNumericalMethod.hpp"
+#include "NissenHealthMonitoredNumericalMethod.hpp"
+#include "NissenLocalTimeSteppingNumericalMethod.hpp"
+#include "CellPolaritySrnModel.hpp"
+#include "CellPolarityTrackingModifier.hpp"
+#include "NissenForce.hpp"
+#include "NissenPairGeometryCache.hpp"
+#include "CellPopulationStateTracker.hpp"
+#include "SimulationTime.hpp"
+
+#include "BlastocystTestCellsGenerator.hpp"
+#include "SmartPointers.hpp"
+
+/**
+ * Tests of the Dhall numerical methods, which compare each with forward Euler at a small fixed time step.
+ */
+class TestNissenNumericalMethods : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Relax a line of seven trophectoderm cells, squashed to 0.7 of their spacing, and return the final node locations.
+     */
+    std::vector<c_vector<double, 2> > RelaxSquashedLine(boost::shared_ptr<AbstractNumericalMethod<2,2> > pNumericalMethod,
+                                                         double dt,
+                                                         const std::string& rOutputDirectory)
+    {
+        // Each run starts afresh at time zero
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+
+        HoneycombMeshGenerator generator(1, 7, 0);
+        MutableMesh<2,2>* p_generating_mesh = generator.GetMesh();
+        p_generating_mesh->Scale(0.7, 0.7);
+
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(*p_generating_mesh, 2.5);
+
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TrophectodermCellProliferativeType>(mesh.GetNumNodes(), cells, true);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+
+        NissenOffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory(rOutputDirectory);
+        simulator.SetDt(dt);
+        simulator.SetSamplingTimestepMultiple(std::max(1u, static_cast<unsigned>(0.2/dt + 0.5)));
+        simulator.SetEndTime(10.0);
+        if (pNumericalMethod)
+        {
+            simulator.SetNumericalMethod(pNumericalMethod);
+        }
+
+        MAKE_PTR(CellPolarityTrackingModifier<2>, p_modifier);
+        simulator.AddSimulationModifier(p_modifier);
+
+        MAKE_PTR(NissenForce<2>, p_force);
+        p_force->SetCutOffLength(2.5);
+        simulator.AddForce(p_force);
+
+        simulator.Solve();
+
+        std::vector<c_vector<double, 2> > locations;
+        for (unsigned i=0; i<mesh.GetNumNodes(); i++)
+        {
+            locations.push_back(mesh.GetNode(i)->rGetLocation());
+        }
+
+        NissenPairGeometryCache<2>::Destroy();
+        CellPopulationStateTracker<2>::Destroy();
+        return locations;
+    }
+
+public:
+
+    void TestAdaptiveMethodMatchesSmallFixedStep() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // The nodes are compared by index
+
+        std::vector<c_vector<double, 2> > reference_locations =
+            RelaxSquashedLine(boost::shared_ptr<AbstractNumericalMethod<2,2> >(), 1.0/2000.0, "NissenNumericalMethods/ForwardEuler");
+
+        // A time step ten times longer than the fixed one, divided into substeps only where the forces require it
+        boost::shared_ptr<NissenAdaptiveNumericalMethod<2,2> > p_method(new NissenAdaptiveNumericalMethod<2,2>());
+        p_method->SetDisplacementTolerance(0.02);
+        p_method->SetForceTolerance(0.5);
+        std::vector<c_vector<double, 2> > locations = RelaxSquashedLine(p_method, 1.0/200.0, "NissenNumericalMethods/Adaptive");
+
+        TS_ASSERT_EQUALS(locations.size(), reference_locations.size());
+        for (unsigned i=0; i<locations.size(); i++)
+        {
+            TS_ASSERT_LESS_THAN(norm_2(locations[i] - reference_locations[i]), 0.02);
+        }
+
+        // By the end the line has relaxed, so each time step is taken in a single substep
+        TS_ASSERT_EQUALS(p_method->GetNumSubstepsInLastStep(), 1u);
+        TS_ASSERT_EQUALS(p_method->GetNumRejectedSubstepsInLastStep(), 0u);
+        TS_ASSERT_DELTA(p_method->GetLargestSubstepInLastStep(), 1.0/200.0, 1e-12);
+    }
+
+    void TestAdaptiveMethodUpdatesNodePairsDuringLongStep() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // The node pairs are checked by index
+
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(10.0, 1);
+
+        // A squashed line of seven cells, and an eighth cell just beyond the mesh's interaction distance of its end
+        std::vector<Node<2>*> nodes;
+        for (unsigned i=0; i<7; i++)
+        {
+            nodes.push_back(new Node<2>(i, false, 0.7*i, 0.0));
+        }
+        nodes.push_back(new Node<2>(7, false, 4.2 + 3.0, 0.0));
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 2.75);
+
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TrophectodermCellProliferativeType>(mesh.GetNumNodes(), cells, true);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+        cell_population.Update();
+        CellPopulationStateTracker<2>* p_tracker = CellPopulationStateTracker<2>::Instance();
+        p_tracker->RecordUpdate(cell_population);
+
+        std::vector<boost::shared_ptr<AbstractForce<2,2> > > forces;
+        MAKE_PTR(NissenForce<2>, p_force);
+        p_force->SetCutOffLength(2.5);
+        forces.push_back(p_force);
+
+        // One time step long enough for the line to relax, so its end node moves well beyond the skin of 0.25
+        NissenAdaptiveNumericalMethod<2,2> method;
+        method.SetCellPopulation(&cell_population);
+        method.SetForceCollection(&forces);
+        method.UpdateAllNodePositions(10.0);
+
+        TS_ASSERT_LESS_THAN(0u, p_tracker->GetNumUpdatesPerformed());
+        TS_ASSERT_LESS_THAN(norm_2(mesh.GetNode(7)->rGetLocation() - mesh.GetNode(6)->rGetLocation()), 2.5);
+
+        // The node pairs cover every pair within the cutoff, including those that came into range during the step
+        std::set<std::pair<unsigned, unsigned> > node_pairs;
+        std::vector<std::pair<Node<2>*, Node<2>*> >& r_node_pairs = cell_population.rGetNodePairs();
+        for (unsigned k=0; k<r_node_pairs.size(); k++)
+        {
+            unsigned index_a = r_node_pairs[k].first->GetIndex();
+            unsigned index_b = r_node_pairs[k].second->GetIndex();
+            node_pairs.insert(std::make_pair(std::min(index_a, index_b), std::max(index_a, index_b)));
+        }
+        for (unsigned i=0; i<mesh.GetNumNodes(); i++)
+        {
+            for (unsigned j=i+1; j<mesh.GetNumNodes(); j++)
+            {
+                if (norm_2(mesh.GetNode(j)->rGetLocation() - mesh.GetNode(i)->rGetLocation()) < 2.5)
+                {
+                    TS_ASSERT(node_pairs.find(std::make_pair(i, j)) != node_pairs.end());
+                }
+            }
+        }
+
+        NissenPairGeometryCache<2>::Destroy();
+        CellPopulationStateTracker<2>::Destroy();
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+    }
+
+    void TestForceComponentsSumToWholeForce() throw (Exception)
+    {
+        std::vector<Node<2>*> nodes;
+        nodes.push_back(new Node<2>(0, false, 0.0, 0.0));
+        nodes.push_back(new Node<2>(1, false, 1.0, 0.0));
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 2.5);
+
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TrophectodermCellProliferativeType>(mesh.GetNumNodes(), cells, true);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+
+        NissenForce<2> force;
+        force.SetCutOffLength(2.5);
+        TS_ASSERT_DELTA(force.GetFastInteractionRange(), 1.5, 1e-12);
+
+        // Either side of the switch, which runs from 2.4 to 3 cell radii (1.2 to 1.5 cell diameters)
+        double distances[5] = {0.4, 1.0, 1.3, 1.45, 2.0};
+        for (unsigned i=0; i<5; i++)
+        {
+            c_vector<double, 2> vector_from_A_to_B = zero_vector<double>(2);
+            vector_from_A_to_B[0] = distances[i];
+
+            c_vector<double, 2> whole = force.CalculateForceFromPairGeometry(0, 1, vector_from_A_to_B, distances[i], cell_population);
+            force.SetForceComponent(NissenForce<2>::FAST_COMPONENT);
+            c_vector<double, 2> fast = force.CalculateForceFromPairGeometry(0, 1, vector_from_A_to_B, distances[i], cell_population);
+            force.SetForceComponent(NissenForce<2>::SLOW_COMPONENT);
+            c_vector<double, 2> slow = force.CalculateForceFromPairGeometry(0, 1, vector_from_A_to_B, distances[i], cell_population);
+            force.SetForceComponent(NissenForce<2>::ALL_COMPONENTS);
+
+            TS_ASSERT_DELTA(fast[0] + slow[0], whole[0], 1e-12);
+            TS_ASSERT_DELTA(fast[1] + slow[1], whole[1], 1e-12);
+            if (distances[i] < 1.2)
+            {
+                // The fast part is the whole of the repulsion, which pushes A away from B
+                TS_ASSERT_LESS_THAN(fast[0], 0.0);
+            }
+            if (distances[i] >= 1.5)
+            {
+                TS_ASSERT_DELTA(norm_2(fast), 0.0, 1e-12);
+            }
+        }
+
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+    }
+
+    void TestMultipleTimeStepMethodMatchesSmallFixedStep() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // The nodes are compared by index
+
+        std::vector<c_vector<double, 2> > reference_locations =
+            RelaxSquashedLine(boost::shared_ptr<AbstractNumericalMethod<2,2> >(), 1.0/2000.0, "NissenNumericalMethods/ForwardEuler");
+
+        // The attraction and polarity are evaluated at an outer step four times longer than the fixed one
+        boost::shared_ptr<NissenMultipleTimeStepNumericalMethod<2,2> > p_method(new NissenMultipleTimeStepNumericalMethod<2,2>());
+        p_method->SetNumInnerSteps(4);
+        std::vector<c_vector<double, 2> > locations = RelaxSquashedLine(p_method, 4.0/2000.0, "NissenNumericalMethods/MultipleTimeStep");
+
+        TS_ASSERT_EQUALS(locations.size(), reference_locations.size());
+        for (unsigned i=0; i<locations.size(); i++)
+        {
+            TS_ASSERT_LESS_THAN(norm_2(locations[i] - reference_locations[i]), 0.02);
+        }
+    }
+
+    void TestMultipleTimeStepMethodTakesStepsTooLongForForwardEuler() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // The nodes are compared by index
+
+        std::vector<c_vector<double, 2> > reference_locations =
+            RelaxSquashedLine(boost::shared_ptr<AbstractNumericalMethod<2,2> >(), 1.0/2000.0, "NissenNumericalMethods/ForwardEuler");
+
+        // At this step forward Euler moves the end cells by more than the movement threshold at once
+        TS_ASSERT_THROWS_CONTAINS(RelaxSquashedLine(boost::shared_ptr<AbstractNumericalMethod<2,2> >(), 2.0, "NissenNumericalMethods/ForwardEulerLongStep"),
+                                  "moving by");
+        NissenPairGeometryCache<2>::Destroy();
+        CellPopulationStateTracker<2>::Destroy();
+
+        // The outer step is a thousand times the fixed one; the fast repulsion is resolved by the inner steps
+        boost::shared_ptr<NissenMultipleTimeStepNumericalMethod<2,2> > p_method(new NissenMultipleTimeStepNumericalMethod<2,2>());
+        p_method->SetNumInnerSteps(8);
+        std::vector<c_vector<double, 2> > locations = RelaxSquashedLine(p_method, 2.0, "NissenNumericalMethods/MultipleTimeStepLongStep");
+
+        TS_ASSERT_EQUALS(locations.size(), reference_locations.size());
+        for (unsigned i=0; i<locations.size(); i++)
+        {
+            TS_ASSERT_LESS_THAN(norm_2(locations[i] - reference_locations[i]), 0.15);
+        }
+    }
+
+    void TestSemiImplicitMethodMatchesSmallFixedStep() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // The nodes are compared by index
+
+        std::vector<c_vector<double, 2> > reference_locations =
+            RelaxSquashedLine(boost::shared_ptr<AbstractNumericalMethod<2,2> >(), 1.0/2000.0, "NissenNumericalMethods/ForwardEuler");
+
+        // The repulsion is taken implicitly at a time step four times longer than the fixed one
+        boost::shared_ptr<NissenSemiImplicitNumericalMethod<2,2> > p_method(new NissenSemiImplicitNumericalMethod<2,2>());
+        TS_ASSERT_EQUALS(p_method->GetMaxIterations(), 20u);
+        TS_ASSERT_DELTA(p_method->GetRelativeTolerance(), 1e-6, 1e-12);
+        std::vector<c_vector<double, 2> > locations = RelaxSquashedLine(p_method, 4.0/2000.0, "NissenNumericalMethods/SemiImplicit");
+
+        TS_ASSERT_EQUALS(locations.size(), reference_locations.size());
+        for (unsigned i=0; i<locations.size(); i++)
+        {
+            TS_ASSERT_LESS_THAN(norm_2(locations[i] - reference_locations[i]), 0.02);
+        }
+        TS_ASSERT_LESS_THAN_EQUALS(p_method->GetNumIterationsInLastStep(), 20u);
+    }
+
+    void TestSemiImplicitMethodTakesStepsTooLongForForwardEuler() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // The nodes are compared by index
+
+        std::vector<c_vector<double, 2> > reference_locations =
+            RelaxSquashedLine(boost::shared_ptr<AbstractNumericalMethod<2,2> >(), 1.0/2000.0, "NissenNumericalMethods/ForwardEuler");
+
+        // Forward Euler is unstable above a step of about 1.3 here, and at this step it trips the movement threshold
+        TS_ASSERT_THROWS_CONTAINS(RelaxSquashedLine(boost::shared_ptr<AbstractNumericalMethod<2,2> >(), 2.0, "NissenNumericalMethods/ForwardEulerLongStep"),
+                                  "moving by");
+        NissenPairGeometryCache<2>::Destroy();
+        CellPopulationStateTracker<2>::Destroy();
+
+        boost::shared_ptr<NissenSemiImplicitNumericalMethod<2,2> > p_method(new NissenSemiImplicitNumericalMethod<2,2>());
+        std::vector<c_vector<double, 2> > locations = RelaxSquashedLine(p_method, 2.0, "NissenNumericalMethods/SemiImplicitLongStep");
+
+        TS_ASSERT_EQUALS(locations.size(), reference_locations.size());
+        for (unsigned i=0; i<locations.size(); i++)
+        {
+            TS_ASSERT_LESS_THAN(norm_2(locations[i] - reference_locations[i]), 0.15);
+        }
+        TS_ASSERT_LESS_THAN_EQUALS(p_method->GetNumIterationsInLastStep(), 20u);
+    }
+
+    void TestHealthMonitoredMethodRecoversFromLongStep() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // The nodes are compared by index
+
+        std::vector<c_vector<double, 2> > reference_locations =
+            RelaxSquashedLine(boost::shared_ptr<AbstractNumericalMethod<2,2> >(), 1.0/2000.0, "NissenNumericalMethods/ForwardEuler");
+
+        // At first the squashed cells would move too far in one time step, so the step is rolled back and halved
+        boost::shared_ptr<NissenHealthMonitoredNumericalMethod<2,2> > p_method(new NissenHealthMonitoredNumericalMethod<2,2>());
+        p_method->SetMaxDisplacement(0.01);
+        p_method->SetRecoveryWindow(20);
+        std::vector<c_vector<double, 2> > locations = RelaxSquashedLine(p_method, 0.1, "NissenNumericalMethods/HealthMonitored");
+
+        TS_ASSERT_LESS_THAN(0u, p_method->GetTotalNumEvents());
+        TS_ASSERT_EQUALS(locations.size(), reference_locations.size());
+        for (unsigned i=0; i<locations.size(); i++)
+        {
+            TS_ASSERT_LESS_THAN(norm_2(locations[i] - reference_locations[i]), 0.05);
+        }
+
+        // By the end the line has relaxed, so the full time step is taken again
+        TS_ASSERT_EQUALS(p_method->GetNumSubstepsInLastStep(), 1u);
+        TS_ASSERT(p_method->rGetEventsInLastStep().empty());
+
+        OutputFileHandler handler("NissenNumericalMethods/HealthMonitored", false);
+        TS_ASSERT(handler.FindFile("results_from_time_0/healthmonitor.dat").Exists());
+    }
+
+    void TestHealthMonitoredMethodRestoresInvalidPolarity() throw (Exception)
+    {
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 10);
+
+        // Two cells out of range of each other, with no forces, so only the polarities are checked
+        std::vector<Node<2>*> nodes;
+        nodes.push_back(new Node<2>(0, false, 0.0, 0.0));
+        nodes.push_back(new Node<2>(1, false, 5.0, 0.0));
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 1.5);
+
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TrophectodermCellProliferativeType>(mesh.GetNumNodes(), cells, true);
+        for (unsigned i=0; i<cells.size(); i++)
+        {
+            cells[i]->InitialiseSrnModel();
+        }
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+        CellPolaritySrnModel* p_srn_model_0 = static_cast<CellPolaritySrnModel*>(cells[0]->GetSrnModel());
+        CellPolaritySrnModel* p_srn_model_1 = static_cast<CellPolaritySrnModel*>(cells[1]->GetSrnModel());
+
+        std::vector<boost::shared_ptr<AbstractForce<2,2> > > forces;
+        NissenHealthMonitoredNumericalMethod<2,2> method;
+        method.SetCellPopulation(&cell_population);
+        method.SetForceCollection(&forces);
+        method.SetSnapshotInterval(1);
+
+        // With no snapshot yet, as for a cell born since the last one, a polarity that is not finite is reset
+        p_srn_model_0->SetPolarityAngle(std::numeric_limits<double>::quiet_NaN());
+        p_srn_model_1->SetPolarityAngle(1.2);
+        method.UpdateAllNodePositions(0.1);
+        TS_ASSERT_EQUALS(method.rGetEventsInLastStep().size(), 1u);
+        TS_ASSERT_EQUALS(method.rGetEventsInLastStep()[0].mFailedCheck, NissenHealthMonitoredNumericalMethod<2,2>::INVALID_POLARITY);
+        TS_ASSERT_DELTA(p_srn_model_0->GetPolarityAngle(), 0.5*M_PI, 1e-12);
+        TS_ASSERT_DELTA(p_srn_model_1->GetPolarityAngle(), 1.2, 1e-12);
+
+        // Every polarity now passes, so a snapshot is taken
+        method.UpdateAllNodePositions(0.1);
+        TS_ASSERT(method.rGetEventsInLastStep().empty());
+
+        // A polarity that goes bad is restored from the snapshot
+        p_srn_model_1->SetPolarityAngle(std::numeric_limits<double>::quiet_NaN());
+        method.UpdateAllNodePositions(0.1);
+        TS_ASSERT_EQUALS(method.rGetEventsInLastStep().size(), 1u);
+        TS_ASSERT_DELTA(p_srn_model_0->GetPolarityAngle(), 0.5*M_PI, 1e-12);
+        TS_ASSERT_DELTA(p_srn_model_1->GetPolarityAngle(), 1.2, 1e-12);
+        TS_ASSERT_EQUALS(method.GetTotalNumEvents(), 2u);
+
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+    }
+
+    void TestLocalTimeSteppingMethodMatchesSmallFixedStep() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // The nodes are compared by index
+
+        std::vector<c_vector<double, 2> > reference_locations =
+            RelaxSquashedLine(boost::shared_ptr<AbstractNumericalMethod<2,2> >(), 1.0/2000.0, "NissenNumericalMethods/ForwardEuler");
+
+        // Each node takes substeps of a time step four times longer than the fixed one, as its own forces require
+        boost::shared_ptr<NissenLocalTimeSteppingNumericalMethod<2,2> > p_method(new NissenLocalTimeSteppingNumericalMethod<2,2>());
+        p_method->SetMaxPolarityUpdateInterval(4);
+        std::vector<c_vector<double, 2> > locations = RelaxSquashedLine(p_method, 4.0/2000.0, "NissenNumericalMethods/LocalTimeStepping");
+
+        TS_ASSERT_EQUALS(locations.size(), reference_locations.size());
+        for (unsigned i=0; i<locations.size(); i++)
+        {
+            TS_ASSERT_LESS_THAN(norm_2(locations[i] - reference_locations[i]), 0.02);
+        }
+
+        // Every node is moved at least once per time step, and the levels account for all of them
+        TS_ASSERT_LESS_THAN_EQUALS(locations.size(), p_method->GetNumNodeUpdatesInLastStep());
+        const std::vector<unsigned>& r_num_nodes_at_level = p_method->rGetNumNodesAtLevelInLastStep();
+        TS_ASSERT_EQUALS(r_num_nodes_at_level.size(), p_method->GetMaxLevel() + 1);
+        unsigned num_nodes = 0;
+        for (unsigned level=0; level<r_num_nodes_at_level.size(); level++)
+        {
+            num_nodes += r_num_nodes_at_level[level];
+        }
+        TS_ASSERT_EQUALS(num_nodes, locations.size());
+    }
+
+    void TestLocalTimeSteppingMethodTakesStepsTooLongForForwardEuler() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // The nodes are compared by index
+
+        std::vector<c_vector<double, 2> > reference_locations =
+            RelaxSquashedLine(boost::shared_ptr<AbstractNumericalMethod<2,2> >(), 1.0/2000.0, "NissenNumericalMethods/ForwardEuler");
+
+        // At this step forward Euler moves the end cells by more than the movement threshold at once
+        TS_ASSERT_THROWS_CONTAINS(RelaxSquashedLine(boost::shared_ptr<AbstractNumericalMethod<2,2> >(), 2.0, "NissenNumericalMethods/ForwardEulerLongStep"),
+                                  "moving by");
+        NissenPairGeometryCache<2>::Destroy();
+        CellPopulationStateTracker<2>::Destroy();
+
+        // The squashed cells fall to the levels their stiffness and speed require
+        boost::shared_ptr<NissenLocalTimeSteppingNumericalMethod<2,2> > p_method(new NissenLocalTimeSteppingNumericalMethod<2,2>());
+        std::vector<c_vector<double, 2> > locations = RelaxSquashedLine(p_method, 2.0, "NissenNumericalMethods/LocalTimeSteppingLongStep");
+
+        TS_ASSERT_EQUALS(locations.size(), reference_locations.size());
+        for (unsigned i=0; i<locations.size(); i++)
+        {
+            TS_ASSERT_LESS_THAN(norm_2(locations[i] - reference_locations[i]), 0.05);
+        }
+        TS_ASSERT_LESS_THAN_EQUALS(locations.size(), p_method->GetNumNodeUpdatesInLastStep());
+    }
+
+    void TestLocalTimeSteppingIntervalsArePassedThroughTheModifier() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // The nodes are compared by index
+
+        HoneycombMeshGenerator generator(3, 3, 0);
+        MutableMesh<2,2>* p_generating_mesh = generator.GetMesh();
+
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(*p_generating_mesh, 2.5);
+
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TrophectodermCellProliferativeType>(mesh.GetNumNodes(), cells, true);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+
+        NissenOffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("NissenNumericalMethods/LocalTimeSteppingPolarity");
+        simulator.SetDt(1.0/200.0);
+        simulator.SetSamplingTimestepMultiple(20);
+        simulator.SetEndTime(0.5);
+
+        boost::shared_ptr<NissenLocalTimeSteppingNumericalMethod<2,2> > p_method(new NissenLocalTimeSteppingNumericalMethod<2,2>());
+        p_method->SetMaxPolarityUpdateInterval(4);
+        simulator.SetNumericalMethod(p_method);
+
+        MAKE_PTR(CellPolarityTrackingModifier<2>, p_modifier);
+        simulator.AddSimulationModifier(p_modifier);
+
+        MAKE_PTR(NissenForce<2>, p_force);
+        p_force->SetCutOffLength(2.5);
+        simulator.AddForce(p_force);
+
+        simulator.Solve();
+
+        // The modifier recomputes the drive every time step, but each SRN model takes the interval of its node
+        TS_ASSERT_EQUALS(p_modifier->GetPolarityUpdateInterval(), 1u);
+        unsigned max_interval = 0;
+        for (unsigned i=0; i<mesh.GetNumNodes(); i++)
+        {
+            unsigned interval = static_cast<CellPolaritySrnModel*>(cell_population.GetCellUsingLocationIndex(i)->GetSrnModel())->GetUpdateInterval();
+            TS_ASSERT_EQUALS(interval, p_method->GetPolarityUpdateInterval(i));
+            max_interval = std::max(max_interval, interval);
+        }
+        TS_ASSERT_LESS_THAN(1u, max_interval);
+
+        // The polarity CellData is refreshed on the sampling time steps, just before the results are written
+        TS_ASSERT_EQUALS(p_modifier->GetSamplingTimestepMultiple(), 20u);
+
+        NissenPairGeometryCache<2>::Destroy();
+        CellPopulationStateTracker<2>::Destroy();
+    }
+};
+
+#endif /*TESTNISSENNUMERICALMETHODS_HPP_*/
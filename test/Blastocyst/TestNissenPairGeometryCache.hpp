@@ -0,0 +1,207 @@
+#ifndef TESTNISSENPAIRGEOMETRYCACHE_HPP_
+#define TESTNISSENPAIRGEOMETRYCACHE_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "TrophectodermCellProliferativeType.hpp"
+
+#include "HoneycombMeshGenerator.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+
+#include "NissenForce.hpp"
+#include "NissenPairGeometryCache.hpp"
+#include "NissenHaloStateMirror.hpp"
+
+#include "BlastocystTestCellsGenerator.hpp"
+#include "SmartPointers.hpp"
+
+/**
+ * Tests of NissenPairGeometryCache, which shares the geometry of each node pair between the Dhall forces and modifiers.
+ */
+class TestNissenPairGeometryCache : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestPairsMatchTheNodePairs() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // The pairs are compared with those of the whole mesh
+
+        HoneycombMeshGenerator generator(4, 4, 0);
+        MutableMesh<2,2>* p_generating_mesh = generator.GetMesh();
+
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(*p_generating_mesh, 1.5);
+
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TrophectodermCellProliferativeType>(mesh.GetNumNodes(), cells, false);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+        cell_population.Update();
+
+        // Each cached pair has the orientation, vector and distance of a node pair of the population
+        NissenPairGeometryCache<2>* p_cache = NissenPairGeometryCache<2>::Instance();
+        const std::vector<NissenPairGeometryCache<2>::PairGeometry>& r_pairs = p_cache->rGetPairs(cell_population);
+        std::vector<std::pair<Node<2>*, Node<2>*> >& r_node_pairs = cell_population.rGetNodePairs();
+        TS_ASSERT_EQUALS(r_pairs.size(), r_node_pairs.size());
+        TS_ASSERT_LESS_THAN(0u, r_pairs.size());
+        for (unsigned i=0; i<r_pairs.size(); i++)
+        {
+            c_vector<double, 2> vector_from_a_to_b = mesh.GetNode(r_pairs[i].mNodeBIndex)->rGetLocation()
+                                                     - mesh.GetNode(r_pairs[i].mNodeAIndex)->rGetLocation();
+            TS_ASSERT_DELTA(r_pairs[i].mVectorFromAtoB[0], vector_from_a_to_b[0], 1e-12);
+            TS_ASSERT_DELTA(r_pairs[i].mVectorFromAtoB[1], vector_from_a_to_b[1], 1e-12);
+            TS_ASSERT_DELTA(r_pairs[i].mDistance, norm_2(vector_from_a_to_b), 1e-12);
+
+            bool is_found = false;
+            for (unsigned j=0; j<r_node_pairs.size(); j++)
+            {
+                if (r_node_pairs[j].first->GetIndex() == r_pairs[i].mNodeAIndex
+                    && r_node_pairs[j].second->GetIndex() == r_pairs[i].mNodeBIndex)
+                {
+                    is_found = true;
+                }
+            }
+            TS_ASSERT(is_found);
+        }
+        TS_ASSERT_EQUALS(p_cache->GetNumRebuilds(), 1u);
+        TS_ASSERT_EQUALS(p_cache->GetNumQueries(), 1u);
+
+        // Nothing has changed, so a second caller gets the same geometry without a rebuild
+        p_cache->rGetPairs(cell_population);
+        TS_ASSERT_EQUALS(p_cache->GetNumRebuilds(), 1u);
+        TS_ASSERT_EQUALS(p_cache->GetNumQueries(), 2u);
+
+        // Moving a node, or invalidating the cache, forces a rebuild
+        c_vector<double, 2> new_location = mesh.GetNode(5)->rGetLocation();
+        new_location[0] += 0.01;
+        mesh.GetNode(5)->rGetModifiableLocation() = new_location;
+        p_cache->rGetPairs(cell_population);
+        TS_ASSERT_EQUALS(p_cache->GetNumRebuilds(), 2u);
+        p_cache->Invalidate();
+        p_cache->rGetPairs(cell_population);
+        TS_ASSERT_EQUALS(p_cache->GetNumRebuilds(), 3u);
+
+        // The force built on the cache applies the same forces as evaluating each pair directly
+        MAKE_PTR(NissenForce<2>, p_force);
+        p_force->SetCutOffLength(2.5);
+        for (unsigned i=0; i<mesh.GetNumNodes(); i++)
+        {
+            mesh.GetNode(i)->ClearAppliedForce();
+        }
+        p_force->AddForceContribution(cell_population);
+
+        std::vector<c_vector<double, 2> > expected_forces(mesh.GetNumNodes(), zero_vector<double>(2));
+        for (unsigned j=0; j<r_node_pairs.size(); j++)
+        {
+            unsigned index_a = r_node_pairs[j].first->GetIndex();
+            unsigned index_b = r_node_pairs[j].second->GetIndex();
+            c_vector<double, 2> force = p_force->CalculateForceBetweenNodes(index_a, index_b, cell_population);
+            expected_forces[index_a] += force;
+            expected_forces[index_b] -= force;
+        }
+        for (unsigned i=0; i<mesh.GetNumNodes(); i++)
+        {
+            TS_ASSERT_DELTA(mesh.GetNode(i)->rGetAppliedForce()[0], expected_forces[i][0], 1e-12);
+            TS_ASSERT_DELTA(mesh.GetNode(i)->rGetAppliedForce()[1], expected_forces[i][1], 1e-12);
+        }
+
+        NissenPairGeometryCache<2>::Destroy();
+        NissenHaloStateMirror<2>::Destroy();
+    }
+
+    void TestNodeOrderingImprovesLocality() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // The ordering is compared with that of the whole mesh
+
+        // An 8 by 8 grid of nodes whose indices are scattered across it, as after many divisions
+        std::vector<Node<2>*> nodes;
+        for (unsigned k=0; k<64; k++)
+        {
+            unsigned grid_point = (37*k)%64;
+            nodes.push_back(new Node<2>(k, false, grid_point%8, grid_point/8));
+        }
+
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 1.5);
+
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TrophectodermCellProliferativeType>(mesh.GetNumNodes(), cells, false);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+        cell_population.Update();
+
+        std::vector<std::pair<Node<2>*, Node<2>*> >& r_node_pairs = cell_population.rGetNodePairs();
+        double index_metric = 0.0;
+        for (unsigned i=0; i<r_node_pairs.size(); i++)
+        {
+            index_metric += abs(int(r_node_pairs[i].first->GetIndex()) - int(r_node_pairs[i].second->GetIndex()));
+        }
+        index_metric /= r_node_pairs.size();
+
+        // The first query orders the nodes along a space-filling curve
+        NissenPairGeometryCache<2>* p_cache = NissenPairGeometryCache<2>::Instance();
+        const std::vector<NissenPairGeometryCache<2>::PairGeometry>& r_pairs = p_cache->rGetPairs(cell_population);
+        TS_ASSERT_EQUALS(p_cache->GetNumReorderings(), 1u);
+        TS_ASSERT_LESS_THAN(p_cache->GetLocalityMetric(), 0.5*index_metric);
+
+        std::vector<unsigned> ordering = p_cache->rGetNodeOrdering(cell_population);
+        TS_ASSERT_EQUALS(ordering.size(), 64u);
+        std::vector<unsigned> positions(64);
+        for (unsigned k=0; k<ordering.size(); k++)
+        {
+            positions[ordering[k]] = k;
+        }
+        std::sort(ordering.begin(), ordering.end());
+        for (unsigned k=0; k<ordering.size(); k++)
+        {
+            TS_ASSERT_EQUALS(ordering[k], k);
+        }
+
+        // The pairs are sorted by the earlier of their nodes in the ordering
+        for (unsigned i=1; i<r_pairs.size(); i++)
+        {
+            TS_ASSERT_LESS_THAN_EQUALS(std::min(positions[r_pairs[i-1].mNodeAIndex], positions[r_pairs[i-1].mNodeBIndex]),
+                                       std::min(positions[r_pairs[i].mNodeAIndex], positions[r_pairs[i].mNodeBIndex]));
+        }
+
+        // A daughter is placed just after a neighbour already in the ordering, without reordering the rest
+        std::vector<CellPtr> new_cells;
+        BlastocystTestCellsGenerator::GenerateCells<TrophectodermCellProliferativeType>(1, new_cells, false);
+        cell_population.AddCell(new_cells[0], cell_population.GetCellUsingLocationIndex(20));
+        cell_population.Update();
+
+        const std::vector<unsigned>& r_new_ordering = p_cache->rGetNodeOrdering(cell_population);
+        TS_ASSERT_EQUALS(p_cache->GetNumReorderings(), 1u);
+        TS_ASSERT_EQUALS(r_new_ordering.size(), 65u);
+        unsigned new_index = cell_population.GetLocationIndexUsingCell(new_cells[0]);
+
+        unsigned new_position = std::find(r_new_ordering.begin(), r_new_ordering.end(), new_index) - r_new_ordering.begin();
+        TS_ASSERT_LESS_THAN(0u, new_position);
+        unsigned anchor_index = r_new_ordering[new_position - 1];
+        bool is_neighbour = false;
+        for (unsigned i=0; i<r_node_pairs.size(); i++)
+        {
+            unsigned index_a = r_node_pairs[i].first->GetIndex();
+            unsigned index_b = r_node_pairs[i].second->GetIndex();
+            if ((index_a == new_index && index_b == anchor_index) || (index_a == anchor_index && index_b == new_index))
+            {
+                is_neighbour = true;
+            }
+        }
+        TS_ASSERT(is_neighbour);
+
+        for (unsigned k=0; k<nodes.size(); k++)
+        {
+            delete nodes[k];
+        }
+        NissenPairGeometryCache<2>::Destroy();
+    }
+};
+
+#endif /*TESTNISSENPAIRGEOMETRYCACHE_HPP_*/
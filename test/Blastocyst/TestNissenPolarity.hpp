@@ -38,8 +38,16 @@
 // Simulation files
 #include "OffLatticeSimulation.hpp"
 #include "CellPolaritySrnModel.hpp"
+#include "CellPolarityOdeSystem.hpp"
+#include "OdeSystemInformation.hpp"
 #include "CellPolarityTrackingModifier.hpp"
+#include "CellPolarityVectorSrnModel.hpp"
+#include "CellPolarityVectorTrackingModifier.hpp"
+#include "NissenForceTrophectoderm3d.hpp"
+#include "TrophectodermBoundaryDetector.hpp"
+#include "NissenHaloStateMirror.hpp"
 
+#include "BlastocystTestCellsGenerator.hpp"
 #include "SmartPointers.hpp"
 #include "NodesOnlyMesh.hpp"
 #include "NodeBasedCellPopulation.hpp"
@@ -51,36 +59,6 @@
 
 class TestNissenPolarity : public AbstractCellBasedWithTimingsTestSuite
 {
-private:
-    void GenerateTrophectodermCells(unsigned num_cells, std::vector<CellPtr>& rCells)
-    {
-        boost::shared_ptr<AbstractCellProperty> p_state(CellPropertyRegistry::Instance()->Get<WildTypeCellMutationState>());
-        boost::shared_ptr<AbstractCellProperty> p_prolif_type(CellPropertyRegistry::Instance()->Get<TrophectodermCellProliferativeType>());
-
-        for (unsigned i=0; i<num_cells; i++)
-        {
-            //In the initial conditions for polarity we have all polarity angles as zero
-            std::vector<double> initial_conditions;
-            initial_conditions.push_back(0.0);
-
-            NoCellCycleModel* p_cc_model = new NoCellCycleModel();
-            p_cc_model->SetDimension(2);
-
-            CellPolaritySrnModel* p_srn_model = new CellPolaritySrnModel();
-            p_srn_model->SetInitialConditions(initial_conditions);
-
-            CellPtr p_cell(new Cell(p_state, p_cc_model, p_srn_model));
-            p_cell->SetCellProliferativeType(p_prolif_type);
-
-            double birth_time = 0.0;
-            p_cell->SetBirthTime(birth_time);
-
-            p_cell->GetCellData()->SetItem("target area", 1.0);
-            rCells.push_back(p_cell);
-        }
-    }
-
-
 public:
     
     void TestNissenPolarityInLine() throw (Exception)
@@ -127,6 +105,477 @@ public:
         simulator.Solve();
    }
 
+    void TestNissenPolarityInLineWithImplicitPolarityUpdate() throw (Exception)
+    {
+        // Create a simple mesh
+        unsigned num_ghosts = 0;
+        HoneycombMeshGenerator generator(1, 7, num_ghosts);
+        MutableMesh<2,2>* p_generating_mesh = generator.GetMesh();
+
+        // Convert this to a NodesOnlyMesh, wide enough for every cell to couple to every other
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(*p_generating_mesh, 6.0);
+
+        // Set up cells, one for each Node, with alternate cells starting half a radian either side of zero
+        std::vector<CellPtr> cells;
+        GenerateTrophectodermCells(mesh.GetNumNodes(),cells);
+        std::vector<double> initial_angles;
+        for (unsigned i=0; i<cells.size(); i++)
+        {
+            initial_angles.push_back((i%2 == 0) ? 0.5 : -0.5);
+            std::vector<double> initial_conditions(1, initial_angles[i]);
+            static_cast<CellPolaritySrnModel*>(cells[i]->GetSrnModel())->SetInitialConditions(initial_conditions);
+        }
+
+        // Create cell population
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+
+        // A polarity step of four time units, which is what the update interval below gives
+        double polarity_step = 4.0;
+        double coupling_radius = 5.5;
+
+        // A forward Euler step of this length would throw the angles past their mean, further than they started
+        double max_explicit_angle = 0.0;
+        for (unsigned a=0; a<mesh.GetNumNodes(); a++)
+        {
+            double drive = 0.0;
+            for (unsigned b=0; b<mesh.GetNumNodes(); b++)
+            {
+                if (b != a && norm_2(mesh.GetNode(b)->rGetLocation() - mesh.GetNode(a)->rGetLocation()) < coupling_radius)
+                {
+                    drive += sin(initial_angles[a] - initial_angles[b]);
+                }
+            }
+            double explicit_angle = initial_angles[a] - polarity_step*CellPolarityOdeSystem::GetCouplingStrength()*drive;
+            max_explicit_angle = std::max(max_explicit_angle, fabs(explicit_angle));
+        }
+        TS_ASSERT_LESS_THAN(0.8, max_explicit_angle);
+
+        // Set up cell-based simulation and output directory
+        OffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("NodeBasedNissenPolarityImplicit");
+        simulator.SetDt(1.0/200.0);
+        simulator.SetSamplingTimestepMultiple(40);
+        simulator.SetEndTime(40.0);
+
+        MAKE_PTR(CellPolarityTrackingModifier<2>, p_modifier);
+        p_modifier->SetUseImplicitPolarityIntegration(true);
+        p_modifier->SetCouplingRadius(coupling_radius);
+
+        // The polarity relaxes slowly, so it may also be updated less often than the mechanics
+        p_modifier->SetMaxPolarityUpdateInterval(static_cast<unsigned>(polarity_step*200.0 + 0.5));
+        p_modifier->SetOutputMultiRateDiagnostics(true);
+        simulator.AddSimulationModifier(p_modifier);
+
+        MAKE_PTR(NissenForce<2>, p_force);
+        p_force->SetCutOffLength(2.5);
+        simulator.AddForce(p_force);
+
+        simulator.Solve();
+
+        // The implicit steps align the cells without overshooting, and the coupling keeps their mean angle
+        double mean_initial_angle = 0.0;
+        for (unsigned i=0; i<initial_angles.size(); i++)
+        {
+            mean_initial_angle += initial_angles[i]/initial_angles.size();
+        }
+        for (AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            double angle = static_cast<CellPolaritySrnModel*>(cell_iter->GetSrnModel())->GetPolarityAngle();
+            TS_ASSERT(!std::isnan(angle));
+            TS_ASSERT_DELTA(angle, mean_initial_angle, 0.02);
+        }
+    }
+
+    void TestPolarityUpdateIntervalAcrossSolves() throw (Exception)
+    {
+        SimulationTime* p_time = SimulationTime::Instance();
+        p_time->SetEndTimeAndNumberOfTimeSteps(1.0, 10);
+
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TrophectodermCellProliferativeType>(1, cells, true);
+        cells[0]->InitialiseSrnModel();
+        CellPolaritySrnModel* p_srn_model = static_cast<CellPolaritySrnModel*>(cells[0]->GetSrnModel());
+        p_srn_model->SetUpdateInterval(5);
+        p_srn_model->SimulateToCurrentTime();
+
+        // The ODE system is solved every fifth step, including in a second Solve(), which restarts the count of steps elapsed
+        for (unsigned solve=0; solve<2; solve++)
+        {
+            if (solve == 1)
+            {
+                p_time->ResetEndTimeAndNumberOfTimeSteps(2.0, 10);
+            }
+            while (!p_time->IsFinished())
+            {
+                p_time->IncrementTimeOneStep();
+                p_srn_model->SimulateToCurrentTime();
+
+                unsigned step = (unsigned)floor(p_time->GetTime()/0.1 + 0.5);
+                TS_ASSERT_DELTA(p_srn_model->GetSimulatedToTime(), 0.1*(step - step%5), 1e-9);
+            }
+        }
+        TS_ASSERT_DELTA(p_srn_model->GetSimulatedToTime(), 2.0, 1e-9);
+    }
+
+    void TestPolaritySrnModelDataSlots() throw (Exception)
+    {
+        std::vector<Node<2>*> nodes;
+        nodes.push_back(new Node<2>(0, false, 0.0, 0.0));
+        nodes.push_back(new Node<2>(1, false, 1.0, 0.0));
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 2.5);
+
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TrophectodermCellProliferativeType>(mesh.GetNumNodes(), cells, true);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+        cell_population.InitialiseCells();
+        CellPolaritySrnModel* p_srn_model = static_cast<CellPolaritySrnModel*>(cells[0]->GetSrnModel());
+
+        // The names resolve to the state variable and the parameter, which follows it
+        TS_ASSERT_EQUALS(p_srn_model->RegisterDataSlot("Polarity Angle"), 0u);
+        TS_ASSERT_EQUALS(p_srn_model->RegisterDataSlot("dVpdAlpha"), 1u);
+        TS_ASSERT_THROWS_THIS(p_srn_model->RegisterDataSlot("Polarity X"),
+                              "No state variable or parameter named 'Polarity X' in this SRN model's ODE system.");
+
+        // The typed accessors read and write the ODE system itself
+        p_srn_model->SetPolarityAngle(0.4);
+        p_srn_model->SetdVpdAlpha(0.7);
+        TS_ASSERT_DELTA(p_srn_model->GetOdeSystem()->rGetStateVariables()[0], 0.4, 1e-12);
+        TS_ASSERT_DELTA(p_srn_model->GetOdeSystem()->GetParameter("dVpdAlpha"), 0.7, 1e-12);
+        TS_ASSERT_DELTA(p_srn_model->GetDataSlotValue(0), 0.4, 1e-12);
+        TS_ASSERT_DELTA(p_srn_model->GetDataSlotValue(1), 0.7, 1e-12);
+
+        // A daughter's model inherits both the angle and the drive
+        CellPolaritySrnModel* p_daughter_model = static_cast<CellPolaritySrnModel*>(p_srn_model->CreateSrnModel());
+        TS_ASSERT_DELTA(p_daughter_model->GetPolarityAngle(), 0.4, 1e-12);
+        TS_ASSERT_DELTA(p_daughter_model->GetdVpdAlpha(), 0.7, 1e-12);
+        delete p_daughter_model;
+
+        // The drive may still be taken from CellData
+        cells[0]->GetCellData()->SetItem("dVpdAlpha", 1.5);
+        p_srn_model->UpdatedVpdAlpha();
+        TS_ASSERT_DELTA(p_srn_model->GetdVpdAlpha(), 1.5, 1e-12);
+
+        // By default CellData is refreshed whenever results are written, which is every time step unless told otherwise
+        MAKE_PTR(CellPolarityTrackingModifier<2>, p_modifier);
+        TS_ASSERT_EQUALS(p_modifier->GetCellDataOutputInterval(), 0u);
+        TS_ASSERT_EQUALS(p_modifier->GetSamplingTimestepMultiple(), 1u);
+
+        // CellData is only refreshed from the SRN models when the modifier writes it
+        p_srn_model->SetdVpdAlpha(-0.2);
+        TS_ASSERT_DELTA(cells[0]->GetCellData()->GetItem("dVpdAlpha"), 1.5, 1e-12);
+        p_modifier->WriteCellData(cell_population);
+        TS_ASSERT_DELTA(cells[0]->GetCellData()->GetItem("Polarity Angle"), 0.4, 1e-12);
+        TS_ASSERT_DELTA(cells[0]->GetCellData()->GetItem("dVpdAlpha"), -0.2, 1e-12);
+
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+    }
+
+    void TestPolarityOdeSystemsShareTheirInformation() throw (Exception)
+    {
+        std::vector<Node<2>*> nodes;
+        for (unsigned i=0; i<3; i++)
+        {
+            nodes.push_back(new Node<2>(i, false, double(i), 0.0));
+        }
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 2.5);
+
+        // Each cell starts from its own angle
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TrophectodermCellProliferativeType>(mesh.GetNumNodes(), cells, true);
+        for (unsigned i=0; i<cells.size(); i++)
+        {
+            std::vector<double> initial_conditions(1, 0.1*(i + 1));
+            static_cast<CellPolaritySrnModel*>(cells[i]->GetSrnModel())->SetInitialConditions(initial_conditions);
+        }
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+        cell_population.InitialiseCells();
+
+        // Every ODE system refers to the one copy of the names, units and default initial conditions
+        boost::shared_ptr<OdeSystemInformation<CellPolarityOdeSystem> > p_info = OdeSystemInformation<CellPolarityOdeSystem>::Instance();
+        TS_ASSERT_EQUALS(p_info->rGetStateVariableNames().size(), 1u);
+        TS_ASSERT_EQUALS(p_info->rGetStateVariableNames()[0], "Polarity Angle");
+        TS_ASSERT_EQUALS(p_info->rGetParameterNames().size(), 1u);
+        TS_ASSERT_EQUALS(p_info->rGetParameterNames()[0], "dVpdAlpha");
+        TS_ASSERT_DELTA(p_info->GetInitialConditions()[0], 0.0, 1e-12);
+
+        for (unsigned i=0; i<cells.size(); i++)
+        {
+            AbstractOdeSystem* p_system = static_cast<CellPolaritySrnModel*>(cells[i]->GetSrnModel())->GetOdeSystem();
+            TS_ASSERT_EQUALS(p_system->GetSystemInformation().get(), p_info.get());
+            TS_ASSERT_EQUALS(p_system->GetNumberOfStateVariables(), 1u);
+            TS_ASSERT_DELTA(p_system->rGetStateVariables()[0], 0.1*(i + 1), 1e-12);
+            TS_ASSERT_DELTA(p_system->GetParameter(0), 0.0, 1e-12);
+        }
+
+        // The per-cell state stays separate from the shared information
+        static_cast<CellPolaritySrnModel*>(cells[0]->GetSrnModel())->SetPolarityAngle(1.0);
+        TS_ASSERT_DELTA(static_cast<CellPolaritySrnModel*>(cells[1]->GetSrnModel())->GetPolarityAngle(), 0.2, 1e-12);
+        TS_ASSERT_DELTA(p_info->GetInitialConditions()[0], 0.0, 1e-12);
+
+        // A daughter's ODE system shares it too
+        AbstractSrnModel* p_daughter_model = cells[2]->GetSrnModel()->CreateSrnModel();
+        AbstractOdeSystem* p_daughter_system = static_cast<CellPolaritySrnModel*>(p_daughter_model)->GetOdeSystem();
+        TS_ASSERT_EQUALS(p_daughter_system->GetSystemInformation().get(), p_info.get());
+        TS_ASSERT_DELTA(p_daughter_system->rGetStateVariables()[0], 0.3, 1e-12);
+        delete p_daughter_model;
+
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+    }
+
+    void TestOverlapAwareDivisionPlacement() throw (Exception)
+    {
+        // Three cells in a row, so the middle one can only divide without overlap perpendicular to the row
+        std::vector<Node<2>*> nodes;
+        for (unsigned i=0; i<3; i++)
+        {
+            nodes.push_back(new Node<2>(i, false, double(i), 0.0));
+        }
+
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 1.5);
+        for (unsigned i=0; i<mesh.GetNumNodes(); i++)
+        {
+            mesh.GetNode(i)->SetRadius(0.5);
+        }
+
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TrophectodermCellProliferativeType>(mesh.GetNumNodes(), cells, true);
+        MAKE_PTR(TransitCellProliferativeType, p_transit_type);
+        for (unsigned i=0; i<cells.size(); i++)
+        {
+            cells[i]->SetCellProliferativeType(p_transit_type);
+        }
+
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+        cell_population.Update();
+
+        NissenBasedDivisionRule<2,2> division_rule;
+        TS_ASSERT_EQUALS(division_rule.GetUseOverlapAwarePlacement(), false);
+
+        // By default the parent moves back half the separation and the daughter takes its old centre
+        CellPtr p_middle_cell = cell_population.GetCellUsingLocationIndex(1);
+        double half_separation = 0.5*cell_population.GetMeinekeDivisionSeparation();
+        std::pair<c_vector<double, 2>, c_vector<double, 2> > default_positions =
+            division_rule.CalculateCellDivisionVector(p_middle_cell, cell_population);
+        TS_ASSERT_DELTA(norm_2(default_positions.second - mesh.GetNode(1)->rGetLocation()), 0.0, 1e-12);
+        TS_ASSERT_DELTA(norm_2(default_positions.first - mesh.GetNode(1)->rGetLocation()), half_separation, 1e-9);
+
+        division_rule.SetUseOverlapAwarePlacement(true);
+        TS_ASSERT_EQUALS(division_rule.GetNumCandidateDirections(), 12u);
+
+        for (unsigned trial=0; trial<10; trial++)
+        {
+            std::pair<c_vector<double, 2>, c_vector<double, 2> > positions =
+                division_rule.CalculateCellDivisionVector(p_middle_cell, cell_population);
+
+            // The best of 12 axes lies within pi/24 of the perpendicular to the row
+            c_vector<double, 2> displacement = positions.second - mesh.GetNode(1)->rGetLocation();
+            TS_ASSERT_DELTA(norm_2(displacement), half_separation, 1e-9);
+            TS_ASSERT_LESS_THAN_EQUALS(fabs(displacement(0)), half_separation*sin(M_PI/24.0) + 1e-9);
+        }
+
+        // Cells in a batch avoid each other's daughters as well as their neighbours
+        std::vector<CellPtr> parents;
+        parents.push_back(cell_population.GetCellUsingLocationIndex(0));
+        parents.push_back(p_middle_cell);
+        division_rule.CalculateDivisionVectorsForBatch(parents, cell_population);
+        TS_ASSERT_EQUALS(division_rule.GetNumBatchedDivisions(), 2u);
+        division_rule.CalculateCellDivisionVector(parents[0], cell_population);
+        division_rule.CalculateCellDivisionVector(parents[1], cell_population);
+        TS_ASSERT_EQUALS(division_rule.GetNumBatchedDivisions(), 0u);
+    }
+
+    void TestTrophectodermBoundaryDetection() throw (Exception)
+    {
+        // A 7 by 7 honeycomb of cells, spaced a cell diameter apart
+        HoneycombMeshGenerator generator(7, 7, 0);
+        MutableMesh<2,2>* p_generating_mesh = generator.GetMesh();
+
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(*p_generating_mesh, 2.0);
+
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TrophectodermCellProliferativeType>(mesh.GetNumNodes(), cells, true);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+        cell_population.Update();
+
+        TrophectodermBoundaryDetector<2> detector;
+        TS_ASSERT_DELTA(detector.GetAlpha(), 0.8, 1e-12);
+        detector.Compute(cell_population);
+
+        // Exactly the cells round the edge are outer
+        TS_ASSERT_EQUALS(detector.GetNumBoundaryNodes(), 24u);
+        TS_ASSERT(detector.IsOnBoundary(0));
+        TS_ASSERT(detector.IsOnBoundary(3));
+        TS_ASSERT(!detector.IsOnBoundary(24));
+
+        // The middle of the bottom row faces straight down
+        TS_ASSERT_DELTA(detector.rGetOutwardNormal(3)(0), 0.0, 1e-6);
+        TS_ASSERT_DELTA(detector.rGetOutwardNormal(3)(1), -1.0, 1e-6);
+    }
+
+    void TestSpringPolarityFactorIn2d() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // Both cells must be local
+
+        // Two trophectoderm cells a cell diameter apart along a line at angle phi
+        double phi = 0.0;
+        std::vector<Node<2>*> nodes;
+        nodes.push_back(new Node<2>(0, false, 0.0, 0.0));
+        nodes.push_back(new Node<2>(1, false, cos(phi), sin(phi)));
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 2.5);
+
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TrophectodermCellProliferativeType>(mesh.GetNumNodes(), cells, true);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+        cell_population.InitialiseCells();
+
+        double angle_A = M_PI/3.0;
+        double angle_B = M_PI/3.0;
+        static_cast<CellPolaritySrnModel*>(cells[0]->GetSrnModel())->SetPolarityAngle(angle_A);
+        static_cast<CellPolaritySrnModel*>(cells[1]->GetSrnModel())->SetPolarityAngle(angle_B);
+
+        MAKE_PTR(NissenGeneralisedLinearSpringForce<2>, p_force);
+        p_force->SetCutOffLength(2.5);
+        c_vector<double, 2> force = p_force->CalculateForceBetweenNodes(0, 1, cell_population);
+
+        // The magnitude of the attraction for a given polarity factor, with a unit rest length and stiffness 15
+        double new_factor = sin(phi - angle_A)*sin(phi - angle_B);
+        double old_factor = -(cos(angle_A)*sin(phi) - sin(angle_A)*cos(phi))*(sin(angle_B)*cos(phi) - cos(angle_B)*cos(phi));
+        double new_overlap = 1.0 - 1.0/(1.0 + new_factor);
+        double old_overlap = 1.0 - 1.0/(1.0 + old_factor);
+        double new_magnitude = 15.0*new_overlap*exp(-5.0*new_overlap/2.5);
+        double old_magnitude = 15.0*old_overlap*exp(-5.0*old_overlap/2.5);
+
+        // The force follows sin(phi - alpha_A)*sin(phi - alpha_B), which the earlier expression did not
+        TS_ASSERT_DELTA(force[0], new_magnitude, 1e-12);
+        TS_ASSERT_DELTA(force[1], 0.0, 1e-12);
+        TS_ASSERT_LESS_THAN(0.1, fabs(new_magnitude - old_magnitude));
+
+        // Along the diagonal the two expressions agree, so forces there are unchanged
+        phi = M_PI/4.0;
+        c_vector<double, 2> diagonal_location;
+        diagonal_location[0] = cos(phi);
+        diagonal_location[1] = sin(phi);
+        mesh.GetNode(1)->rGetModifiableLocation() = diagonal_location;
+        force = p_force->CalculateForceBetweenNodes(0, 1, cell_population);
+
+        new_factor = sin(phi - angle_A)*sin(phi - angle_B);
+        old_factor = -(cos(angle_A)*sin(phi) - sin(angle_A)*cos(phi))*(sin(angle_B)*cos(phi) - cos(angle_B)*cos(phi));
+        TS_ASSERT_DELTA(new_factor, old_factor, 1e-12);
+        new_overlap = 1.0 - 1.0/(1.0 + new_factor);
+        new_magnitude = 15.0*new_overlap*exp(-5.0*new_overlap/2.5);
+        TS_ASSERT_DELTA(norm_2(force), new_magnitude, 1e-12);
+
+        for (unsigned i=0; i<nodes.size(); i++)
+        {
+            delete nodes[i];
+        }
+        NissenHaloStateMirror<2>::Destroy();
+    }
+
+    void TestNissenVectorPolarityIn3d() throw (Exception)
+    {
+        // A 3 by 3 sheet of trophectoderm cells in the plane z = 0, a cell diameter apart
+        std::vector<Node<3>*> nodes;
+        for (unsigned i=0; i<9; i++)
+        {
+            nodes.push_back(new Node<3>(i, false, 2.0*(i%3), 2.0*(i/3), 0.0));
+        }
+        NodesOnlyMesh<3> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 3.0);
+
+        boost::shared_ptr<AbstractCellProperty> p_state(CellPropertyRegistry::Instance()->Get<WildTypeCellMutationState>());
+        boost::shared_ptr<AbstractCellProperty> p_prolif_type(CellPropertyRegistry::Instance()->Get<TrophectodermCellProliferativeType>());
+
+        std::vector<CellPtr> cells;
+        c_vector<double, 3> initial_sum = zero_vector<double>(3);
+        for (unsigned i=0; i<mesh.GetNumNodes(); i++)
+        {
+            // Every cell starts polarised in a random direction
+            c_vector<double, 3> direction;
+            for (unsigned j=0; j<3; j++)
+            {
+                direction[j] = RandomNumberGenerator::Instance()->StandardNormalRandomDeviate();
+            }
+            direction /= norm_2(direction);
+            initial_sum += direction;
+            std::vector<double> initial_conditions(direction.begin(), direction.end());
+
+            NoCellCycleModel* p_cc_model = new NoCellCycleModel();
+            p_cc_model->SetDimension(3);
+
+            CellPolarityVectorSrnModel* p_srn_model = new CellPolarityVectorSrnModel();
+            p_srn_model->SetInitialConditions(initial_conditions);
+
+            CellPtr p_cell(new Cell(p_state, p_cc_model, p_srn_model));
+            p_cell->SetCellProliferativeType(p_prolif_type);
+            p_cell->SetBirthTime(0.0);
+            p_cell->GetCellData()->SetItem("target area", 1.0);
+            cells.push_back(p_cell);
+        }
+
+        NodeBasedCellPopulation<3> cell_population(mesh, cells);
+
+        OffLatticeSimulation<3> simulator(cell_population);
+        simulator.SetOutputDirectory("NodeBasedNissenVectorPolarity");
+        simulator.SetDt(1.0/200.0);
+        simulator.SetSamplingTimestepMultiple(2000);
+        simulator.SetEndTime(60.0);
+
+        // The cells start far from aligned
+        TS_ASSERT_LESS_THAN(norm_2(initial_sum)/mesh.GetNumNodes(), 0.9);
+
+        MAKE_PTR(CellPolarityVectorTrackingModifier<3>, p_modifier);
+        simulator.AddSimulationModifier(p_modifier);
+
+        MAKE_PTR(NissenForceTrophectoderm3d<3>, p_force);
+        p_force->SetCutOffLength(2.5);
+        simulator.AddForce(p_force);
+
+        simulator.Solve();
+
+        // The polarities stay unit vectors
+        c_vector<double, 3> final_sum = zero_vector<double>(3);
+        for (AbstractCellPopulation<3>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            const std::vector<double>& r_polarity = static_cast<CellPolarityVectorSrnModel*>(cell_iter->GetSrnModel())->rGetPolarityVector();
+            double length = sqrt(r_polarity[0]*r_polarity[0] + r_polarity[1]*r_polarity[1] + r_polarity[2]*r_polarity[2]);
+            TS_ASSERT_DELTA(length, 1.0, 1e-6);
+            TS_ASSERT_DELTA(cell_iter->GetCellData()->GetItem("Polarity Z"), r_polarity[2], 1e-12);
+            for (unsigned j=0; j<3; j++)
+            {
+                final_sum[j] += r_polarity[j];
+            }
+        }
+
+        // The coupling has brought them into line with one another
+        TS_ASSERT_LESS_THAN(0.99, norm_2(final_sum)/mesh.GetNumNodes());
+        c_vector<double, 3> mean_direction = final_sum/norm_2(final_sum);
+        for (AbstractCellPopulation<3>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            const std::vector<double>& r_polarity = static_cast<CellPolarityVectorSrnModel*>(cell_iter->GetSrnModel())->rGetPolarityVector();
+            double alignment = r_polarity[0]*mean_direction[0] + r_polarity[1]*mean_direction[1] + r_polarity[2]*mean_direction[2];
+            TS_ASSERT_LESS_THAN(0.98, alignment);
+        }
+    }
+
 };
 
 #endif //TESTNISSENPOLARITY_HPP_
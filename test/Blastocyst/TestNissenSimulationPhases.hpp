@@ -0,0 +1,136 @@
+#ifndef TESTNISSENSIMULATIONPHASES_HPP_
+#define TESTNISSENSIMULATIONPHASES_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+
+#include "TransitCellProliferativeType.hpp"
+
+#include "HoneycombMeshGenerator.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+
+#include "NissenOffLatticeSimulation.hpp"
+#include "NissenSimulationPhase.hpp"
+#include "CellPolarityTrackingModifier.hpp"
+#include "SteadyStateDetectionModifier.hpp"
+#include "TrophectodermSpecificationModifier.hpp"
+#include "NissenForce.hpp"
+#include "NissenForceTrophectoderm.hpp"
+#include "NissenForceNoTroph.hpp"
+#include "NissenPairGeometryCache.hpp"
+#include "NissenHaloStateMirror.hpp"
+#include "CellPopulationStateTracker.hpp"
+#include "CellProliferativeTypesCountWriter.hpp"
+#include "SimulationTime.hpp"
+
+#include "BlastocystTestCellsGenerator.hpp"
+#include "SmartPointers.hpp"
+
+/**
+ * Tests of a protocol of several phases run in one call to NissenOffLatticeSimulation::Solve().
+ */
+class TestNissenSimulationPhases : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestPhasesRunInOneSolve() throw (Exception)
+    {
+        EXIT_IF_PARALLEL; // The trophectoderm specification is not distributed
+
+        HoneycombMeshGenerator generator(3, 3, 0);
+        MutableMesh<2,2>* p_generating_mesh = generator.GetMesh();
+        p_generating_mesh->Scale(0.7, 0.7);
+
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(*p_generating_mesh, 2.5);
+
+        // The trophectoderm forces take the polarity from the SRN model
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TransitCellProliferativeType>(mesh.GetNumNodes(), cells, true);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+
+        NissenOffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("NissenSimulationPhases");
+        simulator.SetDt(1.0/200.0);
+        simulator.SetSamplingTimestepMultiple(200);
+        simulator.SetEndTime(100.0);
+
+        MAKE_PTR(NissenForce<2>, p_force);
+        p_force->SetCutOffLength(2.5);
+        simulator.AddForce(p_force);
+
+        MAKE_PTR(CellPolarityTrackingModifier<2>, p_polarity_modifier);
+        simulator.AddSimulationModifier(p_polarity_modifier);
+
+        // The cells have already reached the target number, so this phase ends as soon as it starts
+        MAKE_PTR_ARGS(NissenSimulationPhase<2>, p_cleavage_phase, ("cleavage"));
+        p_cleavage_phase->SetTargetNumCells(9);
+        simulator.AddPhase(p_cleavage_phase);
+
+        // The squashed cluster spreads out under the forces added to the simulation until it comes to rest
+        MAKE_PTR_ARGS(NissenSimulationPhase<2>, p_morula_phase, ("morula"));
+        MAKE_PTR(SteadyStateDetectionModifier<2>, p_steady_state_modifier);
+        p_steady_state_modifier->SetWindowLength(100);
+        p_morula_phase->SetEndAtSteadyState(p_steady_state_modifier);
+        simulator.AddPhase(p_morula_phase);
+
+        // The outer cells are then specified as trophectoderm, and the forces swapped
+        MAKE_PTR_ARGS(NissenSimulationPhase<2>, p_trophectoderm_phase, ("trophectoderm_forces"));
+        MAKE_PTR(TrophectodermSpecificationModifier<2>, p_specification_modifier);
+        p_trophectoderm_phase->AddSimulationModifier(p_specification_modifier);
+        MAKE_PTR(NissenForceTrophectoderm<2>, p_force_troph);
+        p_force_troph->SetCutOffLength(2.5);
+        p_trophectoderm_phase->AddForce(p_force_troph);
+        MAKE_PTR(NissenForceNoTroph<2>, p_force_no_troph);
+        p_force_no_troph->SetCutOffLength(2.5);
+        p_trophectoderm_phase->AddForce(p_force_no_troph);
+        MAKE_PTR(CellProliferativeTypesCountWriter<2>, p_count_writer);
+        p_trophectoderm_phase->AddCellPopulationCountWriter(p_count_writer);
+        p_trophectoderm_phase->SetDuration(1.0);
+        simulator.AddPhase(p_trophectoderm_phase);
+
+        simulator.Solve();
+
+        // Every phase has run, and the protocol stopped well before the end time
+        TS_ASSERT_EQUALS(simulator.GetCurrentPhase(), 3u);
+        double end_time = SimulationTime::Instance()->GetTime();
+        TS_ASSERT_LESS_THAN(end_time, 100.0);
+
+        TS_ASSERT_DELTA(p_cleavage_phase->GetStartTime(), 0.0, 1e-9);
+        TS_ASSERT_DELTA(p_cleavage_phase->GetEndTime(), 0.0, 1e-9);
+        TS_ASSERT_DELTA(p_morula_phase->GetStartTime(), 0.0, 1e-9);
+        TS_ASSERT(p_steady_state_modifier->HasReachedSteadyState());
+        TS_ASSERT_DELTA(p_morula_phase->GetEndTime(), p_steady_state_modifier->GetSteadyStateTime(), 1e-9);
+        TS_ASSERT_DELTA(p_trophectoderm_phase->GetStartTime(), p_morula_phase->GetEndTime(), 1e-9);
+        TS_ASSERT_DELTA(p_trophectoderm_phase->GetEndTime(), p_trophectoderm_phase->GetStartTime() + 1.0, 1e-9);
+        TS_ASSERT_DELTA(end_time, p_trophectoderm_phase->GetEndTime(), 1e-9);
+
+        // The trophectoderm was specified when its phase started, with the forces of that phase
+        TS_ASSERT_LESS_THAN(0u, p_specification_modifier->GetNumSpecifiedCells());
+        TS_ASSERT_EQUALS(simulator.rGetForceCollection().size(), 2u);
+        TS_ASSERT(simulator.rGetForceCollection()[0] == p_force_troph);
+
+        // The modifiers of each phase were removed when it ended, leaving those of the simulation
+        TS_ASSERT_EQUALS(simulator.GetSimulationModifiers()->size(), 1u);
+        TS_ASSERT((*simulator.GetSimulationModifiers())[0] == p_polarity_modifier);
+
+        // The transitions are logged
+        OutputFileHandler handler("NissenSimulationPhases", false);
+        FileFinder phase_file = handler.FindFile("results_from_time_0/phases.dat");
+        TS_ASSERT(phase_file.Exists());
+
+        // A further call to Solve() has nothing left to do
+        simulator.SetEndTime(110.0);
+        simulator.Solve();
+        TS_ASSERT_DELTA(SimulationTime::Instance()->GetTime(), end_time, 1e-9);
+
+        NissenPairGeometryCache<2>::Destroy();
+        NissenHaloStateMirror<2>::Destroy();
+        CellPopulationStateTracker<2>::Destroy();
+    }
+};
+
+#endif /*TESTNISSENSIMULATIONPHASES_HPP_*/
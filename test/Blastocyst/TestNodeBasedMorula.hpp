@@ -37,9 +37,11 @@
 #include "NissenBasedDivisionRule.hpp"
 
 // Simulation files
-#include "OffLatticeSimulation.hpp"
+#include "NissenOffLatticeSimulation.hpp"
 #include "CellPolaritySrnModel.hpp"
 #include "CellPolarityTrackingModifier.hpp"
+#include "MemoryAccountingModifier.hpp"
+#include "TrophectodermSpecificationModifier.hpp"
 
 #include "SmartPointers.hpp"
 #include "NodesOnlyMesh.hpp"
@@ -55,70 +57,6 @@ class TestNodeBasedMorula : public AbstractCellBasedWithTimingsTestSuite
 {
 private:
     double SIMULATOR_END_TIME = 180.0;
-    
-    /*
-     * Function to call when we wish to make trophectoderm specification at E3.5. This is done by assigning
-     * cells the polarity cell property, a cell label and the trophectoderm cell proliferative type.
-     *
-     * Trophectoderm cells are also given polarity angles, which are initialised to point away from the
-     * centroid of the cell population.
-     */
-    void LabelTrophectodermCells(NodeBasedCellPopulation<2>& cell_population)
-    {
-        const c_vector<double, 2> morula_centre = cell_population.GetCentroidOfCellPopulation();
-
-        /*
-         * Make the relevant pointers to cell properties for trophectoderm polarity, label and proliferative type
-         *
-         * NOTE: When we call this method, the cell population has already called
-         *       CellPropertyRegistry::TakeOwnership(). We must therefore access
-         *       any new or existing cell properties via the existing cell property
-         *       registry, as implemented below.
-         */
-        CellPropertyRegistry* p_registry = cell_population.Begin()->rGetCellPropertyCollection().GetCellPropertyRegistry();
-        boost::shared_ptr<AbstractCellProperty> p_label = p_registry->Get<CellLabel>();
-        boost::shared_ptr<AbstractCellProperty> p_pol = p_registry->Get<PolarityCellProperty>();
-        boost::shared_ptr<AbstractCellProperty> p_troph = p_registry->Get<TrophectodermCellProliferativeType>();
-
-        for (typename AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
-             cell_iter != cell_population.End();
-             ++cell_iter)
-        {
-            unsigned node_index = cell_population.GetLocationIndexUsingCell(*cell_iter);
-            std::set<unsigned> neighbour_indices = cell_population.GetNeighbouringNodeIndices(node_index);
-            if (neighbour_indices.size() < 5.0)
-            {
-                // Add cell properties for labels, and polarity
-                cell_iter->AddCellProperty(p_pol);
-                cell_iter->AddCellProperty(p_label);
-                cell_iter->SetCellProliferativeType(p_troph);
-
-                // Get cell location to work out polarity vector
-                const c_vector<double, 2> cell_location = cell_population.GetLocationOfCellCentre(*cell_iter);
-                c_vector<double,2> unit_vector_from_centroid_to_cell = - morula_centre + cell_location;
-
-                // Norm of the distance from the centroid to the cell
-                double d = sqrt(unit_vector_from_centroid_to_cell[0]*unit_vector_from_centroid_to_cell[0] + unit_vector_from_centroid_to_cell[1]*unit_vector_from_centroid_to_cell[1]);
-
-                // Normalise our vector from centroid to cell
-                unit_vector_from_centroid_to_cell /= d;
-
-                // Store the vector x and y values in cell data for that cell
-                double cell_x_value = unit_vector_from_centroid_to_cell[0];
-		PRINT_VARIABLE(cell_x_value);
-                double cell_y_value = unit_vector_from_centroid_to_cell[1];
-		PRINT_VARIABLE(cell_y_value);
-
-                //We measure angles from the vertical so we want (pi/2 - theta)
-		double angle = atan2(cell_y_value, cell_x_value);
-		PRINT_VARIABLE(angle);
-		
-		cell_iter->GetCellData()->SetItem("target area", 1.5);
-
-                static_cast<CellPolaritySrnModel*>(cell_iter->GetSrnModel())->SetPolarityAngle(angle);
-            }
-        }
-    }
 
 public:
     void TestNodeBasedEarlyMorula() throw (Exception)
@@ -185,11 +123,15 @@ public:
 	cell_population.AddCellWriter<PolarityVectorWriter>();
 
 	//Initialise the Nissen Division Rules and apply to the cell population
-	boost::shared_ptr<AbstractCentreBasedDivisionRule<2,2> > Nissen_Division_Rule(new NissenBasedDivisionRule<2,2>());
+	//Daughters are placed to avoid overlapping their neighbours, trophectoderm axes may turn by up to 30 degrees
+	boost::shared_ptr<NissenBasedDivisionRule<2,2> > Nissen_Division_Rule(new NissenBasedDivisionRule<2,2>());
+	Nissen_Division_Rule->SetUseOverlapAwarePlacement(true);
+	Nissen_Division_Rule->SetMaximumPolarityDeviation(M_PI/6.0);
 	cell_population.SetCentreBasedDivisionRule(Nissen_Division_Rule);
 
-    	// Instantiate the simulation, saving results in NodeBasedMorula, simulating for SIMULATOR_END_TIME hours
-    	OffLatticeSimulation<2> simulation(cell_population);
+    	// Instantiate the simulation, saving results in NodeBasedMorula, simulating for SIMULATOR_END_TIME hours.
+    	// The interaction distance of the mesh is reset from the force cutoffs at the start of each Solve()
+    	NissenOffLatticeSimulation<2> simulation(cell_population);
     	simulation.SetOutputDirectory("NodeBasedMorula");
     	simulation.SetSamplingTimestepMultiple(24);
         double dt = 0.5*simulation.GetDt();
@@ -210,6 +152,11 @@ public:
         MAKE_PTR(CellPolarityTrackingModifier<2>, p_pol_tracking_modifier);
         simulation.AddSimulationModifier(p_pol_tracking_modifier);
 
+        // Record the memory used per cell, and its peak in each stage of the simulation
+        MAKE_PTR(MemoryAccountingModifier<2>, p_memory_modifier);
+        p_memory_modifier->SetPhaseName("morula");
+        simulation.AddSimulationModifier(p_memory_modifier);
+
     	// Solve the simulation the first time round
     	simulation.Solve();
 //    	TRACE("finished first simulation up to early morula");
@@ -217,17 +164,19 @@ public:
 	
         /*
          * At this point we should be at an early morula stage of development and ready to specify our outer cells as
-         * trophectoderm which we do via the private member function LabelTrophectodermCells to which we pass our\
-         * cell_population.
+         * trophectoderm, which the TrophectodermSpecificationModifier does at the start of the next Solve(), pointing
+         * the polarity of each outer cell along its outward normal.
          */
 
         // Make trophectoderm specification and add a writer for cell proliferative types
-        LabelTrophectodermCells(cell_population);
+        MAKE_PTR(TrophectodermSpecificationModifier<2>, p_specification_modifier);
+        simulation.AddSimulationModifier(p_specification_modifier);
         cell_population.AddCellPopulationCountWriter<CellProliferativeTypesCountWriter>();
 	
         // Run simulation for a small amount more time in order to allow trophectoderm cells to reach equilibirum 
 	//and spread out a bit
         simulation.SetEndTime(SIMULATOR_END_TIME + 4.0);
+        p_memory_modifier->SetPhaseName("trophectoderm_equilibration");
         simulation.Solve();
 	
 	//remove our old force
@@ -251,7 +200,12 @@ public:
 	
 	// Run simulation for a small amount more time in order to allow trophectoderm cells to reach equilibirum
         simulation.SetEndTime(SIMULATOR_END_TIME + 25.0);
+        p_memory_modifier->SetPhaseName("trophectoderm_forces");
         simulation.Solve();
+
+        TS_ASSERT_EQUALS(p_memory_modifier->GetNumPhases(), 3u);
+        TS_ASSERT_LESS_THAN(0u, p_specification_modifier->GetNumSpecifiedCells());
+        TS_ASSERT_EQUALS(p_memory_modifier->rGetReport().GetNumCells(), cell_population.GetNumRealCells());
 	
 	
     }
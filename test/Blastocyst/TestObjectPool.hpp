@@ -0,0 +1,132 @@
+#ifndef TESTOBJECTPOOL_HPP_
+#define TESTOBJECTPOOL_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+
+#include <vector>
+
+#include "ObjectPool.hpp"
+#include "CellPolarityOdeSystem.hpp"
+
+/** A small class taking its memory from a pool of four slots per chunk, as the cell-cycle models and SRN models do. */
+class PooledTestObject
+{
+public:
+    double mValues[3];
+
+    void* operator new(size_t size)
+    {
+        return ObjectPool<PooledTestObject, 4>::Instance()->Allocate(size);
+    }
+
+    void operator delete(void* pObject)
+    {
+        ObjectPool<PooledTestObject, 4>::Instance()->Deallocate(pObject);
+    }
+};
+
+/** A subclass without its own operators, so too large for the slots of its parent's pool. */
+class LargerPooledTestObject : public PooledTestObject
+{
+public:
+    double mMoreValues[5];
+};
+
+/**
+ * Tests of ObjectPool, which supplies the memory of the objects created at each cell division.
+ */
+class TestObjectPool : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestFreedSlotsAreReused() throw (Exception)
+    {
+        ObjectPool<PooledTestObject, 4>* p_pool = ObjectPool<PooledTestObject, 4>::Instance();
+        unsigned num_allocated = p_pool->GetNumAllocated();
+
+        PooledTestObject* p_first = new PooledTestObject;
+        PooledTestObject* p_second = new PooledTestObject;
+        TS_ASSERT_EQUALS(p_pool->GetNumAllocated(), num_allocated + 2);
+        unsigned capacity = p_pool->GetCapacity();
+        TS_ASSERT_LESS_THAN_EQUALS(num_allocated + 2, capacity);
+
+        // A freed slot is the next to be handed out, without another chunk
+        void* p_first_slot = p_first;
+        delete p_first;
+        TS_ASSERT_EQUALS(p_pool->GetNumAllocated(), num_allocated + 1);
+        PooledTestObject* p_third = new PooledTestObject;
+        TS_ASSERT_EQUALS(static_cast<void*>(p_third), p_first_slot);
+        TS_ASSERT_EQUALS(p_pool->GetCapacity(), capacity);
+
+        // Chunks are added four slots at a time once the free list runs out
+        std::vector<PooledTestObject*> objects;
+        while (p_pool->GetNumAllocated() < capacity)
+        {
+            objects.push_back(new PooledTestObject);
+        }
+        TS_ASSERT_EQUALS(p_pool->GetCapacity(), capacity);
+        objects.push_back(new PooledTestObject);
+        TS_ASSERT_EQUALS(p_pool->GetCapacity(), capacity + 4);
+        TS_ASSERT_EQUALS(p_pool->GetNumBytesReserved() % p_pool->GetCapacity(), 0u);
+        TS_ASSERT_LESS_THAN_EQUALS(p_pool->GetCapacity()*sizeof(PooledTestObject), p_pool->GetNumBytesReserved());
+
+        for (unsigned i=0; i<objects.size(); i++)
+        {
+            delete objects[i];
+        }
+        delete p_second;
+        delete p_third;
+        TS_ASSERT_EQUALS(p_pool->GetNumAllocated(), num_allocated);
+        TS_ASSERT_EQUALS(p_pool->GetCapacity(), capacity + 4);
+    }
+
+    void TestOversizedObjectsUseTheGlobalOperators() throw (Exception)
+    {
+        ObjectPool<PooledTestObject, 4>* p_pool = ObjectPool<PooledTestObject, 4>::Instance();
+        unsigned num_allocated = p_pool->GetNumAllocated();
+        unsigned capacity = p_pool->GetCapacity();
+
+        // The subclass is passed to the global operator new, and its deletion is recognised as not the pool's
+        LargerPooledTestObject* p_larger = new LargerPooledTestObject;
+        p_larger->mMoreValues[4] = 1.0;
+        TS_ASSERT_EQUALS(p_pool->GetNumAllocated(), num_allocated);
+        TS_ASSERT_EQUALS(p_pool->GetCapacity(), capacity);
+        delete p_larger;
+        TS_ASSERT_EQUALS(p_pool->GetNumAllocated(), num_allocated);
+
+        // The same holds for a request of any other size made directly
+        void* p_memory = p_pool->Allocate(3*sizeof(PooledTestObject));
+        TS_ASSERT_EQUALS(p_pool->GetNumAllocated(), num_allocated);
+        p_pool->Deallocate(p_memory);
+        TS_ASSERT_EQUALS(p_pool->GetNumAllocated(), num_allocated);
+        TS_ASSERT_EQUALS(p_pool->GetCapacity(), capacity);
+
+        // Deallocating a null pointer does nothing
+        p_pool->Deallocate(nullptr);
+        TS_ASSERT_EQUALS(p_pool->GetNumAllocated(), num_allocated);
+    }
+
+    void TestOdeSystemsComeFromThePool() throw (Exception)
+    {
+        ObjectPool<CellPolarityOdeSystem>* p_pool = ObjectPool<CellPolarityOdeSystem>::Instance();
+        unsigned num_allocated = p_pool->GetNumAllocated();
+
+        std::vector<double> initial_conditions(1, 0.3);
+        CellPolarityOdeSystem* p_system = new CellPolarityOdeSystem(initial_conditions);
+        TS_ASSERT_EQUALS(p_pool->GetNumAllocated(), num_allocated + 1);
+        TS_ASSERT_DELTA(p_system->rGetStateVariables()[0], 0.3, 1e-12);
+
+        void* p_slot = p_system;
+        delete p_system;
+        TS_ASSERT_EQUALS(p_pool->GetNumAllocated(), num_allocated);
+
+        CellPolarityOdeSystem* p_other_system = new CellPolarityOdeSystem(initial_conditions);
+        TS_ASSERT_EQUALS(static_cast<void*>(p_other_system), p_slot);
+        delete p_other_system;
+    }
+};
+
+#endif /*TESTOBJECTPOOL_HPP_*/
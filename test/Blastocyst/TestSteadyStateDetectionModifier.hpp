@@ -0,0 +1,83 @@
+#ifndef TESTSTEADYSTATEDETECTIONMODIFIER_HPP_
+#define TESTSTEADYSTATEDETECTIONMODIFIER_HPP_
+
+#include <cxxtest/TestSuite.h>
+
+#include "AbstractCellBasedTestSuite.hpp"
+#include "PetscSetupAndFinalize.hpp"
+
+#include "TransitCellProliferativeType.hpp"
+
+#include "HoneycombMeshGenerator.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+
+#include "NissenOffLatticeSimulation.hpp"
+#include "SteadyStateDetectionModifier.hpp"
+#include "NissenForce.hpp"
+#include "NissenPairGeometryCache.hpp"
+#include "NissenHaloStateMirror.hpp"
+#include "CellPopulationStateTracker.hpp"
+#include "SimulationTime.hpp"
+
+#include "BlastocystTestCellsGenerator.hpp"
+#include "SmartPointers.hpp"
+
+/**
+ * Tests of SteadyStateDetectionModifier, which ends a phase once the embryo stops changing.
+ */
+class TestSteadyStateDetectionModifier : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestRelaxingClusterStopsEarly() throw (Exception)
+    {
+        HoneycombMeshGenerator generator(3, 3, 0);
+        MutableMesh<2,2>* p_generating_mesh = generator.GetMesh();
+        p_generating_mesh->Scale(0.7, 0.7);
+
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(*p_generating_mesh, 2.5);
+
+        std::vector<CellPtr> cells;
+        BlastocystTestCellsGenerator::GenerateCells<TransitCellProliferativeType>(mesh.GetNumNodes(), cells, false);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+
+        NissenOffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("SteadyStateDetection");
+        simulator.SetDt(1.0/200.0);
+        simulator.SetSamplingTimestepMultiple(200);
+        simulator.SetEndTime(100.0);
+
+        MAKE_PTR(NissenForce<2>, p_force);
+        p_force->SetCutOffLength(2.5);
+        simulator.AddForce(p_force);
+
+        MAKE_PTR(SteadyStateDetectionModifier<2>, p_modifier);
+        p_modifier->SetWindowLength(100);
+        p_modifier->SetDisplacementThreshold(1e-4);
+        simulator.AddSimulationModifier(p_modifier);
+
+        simulator.Solve();
+
+        // The squashed cluster spreads out and comes to rest well before the end time
+        TS_ASSERT(p_modifier->HasReachedSteadyState());
+        double end_time = SimulationTime::Instance()->GetTime();
+        TS_ASSERT_LESS_THAN(end_time, 100.0);
+        TS_ASSERT_DELTA(p_modifier->GetSteadyStateTime(), end_time, 1e-9);
+
+        // Steady state is only declared once a whole window has been sampled
+        TS_ASSERT_LESS_THAN_EQUALS(100.0/200.0, end_time);
+
+        // The time is logged
+        OutputFileHandler handler("SteadyStateDetection", false);
+        FileFinder steady_state_file = handler.FindFile("results_from_time_0/steadystate.dat");
+        TS_ASSERT(steady_state_file.Exists());
+
+        NissenPairGeometryCache<2>::Destroy();
+        NissenHaloStateMirror<2>::Destroy();
+        CellPopulationStateTracker<2>::Destroy();
+    }
+};
+
+#endif /*TESTSTEADYSTATEDETECTIONMODIFIER_HPP_*/